@@ -1,12 +1,31 @@
 #include "AsioIOServicePool.h"
+#include "Logger.h"
+#include "ConfigMgr.h"
 #include <iostream>
+#include <sstream>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
 using namespace std;
 
-AsioIOServicePool::AsioIOServicePool(std::size_t size)
-	: _ioServices(size)          // 初始化 IO 服务容器，创建 `size` 个 io_context 对象
-	, _workGuards(size)          // 初始化工作守卫容器，预留 `size` 个位置
+static std::size_t PoolSizeFromConfig() {
+	auto threads = ConfigMgr::Inst()["IOPool"]["Threads"];
+	std::size_t size = threads.empty() ? 2 : std::stoul(threads);
+	if (size == 0) {
+		size = std::thread::hardware_concurrency();
+	}
+	// hardware_concurrency 可能返回0
+	return size == 0 ? 2 : size;
+}
+
+AsioIOServicePool::AsioIOServicePool()
+	: _ioServices(PoolSizeFromConfig())          // 初始化 IO 服务容器，创建 `size` 个 io_context 对象
+	, _workGuards(_ioServices.size())          // 初始化工作守卫容器，预留 `size` 个位置
 	, _nextIOService(0)          // 初始化负载均衡索引，从第 0 个 IO 服务开始分配
 {
+	std::size_t size = _ioServices.size();
 	// 为每个 io_context 创建工作守卫，保持其事件循环持续运行
 	for (std::size_t i = 0; i < size; ++i) {
 		_workGuards[i] = std::make_unique<WorkGuard>(
@@ -14,26 +33,91 @@ AsioIOServicePool::AsioIOServicePool(std::size_t size)
 		);
 	}
 
+	// 每个io_context固定在一个核上，会话的读写、定时器都在该核上执行
+	auto cpus = ParseCpuSet(ConfigMgr::Inst()["IOPool"]["CpuSet"]);
+
 	// 遍历多个ioservice，创建多个线程，每个线程内部启动一个ioservice
 	for (std::size_t i = 0; i < _ioServices.size(); ++i) {
-		_threads.emplace_back([this, i]() { // emplace_back 在容器末尾原地构造元素
+		int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+		_threads.emplace_back([this, i, cpu]() { // emplace_back 在容器末尾原地构造元素
+			if (cpu >= 0 && !PinCurrentThread(cpu)) {
+				LOG_WARN("io thread " << i << " pin to cpu " << cpu << " failed");
+			}
 			_ioServices[i].run();
 			});
 	}
+	LOG_INFO("AsioIOServicePool start " << size << " threads");
+}
+
+std::vector<int> AsioIOServicePool::ParseCpuSet(const std::string& cpu_set) {
+	std::vector<int> cpus;
+	std::stringstream ss(cpu_set);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		if (item.find_first_not_of(" \t") == std::string::npos) {
+			continue;
+		}
+		auto pos = item.find('-');
+		if (pos == std::string::npos) {
+			cpus.push_back(std::stoi(item));
+			continue;
+		}
+		int first = std::stoi(item.substr(0, pos));
+		int last = std::stoi(item.substr(pos + 1));
+		for (int cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+bool AsioIOServicePool::PinCurrentThread(int cpu) {
+#ifdef _WIN32
+	if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+		return false;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu, &cpuset);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#endif
 }
 
 AsioIOServicePool::~AsioIOServicePool() {
 	Stop(); // 利用 RAII 机制，确保对象销毁时资源正确释放
-	std::cout << "AsioIOServicePool destruct" << std::endl;
+	LOG_INFO("AsioIOServicePool destruct");
 }
 
 boost::asio::io_context& AsioIOServicePool::GetIOService() {
-	auto& service = _ioServices[_nextIOService++]; // 选择下一个 IO 服务（轮询）
+	return _ioServices[GetIOServiceIndex()];
+}
+
+std::size_t AsioIOServicePool::GetIOServiceIndex() {
+	auto index = _nextIOService++; // 选择下一个 IO 服务（轮询）
 	// 重置索引，实现循环轮询
 	if (_nextIOService == _ioServices.size()) {
 		_nextIOService = 0;
 	}
-	return service;
+	return index;
+}
+
+boost::asio::io_context& AsioIOServicePool::GetIOService(std::size_t index) {
+	return _ioServices[index];
+}
+
+std::size_t AsioIOServicePool::Size() const {
+	return _ioServices.size();
+}
+
+bool AsioIOServicePool::InPoolThread() {
+	for (auto& io : _ioServices) {
+		if (io.get_executor().running_in_this_thread()) {
+			return true;
+		}
+	}
+	return false;
 }
 
 void AsioIOServicePool::Stop() {
@@ -27,10 +27,24 @@ public:
 
 	// 使用 round-robin 的方式返回一个 io_service
 	boost::asio::io_context& GetIOService();
+	// 使用 round-robin 的方式返回下一个 io_service 的下标
+	std::size_t GetIOServiceIndex();
+	// 根据下标返回 io_service
+	boost::asio::io_context& GetIOService(std::size_t index);
+	// io_service 的数量
+	std::size_t Size() const;
+	// 当前线程是否是池中的io线程，io线程上不能同步等待其他io线程完成的操作
+	bool InPoolThread();
 	void Stop();
 
 private:
-	explicit AsioIOServicePool(std::size_t size = 2/*std::thread::hardware_concurrency()*/); // 默认两个线程(cpu有几个核就分配多少个线程)
+	// 线程数和绑核配置从config.ini的[IOPool]段读取
+	// Threads = 0 表示按cpu核数创建，CpuSet 形如 0-3,8,10，为空表示不绑核
+	AsioIOServicePool();
+	// 解析CpuSet配置，返回cpu编号列表
+	static std::vector<int> ParseCpuSet(const std::string& cpu_set);
+	// 将当前线程绑定到指定cpu上
+	static bool PinCurrentThread(int cpu);
 	std::vector<IOService> _ioServices;
 	std::vector<WorkGuardPtr> _workGuards;
 	std::vector<std::thread> _threads; // 存储工作线程的容器（每个线程运行一个io_context的run()）
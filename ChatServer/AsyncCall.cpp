@@ -0,0 +1,17 @@
+#include "AsyncCall.h"
+#include "ConfigMgr.h"
+
+BlockingPool& BlockingPool::Inst() {
+	static BlockingPool* inst = new BlockingPool();
+	return *inst;
+}
+
+BlockingPool::BlockingPool() :_pool(ThreadsFromConfig()) {
+	LOG_INFO("BlockingPool start " << ThreadsFromConfig() << " threads");
+}
+
+std::size_t BlockingPool::ThreadsFromConfig() {
+	auto threads = ConfigMgr::Inst()["LogicSystem"]["BlockingThreads"];
+	std::size_t size = threads.empty() ? 16 : std::stoul(threads);
+	return size == 0 ? 16 : size;
+}
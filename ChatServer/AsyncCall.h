@@ -0,0 +1,80 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/spawn.hpp>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <utility>
+#include "Logger.h"
+
+// 逻辑层协程中使用的异步调用
+// 1. mysql、grpc的客户端都是同步接口，调用放到BlockingPool的线程上执行(redis使用RedisClient，不经过这里)，
+//    协程挂起期间逻辑线程可以继续处理其他会话的消息
+// 2. 调用完成后回到协程所在的逻辑线程恢复执行，协程内不需要考虑线程切换
+class BlockingPool
+{
+public:
+	// 不析构，进程退出时LogicSystem析构中仍可能有协程在等待调用完成
+	static BlockingPool& Inst();
+	BlockingPool(const BlockingPool&) = delete;
+	BlockingPool& operator=(const BlockingPool&) = delete;
+	boost::asio::thread_pool& Pool() {
+		return _pool;
+	}
+private:
+	// 线程数从config.ini的[LogicSystem] BlockingThreads读取，默认16
+	// 同时进行的阻塞调用受限于各连接池的大小，线程数不需要超过连接数之和
+	BlockingPool();
+	static std::size_t ThreadsFromConfig();
+	boost::asio::thread_pool _pool;
+};
+
+// BlockingPool线程上的执行结果，fn抛出的异常带回协程中重新抛出
+template <typename R>
+struct AsyncCallResult {
+	R _value{};
+	std::exception_ptr _error;
+};
+
+// 在BlockingPool上执行fn()，挂起当前协程直到执行完成，返回fn的结果
+// fn抛出异常时在协程中重新抛出，不会逃出BlockingPool的线程
+template <typename R, typename Fn>
+R AsyncCall(Fn fn, boost::asio::yield_context yield) {
+	auto result = boost::asio::async_initiate<boost::asio::yield_context, void(AsyncCallResult<R>)>(
+		[](auto handler, Fn fn) {
+			auto ex = boost::asio::get_associated_executor(handler);
+			auto work = boost::asio::make_work_guard(ex);
+			boost::asio::post(BlockingPool::Inst().Pool(),
+				[handler = std::move(handler), fn = std::move(fn), work = std::move(work)]() mutable {
+				AsyncCallResult<R> result;
+				try {
+					result._value = fn();
+				}
+				catch (...) {
+					result._error = std::current_exception();
+				}
+				auto ex = work.get_executor();
+				//回到协程所在的执行器上恢复
+				boost::asio::post(ex, [handler = std::move(handler), result = std::move(result)]() mutable {
+					handler(std::move(result));
+				});
+				work.reset();
+			});
+		}, yield, std::move(fn));
+	if (result._error) {
+		std::rethrow_exception(result._error);
+	}
+	return std::move(result._value);
+}
+
+// 挂起当前协程ms毫秒，不占用逻辑线程
+inline void AsyncSleep(int ms, boost::asio::yield_context yield) {
+	boost::asio::async_initiate<boost::asio::yield_context, void()>(
+		[](auto handler, int ms) {
+			auto ex = boost::asio::get_associated_executor(handler);
+			auto timer = std::make_shared<boost::asio::steady_timer>(ex, std::chrono::milliseconds(ms));
+			timer->async_wait([timer, handler = std::move(handler)](const boost::system::error_code&) mutable {
+				handler();
+			});
+		}, yield, ms);
+}
@@ -1,98 +1,174 @@
 #include "CServer.h"
+#include "Logger.h"
 #include <iostream>
 #include "AsioIOServicePool.h"
 #include "UserMgr.h"
 #include "RedisMgr.h"
 #include "ConfigMgr.h"
+#include "MsgPool.h"
+#include "Metrics.h"
+#include "OverloadCtrl.h"
+#include "RateLimiter.h"
+#include <json/json.h>
+#include <array>
 
 // 构造函数中监听对方连接
 CServer::CServer(boost::asio::io_context& io_context, short port):_io_context(io_context), _port(port),
-_acceptor(io_context, tcp::endpoint(tcp::v4(),port)), _timer(_io_context, std::chrono::seconds(60))
+_acceptor(io_context), _b_reuse_port(false), _timer(_io_context, std::chrono::seconds(60))
 {
-	cout << "Server start success, listen on port : " << _port << endl;
-	StartAccept();
+	auto pool = AsioIOServicePool::GetInstance();
+	auto pool_size = pool->Size();
+	for (std::size_t i = 0; i < pool_size; ++i) {
+		_io_sessions.push_back(std::make_unique<IOSessions>());
+		_wheels.push_back(std::make_unique<TimingWheel>(pool->GetIOService(i), std::chrono::seconds(1),
+			[](TimerNode* node, std::shared_ptr<void> holder) {
+				std::static_pointer_cast<CSession>(holder)->OnTimer(node);
+			}));
+	}
+
+	Metrics::Inst().AddGauge("chat_sessions", "Sessions currently registered on this server.", [this]() {
+		return static_cast<double>(_sessions.Size());
+	});
+
+	_b_reuse_port = ConfigMgr::Inst()["IOPool"]["AcceptMode"] == "reuseport";
+#ifndef SO_REUSEPORT
+	if (_b_reuse_port) {
+		LOG_WARN("SO_REUSEPORT is not supported on this platform, use single acceptor");
+		_b_reuse_port = false;
+	}
+#endif
+
+	tcp::endpoint endpoint(tcp::v4(), port);
+	if (!_b_reuse_port) {
+		OpenAcceptor(_acceptor, endpoint);
+		LOG_INFO("Server start success, listen on port : " << _port);
+		StartAccept();
+		return;
+	}
+
+	//每个io_context一个acceptor，由内核在多个监听socket之间分配新连接
+	//连接从accept开始的整个生命周期都在同一个io线程上
+	for (std::size_t i = 0; i < pool_size; ++i) {
+		auto acceptor = std::make_unique<tcp::acceptor>(pool->GetIOService(i));
+		OpenAcceptor(*acceptor, endpoint);
+		_acceptors.push_back(std::move(acceptor));
+	}
+	LOG_INFO("Server start success, listen on port : " << _port << " with " << pool_size << " acceptors");
+	for (std::size_t i = 0; i < pool_size; ++i) {
+		StartAccept(i);
+	}
+}
+
+void CServer::OpenAcceptor(tcp::acceptor& acceptor, const tcp::endpoint& endpoint) {
+	acceptor.open(endpoint.protocol());
+	acceptor.set_option(tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+	if (_b_reuse_port) {
+		acceptor.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+	}
+#endif
+	acceptor.bind(endpoint);
+	acceptor.listen();
 }
 
 CServer::~CServer() {
-	cout << "Server destruct listen on port : " << _port << endl;
+	LOG_INFO("Server destruct listen on port : " << _port);
 }
 
 void CServer::HandleAccept(shared_ptr<CSession> new_session, const boost::system::error_code& error){
-	if (!error) {
+	if (!error && OverloadCtrl::Inst().Overloaded()) {
+		RejectSession(new_session);
+	}
+	else if (!error) {
+		//先登记再开始读取，保证第一次读回调时会话已经有效
+		auto conn_id = new_session->GetConnId();
+		_sessions.Insert(conn_id, new_session);
+		{
+			auto& io_sessions = *_io_sessions[new_session->GetIOIndex()];
+			lock_guard<mutex> io_lock(io_sessions._mtx);
+			io_sessions._sessions.insert(make_pair(conn_id, new_session));
+		}
+		new_session->SetValid(true);
 		new_session->Start();
-		lock_guard<mutex> lock(_mutex);
-		_sessions.insert(make_pair(new_session->GetSessionId(), new_session));
 	}
 	else {
-		cout << "session accept failed, error is " << error.what() << endl;
+		LOG_ERROR("session accept failed, error is " << error.what());
+	}
+
+	if (_b_reuse_port) {
+		StartAccept(new_session->GetIOIndex());
+		return;
 	}
 	StartAccept();
 }
 
+void CServer::RejectSession(shared_ptr<CSession> session) {
+	auto& ctrl = OverloadCtrl::Inst();
+	ctrl.CountRejectAccept();
+	//还没有登录，按json编码回复登录失败，客户端按登录回包处理并稍后重试
+	client::ChatLoginRsp rsp;
+	rsp.error = ErrorCodes::ServerBusy;
+	rsp.retry_after = ctrl.RetryAfter();
+	auto body = EncodeClientMsg(ClientCodec::Json, rsp);
+	auto node = MakePooled<SendNode>(body.c_str(), static_cast<int>(body.length()), MSG_CHAT_LOGIN_RSP);
+	//会话没有登记也没有开始读取，写完即关闭
+	boost::asio::async_write(session->GetSocket(), boost::asio::buffer(node->_data, node->_total_len),
+		[session, node](const boost::system::error_code&, std::size_t) {
+			session->Close();
+		});
+}
+
 void CServer::StartAccept() {
-	auto &io_context = AsioIOServicePool::GetInstance()->GetIOService();
-	shared_ptr<CSession> new_session = make_shared<CSession>(io_context, this);
+	auto pool = AsioIOServicePool::GetInstance();
+	auto io_index = pool->GetIOServiceIndex();
+	auto &io_context = pool->GetIOService(io_index);
+	shared_ptr<CSession> new_session = make_shared<CSession>(io_context, this, io_index);
 	_acceptor.async_accept(new_session->GetSocket(), std::bind(&CServer::HandleAccept, this, new_session, placeholders::_1));
 }
 
-void CServer::ClearSession(std::string session_id) {
-	
-	lock_guard<mutex> lock(_mutex);
-	if (_sessions.find(session_id) != _sessions.end()) {
-		auto uid = _sessions[session_id]->GetUserId();
+void CServer::StartAccept(std::size_t io_index) {
+	auto &io_context = AsioIOServicePool::GetInstance()->GetIOService(io_index);
+	shared_ptr<CSession> new_session = make_shared<CSession>(io_context, this, io_index);
+	_acceptors[io_index]->async_accept(new_session->GetSocket(), std::bind(&CServer::HandleAccept, this, new_session, placeholders::_1));
+}
 
-		//移除用户和session的关联
-		UserMgr::GetInstance()->RmvUserSession(uid, session_id);
+void CServer::ClearSession(uint64_t conn_id) {
+	shared_ptr<CSession> session;
+	if (!_sessions.Find(conn_id, session)) {
+		return;
 	}
 
-	_sessions.erase(session_id);
-}
+	//先置为无效，读回调看到标志后不再处理数据
+	session->SetValid(false);
+	//定时轮只能在会话所在的io线程访问
+	boost::asio::post(session->GetSocket().get_executor(), [session]() {
+		session->CancelHeartbeat();
+	});
+	//移除用户和session的关联
+	UserMgr::GetInstance()->RmvUserSession(session->GetUserId(), conn_id);
 
-shared_ptr<CSession> CServer::GetSession(std::string uuid) {
-	lock_guard<mutex> lock(_mutex);
-	auto it = _sessions.find(uuid);
-	if (it != _sessions.end()) {
-		return it->second;
+	{
+		auto& io_sessions = *_io_sessions[session->GetIOIndex()];
+		lock_guard<mutex> io_lock(io_sessions._mtx);
+		io_sessions._sessions.erase(conn_id);
 	}
-	return nullptr;
+
+	_sessions.Erase(conn_id);
 }
 
-bool CServer::CheckValid(std::string uuid)
-{
-	lock_guard<mutex> lock(_mutex);
-	auto it = _sessions.find(uuid);
-	if (it != _sessions.end()) {
-		return true;
-	}
-	return false;
+shared_ptr<CSession> CServer::GetSession(uint64_t conn_id) {
+	shared_ptr<CSession> session;
+	_sessions.Find(conn_id, session);
+	return session;
 }
 
 void CServer::on_timer(const boost::system::error_code& ec) {
 	if (ec) {
-		std::cout << "timer error: " << ec.message() << std::endl;
+		LOG_ERROR("timer error: " << ec.message());
 		return;
 	}
-	std::vector<std::shared_ptr<CSession>> _expired_sessions;
-	int session_count = 0;
-	//此处加锁遍历session
-	std::map<std::string, shared_ptr<CSession>> sessions_copy;
-	{
-		lock_guard<mutex> lock(_mutex);
-		sessions_copy = _sessions;
-	}
-
-	time_t now = std::time(nullptr);
-	for (auto iter = sessions_copy.begin(); iter != sessions_copy.end(); iter++) {
-		auto b_expired = iter->second->IsHeartbeatExpired(now);
-		if (b_expired) {
-			//关闭socket, 其实这里也会触发async_read的错误处理
-			iter->second->Close();
-			//收集过期信息
-			_expired_sessions.push_back(iter->second);
-			continue;
-		}
-		session_count++;
-	}
+	//心跳超时由各io_context的定时轮处理，这里只上报连接数
+	auto session_count = _sessions.Size();
 
 	//设置session数量
 	auto& cfg = ConfigMgr::Inst();
@@ -100,11 +176,14 @@ void CServer::on_timer(const boost::system::error_code& ec) {
 	auto count_str = std::to_string(session_count);
 	RedisMgr::GetInstance()->HSet(LOGIN_COUNT, self_name, count_str);
 
-	//处理过期session, 单独提出，防止死锁
-	for (auto &session : _expired_sessions) {
-		session->DealExceptionSession();
-	}
-	
+	//输出消息内存池的命中率和占用情况
+	auto pool_stats = MsgPool::Inst().GetStats();
+	LOG_INFO("msg pool hit rate is " << pool_stats.HitRate() << ", bytes held is " << pool_stats._bytes_held
+		<< ", bytes in use is " << pool_stats._bytes_in_use << ", oversize count is " << pool_stats._oversize_count);
+
+	//回收空闲用户的限流令牌桶
+	RateLimiter::Inst().Purge();
+
 	//再次设置，下一个60s检测
 	_timer.expires_after(std::chrono::seconds(60));
 	_timer.async_wait([this](boost::system::error_code ec) {
@@ -112,8 +191,90 @@ void CServer::on_timer(const boost::system::error_code& ec) {
 	});
 }
 
+void CServer::Broadcast(short msgid, const std::string& json_body, const std::string& proto_body)
+{
+	//下标依次为编码(json/proto)、是否压缩、是否支持扩展头部，和SendBody组帧规则一致
+	using NodeTable = std::array<std::shared_ptr<SendNode>, 8>;
+	auto nodes = std::make_shared<NodeTable>();
+	for (int codec = 0; codec < 2; ++codec) {
+		const std::string& body = codec ? proto_body : json_body;
+		for (int compress = 0; compress < 2; ++compress) {
+			for (int ext_head = 0; ext_head < 2; ++ext_head) {
+				(*nodes)[codec * 4 + compress * 2 + ext_head] = CSession::MakeBodyNode(body, msgid,
+					codec ? ClientCodec::Proto : ClientCodec::Json, compress != 0, ext_head != 0);
+			}
+		}
+	}
+
+	auto pool = AsioIOServicePool::GetInstance();
+	for (std::size_t i = 0; i < _io_sessions.size(); ++i) {
+		//投递到各自的io_context，由该线程遍历自己的会话并入队
+		boost::asio::post(pool->GetIOService(i), [this, i, nodes, msgid]() {
+			std::vector<shared_ptr<CSession>> sessions;
+			{
+				auto& io_sessions = *_io_sessions[i];
+				lock_guard<mutex> lock(io_sessions._mtx);
+				sessions.reserve(io_sessions._sessions.size());
+				for (auto& item : io_sessions._sessions) {
+					sessions.push_back(item.second);
+				}
+			}
+
+			std::size_t skipped = 0;
+			for (auto& session : sessions) {
+				//只推送给已经登录的用户
+				if (session->GetUserId() == 0) {
+					continue;
+				}
+				auto& node = (*nodes)[(session->GetCodec() == ClientCodec::Proto ? 4 : 0)
+					+ (session->GetCompress() ? 2 : 0) + (session->GetExtHead() ? 1 : 0)];
+				if (!node) {
+					++skipped;
+					continue;
+				}
+				session->Send(node);
+			}
+			if (skipped > 0) {
+				LOG_WARN("broadcast msg too long for short head, msg id is " << msgid
+					<< ", skipped sessions is " << skipped);
+			}
+		});
+	}
+}
+
+bool CServer::BroadcastNotice(int notice_type, const std::string& content)
+{
+	client::NotifySystemMsg notify;
+	notify.error = ErrorCodes::Success;
+	notify.type = notice_type;
+	notify.content = content;
+	//每种编码只序列化一次，所有会话共享
+	std::string json_str = EncodeClientMsg(ClientCodec::Json, notify);
+	std::string proto_str = EncodeClientMsg(ClientCodec::Proto, notify);
+	//json不压缩是最大的一种包，放不下短头部时部分会话收不到，整条公告拒绝
+	if (json_str.length() > SHRT_MAX) {
+		LOG_WARN("notice too long for short head, length is " << json_str.length());
+		return false;
+	}
+	Broadcast(ID_NOTIFY_SYSTEM_MSG_REQ, json_str, proto_str);
+	return true;
+}
+
+TimingWheel& CServer::GetTimingWheel(std::size_t io_index)
+{
+	return *_wheels[io_index];
+}
+
 void CServer::StartTimer()
 {
+	auto pool = AsioIOServicePool::GetInstance();
+	for (std::size_t i = 0; i < _wheels.size(); ++i) {
+		auto wheel = _wheels[i].get();
+		boost::asio::post(pool->GetIOService(i), [wheel]() {
+			wheel->Start();
+		});
+	}
+
 	auto self(shared_from_this());
 	_timer.async_wait([self](boost::system::error_code ec) {
 		self->on_timer(ec);
@@ -123,4 +284,8 @@ void CServer::StartTimer()
 void CServer::StopTimer()
 {
 	_timer.cancel();
+	//此时io线程已经退出，直接停止定时轮
+	for (auto& wheel : _wheels) {
+		wheel->Stop();
+	}
 }
@@ -6,6 +6,10 @@
 #include <map>
 #include <mutex>
 #include <boost/asio/steady_timer.hpp>
+#include <vector>
+#include <unordered_map>
+#include "ShardedMap.h"
+#include "TimingWheel.h"
 
 using boost::asio::ip::tcp;
 
@@ -15,11 +19,9 @@ public:
 	CServer(boost::asio::io_context& io_context, short port);
 	~CServer();
 	// ݱʶuidỰϿͻˣ
-	void ClearSession(std::string); 
-	// uidȡsession
-	shared_ptr<CSession> GetSession(std::string);
-	// ʶӦĻỰǷЧǷߣ
-	bool CheckValid(std::string);
+	void ClearSession(uint64_t conn_id); 
+	// Ựidȡsession
+	shared_ptr<CSession> GetSession(uint64_t conn_id);
 	
 	// ʱص⡢ʱ
 	void on_timer(const boost::system::error_code& ec);
@@ -27,17 +29,41 @@ public:
 	void StartTimer(); 
 	// ֹͣʱ
 	void StopTimer();
+	// ѵ¼߻Ự㲥ͬһϢỰͶйõĽڵ
+	// io_context֣ÿio_contextֻԼ߳ϵĻỰ
+	// 롢ѹչͷÿϸһΣỰЭ̵Ľѡ񣬶ͷŲµĻỰ
+	void Broadcast(short msgid, const std::string& json_body, const std::string& proto_body);
+	// 㲥ϵͳͣά֪ͨδѹjsonͷʱܾfalse
+	bool BroadcastNotice(int notice_type, const std::string& content);
+	// ±Ӧio_contextʱֻ֣ڸio_context߳з
+	TimingWheel& GetTimingWheel(std::size_t io_index);
 private: 
 	// ӵĻص
 	void HandleAccept(shared_ptr<CSession>, const boost::system::error_code & error);
+	// ʱܾӣظԼĵ¼ʧܺر
+	void RejectSession(shared_ptr<CSession> session);
 	// ʼ첽ͻ
 	void StartAccept();
+	// reuseportģʽָio_contextacceptorϼ
+	void StartAccept(std::size_t io_index);
+	void OpenAcceptor(tcp::acceptor& acceptor, const tcp::endpoint& endpoint);
 	
 	boost::asio::io_context &_io_context;
 	short _port;
 	tcp::acceptor _acceptor;
-	std::map<std::string, shared_ptr<CSession>> _sessions;
-	std::mutex _mutex;
+	// Ƿÿio_contextһacceptor(SO_REUSEPORT)
+	bool _b_reuse_port;
+	std::vector<std::unique_ptr<tcp::acceptor>> _acceptors;
+	// ỰidΪkeyķֶλỰЧԼɻỰı־ɣ·
+	ShardedMap<uint64_t, shared_ptr<CSession>> _sessions;
+	// io_contextֵĻỰϣ±AsioIOServicePoolһ£㲥ʹ
+	struct IOSessions {
+		std::mutex _mtx;
+		std::unordered_map<uint64_t, shared_ptr<CSession>> _sessions;
+	};
+	std::vector<std::unique_ptr<IOSessions>> _io_sessions;
+	// ÿio_contextһʱֻ֣ʱĻỰ
+	std::vector<std::unique_ptr<TimingWheel>> _wheels;
 	boost::asio::steady_timer _timer;
 };
 
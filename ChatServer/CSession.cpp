@@ -1,25 +1,139 @@
 #include "CSession.h"
+#include "Logger.h"
 #include "CServer.h"
 #include <iostream>
 #include <sstream>
+#include <climits>
 #include <json/json.h>
 #include <json/value.h>
 #include <json/reader.h>
 #include "LogicSystem.h"
+#include "RateLimiter.h"
 #include "RedisMgr.h"
 #include "ConfigMgr.h"
+#include "Compressor.h"
+#include "Metrics.h"
 
-CSession::CSession(boost::asio::io_context& io_context, CServer* server):
-	_socket(io_context), _server(server), _b_close(false),_b_head_parse(false), _user_uid(0) 
+namespace {
+
+// 所有会话发送队列中积压的字节数
+MetricGauge& SendBytesGauge() {
+	static MetricGauge& gauge = Metrics::Inst().GetGauge("chat_send_queue_bytes",
+		"Bytes queued for sending across all sessions.");
+	return gauge;
+}
+
+// io层直接回复的心跳数
+MetricGauge& FastHeartbeatGauge() {
+	static MetricGauge& gauge = Metrics::Inst().GetGauge("chat_heartbeat_fast_total",
+		"Heartbeats answered on the io thread without going through LogicSystem.");
+	return gauge;
+}
+
+std::shared_ptr<SendNode> MakeHeartbeatFrame(ClientCodec codec) {
+	client::HeartBeatRsp rsp;
+	rsp.error = ErrorCodes::Success;
+	auto body = EncodeClientMsg(codec, rsp);
+	unsigned short flags = codec == ClientCodec::Proto ? HEAD_PROTO_FLAG : 0;
+	auto frame = MakePooled<SendNode>(body.c_str(), static_cast<int>(body.length()), ID_HEARTBEAT_RSP, false, flags);
+	frame->SetConstant();
+	return frame;
+}
+
+// 心跳回包的内容固定，每种编码组一个常量帧，所有会话的发送队列共享，不再逐次序列化和分配
+const std::shared_ptr<SendNode>& HeartbeatFrame(ClientCodec codec) {
+	static const std::shared_ptr<SendNode> json_frame = MakeHeartbeatFrame(ClientCodec::Json);
+	static const std::shared_ptr<SendNode> proto_frame = MakeHeartbeatFrame(ClientCodec::Proto);
+	return codec == ClientCodec::Proto ? proto_frame : json_frame;
+}
+
+}
+
+SessionConfig::SessionConfig() :_ring_recv(false), _recv_buf_size(64 * 1024),
+_write_gather(false), _max_flush_bytes(64 * 1024), _max_ext_length(16 * 1024 * 1024),
+_heartbeat_timeout(20000000), _send_high_water(4 * 1024 * 1024), _send_low_water(1024 * 1024),
+_slow_consumer_timeout(30), _throttle_peers(false), _compress(false), _compress_min_bytes(256), _compress_level(6) {
+	auto& cfg = ConfigMgr::Inst();
+	_ring_recv = cfg["Session"]["RecvMode"] == "ring";
+	auto buf_size = cfg["Session"]["RecvBufSize"];
+	if (!buf_size.empty()) {
+		//至少要能放下一个最大长度的消息
+		_recv_buf_size = (std::max)(static_cast<std::size_t>(std::stoul(buf_size)),
+			static_cast<std::size_t>(HEAD_TOTAL_LEN + MAX_LENGTH));
+	}
+
+	_write_gather = cfg["Session"]["WriteMode"] == "gather";
+	auto flush_bytes = cfg["Session"]["MaxFlushBytes"];
+	if (!flush_bytes.empty()) {
+		_max_flush_bytes = std::stoul(flush_bytes);
+	}
+
+	auto ext_length = cfg["Session"]["MaxExtLength"];
+	if (!ext_length.empty()) {
+		_max_ext_length = std::stoul(ext_length);
+	}
+
+	auto heartbeat_timeout = cfg["Session"]["HeartbeatTimeout"];
+	if (!heartbeat_timeout.empty()) {
+		_heartbeat_timeout = std::stoull(heartbeat_timeout);
+	}
+
+	auto high_water = cfg["Session"]["SendHighWater"];
+	if (!high_water.empty()) {
+		_send_high_water = std::stoul(high_water);
+	}
+	auto low_water = cfg["Session"]["SendLowWater"];
+	if (!low_water.empty()) {
+		_send_low_water = std::stoul(low_water);
+	}
+	//低水位不能高于高水位，否则永远无法恢复
+	_send_low_water = (std::min)(_send_low_water, _send_high_water);
+
+	auto slow_timeout = cfg["Session"]["SlowConsumerTimeout"];
+	if (!slow_timeout.empty()) {
+		_slow_consumer_timeout = std::stoull(slow_timeout);
+	}
+	_throttle_peers = cfg["Session"]["ThrottlePeers"] == "true";
+
+	_compress = cfg["Session"]["Compress"] == "deflate";
+	auto compress_min = cfg["Session"]["CompressMinBytes"];
+	if (!compress_min.empty()) {
+		_compress_min_bytes = std::stoul(compress_min);
+	}
+	auto compress_level = cfg["Session"]["CompressLevel"];
+	if (!compress_level.empty()) {
+		_compress_level = std::stoi(compress_level);
+	}
+}
+
+const SessionConfig& SessionConfig::Inst() {
+	static SessionConfig cfg;
+	return cfg;
+}
+
+CSession::CSession(boost::asio::io_context& io_context, CServer* server, std::size_t io_index):
+	_socket(io_context), _io_index(io_index), _b_valid(false), _server(server), _b_close(false), _b_drain_posted(false),
+	_flush_count(0), _send_bytes(0), _b_over_high(false), _read_pause_count(0), _b_read_stalled(false),
+	_b_head_parse(false), _ext_head(false), _compress(false), _codec(ClientCodec::Json), _body_flags(0), _body_msg_id(0),
+	_user_uid(0)
 {
+	for (auto& running : _b_logic_running) {
+		running = false;
+	}
 	boost::uuids::uuid  a_uuid = boost::uuids::random_generator()();
 	_session_id = boost::uuids::to_string(a_uuid);
-	_recv_head_node = make_shared<MsgNode>(HEAD_TOTAL_LEN);
+	static std::atomic<uint64_t> next_conn_id(1);
+	_conn_id = next_conn_id.fetch_add(1, std::memory_order_relaxed);
+	if (SessionConfig::Inst()._ring_recv) {
+		_recv_ring = std::make_unique<RecvRingBuffer>(SessionConfig::Inst()._recv_buf_size);
+	}
 	_last_heartbeat = std::time(nullptr);
 }
 
 CSession::~CSession() {
-	std::cout << "~CSession destruct" << endl;
+	LOG_DEBUG("~CSession destruct");
+	//关闭时没有发出去的消息随会话一起释放
+	SendBytesGauge().Add(-static_cast<int64_t>(_send_bytes));
 }
 
 tcp::socket& CSession::GetSocket() {
@@ -30,6 +144,18 @@ std::string& CSession::GetSessionId() {
 	return _session_id;
 }
 
+uint64_t CSession::GetConnId() const {
+	return _conn_id;
+}
+
+bool CSession::IsValid() const {
+	return _b_valid.load(std::memory_order_acquire);
+}
+
+void CSession::SetValid(bool valid) {
+	_b_valid.store(valid, std::memory_order_release);
+}
+
 void CSession::SetUserId(int uid)
 {
 	_user_uid = uid;
@@ -41,40 +167,240 @@ int CSession::GetUserId()
 }
 
 void CSession::Start(){
+	//切到会话所在的io线程再开始，定时轮只在该线程访问
+	auto self = SharedSelf();
+	boost::asio::post(_socket.get_executor(), [self, this]() {
+		UpdateHeartbeat();
+		ContinueRead();
+	});
+}
+
+void CSession::ContinueRead() {
+	//读取被暂停时不再发起读操作，恢复时再继续
+	if (_read_pause_count > 0) {
+		_b_read_stalled = true;
+		return;
+	}
+	_b_read_stalled = false;
+	if (_recv_ring) {
+		AsyncReadRing();
+		return;
+	}
 	AsyncReadHead(HEAD_TOTAL_LEN);
 }
 
+void CSession::PauseRead() {
+	auto self = SharedSelf();
+	boost::asio::post(_socket.get_executor(), [self, this]() {
+		++_read_pause_count;
+	});
+}
+
+void CSession::ResumeRead() {
+	auto self = SharedSelf();
+	boost::asio::post(_socket.get_executor(), [self, this]() {
+		if (_read_pause_count > 0 && --_read_pause_count == 0 && _b_read_stalled && !_b_close) {
+			ContinueRead();
+		}
+	});
+}
+
+void CSession::ThrottlePeer(std::shared_ptr<CSession> peer) {
+	if (!SessionConfig::Inst()._throttle_peers || peer.get() == this) {
+		return;
+	}
+
+	//积压状态只在本会话的io线程访问
+	auto self = SharedSelf();
+	boost::asio::dispatch(_socket.get_executor(), [self, this, peer]() {
+		if (!_b_over_high) {
+			return;
+		}
+		for (auto& throttled : _throttled_peers) {
+			if (throttled.lock() == peer) {
+				return;
+			}
+		}
+		_throttled_peers.push_back(peer);
+		LOG_WARN("session: " << _session_id << " is over high water, pause reading from peer "
+			<< peer->GetSessionId());
+		peer->PauseRead();
+	});
+}
+
+void CSession::OnTimer(TimerNode* node) {
+	if (node == &_hb_node) {
+		LOG_INFO("heartbeat expired, session id is  " << _session_id);
+		CloseOnTimer();
+		return;
+	}
+
+	if (node == &_slow_node) {
+		if (!_b_over_high) {
+			return;
+		}
+		LOG_WARN("slow consumer, session id is " << _session_id << ", uid is " << _user_uid.load()
+			<< ", send backlog " << _send_bytes << " bytes over " << SessionConfig::Inst()._slow_consumer_timeout
+			<< "s, disconnect");
+		CloseOnTimer();
+	}
+}
+
+void CSession::CloseOnTimer() {
+	Close();
+	//有挂起的读操作时由读回调统一清理，读取已暂停时没有回调，这里直接清理
+	if (_b_read_stalled) {
+		DealExceptionSession();
+	}
+}
+
+std::size_t CSession::GetIOIndex() const {
+	return _io_index;
+}
+
+void CSession::SetExtHead(bool ext_head) {
+	_ext_head = ext_head;
+}
+
+bool CSession::GetExtHead() const {
+	return _ext_head;
+}
+
+void CSession::SetCompress(bool compress) {
+	_compress = compress;
+}
+
+bool CSession::GetCompress() const {
+	return _compress;
+}
+
+void CSession::SetCodec(ClientCodec codec) {
+	_codec = codec;
+}
+
+ClientCodec CSession::GetCodec() const {
+	return _codec;
+}
+
 void CSession::Send(std::string msg, short msgid) {
-	std::lock_guard<std::mutex> lock(_send_lock);
-	int send_que_size = _send_que.size();
-	if (send_que_size > MAX_SENDQUE) {
-		std::cout << "session: " << _session_id << " send que fulled, size is " << MAX_SENDQUE << endl;
+	SendBody(msg, msgid, ClientCodec::Json);
+}
+
+void CSession::SendBody(const std::string& msg, short msgid, ClientCodec codec) {
+	auto node = MakeBodyNode(msg, msgid, codec, _compress, _ext_head);
+	if (!node) {
+		LOG_WARN("session: " << _session_id << " msg too long for short head, msg id is " << msgid
+			<< ", length is " << msg.length());
 		return;
 	}
+	Send(node);
+}
 
-	_send_que.push(make_shared<SendNode>(msg.c_str(), msg.length(), msgid));
-	if (send_que_size > 0) {
-		return; // 此时消息正在等待发送，不需要再做其他处理。
+std::shared_ptr<SendNode> CSession::MakeBodyNode(const std::string& msg, short msgid, ClientCodec codec,
+	bool compress, bool ext_head) {
+	unsigned short flags = codec == ClientCodec::Proto ? HEAD_PROTO_FLAG : 0;
+	//开启压缩后较大的消息在调用线程压缩，压缩后没有变小的按原文发送
+	auto& cfg = SessionConfig::Inst();
+	std::string packed;
+	if (compress && msg.length() >= cfg._compress_min_bytes
+		&& Compressor::Deflate(msg.data(), msg.length(), cfg._compress_level, packed)) {
+		flags |= HEAD_COMPRESS_FLAG;
 	}
-	auto& msgnode = _send_que.front();
-	boost::asio::async_write(_socket, boost::asio::buffer(msgnode->_data, msgnode->_total_len),
-		std::bind(&CSession::HandleWrite, this, std::placeholders::_1, SharedSelf()));
+	const std::string& body = (flags & HEAD_COMPRESS_FLAG) ? packed : msg;
+
+	//超过MAX_LENGTH且客户端支持时使用扩展头部，否则沿用2字节长度
+	bool use_ext = ext_head && body.length() > MAX_LENGTH;
+	if (!use_ext && body.length() > SHRT_MAX) {
+		return nullptr;
+	}
+	return MakePooled<SendNode>(body.c_str(), static_cast<int>(body.length()), msgid, use_ext, flags);
 }
 
 void CSession::Send(char* msg, short max_length, short msgid) {
-	std::lock_guard<std::mutex> lock(_send_lock);
-	int send_que_size = _send_que.size();
-	if (send_que_size > MAX_SENDQUE) {
-		std::cout << "session: " << _session_id << " send que fulled, size is " << MAX_SENDQUE << endl;
+	Send(MakePooled<SendNode>(msg, max_length, msgid));
+}
+
+void CSession::Send(std::shared_ptr<SendNode> msgnode) {
+	//任意线程只把已组帧的消息压入无锁队列，发送队列和socket只在本会话的io线程访问
+	_send_mpsc.Push(std::move(msgnode));
+	//已经投递了还没执行的取队列任务时不再重复投递，一次取队列会带走这期间压入的所有消息
+	if (_b_drain_posted.exchange(true, std::memory_order_acq_rel)) {
 		return;
 	}
+	auto self = SharedSelf();
+	boost::asio::dispatch(_socket.get_executor(), [self, this]() {
+		DrainSendQue();
+	});
+}
+
+void CSession::DrainSendQue() {
+	//先清标志再取，清标志之后完成的Push会重新投递，不会漏掉消息
+	_b_drain_posted.exchange(false, std::memory_order_acq_rel);
+	std::shared_ptr<SendNode> msgnode;
+	std::size_t drained_bytes = 0;
+	while (_send_mpsc.Pop(msgnode)) {
+		if (_b_close) {
+			continue;
+		}
+		//不再按消息个数丢弃，积压字节数超过高水位时暂停读取该会话，长时间不恢复则断开
+		drained_bytes += msgnode->_total_len;
+		_send_que.push_back(std::move(msgnode));
+	}
+	OnSendQueued(drained_bytes);
+}
+
+void CSession::OnSendQueued(std::size_t bytes) {
+	_send_bytes += bytes;
+	SendBytesGauge().Add(static_cast<int64_t>(bytes));
+
+	if (!_b_over_high && _send_bytes > SessionConfig::Inst()._send_high_water) {
+		_b_over_high = true;
+		OnHighWater();
+	}
+
+	if (_flush_count > 0 || _send_que.empty()) {
+		return; // 此时有写操作正在进行，写完成后会继续发送
+	}
+	FlushSendQue();
+}
+
+void CSession::OnHighWater() {
+	LOG_WARN("session: " << _session_id << " send backlog " << _send_bytes << " bytes over high water, pause reading");
+	PauseRead();
+	_server->GetTimingWheel(_io_index).Schedule(&_slow_node, SharedSelf(), SessionConfig::Inst()._slow_consumer_timeout);
+}
+
+void CSession::OnLowWater() {
+	LOG_INFO("session: " << _session_id << " send backlog " << _send_bytes << " bytes below low water, resume reading");
+	ResumeRead();
+	_server->GetTimingWheel(_io_index).Cancel(&_slow_node);
+}
 
-	_send_que.push(make_shared<SendNode>(msg, max_length, msgid));
-	if (send_que_size>0) {
+void CSession::FlushSendQue() {
+	//非合并模式每次只写队首的一个消息
+	if (!SessionConfig::Inst()._write_gather) {
+		auto& msgnode = _send_que.front();
+		_flush_count = 1;
+		boost::asio::async_write(_socket, boost::asio::buffer(msgnode->_data, msgnode->_total_len),
+			std::bind(&CSession::HandleWrite, this, std::placeholders::_1, SharedSelf()));
 		return;
 	}
-	auto& msgnode = _send_que.front();
-	boost::asio::async_write(_socket, boost::asio::buffer(msgnode->_data, msgnode->_total_len), 
+
+	//合并模式把队列中的消息组织成一个缓冲区序列，由一次writev发出
+	//至少发送一个消息，超过单次上限的部分留到下一次写
+	auto max_bytes = SessionConfig::Inst()._max_flush_bytes;
+	std::size_t flush_bytes = 0;
+	_flush_bufs.clear();
+	for (auto& msgnode : _send_que) {
+		if (!_flush_bufs.empty() && flush_bytes + msgnode->_total_len > max_bytes) {
+			break;
+		}
+		_flush_bufs.push_back(boost::asio::buffer(msgnode->_data, msgnode->_total_len));
+		flush_bytes += msgnode->_total_len;
+	}
+
+	_flush_count = _flush_bufs.size();
+	boost::asio::async_write(_socket, _flush_bufs,
 		std::bind(&CSession::HandleWrite, this, std::placeholders::_1, SharedSelf()));
 }
 
@@ -88,44 +414,49 @@ std::shared_ptr<CSession>CSession::SharedSelf() {
 	return shared_from_this();
 }
 
-void CSession::AsyncReadBody(int total_len)
+void CSession::AsyncReadBody(std::size_t read_len, std::size_t total_len)
 {
 	auto self = shared_from_this();
-	asyncReadFull(total_len, [self, this, total_len](const boost::system::error_code& ec, std::size_t bytes_transfered) {
+	//直接读到消息节点中，大消息分多次读取，不经过固定大小的缓冲区
+	asyncReadLen(_recv_msg_node->_data, read_len, total_len, [self, this, total_len](const boost::system::error_code& ec, std::size_t bytes_transfered) {
 		try {
 			if (ec) {
-				std::cout << "handle read failed, error is " << ec.what() << endl;
+				LOG_WARN("handle read failed, error is " << ec.what());
 				Close();
 				DealExceptionSession();
 				return;
 			}
 
 			if (bytes_transfered < total_len) {
-				std::cout << "read length not match, read [" << bytes_transfered << "] , total ["<< total_len<<"]" << endl;
+				LOG_DEBUG("read length not match, read [" << bytes_transfered << "] , total ["<< total_len<<"]");
 				Close();
-				_server->ClearSession(_session_id);
+				_server->ClearSession(_conn_id);
 				return;
 			}
 
 			//判断连接无效
-			if (!_server->CheckValid(_session_id)) {
+			if (!IsValid()) {
 				Close();
 				return;
 			}
 
-			memcpy(_recv_msg_node->_data , _data , bytes_transfered);
-			_recv_msg_node->_cur_len += bytes_transfered;
+			_recv_msg_node->_cur_len = static_cast<int>(bytes_transfered);
 			_recv_msg_node->_data[_recv_msg_node->_total_len] = '\0'; // 在接收到的数据末尾添加一个空字符（'\0'），确保数据是一个有效的 C 风格字符串
-			cout << "receive data is " << _recv_msg_node->_data << endl;
+			LOG_TRACE("receive data is " << _recv_msg_node->_data);
 			//更新session心跳时间
 			UpdateHeartbeat();
 			//此处将消息投递到逻辑队列中
-			LogicSystem::GetInstance()->PostMsgToQue(make_shared<LogicNode>(shared_from_this(), _recv_msg_node));
-			//继续监听头部接受事件
-			AsyncReadHead(HEAD_TOTAL_LEN);
+			auto recv_node = std::move(_recv_msg_node);
+			if (!PostRecvNode(recv_node, _body_msg_id, _body_flags)) {
+				Close();
+				DealExceptionSession();
+				return;
+			}
+			//继续监听头部接受事件，环形缓冲区模式下超大消息读完后回到环形读取
+			ContinueRead();
 		}
 		catch (std::exception& e) {
-			std::cout << "Exception code is " << e.what() << endl;
+			LOG_ERROR("Exception code is " << e.what());
 		}
 		});
 }
@@ -133,105 +464,310 @@ void CSession::AsyncReadBody(int total_len)
 void CSession::AsyncReadHead(int total_len)
 {
 	auto self = shared_from_this();
-	asyncReadFull(HEAD_TOTAL_LEN, [self, this](const boost::system::error_code& ec, std::size_t bytes_transfered) {
+	//扩展头部时前4字节已经在_data中，只需补读剩余的长度字段
+	std::size_t read_len = total_len > HEAD_TOTAL_LEN ? HEAD_TOTAL_LEN : 0;
+	asyncReadLen(_data, read_len, total_len, [self, this, total_len](const boost::system::error_code& ec, std::size_t bytes_transfered) {
 		try {
 			if (ec) {
-				std::cout << "handle read failed, error is " << ec.what() << endl;
+				LOG_WARN("handle read failed, error is " << ec.what());
 				Close();
 				DealExceptionSession();
 				return;
 			}
 
-			if (bytes_transfered < HEAD_TOTAL_LEN) { // 实际读取到的字节数 < 头部总长度
-				std::cout << "read length not match, read [" << bytes_transfered << "] , total [" << HEAD_TOTAL_LEN << "]" << endl;
+			//头部长度不为正时同样按长度不符处理，之后再按无符号比较
+			if (total_len <= 0 || bytes_transfered < static_cast<std::size_t>(total_len)) { // 实际读取到的字节数 < 头部总长度
+				LOG_DEBUG("read length not match, read [" << bytes_transfered << "] , total [" << total_len << "]");
 				Close();
-				_server->ClearSession(_session_id);
+				_server->ClearSession(_conn_id);
 				return;
 			}
 
 			//判断连接无效
-			if (!_server->CheckValid(_session_id)) {
+			if (!IsValid()) {
 				Close();
 				return;
 			}
 
-			_recv_head_node->Clear();
-			memcpy(_recv_head_node->_data, _data, bytes_transfered);
-
-			//获取头部MSGID数据
 			short msg_id = 0;
-			memcpy(&msg_id, _recv_head_node->_data, HEAD_ID_LEN);
-			//网络字节序转化为本地字节序
-			msg_id = boost::asio::detail::socket_ops::network_to_host_short(msg_id);
-			std::cout << "msg_id is " << msg_id << endl;
-			//id非法
-			if (msg_id > MAX_LENGTH) {
-				std::cout << "invalid msg_id is " << msg_id << endl;
-				_server->ClearSession(_session_id);
+			std::size_t msg_len = 0;
+			unsigned short flags = 0;
+			int head_len = ParseHead(_data, bytes_transfered, msg_id, msg_len, flags);
+			if (head_len < 0) {
+				_server->ClearSession(_conn_id);
 				return;
 			}
-			short msg_len = 0;
-			memcpy(&msg_len, _recv_head_node->_data + HEAD_ID_LEN, HEAD_DATA_LEN);
-			//网络字节序转化为本地字节序
-			msg_len = boost::asio::detail::socket_ops::network_to_host_short(msg_len);
-			std::cout << "msg_len is " << msg_len << endl;
-
-			//id非法
-			if (msg_len > MAX_LENGTH) {
-				std::cout << "invalid data length is " << msg_len << endl;
-				_server->ClearSession(_session_id);
+
+			//扩展头部，继续读取剩余的长度字段
+			if (head_len == 0) {
+				AsyncReadHead(HEAD_EXT_TOTAL_LEN);
 				return;
 			}
+			LOG_TRACE("msg_id is " << msg_id << ", msg_len is " << msg_len);
 
-			_recv_msg_node = make_shared<RecvNode>(msg_len, msg_id);
-			AsyncReadBody(msg_len);
+			//心跳不分配消息节点，读完消息体后在本线程直接回复
+			if (IsFastHeartbeat(msg_id, msg_len, flags)) {
+				AsyncReadHeartbeat(msg_len);
+				return;
+			}
+
+			_recv_msg_node = MakePooled<RecvNode>(static_cast<int>(msg_len), msg_id);
+			_body_flags = flags;
+			_body_msg_id = msg_id;
+			AsyncReadBody(0, msg_len);
+		}
+		catch (std::exception& e) {
+			LOG_ERROR("Exception code is " << e.what());
+		}
+	});
+}
+
+void CSession::AsyncReadHeartbeat(std::size_t msg_len)
+{
+	auto self = shared_from_this();
+	asyncReadLen(_hb_body, 0, msg_len, [self, this, msg_len](const boost::system::error_code& ec, std::size_t bytes_transfered) {
+		try {
+			if (ec) {
+				LOG_WARN("handle read failed, error is " << ec.what());
+				Close();
+				DealExceptionSession();
+				return;
+			}
+
+			if (bytes_transfered < msg_len) {
+				LOG_DEBUG("read length not match, read [" << bytes_transfered << "] , total [" << msg_len << "]");
+				Close();
+				_server->ClearSession(_conn_id);
+				return;
+			}
+
+			//判断连接无效
+			if (!IsValid()) {
+				Close();
+				return;
+			}
+
+			UpdateHeartbeat();
+			ReplyHeartbeat();
+			ContinueRead();
+		}
+		catch (std::exception& e) {
+			LOG_ERROR("Exception code is " << e.what());
+		}
+	});
+}
+
+void CSession::AsyncReadRing()
+{
+	auto self = shared_from_this();
+	_socket.async_read_some(_recv_ring->Prepare(), [self, this](const boost::system::error_code& ec, std::size_t bytes_transfered) {
+		try {
+			if (ec) {
+				LOG_WARN("handle read failed, error is " << ec.what());
+				Close();
+				DealExceptionSession();
+				return;
+			}
+
+			//判断连接无效
+			if (!IsValid()) {
+				Close();
+				return;
+			}
+
+			_recv_ring->Commit(bytes_transfered);
+			//更新session心跳时间
+			UpdateHeartbeat();
+			//一次读取可能包含多个消息，全部解析后再继续读取
+			if (!ParseRingFrames()) {
+				return;
+			}
+			ContinueRead();
 		}
 		catch (std::exception& e) {
-			std::cout << "Exception code is " << e.what() << endl;
+			LOG_ERROR("Exception code is " << e.what());
 		}
 	});
 }
 
+int CSession::ParseHead(const char* head, std::size_t len, short& msg_id, std::size_t& msg_len, unsigned short& flags)
+{
+	//只有登录成功并协商了扩展头部的连接才接受扩展头部，未登录的连接消息体不超过MAX_LENGTH，
+	//避免未认证的连接按MaxExtLength申请接收缓冲区
+	std::size_t max_ext_length = _ext_head && _user_uid != 0 ? SessionConfig::Inst()._max_ext_length : 0;
+	int head_len = ParseMsgHead(head, len, max_ext_length, msg_id, msg_len, flags);
+	//没有协商压缩的连接不接受压缩消息
+	if (head_len > 0 && (flags & HEAD_COMPRESS_FLAG) && !_compress) {
+		LOG_WARN("compressed msg without negotiation, msg_id is " << msg_id);
+		return -1;
+	}
+	return head_len;
+}
+
+bool CSession::IsFastHeartbeat(short msg_id, std::size_t msg_len, unsigned short flags) const
+{
+	//压缩的心跳需要先解压，仍交给逻辑层
+	return msg_id == ID_HEART_BEAT_REQ && msg_len <= HEARTBEAT_MAX_BODY && !(flags & HEAD_COMPRESS_FLAG);
+}
+
+void CSession::ReplyHeartbeat()
+{
+	if (_b_close) {
+		return;
+	}
+	FastHeartbeatGauge().Add(1);
+	//已经在本会话的io线程，不经过无锁队列，直接放入发送队列
+	//其他线程先于心跳提交的消息可能还在无锁队列中，先取出，保证本会话的发送顺序
+	DrainSendQue();
+	auto& frame = HeartbeatFrame(GetCodec());
+	_send_que.push_back(frame);
+	OnSendQueued(frame->_total_len);
+}
+
+bool CSession::ParseRingFrames()
+{
+	for (;;) {
+		const char* head = _recv_ring->ReadPtr();
+		short msg_id = 0;
+		std::size_t msg_len = 0;
+		unsigned short flags = 0;
+		int head_len = ParseHead(head, _recv_ring->Readable(), msg_id, msg_len, flags);
+		if (head_len < 0) {
+			_server->ClearSession(_conn_id);
+			return false;
+		}
+
+		//头部还没有收全
+		if (head_len == 0) {
+			break;
+		}
+
+		std::size_t frame_len = head_len + msg_len;
+		if (_recv_ring->Readable() < frame_len) {
+			//超过缓冲区大小的消息不在缓冲区中拼接，已收到的部分拷贝到消息节点，剩余部分直接读到节点中
+			if (frame_len > _recv_ring->Capacity()) {
+				std::size_t body_read = _recv_ring->Readable() - head_len;
+				_recv_msg_node = MakePooled<RecvNode>(static_cast<int>(msg_len), msg_id);
+				memcpy(_recv_msg_node->_data, head + head_len, body_read);
+				_body_flags = flags;
+				_body_msg_id = msg_id;
+				_recv_ring->Consume(_recv_ring->Readable());
+				AsyncReadBody(body_read, msg_len);
+				return false;
+			}
+
+			//消息体还没有收全，保证下次读取后整个消息在内存中连续
+			_recv_ring->Reserve(frame_len);
+			break;
+		}
+
+		//心跳时间已在读取完成时更新，这里只需回复
+		if (IsFastHeartbeat(msg_id, msg_len, flags)) {
+			_recv_ring->Consume(frame_len);
+			ReplyHeartbeat();
+			continue;
+		}
+
+		//消息体直接引用接收缓冲区，逻辑层处理完释放后内存才会被复用
+		auto body = const_cast<char*>(head) + head_len;
+		auto recv_node = MakePooled<RecvNode>(_recv_ring->Block(), body, static_cast<int>(msg_len), msg_id);
+		_recv_ring->Consume(frame_len);
+		if (!PostRecvNode(recv_node, msg_id, flags)) {
+			Close();
+			DealExceptionSession();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CSession::PostRecvNode(std::shared_ptr<RecvNode> recv_node, short msg_id, unsigned short flags)
+{
+	//在解压和投递之前限流，被限流的请求只回复错误，不占用逻辑线程
+	if (!_limiter.Allow(msg_id, GetUserId())) {
+		RateLimiter::Inst().CountReject();
+		LogicSystem::GetInstance()->RejectMsg(shared_from_this(), msg_id, ErrorCodes::RateLimited);
+		return true;
+	}
+	if (flags & HEAD_COMPRESS_FLAG) {
+		//解压后的长度同样受扩展头部最大长度限制
+		std::string raw;
+		if (!Compressor::Inflate(recv_node->_data, recv_node->_cur_len, SessionConfig::Inst()._max_ext_length, raw)) {
+			LOG_ERROR("inflate msg failed, session id is " << _session_id << ", msg_id is " << msg_id);
+			return false;
+		}
+		recv_node = MakePooled<RecvNode>(static_cast<int>(raw.length()), msg_id);
+		memcpy(recv_node->_data, raw.data(), raw.length());
+		recv_node->_cur_len = static_cast<int>(raw.length());
+	}
+	recv_node->SetCodec((flags & HEAD_PROTO_FLAG) ? ClientCodec::Proto : ClientCodec::Json);
+	LogicSystem::GetInstance()->PostMsgToQue(MakePooled<LogicNode>(shared_from_this(), recv_node));
+	return true;
+}
+
 void CSession::HandleWrite(const boost::system::error_code& error, std::shared_ptr<CSession> shared_self) {
 	//增加异常处理
 	try {
 		auto self = shared_from_this();
 		if (!error) {
-			std::lock_guard<std::mutex> lock(_send_lock);
 			//cout << "send data " << _send_que.front()->_data+HEAD_LENGTH << endl;
-			_send_que.pop();
+			//本次写入的消息全部完成，一次性弹出，并记录每个消息从组包到写完成的耗时
+			auto now = Metrics::NowNs();
+			std::size_t flushed_bytes = 0;
+			for (std::size_t i = 0; i < _flush_count; ++i) {
+				auto& msgnode = _send_que[i];
+				flushed_bytes += msgnode->_total_len;
+				if (msgnode->GetCreateTime() > 0) {
+					Metrics::Inst().RecordMsg(MsgPhase::Send, msgnode->GetMsgId(), now - msgnode->GetCreateTime());
+				}
+			}
+			_send_bytes -= flushed_bytes;
+			SendBytesGauge().Add(-static_cast<int64_t>(flushed_bytes));
+			_send_que.erase(_send_que.begin(), _send_que.begin() + _flush_count);
+			_flush_count = 0;
+			if (_b_over_high && _send_bytes <= SessionConfig::Inst()._send_low_water) {
+				_b_over_high = false;
+				OnLowWater();
+				//积压已经消化，恢复被暂停的发送方
+				std::vector<std::weak_ptr<CSession>> throttled_peers;
+				throttled_peers.swap(_throttled_peers);
+				for (auto& weak_peer : throttled_peers) {
+					auto peer = weak_peer.lock();
+					if (peer) {
+						peer->ResumeRead();
+					}
+				}
+			}
 			if (!_send_que.empty()) {
-				auto& msgnode = _send_que.front();
-				boost::asio::async_write(_socket, boost::asio::buffer(msgnode->_data, msgnode->_total_len),
-					std::bind(&CSession::HandleWrite, this, std::placeholders::_1, shared_self));
+				FlushSendQue();
 			}
 		}
 		else {
-			std::cout << "handle write failed, error is " << error.what() << endl;
+			LOG_WARN("handle write failed, error is " << error.what());
 			Close();
 			DealExceptionSession();
 		}
 	}
 	catch (std::exception& e) {
-		std::cerr << "Exception code : " << e.what() << endl;
+		LOG_ERROR("Exception code : " << e.what());
 	}
 	
 }
 
 //读取完整长度
-void CSession::asyncReadFull(std::size_t maxLength, std::function<void(const boost::system::error_code&, std::size_t)> handler )
+void CSession::asyncReadFull(char* buf, std::size_t maxLength, std::function<void(const boost::system::error_code&, std::size_t)> handler )
 {
-	::memset(_data, 0, MAX_LENGTH);
-	asyncReadLen(0, maxLength, handler);
+	asyncReadLen(buf, 0, maxLength, handler);
 }
 
 //读取指定字节数
-void CSession::asyncReadLen(std::size_t read_len, std::size_t total_len, 
+void CSession::asyncReadLen(char* buf, std::size_t read_len, std::size_t total_len, 
 	std::function<void(const boost::system::error_code&, std::size_t)> handler)
 {
 	auto self = shared_from_this();
-	_socket.async_read_some(boost::asio::buffer(_data + read_len, total_len-read_len),
-		[read_len, total_len, handler, self](const boost::system::error_code& ec, std::size_t  bytesTransfered) {
+	_socket.async_read_some(boost::asio::buffer(buf + read_len, total_len-read_len),
+		[buf, read_len, total_len, handler, self](const boost::system::error_code& ec, std::size_t  bytesTransfered) {
 			if (ec) {
 				// 出现错误，调用回调函数
 				handler(ec, read_len + bytesTransfered);
@@ -245,73 +781,102 @@ void CSession::asyncReadLen(std::size_t read_len, std::size_t total_len,
 			}
 
 			// 没有错误，且长度不足则继续读取
-			self->asyncReadLen(read_len + bytesTransfered, total_len, handler);
+			self->asyncReadLen(buf, read_len + bytesTransfered, total_len, handler);
 	});
 }
 
 void CSession::NotifyOffline(int uid) {
 
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success;
-	rtvalue["uid"] = uid;
-
-
-	std::string return_str = rtvalue.toStyledString();
-
-	Send(return_str, ID_NOTIFY_OFF_LINE_REQ);
+	client::NotifyOffline notify;
+	notify.error = ErrorCodes::Success;
+	notify.uid = uid;
+	SendMsg(notify, ID_NOTIFY_OFF_LINE_REQ);
 	return;
 }
 
-LogicNode::LogicNode(shared_ptr<CSession>  session, 
-	shared_ptr<RecvNode> recvnode):_session(session),_recvnode(recvnode) {
-
+bool CSession::PushLogicMsg(MsgLane lane, shared_ptr<LogicNode> node) {
+	int index = static_cast<int>(lane);
+	std::lock_guard<std::mutex> lock(_logic_mtx);
+	_logic_que[index].push_back(std::move(node));
+	if (_b_logic_running[index]) {
+		return false;
+	}
+	_b_logic_running[index] = true;
+	return true;
 }
 
+shared_ptr<LogicNode> CSession::PopLogicMsg(MsgLane lane) {
+	int index = static_cast<int>(lane);
+	std::lock_guard<std::mutex> lock(_logic_mtx);
+	if (_logic_que[index].empty()) {
+		return nullptr;
+	}
+	auto node = std::move(_logic_que[index].front());
+	_logic_que[index].pop_front();
+	return node;
+}
 
-bool CSession::IsHeartbeatExpired(std::time_t& now) {
-	double diff_sec = std::difftime(now, _last_heartbeat);
-	if (diff_sec > 20000000) {
-		std::cout << "heartbeat expired, session id is  " << _session_id << endl;
-		return true;
+bool CSession::FinishLogicMsg(MsgLane lane) {
+	int index = static_cast<int>(lane);
+	std::lock_guard<std::mutex> lock(_logic_mtx);
+	if (_logic_que[index].empty()) {
+		_b_logic_running[index] = false;
+		return false;
 	}
+	return true;
+}
+
+LogicNode::LogicNode(shared_ptr<CSession>  session, 
+	shared_ptr<RecvNode> recvnode):_session(session),_recvnode(recvnode), _enqueue_ns(Metrics::NowNs()) {
 
-	return false;
 }
 
+
 void CSession::UpdateHeartbeat()
 {
 	time_t now = std::time(nullptr);
 	_last_heartbeat = now;
+	//定时轮一个tick为1秒，同一秒内的多次刷新不会移动节点
+	_server->GetTimingWheel(_io_index).Schedule(&_hb_node, SharedSelf(), SessionConfig::Inst()._heartbeat_timeout);
+}
+
+void CSession::CancelHeartbeat()
+{
+	_server->GetTimingWheel(_io_index).Cancel(&_hb_node);
 }
 
 void CSession::DealExceptionSession()
 {
 	auto self = shared_from_this();
-	//加锁清除session
-	auto uid_str = std::to_string(_user_uid);
-	auto lock_key = LOCK_PREFIX + uid_str;
-	auto identifier = RedisMgr::GetInstance()->acquireLock(lock_key, LOCK_TIME_OUT, ACQUIRE_TIME_OUT);
-	Defer defer([identifier, lock_key, self, this]() {
-		_server->ClearSession(_session_id);
-		RedisMgr::GetInstance()->releaseLock(lock_key, identifier);
-		});
-
-	if (identifier.empty()) {
-		return;
-	}
-	std::string redis_session_id = "";
-	auto bsuccess = RedisMgr::GetInstance()->Get(USER_SESSION_PREFIX + uid_str, redis_session_id);
-	if (!bsuccess) {
-		return;
-	}
+	int uid = _user_uid.load();
+	//在io线程上调用，redis操作交给逻辑线程的协程执行，io线程不等待回复
+	LogicSystem::GetInstance()->PostTask(uid, [self, this, uid](boost::asio::yield_context yield) {
+		//加锁清除session
+		auto uid_str = std::to_string(uid);
+		auto lock_key = LOCK_PREFIX + uid_str;
+		auto identifier = RedisMgr::GetInstance()->AsyncAcquireLock(lock_key, LOCK_TIME_OUT, ACQUIRE_TIME_OUT, yield);
+		Defer defer([identifier, lock_key, this]() {
+			_server->ClearSession(_conn_id);
+			RedisMgr::GetInstance()->PostReleaseLock(lock_key, identifier);
+			});
+
+		if (identifier.empty()) {
+			return;
+		}
+		std::string redis_session_id = "";
+		auto bsuccess = RedisMgr::GetInstance()->AsyncGet(USER_SESSION_PREFIX + uid_str, redis_session_id, yield);
+		if (!bsuccess) {
+			return;
+		}
 
-	if (redis_session_id != _session_id) {
-		//说明有客户在其他服务器异地登录了
-		return;
-	}
+		if (redis_session_id != _session_id) {
+			//说明有客户在其他服务器异地登录了
+			return;
+		}
 
-	RedisMgr::GetInstance()->Del(USER_SESSION_PREFIX + uid_str);
-	//清除用户登录信息
-	RedisMgr::GetInstance()->Del(USERIPPREFIX + uid_str);
+		RedisMgr::GetInstance()->AsyncDel(USER_SESSION_PREFIX + uid_str, yield);
+		//清除用户登录信息
+		RedisMgr::GetInstance()->AsyncDel(USERIPPREFIX + uid_str, yield);
+	});
 }
 
@@ -5,10 +5,17 @@
 #include <boost/beast/http.hpp>
 #include <boost/beast.hpp>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <memory>
 #include "const.h"
 #include "MsgNode.h"
+#include "RecvRingBuffer.h"
+#include "TimingWheel.h"
+#include "MpscQueue.h"
+#include "ClientMsg.h"
+#include "LogicLanes.h"
+#include "RateLimiter.h"
 using namespace std;
 
 namespace beast = boost::beast;         // from <boost/beast.hpp>
@@ -18,14 +25,55 @@ using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 
 class CServer;
 class LogicSystem;
+class LogicNode;
+
+// 在io层直接回复的心跳消息体最大长度，心跳只有fromuid一个字段，超过该长度的心跳仍交给逻辑层处理
+const std::size_t HEARTBEAT_MAX_BODY = 64;
+
+// 会话相关配置，首次使用时从config.ini的[Session]段读取
+struct SessionConfig {
+	static const SessionConfig& Inst();
+	// 是否使用环形缓冲区接收(RecvMode = ring)，否则按头部、消息体分两次读取
+	bool _ring_recv;
+	// 环形缓冲区大小
+	std::size_t _recv_buf_size;
+	// 是否合并发送(WriteMode = gather)，一次async_write发出发送队列中的多个消息
+	bool _write_gather;
+	// 合并发送时单次写入的最大字节数，防止积压过多时长时间占用io_context
+	std::size_t _max_flush_bytes;
+	// 扩展头部允许的最大消息体长度
+	std::size_t _max_ext_length;
+	// 心跳超时时间(秒)，超过该时间没有收到数据的连接会被关闭
+	uint64_t _heartbeat_timeout;
+	// 发送积压的高、低水位(字节)，超过高水位暂停读取该会话，降到低水位以下恢复
+	std::size_t _send_high_water;
+	std::size_t _send_low_water;
+	// 积压持续超过高水位的最长时间(秒)，超时断开
+	uint64_t _slow_consumer_timeout;
+	// 是否同时暂停向积压会话发消息的发送方
+	bool _throttle_peers;
+	// 是否允许客户端在登录时开启压缩(Compress = deflate)
+	bool _compress;
+	// 超过该长度的消息才压缩，小消息压缩收益低
+	std::size_t _compress_min_bytes;
+	// zlib压缩级别(1~9)
+	int _compress_level;
+private:
+	SessionConfig();
+};
 
 class CSession: public std::enable_shared_from_this<CSession>
 {
 public:
-	CSession(boost::asio::io_context& io_context, CServer* server);
+	CSession(boost::asio::io_context& io_context, CServer* server, std::size_t io_index = 0);
 	~CSession();
 	tcp::socket& GetSocket();
 	std::string& GetSessionId();
+	// 进程内唯一的整数会话id，用作本地会话表的key，uuid只用于跨服务器的登录状态
+	uint64_t GetConnId() const;
+	// 会话是否还在会话表中，读路径上只检查该标志，不再加锁查表
+	bool IsValid() const;
+	void SetValid(bool valid);
 	void SetUserId(int uid);
 	int GetUserId();
 	void Start(); 
@@ -33,44 +81,155 @@ public:
 	void Send(char* msg,  short max_length, short msgid); 
 	// 发送std::string类型的消息，包含消息ID。
 	void Send(std::string msg, short msgid);
+	// 按会话协商的编码(json/protobuf)序列化并发送客户端消息
+	template <typename Msg>
+	void SendMsg(const Msg& msg, short msgid) {
+		auto codec = GetCodec();
+		SendBody(EncodeClientMsg(codec, msg), msgid, codec);
+	}
+	// 发送已经组好包的消息，节点只读，可以被多个会话的发送队列共享(广播)
+	void Send(std::shared_ptr<SendNode> msgnode);
+	// 会话所在io_context在AsioIOServicePool中的下标
+	std::size_t GetIOIndex() const;
+	// 登录时协商，客户端支持扩展头部后才会发送超过MAX_LENGTH的消息
+	void SetExtHead(bool ext_head);
+	bool GetExtHead() const;
+	// 登录时协商，开启后较大的消息压缩发送，并接受客户端发来的压缩消息
+	void SetCompress(bool compress);
+	bool GetCompress() const;
+	// 按压缩、扩展头部的协商结果组帧，SendBody和广播共用；短头部放不下时返回nullptr
+	static std::shared_ptr<SendNode> MakeBodyNode(const std::string& msg, short msgid, ClientCodec codec,
+		bool compress, bool ext_head);
+	// 登录消息的编码决定会话之后回包的编码
+	void SetCodec(ClientCodec codec);
+	ClientCodec GetCodec() const;
 	void Close();
 	// 返回一个指向当前 CSession 对象的 shared_ptr
 	std::shared_ptr<CSession> SharedSelf();
-	void AsyncReadBody(int length);
+	// 从read_len处继续读取消息体，直到读满total_len
+	void AsyncReadBody(std::size_t read_len, std::size_t total_len);
 	void AsyncReadHead(int total_len);
+	// 环形缓冲区模式：一次读取尽量多的数据，解析出所有完整消息
+	void AsyncReadRing();
 	void NotifyOffline(int uid);
-	//判断心跳是否过期
-	bool IsHeartbeatExpired(std::time_t& now);
-	//更新心跳
+	//更新心跳，在定时轮中重新调度，只能在会话所在io线程调用
 	void UpdateHeartbeat();
+	//从定时轮中移除，只能在会话所在io线程调用
+	void CancelHeartbeat();
+	//定时轮到期回调(心跳超时、慢消费者检测)，在会话所在io线程执行
+	void OnTimer(TimerNode* node);
+	//逻辑层按会话和优先级串行处理消息，同一会话的同一优先级同时只处理一条，处理期间后续消息在这里排队
+	//返回true表示该优先级之前没有待处理的消息，调用方需要把会话排入逻辑线程的优先级队列
+	bool PushLogicMsg(MsgLane lane, shared_ptr<LogicNode> node);
+	//取出该优先级的下一条消息，会话被逻辑线程取出时调用，此时队列不为空
+	shared_ptr<LogicNode> PopLogicMsg(MsgLane lane);
+	//一条消息处理完成，返回true表示还有待处理的消息，调用方需要把会话重新排队，否则结束处理状态
+	bool FinishLogicMsg(MsgLane lane);
+	//暂停/恢复读取，可以在任意线程调用，按次数配对
+	void PauseRead();
+	void ResumeRead();
+	//本会话积压超过高水位时暂停peer的读取，积压消化后恢复
+	void ThrottlePeer(std::shared_ptr<CSession> peer);
 	//处理异常连接
 	void DealExceptionSession();
 private: 
-	// 异步读取固定长度数据，读取完毕后触发回调处理。
-	void asyncReadFull(std::size_t maxLength, std::function<void(const boost::system::error_code& , std::size_t)> handler); 
-	// 异步分批读取数据，直到读取完指定总长度，回调处理每次读取的结果。
-	void asyncReadLen(std::size_t  read_len, std::size_t total_len, std::function<void(const boost::system::error_code&, std::size_t)> handler);
+	// 异步读取固定长度数据到buf，读取完毕后触发回调处理。
+	void asyncReadFull(char* buf, std::size_t maxLength, std::function<void(const boost::system::error_code& , std::size_t)> handler); 
+	// 异步分批读取数据到buf，直到读取完指定总长度，回调处理每次读取的结果。
+	void asyncReadLen(char* buf, std::size_t  read_len, std::size_t total_len, std::function<void(const boost::system::error_code&, std::size_t)> handler);
+	// 解析消息头部，返回头部长度(普通头部或扩展头部)，数据不足返回0，头部非法返回-1
+	// flags为头部中的HEAD_COMPRESS_FLAG、HEAD_PROTO_FLAG
+	int ParseHead(const char* head, std::size_t len, short& msg_id, std::size_t& msg_len, unsigned short& flags);
+	// 投递消息到逻辑队列，压缩的消息先解压，解压失败返回false
+	bool PostRecvNode(std::shared_ptr<RecvNode> recv_node, short msg_id, unsigned short flags);
+	// 组帧发送已经编码的消息体，codec决定头部是否带HEAD_PROTO_FLAG
+	void SendBody(const std::string& msg, short msgid, ClientCodec codec);
+	// 未压缩且消息体不超过HEARTBEAT_MAX_BODY的心跳在io线程直接回复，不经过逻辑层
+	bool IsFastHeartbeat(short msg_id, std::size_t msg_len, unsigned short flags) const;
+	// 把心跳消息体读到_hb_body中，读完后回复心跳并继续读取
+	void AsyncReadHeartbeat(std::size_t msg_len);
+	// 回复预先组好的常量心跳帧，直接放入发送队列，只在io线程调用
+	void ReplyHeartbeat();
+	// 解析环形缓冲区中所有完整的消息并投递到逻辑队列
+	// 消息非法，或者转为直接读取超大消息体时返回false，此时不再继续环形读取
+	bool ParseRingFrames();
 	 
 	
 	void HandleWrite(const boost::system::error_code& error, std::shared_ptr<CSession> shared_self);
+	// 把无锁队列中的消息取到发送队列，没有写操作在进行时发起写，只在io线程调用
+	void DrainSendQue();
+	// 发送队列新增了bytes字节，检查高水位，没有写操作在进行时发起写，只在io线程调用
+	void OnSendQueued(std::size_t bytes);
+	// 发起一次写操作，只在io线程调用
+	void FlushSendQue();
+	// 积压越过高水位/降到低水位，只在io线程调用
+	void OnHighWater();
+	void OnLowWater();
+	// 继续下一次读取，读取被暂停时记录下来等恢复时再读
+	void ContinueRead();
+	// 定时器触发的断开
+	void CloseOnTimer();
 	tcp::socket _socket;
+	std::size_t _io_index;
 	std::string _session_id;
-	char _data[MAX_LENGTH];
+	uint64_t _conn_id;
+	std::atomic<bool> _b_valid;
+	// 头部接收缓冲区，消息体直接读到消息节点中
+	char _data[HEAD_EXT_TOTAL_LEN];
+	// 分两次读取时心跳消息体的接收缓冲区，内容不解析，只为把数据从socket中读走
+	char _hb_body[HEARTBEAT_MAX_BODY];
 	CServer* _server;
 	bool _b_close;
-	std::queue<shared_ptr<SendNode> > _send_que;
-	std::mutex _send_lock;
+	// 其他线程投递过来的待发送消息，多生产者单消费者，链表节点从内存池分配
+	MpscQueue<std::shared_ptr<SendNode>, MsgPoolAllocator<std::shared_ptr<SendNode>>> _send_mpsc;
+	// 是否已经投递了取队列任务
+	std::atomic<bool> _b_drain_posted;
+	// 发送队列，只在io线程访问
+	std::deque<shared_ptr<SendNode> > _send_que;
+	// 正在写入中的消息个数，写完成后一次性从队列中弹出
+	std::size_t _flush_count;
+	// 合并发送的缓冲区序列，复用容量避免每次分配
+	std::vector<boost::asio::const_buffer> _flush_bufs;
+	// 发送队列中积压的字节数，只在io线程访问
+	std::size_t _send_bytes;
+	// 积压是否超过高水位，只在io线程访问
+	bool _b_over_high;
+	// 因本会话积压而被暂停读取的发送方，只在io线程访问
+	std::vector<std::weak_ptr<CSession>> _throttled_peers;
+	// 读取暂停计数和是否有读操作在等待恢复，只在io线程访问
+	int _read_pause_count;
+	bool _b_read_stalled;
 	//收到的消息结构
 	std::shared_ptr<RecvNode> _recv_msg_node;
 	// 消息头解析标志
 	bool _b_head_parse;
-	//收到的头部结构
-	std::shared_ptr<MsgNode> _recv_head_node;
-	int _user_uid;
+	// 是否支持扩展头部
+	std::atomic<bool> _ext_head;
+	// 是否开启压缩
+	std::atomic<bool> _compress;
+	// 回包的编码方式
+	std::atomic<ClientCodec> _codec;
+	// 分两次读取时，正在读取的消息体的头部标志及其消息id
+	unsigned short _body_flags;
+	short _body_msg_id;
+	//环形接收缓冲区，仅在ring模式下使用
+	std::unique_ptr<RecvRingBuffer> _recv_ring;
+	//逻辑线程登录时写入，io线程按uid分配逻辑线程时读取
+	std::atomic<int> _user_uid;
 	//记录上次接受数据的时间
 	std::atomic<time_t> _last_heartbeat;
+	//心跳定时轮节点
+	TimerNode _hb_node;
+	//慢消费者检测的定时轮节点
+	TimerNode _slow_node;
 	//session 锁
 	std::mutex _session_mtx;
+	//逻辑层各优先级待处理的消息，_b_logic_running表示该优先级已排入逻辑线程或正在处理
+	std::mutex _logic_mtx;
+	std::deque<shared_ptr<LogicNode>> _logic_que[LANE_COUNT];
+	bool _b_logic_running[LANE_COUNT];
+	//session、uid范围的限流，只在会话所在io线程访问
+	SessionLimiter _limiter;
 };
 
 class LogicNode {
@@ -80,4 +239,5 @@ public:
 private:
 	shared_ptr<CSession> _session; // 会话对象
 	shared_ptr<RecvNode> _recvnode; // 接收到的数据节点
+	int64_t _enqueue_ns; // 投递到逻辑队列的时间，统计排队耗时
 };
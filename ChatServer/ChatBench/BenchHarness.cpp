@@ -0,0 +1,113 @@
+#include "BenchHarness.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <json/json.h>
+
+BenchRegistry& BenchRegistry::Inst() {
+	static BenchRegistry registry;
+	return registry;
+}
+
+void BenchRegistry::Add(const std::string& name, BenchFunc func) {
+	_benches.emplace_back(name, func);
+}
+
+int BenchRegistry::Run(const std::string& filter) {
+	int count = 0;
+	for (auto& bench : _benches) {
+		if (!filter.empty() && bench.first.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		std::cout << "== " << bench.first << std::endl;
+		std::vector<BenchResult> results;
+		bench.second(results);
+		for (auto& result : results) {
+			std::cout << std::left << std::setw(40) << result._name
+				<< " threads " << std::setw(4) << result._threads
+				<< " ops " << std::setw(12) << result._ops
+				<< " time " << std::fixed << std::setprecision(3) << result._seconds << "s"
+				<< " rate " << std::setprecision(0) << result.OpsPerSec() << " ops/s" << std::endl;
+			_results.emplace_back(bench.first, result);
+		}
+		++count;
+	}
+	return count;
+}
+
+bool BenchRegistry::WriteJson(const std::string& path) const {
+	Json::Value root;
+	char date[32] = { 0 };
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+	root["context"]["date"] = date;
+	root["context"]["num_cpus"] = std::thread::hardware_concurrency();
+#ifdef NDEBUG
+	root["context"]["library_build_type"] = "release";
+#else
+	root["context"]["library_build_type"] = "debug";
+#endif
+	root["benchmarks"] = Json::Value(Json::arrayValue);
+	for (auto& item : _results) {
+		auto& result = item.second;
+		//名字格式与Google Benchmark一致: 用例/实现/threads:N
+		Json::Value bench;
+		bench["name"] = item.first + "/" + result._name + "/threads:" + std::to_string(result._threads);
+		bench["run_name"] = bench["name"];
+		bench["run_type"] = "iteration";
+		bench["threads"] = result._threads;
+		bench["iterations"] = Json::UInt64(result._ops);
+		//多线程用例的real_time为墙钟时间除以总操作次数
+		double ns_per_op = result._ops == 0 ? 0.0 : result._seconds * 1e9 / result._ops;
+		bench["real_time"] = ns_per_op;
+		bench["cpu_time"] = ns_per_op;
+		bench["time_unit"] = "ns";
+		bench["items_per_second"] = result.OpsPerSec();
+		root["benchmarks"].append(bench);
+	}
+
+	std::ofstream out(path);
+	if (!out) {
+		return false;
+	}
+	out << root.toStyledString();
+	return static_cast<bool>(out);
+}
+
+double RunThreads(int threads, const std::function<void(int)>& fn) {
+	std::atomic<int> ready(0);
+	std::atomic<bool> start(false);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; ++i) {
+		workers.emplace_back([&, i]() {
+			ready.fetch_add(1);
+			while (!start.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+			fn(i);
+		});
+	}
+
+	//等所有线程就绪后同时开始，避免线程创建的时间算进结果
+	while (ready.load() < threads) {
+		std::this_thread::yield();
+	}
+	auto begin = std::chrono::steady_clock::now();
+	start.store(true, std::memory_order_release);
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - begin).count();
+}
+
+static std::atomic<uint64_t> g_sink(0);
+
+void DoNotOptimize(uint64_t value) {
+	g_sink.fetch_add(value, std::memory_order_relaxed);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+// 压测结果，一个用例可以输出多行(不同线程数、不同实现)
+struct BenchResult {
+	std::string _name;     // 用例名/实现名
+	int _threads;          // 并发线程数
+	uint64_t _ops;         // 总操作次数
+	double _seconds;       // 耗时
+	double OpsPerSec() const {
+		return _seconds <= 0 ? 0.0 : _ops / _seconds;
+	}
+};
+
+// 压测用例注册表，用例通过CHAT_BENCH宏在静态初始化阶段注册
+class BenchRegistry
+{
+public:
+	using BenchFunc = std::function<void(std::vector<BenchResult>&)>;
+	static BenchRegistry& Inst();
+	void Add(const std::string& name, BenchFunc func);
+	// 运行名字包含filter的用例，filter为空时全部运行，返回运行的用例个数
+	int Run(const std::string& filter);
+	// 把已运行用例的结果按Google Benchmark的json格式写入文件，便于脚本对比不同版本的结果
+	bool WriteJson(const std::string& path) const;
+private:
+	BenchRegistry() = default;
+	std::vector<std::pair<std::string, BenchFunc>> _benches;
+	// 已运行的用例名和结果
+	std::vector<std::pair<std::string, BenchResult>> _results;
+};
+
+struct BenchRegistrar {
+	BenchRegistrar(const char* name, BenchRegistry::BenchFunc func) {
+		BenchRegistry::Inst().Add(name, func);
+	}
+};
+
+#define CHAT_BENCH(name) \
+	static void name(std::vector<BenchResult>& results); \
+	static BenchRegistrar name##_registrar(#name, name); \
+	static void name(std::vector<BenchResult>& results)
+
+// 启动threads个线程，同时开始执行fn(线程序号)，返回全部线程执行完的耗时(秒)
+double RunThreads(int threads, const std::function<void(int)>& fn);
+
+// 防止被压测的计算结果被编译器优化掉
+void DoNotOptimize(uint64_t value);
@@ -0,0 +1,32 @@
+#include "BenchHarness.h"
+#include <iostream>
+
+// 用法: ChatBench [filter] [--json=path]
+// 只运行名字包含filter的用例，不带filter时运行全部用例
+// 指定--json时额外把结果按Google Benchmark的json格式写入path
+int main(int argc, char* argv[])
+{
+	const std::string json_opt = "--json=";
+	std::string filter;
+	std::string json_path;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg.compare(0, json_opt.size(), json_opt) == 0) {
+			json_path = arg.substr(json_opt.size());
+		}
+		else {
+			filter = arg;
+		}
+	}
+
+	int count = BenchRegistry::Inst().Run(filter);
+	if (count == 0) {
+		std::cout << "no bench matched filter: " << filter << std::endl;
+		return 1;
+	}
+	if (!json_path.empty() && !BenchRegistry::Inst().WriteJson(json_path)) {
+		std::cout << "write json failed: " << json_path << std::endl;
+		return 1;
+	}
+	return 0;
+}
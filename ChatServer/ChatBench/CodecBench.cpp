@@ -0,0 +1,114 @@
+#include "BenchHarness.h"
+#include "../ClientMsg.h"
+#include <string>
+
+// 客户端消息编解码压测: json与protobuf的序列化、解析耗时和消息体字节数
+// 登录回包带好友和申请列表，代表大消息；聊天和加好友通知代表高频小消息
+namespace {
+
+const int LOGIN_ITERS = 5000;
+const int SMALL_ITERS = 200000;
+const int FRIEND_COUNT = 50;
+const int APPLY_COUNT = 10;
+
+client::ChatLoginRsp MakeLoginRsp() {
+	client::ChatLoginRsp rsp;
+	rsp.uid = 1019;
+	rsp.pwd = "745230";
+	rsp.name = "llfc";
+	rsp.email = "secondtonone1@163.com";
+	rsp.nick = "llfc";
+	rsp.desc = "hello world";
+	rsp.sex = 1;
+	rsp.icon = ":/res/head_1.jpg";
+	rsp.compress = "deflate";
+	for (int i = 0; i < APPLY_COUNT; ++i) {
+		client::ApplyInfo apply;
+		apply.uid = 2000 + i;
+		apply.name = "apply_" + std::to_string(i);
+		apply.nick = "nick_" + std::to_string(i);
+		apply.icon = ":/res/head_2.jpg";
+		apply.sex = i % 2;
+		apply.desc = "";
+		apply.status = i % 2;
+		rsp.apply_list.push_back(apply);
+	}
+	for (int i = 0; i < FRIEND_COUNT; ++i) {
+		client::FriendInfo info;
+		info.uid = 3000 + i;
+		info.name = "friend_" + std::to_string(i);
+		info.nick = "nick_" + std::to_string(i);
+		info.icon = ":/res/head_3.jpg";
+		info.sex = i % 2;
+		info.desc = "a friend of llfc";
+		info.back = "back_" + std::to_string(i);
+		rsp.friend_list.push_back(info);
+	}
+	return rsp;
+}
+
+client::TextChatMsgReq MakeChatMsg() {
+	client::TextChatMsgReq req;
+	req.fromuid = 1019;
+	req.touid = 1020;
+	client::TextChatData data;
+	//客户端生成的消息id为uuid
+	data.msgid = "5b9f2f5e-4bde-4b5c-9c1e-7d2a9e8f1a01";
+	data.content = "hello, are you free this evening?";
+	req.text_array.push_back(data);
+	return req;
+}
+
+client::NotifyAddFriend MakeNotify() {
+	client::NotifyAddFriend notify;
+	notify.error = 0;
+	notify.applyuid = 1019;
+	notify.name = "llfc";
+	notify.desc = "hello world";
+	notify.icon = ":/res/head_1.jpg";
+	notify.sex = 1;
+	notify.nick = "llfc";
+	return notify;
+}
+
+// 序列化和解析各跑iters次，字节数写进结果名里一起输出
+template <typename Msg>
+void RunCodec(std::vector<BenchResult>& results, const std::string& name, const Msg& msg,
+	ClientCodec codec, int iters) {
+	const char* codec_name = codec == ClientCodec::Proto ? "proto" : "json";
+	std::string encoded = EncodeClientMsg(codec, msg);
+	std::string tag = name + " " + codec_name + " (" + std::to_string(encoded.size()) + " B)";
+
+	double seconds = RunThreads(1, [&](int) {
+		uint64_t bytes = 0;
+		for (int i = 0; i < iters; ++i) {
+			bytes += EncodeClientMsg(codec, msg).size();
+		}
+		DoNotOptimize(bytes);
+	});
+	results.push_back({ tag + " encode", 1, uint64_t(iters), seconds });
+
+	seconds = RunThreads(1, [&](int) {
+		uint64_t ok = 0;
+		for (int i = 0; i < iters; ++i) {
+			Msg decoded;
+			ok += DecodeClientMsg(codec, encoded, decoded) ? 1 : 0;
+		}
+		DoNotOptimize(ok);
+	});
+	results.push_back({ tag + " decode", 1, uint64_t(iters), seconds });
+}
+
+template <typename Msg>
+void RunBoth(std::vector<BenchResult>& results, const std::string& name, const Msg& msg, int iters) {
+	RunCodec(results, name, msg, ClientCodec::Json, iters);
+	RunCodec(results, name, msg, ClientCodec::Proto, iters);
+}
+
+}
+
+CHAT_BENCH(ClientCodec) {
+	RunBoth(results, "login rsp", MakeLoginRsp(), LOGIN_ITERS);
+	RunBoth(results, "text chat", MakeChatMsg(), SMALL_ITERS);
+	RunBoth(results, "notify add friend", MakeNotify(), SMALL_ITERS);
+}
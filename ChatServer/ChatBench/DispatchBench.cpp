@@ -0,0 +1,167 @@
+#include "BenchHarness.h"
+#include "../ClientMsg.h"
+#include "../ShardedMap.h"
+#include <array>
+#include <map>
+#include <memory>
+#include <functional>
+#include <string>
+
+// 逻辑层分发路径压测
+// 分发: 对比旧的std::map查找+拷贝消息体，和LogicSystem::HandleMsg现在按消息id下标查表、直接引用消息体
+// 分发+解码: 处理函数按RegisterHandler的方式先把消息体解码成请求类型，覆盖json和protobuf
+// 会话查找: 投递时按uid查找接收方会话，对比uid均匀分布和全部打到一个热点用户两种情况
+namespace {
+
+const int DISPATCH_ITERS = 2000000;
+const int DECODE_ITERS = 200000;
+const int LOOKUP_ITERS = 500000;
+const int SESSION_COUNT = 10000;
+const int THREAD_COUNTS[] = { 1, 2, 4, 8, 16 };
+// LogicSystem::RegisterCallBacks注册的消息id
+const short HANDLER_IDS[] = { MSG_CHAT_LOGIN, ID_SEARCH_USER_REQ, ID_ADD_FRIEND_REQ,
+	ID_AUTH_FRIEND_REQ, ID_TEXT_CHAT_MSG_REQ, ID_HEART_BEAT_REQ };
+
+struct BenchSession {
+	int _uid;
+	uint64_t _handled;
+};
+
+typedef std::function<void(std::shared_ptr<BenchSession>, const short& msg_id, ClientCodec codec,
+	const std::string& msg_data)> BenchCallBack;
+
+template <typename Req>
+BenchCallBack MakeDecodeHandler() {
+	return [](std::shared_ptr<BenchSession> session, const short& msg_id, ClientCodec codec,
+		const std::string& msg_data) {
+		Req req;
+		if (DecodeClientMsg(codec, msg_data, req)) {
+			++session->_handled;
+		}
+	};
+}
+
+client::TextChatMsgReq MakeChatReq() {
+	client::TextChatMsgReq req;
+	req.fromuid = 1019;
+	req.touid = 1020;
+	client::TextChatData data;
+	data.msgid = "8f14e45f-ceea-467f-a0e6-100000000001";
+	data.content = std::string(64, 'x');
+	req.text_array.push_back(data);
+	return req;
+}
+
+}
+
+CHAT_BENCH(DispatchLookup) {
+	std::map<short, BenchCallBack> callbacks;
+	for (auto id : HANDLER_IDS) {
+		callbacks[id] = [](std::shared_ptr<BenchSession> session, const short& msg_id, ClientCodec codec,
+			const std::string& msg_data) {
+			session->_handled += msg_data.size();
+		};
+	}
+	auto session = std::make_shared<BenchSession>();
+	session->_handled = 0;
+	std::string body(64, 'x');
+	const int id_count = sizeof(HANDLER_IDS) / sizeof(HANDLER_IDS[0]);
+	double seconds = RunThreads(1, [&](int) {
+		for (int i = 0; i < DISPATCH_ITERS; ++i) {
+			short msg_id = HANDLER_IDS[i % id_count];
+			auto iter = callbacks.find(msg_id);
+			if (iter == callbacks.end()) {
+				continue;
+			}
+			iter->second(session, msg_id, ClientCodec::Json, std::string(body.data(), body.size()));
+		}
+	});
+	DoNotOptimize(session->_handled);
+	results.push_back({ "map find + call", 1, uint64_t(DISPATCH_ITERS), seconds });
+
+	typedef void(*BenchDispatcher)(const std::shared_ptr<BenchSession>& session, ClientCodec codec,
+		const char* data, std::size_t len);
+	std::array<BenchDispatcher, MSG_ID_END - MSG_ID_BEGIN> dispatchers;
+	dispatchers.fill(nullptr);
+	for (auto id : HANDLER_IDS) {
+		dispatchers[id - MSG_ID_BEGIN] = [](const std::shared_ptr<BenchSession>& session, ClientCodec codec,
+			const char* data, std::size_t len) {
+			session->_handled += len;
+		};
+	}
+	session->_handled = 0;
+	seconds = RunThreads(1, [&](int) {
+		for (int i = 0; i < DISPATCH_ITERS; ++i) {
+			short msg_id = HANDLER_IDS[i % id_count];
+			if (msg_id < MSG_ID_BEGIN || msg_id >= MSG_ID_END || dispatchers[msg_id - MSG_ID_BEGIN] == nullptr) {
+				continue;
+			}
+			dispatchers[msg_id - MSG_ID_BEGIN](session, ClientCodec::Json, body.data(), body.size());
+		}
+	});
+	DoNotOptimize(session->_handled);
+	results.push_back({ "jump table + call", 1, uint64_t(DISPATCH_ITERS), seconds });
+}
+
+CHAT_BENCH(DispatchDecode) {
+	std::map<short, BenchCallBack> callbacks;
+	callbacks[ID_TEXT_CHAT_MSG_REQ] = MakeDecodeHandler<client::TextChatMsgReq>();
+	callbacks[ID_HEART_BEAT_REQ] = MakeDecodeHandler<client::HeartBeatReq>();
+	client::HeartBeatReq heartbeat;
+	heartbeat.fromuid = 1019;
+	auto chat = MakeChatReq();
+
+	for (auto codec : { ClientCodec::Json, ClientCodec::Proto }) {
+		std::string codec_name = codec == ClientCodec::Json ? "json" : "proto";
+		struct Case {
+			const char* _name;
+			short _msg_id;
+			std::string _data;
+		};
+		Case cases[] = {
+			{ "heartbeat", ID_HEART_BEAT_REQ, EncodeClientMsg(codec, heartbeat) },
+			{ "text chat", ID_TEXT_CHAT_MSG_REQ, EncodeClientMsg(codec, chat) },
+		};
+		for (auto& item : cases) {
+			auto session = std::make_shared<BenchSession>();
+			session->_handled = 0;
+			double seconds = RunThreads(1, [&](int) {
+				for (int i = 0; i < DECODE_ITERS; ++i) {
+					auto iter = callbacks.find(item._msg_id);
+					iter->second(session, item._msg_id, codec, item._data);
+				}
+			});
+			DoNotOptimize(session->_handled);
+			results.push_back({ std::string(item._name) + " " + codec_name, 1, uint64_t(DECODE_ITERS), seconds });
+		}
+	}
+}
+
+CHAT_BENCH(DispatchSessionLookup) {
+	ShardedMap<int, std::shared_ptr<BenchSession>> sessions;
+	for (int i = 0; i < SESSION_COUNT; ++i) {
+		auto session = std::make_shared<BenchSession>();
+		session->_uid = 10000 + i;
+		session->_handled = 0;
+		sessions.Insert(session->_uid, session);
+	}
+
+	for (bool hot : { false, true }) {
+		for (int threads : THREAD_COUNTS) {
+			double seconds = RunThreads(threads, [&](int index) {
+				uint64_t found = 0;
+				uint32_t seed = 2654435761u * (index + 1);
+				for (int i = 0; i < LOOKUP_ITERS; ++i) {
+					seed = seed * 1664525u + 1013904223u;
+					int uid = hot ? 10000 : 10000 + static_cast<int>(seed % SESSION_COUNT);
+					std::shared_ptr<BenchSession> session;
+					if (sessions.Find(uid, session)) {
+						found += session->_uid;
+					}
+				}
+				DoNotOptimize(found);
+			});
+			results.push_back({ hot ? "hot uid" : "uniform uid", threads, uint64_t(threads) * LOOKUP_ITERS, seconds });
+		}
+	}
+}
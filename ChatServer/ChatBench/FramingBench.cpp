@@ -0,0 +1,79 @@
+#include "BenchHarness.h"
+#include "../MsgNode.h"
+#include <string>
+
+// 组帧与拆帧压测
+// 组帧: 构造SendNode(内存池分配 + 写头部 + 拷贝消息体)，覆盖常见消息大小和扩展头部
+// 拆帧: 对连续排列的已组帧数据逐个解析头部，与会话读路径一致，不包含消息体拷贝
+namespace {
+
+const int ENCODE_ITERS = 500000;
+const int DECODE_ITERS = 2000000;
+// 普通头部的消息体不超过MAX_LENGTH，扩展头部另测一个好友列表量级的大消息
+struct FrameCase {
+	bool _ext_head;
+	int _body_size;
+};
+const FrameCase FRAME_CASES[] = { { false, 64 }, { false, 512 }, { false, MAX_LENGTH },
+	{ true, 64 }, { true, 512 }, { true, 64 * 1024 } };
+// 文本聊天通知的消息id
+const short BENCH_MSG_ID = 1019;
+const std::size_t BENCH_MAX_EXT_LENGTH = 4 * 1024 * 1024;
+
+// 按读缓冲区的方式连续排列count个帧
+std::string MakeFrames(bool ext_head, int body_size, int count) {
+	std::string body(body_size, 'x');
+	std::string frames;
+	for (int i = 0; i < count; ++i) {
+		SendNode node(body.data(), body_size, BENCH_MSG_ID, ext_head);
+		frames.append(node._data, node._total_len);
+	}
+	return frames;
+}
+
+std::string CaseName(const FrameCase& item) {
+	return std::string(item._ext_head ? "ext head " : "head ") + std::to_string(item._body_size) + "B";
+}
+
+}
+
+CHAT_BENCH(FramingEncode) {
+	for (auto& item : FRAME_CASES) {
+		std::string body(item._body_size, 'x');
+		double seconds = RunThreads(1, [&](int) {
+			for (int i = 0; i < ENCODE_ITERS; ++i) {
+				auto node = MakePooled<SendNode>(body.data(), item._body_size, BENCH_MSG_ID, item._ext_head);
+				DoNotOptimize(static_cast<uint64_t>(node->_data[i % node->_total_len]));
+			}
+		});
+		results.push_back({ CaseName(item), 1, uint64_t(ENCODE_ITERS), seconds });
+	}
+}
+
+CHAT_BENCH(FramingDecode) {
+	const int FRAME_COUNT = 64;
+	for (auto& item : FRAME_CASES) {
+		auto frames = MakeFrames(item._ext_head, item._body_size, FRAME_COUNT);
+		double seconds = RunThreads(1, [&](int) {
+			std::size_t offset = 0;
+			uint64_t total = 0;
+			for (int i = 0; i < DECODE_ITERS; ++i) {
+				short msg_id = 0;
+				std::size_t msg_len = 0;
+				unsigned short flags = 0;
+				int head_len = ParseMsgHead(frames.data() + offset, frames.size() - offset,
+					BENCH_MAX_EXT_LENGTH, msg_id, msg_len, flags);
+				if (head_len <= 0) {
+					break;
+				}
+				total += msg_id + msg_len;
+				offset += head_len + msg_len;
+				if (offset >= frames.size()) {
+					offset = 0;
+				}
+			}
+			DoNotOptimize(total);
+		});
+		results.push_back({ CaseName(item), 1, uint64_t(DECODE_ITERS), seconds });
+	}
+}
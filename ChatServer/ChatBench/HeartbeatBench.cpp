@@ -0,0 +1,107 @@
+#include "BenchHarness.h"
+#include "../MsgNode.h"
+#include "../MpscQueue.h"
+#include "../MpscRing.h"
+#include "../ClientMsg.h"
+#include <deque>
+#include <memory>
+#include <string>
+
+// 心跳处理路径压测，模拟10万个空闲连接各发一次心跳，单线程计算每个心跳消耗的CPU
+// 1. 逻辑层路径: 拆帧、分配消息节点、投递逻辑队列、解析请求、序列化回包、组帧、经发送队列回到io线程
+//    两次跨线程投递本身的开销见LogicQueue、SendPath用例，这里只在单线程内走一遍队列操作
+// 2. io层快速路径: 拆帧后先取出无锁队列中已提交的消息(通常为空)，再把共享的常量回包帧放入发送队列
+namespace {
+
+const int CONNECTIONS = 100000;
+const int ROUNDS = 10;
+const std::size_t BENCH_MAX_EXT_LENGTH = 4 * 1024 * 1024;
+
+std::string MakeHeartbeatReq(ClientCodec codec) {
+	client::HeartBeatReq req;
+	req.fromuid = 1019;
+	auto body = EncodeClientMsg(codec, req);
+	unsigned short flags = codec == ClientCodec::Proto ? HEAD_PROTO_FLAG : 0;
+	SendNode node(body.data(), static_cast<int>(body.length()), ID_HEART_BEAT_REQ, false, flags);
+	return std::string(node._data, node._total_len);
+}
+
+struct BenchLogicNode {
+	BenchLogicNode(std::shared_ptr<RecvNode> recvnode) :_recvnode(recvnode), _enqueue_ns(0) {}
+	std::shared_ptr<RecvNode> _recvnode;
+	int64_t _enqueue_ns;
+};
+
+double RunLogicPath(ClientCodec codec) {
+	auto frame = MakeHeartbeatReq(codec);
+	MpscRing<std::shared_ptr<BenchLogicNode>> inbox(1024);
+	MpscQueue<std::shared_ptr<SendNode>, MsgPoolAllocator<std::shared_ptr<SendNode>>> send_mpsc;
+	std::deque<std::shared_ptr<SendNode>> send_que;
+	return RunThreads(1, [&](int) {
+		for (int round = 0; round < ROUNDS; ++round) {
+			for (int i = 0; i < CONNECTIONS; ++i) {
+				short msg_id = 0;
+				std::size_t msg_len = 0;
+				unsigned short flags = 0;
+				int head_len = ParseMsgHead(frame.data(), frame.size(), BENCH_MAX_EXT_LENGTH, msg_id, msg_len, flags);
+				auto recv_node = MakePooled<RecvNode>(static_cast<int>(msg_len), msg_id);
+				memcpy(recv_node->_data, frame.data() + head_len, msg_len);
+				recv_node->_cur_len = static_cast<int>(msg_len);
+				inbox.TryPush(MakePooled<BenchLogicNode>(recv_node));
+
+				std::shared_ptr<BenchLogicNode> node;
+				inbox.Pop(node);
+				client::HeartBeatReq req;
+				DecodeClientMsg(codec, node->_recvnode->_data, node->_recvnode->_cur_len, req);
+				client::HeartBeatRsp rsp;
+				rsp.error = req.fromuid == 0 ? 1 : 0;
+				auto body = EncodeClientMsg(codec, rsp);
+				send_mpsc.Push(MakePooled<SendNode>(body.c_str(), static_cast<int>(body.length()), ID_HEARTBEAT_RSP));
+
+				std::shared_ptr<SendNode> msgnode;
+				send_mpsc.Pop(msgnode);
+				send_que.push_back(std::move(msgnode));
+				DoNotOptimize(static_cast<uint64_t>(send_que.back()->_total_len));
+				send_que.pop_front();
+			}
+		}
+	});
+}
+
+double RunFastPath(ClientCodec codec) {
+	auto frame = MakeHeartbeatReq(codec);
+	client::HeartBeatRsp rsp;
+	auto body = EncodeClientMsg(codec, rsp);
+	auto rsp_frame = MakePooled<SendNode>(body.c_str(), static_cast<int>(body.length()), ID_HEARTBEAT_RSP);
+	MpscQueue<std::shared_ptr<SendNode>, MsgPoolAllocator<std::shared_ptr<SendNode>>> send_mpsc;
+	std::deque<std::shared_ptr<SendNode>> send_que;
+	return RunThreads(1, [&](int) {
+		for (int round = 0; round < ROUNDS; ++round) {
+			for (int i = 0; i < CONNECTIONS; ++i) {
+				short msg_id = 0;
+				std::size_t msg_len = 0;
+				unsigned short flags = 0;
+				ParseMsgHead(frame.data(), frame.size(), BENCH_MAX_EXT_LENGTH, msg_id, msg_len, flags);
+				if (msg_id == ID_HEART_BEAT_REQ) {
+					std::shared_ptr<SendNode> msgnode;
+					while (send_mpsc.Pop(msgnode)) {
+						send_que.push_back(std::move(msgnode));
+					}
+					send_que.push_back(rsp_frame);
+				}
+				DoNotOptimize(static_cast<uint64_t>(send_que.back()->_total_len));
+				send_que.pop_front();
+			}
+		}
+	});
+}
+
+}
+
+CHAT_BENCH(Heartbeat) {
+	uint64_t ops = uint64_t(CONNECTIONS) * ROUNDS;
+	results.push_back({ "logic path json", 1, ops, RunLogicPath(ClientCodec::Json) });
+	results.push_back({ "logic path proto", 1, ops, RunLogicPath(ClientCodec::Proto) });
+	results.push_back({ "io fast path json", 1, ops, RunFastPath(ClientCodec::Json) });
+	results.push_back({ "io fast path proto", 1, ops, RunFastPath(ClientCodec::Proto) });
+}
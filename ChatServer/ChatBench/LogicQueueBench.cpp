@@ -0,0 +1,197 @@
+#include "BenchHarness.h"
+#include "../MpscRing.h"
+#include "../const.h"
+#include <boost/asio.hpp>
+#include <condition_variable>
+#include <queue>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+// 逻辑队列投递路径压测
+// N个io线程同时投递消息，一个逻辑线程取出并计数，只衡量投递和取出本身的同步开销
+// 1. 原有实现: 一把锁保护std::queue，0->1时通知，逻辑线程每次加锁取一条
+// 2. 每条消息post到逻辑线程的io_context
+// 3. 有界MPSC环形队列，空->非空时投递一次，逻辑线程批量取出
+namespace {
+
+const int MSGS_PER_THREAD = 200000;
+const int THREAD_COUNTS[] = { 1, 4, 8 };
+const int DRAIN_BATCH = 256;
+
+struct BenchMsg {
+	uint64_t _seq;
+};
+
+class MutexQueue {
+public:
+	MutexQueue() :_b_stop(false), _handled(0) {
+		_thread = std::thread([this]() {
+			Run();
+		});
+	}
+
+	~MutexQueue() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_b_stop = true;
+		}
+		_cond.notify_one();
+		_thread.join();
+	}
+
+	void Post(std::shared_ptr<BenchMsg> msg) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_msg_que.push(std::move(msg));
+		if (_msg_que.size() == 1) {
+			lock.unlock();
+			_cond.notify_one();
+		}
+	}
+
+	uint64_t Handled() const {
+		return _handled.load(std::memory_order_acquire);
+	}
+
+private:
+	void Run() {
+		for (;;) {
+			std::unique_lock<std::mutex> lock(_mutex);
+			_cond.wait(lock, [this]() {
+				return _b_stop || !_msg_que.empty();
+			});
+			if (_b_stop) {
+				return;
+			}
+			auto msg = std::move(_msg_que.front());
+			_msg_que.pop();
+			DoNotOptimize(msg->_seq);
+			_handled.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	std::mutex _mutex;
+	std::condition_variable _cond;
+	std::queue<std::shared_ptr<BenchMsg>> _msg_que;
+	bool _b_stop;
+	std::atomic<uint64_t> _handled;
+	std::thread _thread;
+};
+
+// 逻辑线程，析构时等待已投递的任务执行完，使用者需要把它声明为最后一个成员，先于其他成员析构
+class BenchWorker {
+public:
+	BenchWorker() :_work(boost::asio::make_work_guard(_io_context)) {
+		_thread = std::thread([this]() {
+			_io_context.run();
+		});
+	}
+
+	~BenchWorker() {
+		_work.reset();
+		_thread.join();
+	}
+
+	boost::asio::io_context& Context() {
+		return _io_context;
+	}
+
+private:
+	boost::asio::io_context _io_context;
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> _work;
+	std::thread _thread;
+};
+
+class PostQueue {
+public:
+	PostQueue() :_handled(0) {}
+
+	void Post(std::shared_ptr<BenchMsg> msg) {
+		boost::asio::post(_worker.Context(), [this, msg]() {
+			DoNotOptimize(msg->_seq);
+			_handled.fetch_add(1, std::memory_order_release);
+		});
+	}
+
+	uint64_t Handled() const {
+		return _handled.load(std::memory_order_acquire);
+	}
+
+private:
+	std::atomic<uint64_t> _handled;
+	BenchWorker _worker;
+};
+
+class RingQueue {
+public:
+	RingQueue() :_inbox(MAX_RECVQUE), _b_drain_posted(false), _handled(0) {}
+
+	void Post(std::shared_ptr<BenchMsg> msg) {
+		//压测中不丢消息，队列满时等待逻辑线程取出
+		while (!_inbox.TryPush(msg)) {
+			std::this_thread::yield();
+		}
+		if (!_b_drain_posted.exchange(true, std::memory_order_acq_rel)) {
+			boost::asio::post(_worker.Context(), [this]() {
+				Drain();
+			});
+		}
+	}
+
+	uint64_t Handled() const {
+		return _handled.load(std::memory_order_acquire);
+	}
+
+private:
+	void Drain() {
+		_b_drain_posted.exchange(false, std::memory_order_acq_rel);
+		std::shared_ptr<BenchMsg> msg;
+		int count = 0;
+		while (count < DRAIN_BATCH && _inbox.Pop(msg)) {
+			++count;
+			DoNotOptimize(msg->_seq);
+		}
+		_handled.fetch_add(count, std::memory_order_release);
+		if (count == DRAIN_BATCH && !_b_drain_posted.exchange(true, std::memory_order_acq_rel)) {
+			boost::asio::post(_worker.Context(), [this]() {
+				Drain();
+			});
+		}
+	}
+
+	MpscRing<std::shared_ptr<BenchMsg>> _inbox;
+	std::atomic<bool> _b_drain_posted;
+	std::atomic<uint64_t> _handled;
+	BenchWorker _worker;
+};
+
+// threads个生产者各投递MSGS_PER_THREAD条消息，计时到逻辑线程全部取出为止
+template <typename Queue>
+double RunQueue(int threads) {
+	Queue queue;
+	auto msg = std::make_shared<BenchMsg>();
+	msg->_seq = 1;
+	uint64_t total = uint64_t(threads) * MSGS_PER_THREAD;
+	return RunThreads(threads, [&](int index) {
+		for (int i = 0; i < MSGS_PER_THREAD; ++i) {
+			queue.Post(msg);
+		}
+		if (index == 0) {
+			while (queue.Handled() < total) {
+				std::this_thread::yield();
+			}
+		}
+	});
+}
+
+}
+
+CHAT_BENCH(LogicQueue) {
+	for (int threads : THREAD_COUNTS) {
+		uint64_t ops = uint64_t(threads) * MSGS_PER_THREAD;
+		results.push_back({ "mutex queue + cond", threads, ops, RunQueue<MutexQueue>(threads) });
+		results.push_back({ "post per msg", threads, ops, RunQueue<PostQueue>(threads) });
+		results.push_back({ "mpsc ring + batch drain", threads, ops, RunQueue<RingQueue>(threads) });
+	}
+}
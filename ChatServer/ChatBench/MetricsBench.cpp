@@ -0,0 +1,33 @@
+#include "BenchHarness.h"
+#include "../Metrics.h"
+
+// 指标记录开销压测: 单个直方图多线程并发记录，以及按消息id记录(含取时间戳)
+namespace {
+
+const int RECORD_ITERS = 2000000;
+// 文本聊天请求的消息id
+const short BENCH_MSG_ID = 1017;
+
+}
+
+CHAT_BENCH(MetricsRecord) {
+	for (int threads : { 1, 2, 4, 8 }) {
+		LatencyHistogram hist;
+		double seconds = RunThreads(threads, [&](int index) {
+			for (int i = 0; i < RECORD_ITERS; ++i) {
+				hist.Record(static_cast<int64_t>((i * 2654435761u + index) % 10000000));
+			}
+		});
+		results.push_back({ "histogram record", threads, uint64_t(threads) * RECORD_ITERS, seconds });
+	}
+
+	for (int threads : { 1, 2, 4, 8 }) {
+		double seconds = RunThreads(threads, [&](int) {
+			for (int i = 0; i < RECORD_ITERS; ++i) {
+				auto start = Metrics::NowNs();
+				Metrics::Inst().RecordMsg(MsgPhase::Handle, BENCH_MSG_ID, Metrics::NowNs() - start);
+			}
+		});
+		results.push_back({ "msg record with clock", threads, uint64_t(threads) * RECORD_ITERS, seconds });
+	}
+}
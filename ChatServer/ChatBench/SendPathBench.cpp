@@ -0,0 +1,165 @@
+#include "BenchHarness.h"
+#include "../MpscQueue.h"
+#include <boost/asio.hpp>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <string>
+
+// 热点会话发送路径压测
+// N个生产者线程(对应逻辑线程、grpc线程)同时向同一个会话发送已组帧的消息，
+// 会话所在的io线程负责写出。写操作用投递一个完成回调模拟，只衡量发送路径本身的同步开销
+// 两种实现都按合并写的方式一次写出队列中已有的全部消息
+namespace {
+
+const int MSGS_PER_THREAD = 200000;
+const int THREAD_COUNTS[] = { 1, 8, 32 };
+
+struct BenchFrame {
+	std::string _data;
+};
+
+// 原有实现: 生产者和写完成回调争用同一把发送锁
+class MutexSender {
+public:
+	explicit MutexSender(boost::asio::io_context& io_context) :_io_context(io_context), _flush_count(0), _sent(0) {}
+
+	void Send(std::shared_ptr<BenchFrame> frame) {
+		std::lock_guard<std::mutex> lock(_send_lock);
+		_send_que.push_back(std::move(frame));
+		if (_send_que.size() > 1) {
+			return;
+		}
+		Flush();
+	}
+
+	uint64_t Sent() const {
+		return _sent.load(std::memory_order_acquire);
+	}
+
+private:
+	// 调用方需持有_send_lock
+	void Flush() {
+		_flush_count = _send_que.size();
+		boost::asio::post(_io_context, [this]() {
+			HandleWrite();
+		});
+	}
+
+	void HandleWrite() {
+		std::lock_guard<std::mutex> lock(_send_lock);
+		_send_que.erase(_send_que.begin(), _send_que.begin() + _flush_count);
+		_sent.fetch_add(_flush_count, std::memory_order_release);
+		_flush_count = 0;
+		if (!_send_que.empty()) {
+			Flush();
+		}
+	}
+
+	boost::asio::io_context& _io_context;
+	std::mutex _send_lock;
+	std::deque<std::shared_ptr<BenchFrame>> _send_que;
+	std::size_t _flush_count;
+	std::atomic<uint64_t> _sent;
+};
+
+// 新实现: 生产者压入无锁队列并投递一次取队列任务，发送队列只在io线程访问
+class MpscSender {
+public:
+	explicit MpscSender(boost::asio::io_context& io_context) :_io_context(io_context), _b_drain_posted(false),
+		_flush_count(0), _sent(0) {}
+
+	void Send(std::shared_ptr<BenchFrame> frame) {
+		_send_mpsc.Push(std::move(frame));
+		if (_b_drain_posted.exchange(true, std::memory_order_acq_rel)) {
+			return;
+		}
+		boost::asio::dispatch(_io_context, [this]() {
+			Drain();
+		});
+	}
+
+	uint64_t Sent() const {
+		return _sent.load(std::memory_order_acquire);
+	}
+
+private:
+	void Drain() {
+		_b_drain_posted.exchange(false, std::memory_order_acq_rel);
+		std::shared_ptr<BenchFrame> frame;
+		while (_send_mpsc.Pop(frame)) {
+			_send_que.push_back(std::move(frame));
+		}
+		if (_flush_count > 0 || _send_que.empty()) {
+			return;
+		}
+		Flush();
+	}
+
+	void Flush() {
+		_flush_count = _send_que.size();
+		boost::asio::post(_io_context, [this]() {
+			HandleWrite();
+		});
+	}
+
+	void HandleWrite() {
+		_send_que.erase(_send_que.begin(), _send_que.begin() + _flush_count);
+		_sent.fetch_add(_flush_count, std::memory_order_release);
+		_flush_count = 0;
+		if (!_send_que.empty()) {
+			Flush();
+		}
+	}
+
+	boost::asio::io_context& _io_context;
+	MpscQueue<std::shared_ptr<BenchFrame>> _send_mpsc;
+	std::atomic<bool> _b_drain_posted;
+	std::deque<std::shared_ptr<BenchFrame>> _send_que;
+	std::size_t _flush_count;
+	std::atomic<uint64_t> _sent;
+};
+
+// 启动一个io线程，threads个生产者各发送MSGS_PER_THREAD个消息，计时到io线程全部写出为止
+template <typename Sender>
+double RunSender(int threads) {
+	boost::asio::io_context io_context;
+	auto work = boost::asio::make_work_guard(io_context);
+	std::thread io_thread([&io_context]() {
+		io_context.run();
+	});
+
+	Sender sender(io_context);
+	//广播消息只组帧一次，所有发送共享同一个帧
+	auto frame = std::make_shared<BenchFrame>();
+	frame->_data.assign(64, 'x');
+	uint64_t total = uint64_t(threads) * MSGS_PER_THREAD;
+	double seconds = RunThreads(threads, [&](int index) {
+		for (int i = 0; i < MSGS_PER_THREAD; ++i) {
+			sender.Send(frame);
+		}
+		//0号生产者发送完后等待io线程全部写出，耗时包含排空队列的时间
+		if (index == 0) {
+			while (sender.Sent() < total) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	work.reset();
+	io_context.stop();
+	io_thread.join();
+	return seconds;
+}
+
+}
+
+CHAT_BENCH(SendPath) {
+	for (int threads : THREAD_COUNTS) {
+		uint64_t ops = uint64_t(threads) * MSGS_PER_THREAD;
+		results.push_back({ "mutex send queue", threads, ops, RunSender<MutexSender>(threads) });
+		results.push_back({ "mpsc queue + io executor", threads, ops, RunSender<MpscSender>(threads) });
+	}
+}
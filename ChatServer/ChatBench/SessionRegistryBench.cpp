@@ -0,0 +1,164 @@
+#include "BenchHarness.h"
+#include "../ShardedMap.h"
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <string>
+
+// 会话表争用压测
+// 模拟读路径: 每收到一个消息检查两次会话有效性(头部、消息体)，再按uid查一次会话做投递
+// 另有1%的操作是登录/断开，对应会话表的插入和删除
+namespace {
+
+const int SESSION_COUNT = 10000;
+const int OPS_PER_THREAD = 200000;
+const int THREAD_COUNTS[] = { 1, 2, 4, 8, 16 };
+
+struct BenchSession {
+	std::string _uuid;
+	uint64_t _conn_id;
+	int _uid;
+	std::atomic<bool> _b_valid;
+};
+
+std::vector<std::shared_ptr<BenchSession>> MakeSessions() {
+	std::vector<std::shared_ptr<BenchSession>> sessions;
+	for (int i = 0; i < SESSION_COUNT; ++i) {
+		auto session = std::make_shared<BenchSession>();
+		//与uuid字符串长度一致
+		session->_uuid = "8f14e45f-ceea-467f-a0e6-" + std::to_string(100000000000ll + i);
+		session->_conn_id = i + 1;
+		session->_uid = 10000 + i;
+		session->_b_valid = true;
+		sessions.push_back(session);
+	}
+	return sessions;
+}
+
+// 原有实现: CServer和UserMgr各一把全局锁，会话表以uuid字符串为key
+struct LegacyRegistry {
+	std::mutex _mutex;
+	std::map<std::string, std::shared_ptr<BenchSession>> _sessions;
+	std::mutex _session_mtx;
+	std::unordered_map<int, std::shared_ptr<BenchSession>> _uid_to_session;
+
+	bool CheckValid(const std::string& uuid) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _sessions.find(uuid) != _sessions.end();
+	}
+
+	std::shared_ptr<BenchSession> GetSession(int uid) {
+		std::lock_guard<std::mutex> lock(_session_mtx);
+		auto iter = _uid_to_session.find(uid);
+		return iter == _uid_to_session.end() ? nullptr : iter->second;
+	}
+
+	void Add(const std::shared_ptr<BenchSession>& session) {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_sessions[session->_uuid] = session;
+		}
+		std::lock_guard<std::mutex> lock(_session_mtx);
+		_uid_to_session[session->_uid] = session;
+	}
+
+	void Remove(const std::shared_ptr<BenchSession>& session) {
+		{
+			std::lock_guard<std::mutex> lock(_session_mtx);
+			_uid_to_session.erase(session->_uid);
+		}
+		std::lock_guard<std::mutex> lock(_mutex);
+		_sessions.erase(session->_uuid);
+	}
+};
+
+// 新实现: 整数id和uid两张分段表，有效性检查只读会话自身的原子标志
+struct ShardedRegistry {
+	ShardedMap<uint64_t, std::shared_ptr<BenchSession>> _sessions;
+	ShardedMap<int, std::shared_ptr<BenchSession>> _uid_to_session;
+
+	bool CheckValid(const BenchSession& session) {
+		return session._b_valid.load(std::memory_order_acquire);
+	}
+
+	std::shared_ptr<BenchSession> GetSession(int uid) {
+		std::shared_ptr<BenchSession> session;
+		_uid_to_session.Find(uid, session);
+		return session;
+	}
+
+	void Add(const std::shared_ptr<BenchSession>& session) {
+		_sessions.Insert(session->_conn_id, session);
+		_uid_to_session.Insert(session->_uid, session);
+		session->_b_valid.store(true, std::memory_order_release);
+	}
+
+	void Remove(const std::shared_ptr<BenchSession>& session) {
+		session->_b_valid.store(false, std::memory_order_release);
+		_uid_to_session.Erase(session->_uid);
+		_sessions.Erase(session->_conn_id);
+	}
+};
+
+// 每个线程用简单的线性同余生成器挑选会话，避免rand()内部加锁影响结果
+inline uint32_t NextRand(uint32_t& seed) {
+	seed = seed * 1664525u + 1013904223u;
+	return seed >> 8;
+}
+
+}
+
+CHAT_BENCH(SessionRegistry) {
+	auto sessions = MakeSessions();
+	for (int threads : THREAD_COUNTS) {
+		{
+			LegacyRegistry registry;
+			for (auto& session : sessions) {
+				registry.Add(session);
+			}
+			double seconds = RunThreads(threads, [&](int index) {
+				uint32_t seed = index * 7919 + 1;
+				uint64_t hits = 0;
+				for (int i = 0; i < OPS_PER_THREAD; ++i) {
+					auto& session = sessions[NextRand(seed) % SESSION_COUNT];
+					if (NextRand(seed) % 100 == 0) {
+						registry.Remove(session);
+						registry.Add(session);
+						continue;
+					}
+					hits += registry.CheckValid(session->_uuid);
+					hits += registry.CheckValid(session->_uuid);
+					hits += registry.GetSession(session->_uid) != nullptr;
+				}
+				DoNotOptimize(hits);
+			});
+			results.push_back({ "legacy map + global mutex", threads, uint64_t(threads) * OPS_PER_THREAD, seconds });
+		}
+
+		{
+			ShardedRegistry registry;
+			for (auto& session : sessions) {
+				registry.Add(session);
+			}
+			double seconds = RunThreads(threads, [&](int index) {
+				uint32_t seed = index * 7919 + 1;
+				uint64_t hits = 0;
+				for (int i = 0; i < OPS_PER_THREAD; ++i) {
+					auto& session = sessions[NextRand(seed) % SESSION_COUNT];
+					if (NextRand(seed) % 100 == 0) {
+						registry.Remove(session);
+						registry.Add(session);
+						continue;
+					}
+					hits += registry.CheckValid(*session);
+					hits += registry.CheckValid(*session);
+					hits += registry.GetSession(session->_uid) != nullptr;
+				}
+				DoNotOptimize(hits);
+			});
+			results.push_back({ "sharded map + session flag", threads, uint64_t(threads) * OPS_PER_THREAD, seconds });
+		}
+	}
+}
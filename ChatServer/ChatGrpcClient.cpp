@@ -1,4 +1,5 @@
 #include "ChatGrpcClient.h"
+#include "Logger.h"
 #include "RedisMgr.h"
 #include "ConfigMgr.h"
 #include "UserMgr.h"
@@ -78,8 +79,8 @@ bool ChatGrpcClient::GetBaseInfo(std::string base_key, int uid, std::shared_ptr<
 		userinfo->desc = root["desc"].asString();
 		userinfo->sex = root["sex"].asInt();
 		userinfo->icon = root["icon"].asString();
-		std::cout << "user login uid is  " << userinfo->uid << " name  is "
-			<< userinfo->name << " pwd is " << userinfo->pwd << " email is " << userinfo->email << endl;
+		LOG_DEBUG("user login uid is  " << userinfo->uid << " name  is "
+			<< userinfo->name << " pwd is " << userinfo->pwd << " email is " << userinfo->email);
 	}
 	else {
 		//redis中没有则查询mysql
@@ -137,7 +138,7 @@ AuthFriendRsp ChatGrpcClient::NotifyAuthFriend(std::string server_ip, const Auth
 }
 
 TextChatMsgRsp ChatGrpcClient::NotifyTextChatMsg(std::string server_ip, 
-	const TextChatMsgReq& req, const Json::Value& rtvalue) {
+	const TextChatMsgReq& req) {
 	
 	TextChatMsgRsp rsp;
 	rsp.set_error(ErrorCodes::Success);
@@ -202,3 +203,31 @@ KickUserRsp ChatGrpcClient::NotifyKickUser(std::string server_ip, const KickUser
 
 	return rsp;
 }
+
+AddFriendRsp ChatGrpcClient::AsyncNotifyAddFriend(const std::string& server_ip, const AddFriendReq& req,
+	boost::asio::yield_context yield) {
+	return AsyncCall<AddFriendRsp>([this, &server_ip, &req]() {
+		return NotifyAddFriend(server_ip, req);
+	}, yield);
+}
+
+AuthFriendRsp ChatGrpcClient::AsyncNotifyAuthFriend(const std::string& server_ip, const AuthFriendReq& req,
+	boost::asio::yield_context yield) {
+	return AsyncCall<AuthFriendRsp>([this, &server_ip, &req]() {
+		return NotifyAuthFriend(server_ip, req);
+	}, yield);
+}
+
+TextChatMsgRsp ChatGrpcClient::AsyncNotifyTextChatMsg(const std::string& server_ip, const TextChatMsgReq& req,
+	boost::asio::yield_context yield) {
+	return AsyncCall<TextChatMsgRsp>([this, &server_ip, &req]() {
+		return NotifyTextChatMsg(server_ip, req);
+	}, yield);
+}
+
+KickUserRsp ChatGrpcClient::AsyncNotifyKickUser(const std::string& server_ip, const KickUserReq& req,
+	boost::asio::yield_context yield) {
+	return AsyncCall<KickUserRsp>([this, &server_ip, &req]() {
+		return NotifyKickUser(server_ip, req);
+	}, yield);
+}
@@ -7,6 +7,7 @@
 #include "message.pb.h"
 #include <queue>
 #include "data.h"
+#include "AsyncCall.h"
 #include <json/json.h>
 #include <json/value.h>
 #include <json/reader.h>
@@ -114,8 +115,14 @@ public:
 	AddFriendRsp NotifyAddFriend(std::string server_ip, const AddFriendReq& req); // 发送添加好友请求
 	AuthFriendRsp NotifyAuthFriend(std::string server_ip, const AuthFriendReq& req); // 发送验证好友请求
 	bool GetBaseInfo(std::string base_key, int uid, std::shared_ptr<UserInfo>& userinfo); // 获取用户基本信息
-	TextChatMsgRsp NotifyTextChatMsg(std::string server_ip, const TextChatMsgReq& req, const Json::Value& rtvalue); // 发送文本消息
+	TextChatMsgRsp NotifyTextChatMsg(std::string server_ip, const TextChatMsgReq& req); // 发送文本消息
 	KickUserRsp NotifyKickUser(std::string server_ip, const KickUserReq& req);
+
+	// 逻辑层协程使用的异步版本，rpc在BlockingPool上执行，等待对端回包期间逻辑线程可以处理其他消息
+	AddFriendRsp AsyncNotifyAddFriend(const std::string& server_ip, const AddFriendReq& req, boost::asio::yield_context yield);
+	AuthFriendRsp AsyncNotifyAuthFriend(const std::string& server_ip, const AuthFriendReq& req, boost::asio::yield_context yield);
+	TextChatMsgRsp AsyncNotifyTextChatMsg(const std::string& server_ip, const TextChatMsgReq& req, boost::asio::yield_context yield);
+	KickUserRsp AsyncNotifyKickUser(const std::string& server_ip, const KickUserReq& req, boost::asio::yield_context yield);
 private:
 	ChatGrpcClient();
 	unordered_map<std::string, std::unique_ptr<ChatConPool>> _pools; //存储连接池的映射
@@ -0,0 +1,241 @@
+#include "LoadGen.h"
+#include "SimUser.h"
+#include "../ConfigMgr.h"
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+namespace {
+
+std::string GetOr(SectionInfo& section, const std::string& key, const std::string& def) {
+	auto value = section[key];
+	return value.empty() ? def : value;
+}
+
+int GetInt(SectionInfo& section, const std::string& key, int def) {
+	auto value = section[key];
+	return value.empty() ? def : std::stoi(value);
+}
+
+double ToMs(uint64_t ns) {
+	return ns / 1e6;
+}
+
+void PrintLatency(const std::string& name, const LatencyHistogram& hist, double seconds) {
+	auto snap = hist.GetSnapshot();
+	std::cout << std::left << std::setw(24) << name
+		<< " count " << std::setw(10) << snap._count
+		<< " rate " << std::setw(10) << std::fixed << std::setprecision(1) << (seconds > 0 ? snap._count / seconds : 0.0)
+		<< std::setprecision(3)
+		<< " p50 " << std::setw(9) << ToMs(snap.Quantile(0.5))
+		<< " p99 " << std::setw(9) << ToMs(snap.Quantile(0.99))
+		<< " p999 " << std::setw(9) << ToMs(snap.Quantile(0.999))
+		<< " max " << ToMs(snap._max) << " ms" << std::endl;
+}
+
+}
+
+LoadConfig::LoadConfig() {
+	auto section = ConfigMgr::Inst()["LoadGen"];
+	_gate_host = GetOr(section, "GateHost", "127.0.0.1");
+	_gate_port = GetOr(section, "GatePort", "8080");
+	_email_format = GetOr(section, "EmailFormat", "loadtest{}@llfc.com");
+	_passwd = GetOr(section, "Passwd", "123456");
+	_user_start = GetInt(section, "UserStart", 0);
+	_user_count = GetInt(section, "UserCount", 1000);
+	_threads = (std::max)(1, GetInt(section, "Threads", 4));
+	_login_rate = (std::max)(1, GetInt(section, "LoginRate", 200));
+	_login_timeout = GetInt(section, "LoginTimeout", 30);
+	_duration = GetInt(section, "Duration", 60);
+	_msg_rate = std::stod(GetOr(section, "MsgRate", "1"));
+	_weight_chat = GetInt(section, "WeightChat", 80);
+	_weight_search = GetInt(section, "WeightSearch", 10);
+	_weight_add_friend = GetInt(section, "WeightAddFriend", 5);
+	_weight_heartbeat = GetInt(section, "WeightHeartBeat", 5);
+	_heartbeat_interval = GetInt(section, "HeartbeatInterval", 10);
+	_content_bytes = (std::min)(GetInt(section, "ContentBytes", 64), MAX_LENGTH / 2);
+	_codec = section["Codec"] == "proto" ? ClientCodec::Proto : ClientCodec::Json;
+}
+
+const char* ReqKindName(ReqKind kind) {
+	switch (kind) {
+	case ReqKind::Chat:
+		return "text chat";
+	case ReqKind::Search:
+		return "search user";
+	case ReqKind::AddFriend:
+		return "add friend";
+	case ReqKind::HeartBeat:
+		return "heartbeat";
+	default:
+		return "unknown";
+	}
+}
+
+LoadStats::LoadStats() :_login_ok(0), _login_failed(0), _disconnected(0), _delivered(0),
+_bytes_sent(0), _bytes_recv(0) {
+	for (int i = 0; i < static_cast<int>(ReqKind::Count); ++i) {
+		_sent[i] = 0;
+		_rsp[i] = 0;
+	}
+}
+
+LoadGen::LoadGen(const LoadConfig& config) :_config(config), _uids(new std::atomic<int>[config._user_count]),
+_window_start((std::numeric_limits<int64_t>::max)()), _window_end((std::numeric_limits<int64_t>::max)()),
+_b_sending(true) {
+	for (int i = 0; i < _config._user_count; ++i) {
+		_uids[i] = 0;
+	}
+}
+
+LoadGen::~LoadGen() {
+	for (auto& work : _works) {
+		work.reset();
+	}
+	for (auto& io_context : _io_contexts) {
+		io_context->stop();
+	}
+	for (auto& thread : _threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+}
+
+int LoadGen::ServerIndex(const std::string& host, const std::string& port) {
+	std::lock_guard<std::mutex> lock(_server_mtx);
+	auto name = host + ":" + port;
+	auto iter = _servers.find(name);
+	if (iter != _servers.end()) {
+		return iter->second;
+	}
+	int index = static_cast<int>(_servers.size());
+	_servers[name] = index;
+	return index;
+}
+
+std::string LoadGen::ServerName(int index) {
+	std::lock_guard<std::mutex> lock(_server_mtx);
+	for (auto& server : _servers) {
+		if (server.second == index) {
+			return server.first;
+		}
+	}
+	return "";
+}
+
+void LoadGen::SetUid(int index, int uid) {
+	_uids[index].store(uid, std::memory_order_relaxed);
+}
+
+int LoadGen::GetUid(int index) const {
+	if (index < 0 || index >= _config._user_count) {
+		return 0;
+	}
+	return _uids[index].load(std::memory_order_relaxed);
+}
+
+int LoadGen::PeerOf(int index) const {
+	//两两配对，用户数为奇数时最后一个用户和第一个用户聊天
+	int peer = index ^ 1;
+	return peer < _config._user_count ? peer : 0;
+}
+
+void LoadGen::Run() {
+	for (int i = 0; i < _config._threads; ++i) {
+		_io_contexts.push_back(std::unique_ptr<boost::asio::io_context>(new boost::asio::io_context(1)));
+		_works.push_back(std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+			new boost::asio::executor_work_guard<boost::asio::io_context::executor_type>(_io_contexts.back()->get_executor())));
+	}
+	for (auto& io_context : _io_contexts) {
+		auto* io = io_context.get();
+		_threads.emplace_back([io]() {
+			io->run();
+		});
+	}
+
+	std::cout << "login " << _config._user_count << " users through " << _config._gate_host << ":" << _config._gate_port
+		<< ", " << _config._login_rate << " users per second" << std::endl;
+	for (int i = 0; i < _config._user_count; ++i) {
+		auto& io_context = *_io_contexts[i % _io_contexts.size()];
+		auto user = std::make_shared<SimUser>(io_context, *this, i);
+		_users.push_back(user);
+		int delay_ms = static_cast<int>(static_cast<int64_t>(i) * 1000 / _config._login_rate);
+		boost::asio::post(io_context, [user, delay_ms]() {
+			user->Start(delay_ms);
+		});
+	}
+
+	//登录阶段，全部用户登录完成(成功或失败)或者超时后进入压测阶段
+	auto login_start = std::chrono::steady_clock::now();
+	auto login_limit = std::chrono::seconds(_config._user_count / _config._login_rate + _config._login_timeout);
+	while (_stats._login_ok + _stats._login_failed < static_cast<uint64_t>(_config._user_count)
+		&& std::chrono::steady_clock::now() - login_start < login_limit) {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		std::cout << "logged in " << _stats._login_ok << ", failed " << _stats._login_failed << std::endl;
+	}
+	if (_stats._login_ok == 0) {
+		std::cout << "no user logged in, abort" << std::endl;
+		for (auto& user : _users) {
+			user->Stop();
+		}
+		return;
+	}
+
+	//压测阶段
+	std::cout << "run " << _config._duration << " seconds with " << _stats._login_ok << " users" << std::endl;
+	auto start = std::chrono::steady_clock::now();
+	_window_start = Metrics::NowNs();
+	for (int i = 1; i <= _config._duration; ++i) {
+		std::this_thread::sleep_until(start + std::chrono::seconds(i));
+		PrintProgress(i);
+	}
+	_window_end = Metrics::NowNs();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	//停止发送，等待在途的消息送达后再统计
+	_b_sending = false;
+	std::this_thread::sleep_for(std::chrono::seconds(3));
+	for (auto& user : _users) {
+		user->Stop();
+	}
+	PrintReport(seconds);
+}
+
+void LoadGen::PrintProgress(double seconds) {
+	uint64_t sent = 0;
+	for (auto& count : _stats._sent) {
+		sent += count;
+	}
+	std::cout << std::fixed << std::setprecision(0) << seconds << "s sent " << sent
+		<< ", delivered " << _stats._delivered << ", disconnected " << _stats._disconnected << std::endl;
+}
+
+void LoadGen::PrintReport(double seconds) {
+	std::cout << "== login" << std::endl;
+	std::cout << "ok " << _stats._login_ok << ", failed " << _stats._login_failed
+		<< ", disconnected during run " << _stats._disconnected << std::endl;
+	PrintLatency("login", _stats._login, 0);
+
+	std::cout << "== requests (" << std::fixed << std::setprecision(1) << seconds << "s)" << std::endl;
+	for (int i = 0; i < static_cast<int>(ReqKind::Count); ++i) {
+		std::cout << std::left << std::setw(24) << ReqKindName(static_cast<ReqKind>(i))
+			<< " sent " << std::setw(10) << _stats._sent[i]
+			<< " rsp " << _stats._rsp[i] << std::endl;
+		PrintLatency(std::string(ReqKindName(static_cast<ReqKind>(i))) + " rtt", _stats._rtt[i], seconds);
+	}
+
+	std::cout << "== delivery" << std::endl;
+	auto chat_sent = _stats._sent[static_cast<int>(ReqKind::Chat)].load();
+	std::cout << "text chat sent " << chat_sent << ", delivered " << _stats._delivered
+		<< ", lost " << (chat_sent > _stats._delivered ? chat_sent - _stats._delivered : 0) << std::endl;
+	PrintLatency("same server", _stats._delivery_same, seconds);
+	PrintLatency("cross server", _stats._delivery_cross, seconds);
+
+	std::cout << "== traffic" << std::endl;
+	std::cout << "bytes sent " << _stats._bytes_sent << ", bytes recv " << _stats._bytes_recv << std::endl;
+	std::lock_guard<std::mutex> lock(_server_mtx);
+	for (auto& server : _servers) {
+		std::cout << "chat server " << server.second << " : " << server.first << std::endl;
+	}
+}
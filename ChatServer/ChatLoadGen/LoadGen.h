@@ -0,0 +1,130 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <map>
+#include "../const.h"
+#include "../Metrics.h"
+
+class SimUser;
+
+// 压测配置，从config.ini的[LoadGen]段读取
+struct LoadConfig {
+	LoadConfig();
+	// GateServer地址，登录走 POST /user_login
+	std::string _gate_host;
+	std::string _gate_port;
+	// 账号邮箱格式，{}替换为序号，账号需要提前注册好并使用相同的密码
+	std::string _email_format;
+	std::string _passwd;
+	int _user_start;
+	int _user_count;
+	// io线程数，模拟用户平均分配到各线程
+	int _threads;
+	// 每秒发起登录的用户数，避免瞬间打满GateServer
+	int _login_rate;
+	// 登录阶段最长等待时间(秒)，超时后未登录成功的用户不再计入
+	int _login_timeout;
+	// 全部登录后持续压测的时间(秒)
+	int _duration;
+	// 每个用户每秒发送的消息数，发送间隔按指数分布随机
+	double _msg_rate;
+	// 各类消息所占的比例
+	int _weight_chat;
+	int _weight_search;
+	int _weight_add_friend;
+	int _weight_heartbeat;
+	// 独立于消息比例的心跳间隔(秒)，保证连接不会被服务器超时断开
+	int _heartbeat_interval;
+	// 聊天消息内容的字节数，不足时补齐
+	int _content_bytes;
+	ClientCodec _codec;
+};
+
+// 用户发出的请求类型，每种请求按回包统计往返延迟
+enum class ReqKind : int {
+	Chat = 0,
+	Search = 1,
+	AddFriend = 2,
+	HeartBeat = 3,
+	Count = 4,
+};
+
+const char* ReqKindName(ReqKind kind);
+
+// 全部模拟用户共享的统计，各用户在自己的io线程中更新
+struct LoadStats {
+	LoadStats();
+	std::atomic<uint64_t> _login_ok;
+	std::atomic<uint64_t> _login_failed;
+	std::atomic<uint64_t> _disconnected;
+	std::atomic<uint64_t> _sent[static_cast<int>(ReqKind::Count)];
+	std::atomic<uint64_t> _rsp[static_cast<int>(ReqKind::Count)];
+	std::atomic<uint64_t> _delivered;
+	std::atomic<uint64_t> _bytes_sent;
+	std::atomic<uint64_t> _bytes_recv;
+	// http登录到chat server登录回包的耗时
+	LatencyHistogram _login;
+	// 聊天消息从发送方发出到接收方收到通知的耗时，按双方是否在同一个chat server区分
+	LatencyHistogram _delivery_same;
+	LatencyHistogram _delivery_cross;
+	// 请求到回包的耗时
+	LatencyHistogram _rtt[static_cast<int>(ReqKind::Count)];
+};
+
+// 无界面的压测客户端，按真实客户端的流程登录，然后按配置的比例发送消息
+// 聊天消息内容中带有发送时间和发送方所在的chat server，接收方据此统计端到端投递延迟
+class LoadGen
+{
+public:
+	explicit LoadGen(const LoadConfig& config);
+	~LoadGen();
+	// 执行完整的压测并输出报告，阻塞到结束
+	void Run();
+
+	const LoadConfig& Config() const {
+		return _config;
+	}
+	LoadStats& Stats() {
+		return _stats;
+	}
+	// 是否在统计窗口内发出，只统计压测阶段发出的消息，登录爬坡和收尾阶段发出的不计入
+	// 窗口结束后仍在途中的消息收到时照常统计，避免漏掉慢消息
+	bool InWindow(int64_t send_ns) const {
+		return send_ns >= _window_start.load(std::memory_order_relaxed)
+			&& send_ns < _window_end.load(std::memory_order_relaxed);
+	}
+	// 是否继续发送消息
+	bool Sending() const {
+		return _b_sending.load(std::memory_order_relaxed);
+	}
+	// chat server地址转为序号，用于区分是否同服投递
+	int ServerIndex(const std::string& host, const std::string& port);
+	std::string ServerName(int index);
+	// 登录成功后登记uid，供其他用户选择聊天对象，未登录时返回0
+	void SetUid(int index, int uid);
+	int GetUid(int index) const;
+	// 聊天对象固定为相邻序号的用户，保证每个用户都会收到消息
+	int PeerOf(int index) const;
+
+private:
+	void PrintProgress(double seconds);
+	void PrintReport(double seconds);
+
+	LoadConfig _config;
+	LoadStats _stats;
+	std::vector<std::unique_ptr<boost::asio::io_context>> _io_contexts;
+	std::vector<std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>> _works;
+	std::vector<std::thread> _threads;
+	std::vector<std::shared_ptr<SimUser>> _users;
+	std::unique_ptr<std::atomic<int>[]> _uids;
+	std::mutex _server_mtx;
+	std::map<std::string, int> _servers;
+	std::atomic<int64_t> _window_start;
+	std::atomic<int64_t> _window_end;
+	std::atomic<bool> _b_sending;
+};
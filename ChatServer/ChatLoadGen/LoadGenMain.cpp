@@ -0,0 +1,11 @@
+#include "LoadGen.h"
+
+// 用法: ChatLoadGen
+// 参数从当前目录config.ini的[LoadGen]段读取，压测账号需要提前注册
+int main()
+{
+	LoadConfig config;
+	LoadGen gen(config);
+	gen.Run();
+	return 0;
+}
@@ -0,0 +1,520 @@
+#include "SimUser.h"
+#include "../Logger.h"
+#include <cstring>
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// 与客户端一致的密码异或处理，账号密码只包含ascii字符
+std::string XorString(const std::string& input) {
+	std::string result = input;
+	int length = static_cast<int>(input.length()) % 255;
+	for (int i = 0; i < length; ++i) {
+		result[i] = static_cast<char>(input[i] ^ length);
+	}
+	return result;
+}
+
+// 聊天内容的前缀，后面依次是发送时间(纳秒)和发送方所在chat server的序号
+const char CONTENT_TAG[] = "lg ";
+// 单个消息体的上限，超过认为数据损坏
+const std::size_t MAX_BODY_LEN = 16 * 1024 * 1024;
+const std::size_t READ_CHUNK = 8192;
+
+}
+
+SimUser::SimUser(boost::asio::io_context& io_context, LoadGen& gen, int index)
+	:_io_context(io_context), _gen(gen), _index(index), _uid(0), _server(-1), _login_start(0),
+	_b_logged_in(false), _b_closed(false), _resolver(io_context), _http_socket(io_context),
+	_socket(io_context), _read_buf(READ_CHUNK), _read_len(0), _send_timer(io_context),
+	_heartbeat_timer(io_context), _rand(static_cast<unsigned int>(index) * 7919u + 17u), _seq(0) {
+}
+
+void SimUser::Start(int delay_ms) {
+	auto self = shared_from_this();
+	_send_timer.expires_after(std::chrono::milliseconds(delay_ms));
+	_send_timer.async_wait([self](const boost::system::error_code& ec) {
+		if (ec || self->_b_closed) {
+			return;
+		}
+		self->HttpLogin();
+	});
+}
+
+void SimUser::Stop() {
+	auto self = shared_from_this();
+	boost::asio::post(_io_context, [self]() {
+		self->Close();
+	});
+}
+
+void SimUser::HttpLogin() {
+	auto& config = _gen.Config();
+	_login_start = Metrics::NowNs();
+
+	std::string email = config._email_format;
+	auto pos = email.find("{}");
+	if (pos != std::string::npos) {
+		email.replace(pos, 2, std::to_string(config._user_start + _index));
+	}
+	Json::Value root;
+	root["email"] = email;
+	root["passwd"] = XorString(config._passwd);
+
+	_http_req.method(http::verb::post);
+	_http_req.target("/user_login");
+	_http_req.version(11);
+	_http_req.set(http::field::host, config._gate_host);
+	_http_req.set(http::field::content_type, "application/json");
+	_http_req.body() = root.toStyledString();
+	_http_req.prepare_payload();
+
+	auto self = shared_from_this();
+	_resolver.async_resolve(config._gate_host, config._gate_port,
+		[self](const boost::system::error_code& ec, tcp::resolver::results_type results) {
+			if (ec) {
+				self->LoginFailed("resolve gate server failed, " + ec.message());
+				return;
+			}
+			boost::asio::async_connect(self->_http_socket, results,
+				[self](const boost::system::error_code& ec, const tcp::endpoint&) {
+					if (ec) {
+						self->LoginFailed("connect gate server failed, " + ec.message());
+						return;
+					}
+					http::async_write(self->_http_socket, self->_http_req,
+						[self](const boost::system::error_code& ec, std::size_t) {
+							if (ec) {
+								self->LoginFailed("write login request failed, " + ec.message());
+								return;
+							}
+							http::async_read(self->_http_socket, self->_http_buffer, self->_http_rsp,
+								[self](const boost::system::error_code& ec, std::size_t) {
+									self->OnHttpLogin(ec);
+								});
+						});
+				});
+		});
+}
+
+void SimUser::OnHttpLogin(const boost::system::error_code& ec) {
+	boost::system::error_code ignored;
+	_http_socket.close(ignored);
+	if (ec) {
+		LoginFailed("read login response failed, " + ec.message());
+		return;
+	}
+
+	Json::Reader reader;
+	Json::Value root;
+	if (!reader.parse(_http_rsp.body(), root)) {
+		LoginFailed("parse login response failed");
+		return;
+	}
+	if (root["error"].asInt() != ErrorCodes::Success) {
+		LoginFailed("gate server error " + std::to_string(root["error"].asInt()));
+		return;
+	}
+
+	_uid = root["uid"].asInt();
+	_token = root["token"].asString();
+	ConnectChat(root["host"].asString(), root["port"].asString());
+}
+
+void SimUser::ConnectChat(const std::string& host, const std::string& port) {
+	_server = _gen.ServerIndex(host, port);
+	auto self = shared_from_this();
+	_resolver.async_resolve(host, port,
+		[self](const boost::system::error_code& ec, tcp::resolver::results_type results) {
+			if (ec) {
+				self->LoginFailed("resolve chat server failed, " + ec.message());
+				return;
+			}
+			boost::asio::async_connect(self->_socket, results,
+				[self](const boost::system::error_code& ec, const tcp::endpoint&) {
+					if (ec) {
+						self->LoginFailed("connect chat server failed, " + ec.message());
+						return;
+					}
+					self->_socket.set_option(tcp::no_delay(true));
+					self->ChatLogin();
+				});
+		});
+}
+
+void SimUser::ChatLogin() {
+	client::ChatLoginReq req;
+	req.uid = _uid;
+	req.token = _token;
+	SendMsg(req, MSG_CHAT_LOGIN);
+	AsyncRead();
+}
+
+void SimUser::LoginFailed(const std::string& reason) {
+	LOG_WARN("user " << _index << " login failed: " << reason);
+	_gen.Stats()._login_failed++;
+	Close();
+}
+
+void SimUser::AsyncRead() {
+	if (_read_buf.size() - _read_len < READ_CHUNK) {
+		_read_buf.resize(_read_len + READ_CHUNK);
+	}
+	auto self = shared_from_this();
+	_socket.async_read_some(boost::asio::buffer(_read_buf.data() + _read_len, _read_buf.size() - _read_len),
+		[self](const boost::system::error_code& ec, std::size_t bytes) {
+			if (ec) {
+				if (!self->_b_closed) {
+					LOG_WARN("user " << self->_index << " read failed, error is " << ec.message());
+					if (self->_b_logged_in) {
+						self->_gen.Stats()._disconnected++;
+					}
+					else {
+						self->LoginFailed("chat connection closed before login response");
+					}
+					self->Close();
+				}
+				return;
+			}
+			self->_read_len += bytes;
+			self->_gen.Stats()._bytes_recv += bytes;
+			if (!self->ParseFrames()) {
+				self->_gen.Stats()._disconnected++;
+				self->Close();
+				return;
+			}
+			self->AsyncRead();
+		});
+}
+
+bool SimUser::ParseFrames() {
+	std::size_t offset = 0;
+	while (_read_len - offset >= HEAD_TOTAL_LEN) {
+		const char* head = _read_buf.data() + offset;
+		unsigned short raw_id = 0;
+		memcpy(&raw_id, head, HEAD_ID_LEN);
+		raw_id = boost::asio::detail::socket_ops::network_to_host_short(raw_id);
+
+		std::size_t head_len = HEAD_TOTAL_LEN;
+		std::size_t body_len = 0;
+		if (raw_id & HEAD_EXT_FLAG) {
+			head_len = HEAD_EXT_TOTAL_LEN;
+			if (_read_len - offset < head_len) {
+				break;
+			}
+			uint32_t ext_len = 0;
+			memcpy(&ext_len, head + HEAD_ID_LEN, HEAD_EXT_DATA_LEN);
+			body_len = boost::asio::detail::socket_ops::network_to_host_long(ext_len);
+		}
+		else {
+			unsigned short len = 0;
+			memcpy(&len, head + HEAD_ID_LEN, HEAD_DATA_LEN);
+			body_len = boost::asio::detail::socket_ops::network_to_host_short(len);
+		}
+
+		if (body_len > MAX_BODY_LEN) {
+			LOG_ERROR("user " << _index << " invalid body length " << body_len);
+			return false;
+		}
+		if (_read_len - offset < head_len + body_len) {
+			//消息不完整，保证缓冲区放得下整个消息后继续读取
+			if (_read_buf.size() < head_len + body_len) {
+				_read_buf.resize(head_len + body_len + READ_CHUNK);
+			}
+			break;
+		}
+
+		auto flags = static_cast<unsigned short>(raw_id & (HEAD_COMPRESS_FLAG | HEAD_PROTO_FLAG));
+		auto msg_id = static_cast<short>(raw_id & ~(HEAD_EXT_FLAG | HEAD_COMPRESS_FLAG | HEAD_PROTO_FLAG));
+		HandleMsg(msg_id, flags, std::string(head + head_len, body_len));
+		offset += head_len + body_len;
+	}
+
+	if (offset > 0) {
+		memmove(_read_buf.data(), _read_buf.data() + offset, _read_len - offset);
+		_read_len -= offset;
+	}
+	return true;
+}
+
+void SimUser::HandleMsg(short msg_id, unsigned short flags, const std::string& body) {
+	//登录时没有请求压缩，服务器不会发送压缩消息
+	if (flags & HEAD_COMPRESS_FLAG) {
+		LOG_WARN("user " << _index << " unexpected compressed msg " << msg_id);
+		return;
+	}
+	auto codec = (flags & HEAD_PROTO_FLAG) ? ClientCodec::Proto : ClientCodec::Json;
+	switch (msg_id) {
+	case MSG_CHAT_LOGIN_RSP: {
+		client::ChatLoginRsp rsp;
+		if (!DecodeClientMsg(codec, body, rsp)) {
+			LoginFailed("decode chat login response failed");
+			return;
+		}
+		OnLoginRsp(rsp);
+		break;
+	}
+	case ID_NOTIFY_TEXT_CHAT_MSG_REQ: {
+		client::NotifyTextChatMsg notify;
+		if (DecodeClientMsg(codec, body, notify)) {
+			OnTextNotify(notify);
+		}
+		break;
+	}
+	case ID_TEXT_CHAT_MSG_RSP:
+		OnRsp(ReqKind::Chat);
+		break;
+	case ID_SEARCH_USER_RSP:
+		OnRsp(ReqKind::Search);
+		break;
+	case ID_ADD_FRIEND_RSP:
+		OnRsp(ReqKind::AddFriend);
+		break;
+	case ID_HEARTBEAT_RSP:
+		OnRsp(ReqKind::HeartBeat);
+		break;
+	case ID_NOTIFY_OFF_LINE_REQ:
+		//同一账号在别处登录，说明账号被重复使用
+		LOG_WARN("user " << _index << " uid " << _uid << " kicked offline");
+		_gen.Stats()._disconnected++;
+		Close();
+		break;
+	default:
+		break;
+	}
+}
+
+void SimUser::OnLoginRsp(const client::ChatLoginRsp& rsp) {
+	if (rsp.error != ErrorCodes::Success) {
+		LoginFailed("chat server error " + std::to_string(rsp.error));
+		return;
+	}
+	_b_logged_in = true;
+	_gen.Stats()._login_ok++;
+	_gen.Stats()._login.Record(Metrics::NowNs() - _login_start);
+	_gen.SetUid(_index, _uid);
+	ScheduleHeartbeat();
+	ScheduleSend();
+}
+
+void SimUser::OnTextNotify(const client::NotifyTextChatMsg& notify) {
+	auto now = Metrics::NowNs();
+	auto& stats = _gen.Stats();
+	for (auto& text : notify.text_array) {
+		//只统计压测工具自己发出的消息
+		if (text.content.compare(0, sizeof(CONTENT_TAG) - 1, CONTENT_TAG) != 0) {
+			continue;
+		}
+		char* end = nullptr;
+		int64_t send_ns = std::strtoll(text.content.c_str() + sizeof(CONTENT_TAG) - 1, &end, 10);
+		int server = static_cast<int>(std::strtol(end, nullptr, 10));
+		if (!_gen.InWindow(send_ns)) {
+			continue;
+		}
+		stats._delivered++;
+		if (server == _server) {
+			stats._delivery_same.Record(now - send_ns);
+		}
+		else {
+			stats._delivery_cross.Record(now - send_ns);
+		}
+	}
+}
+
+void SimUser::OnRsp(ReqKind kind) {
+	auto& pending = _pending[static_cast<int>(kind)];
+	if (pending.empty()) {
+		return;
+	}
+	auto send_ns = pending.front();
+	pending.pop_front();
+	if (!_gen.InWindow(send_ns)) {
+		return;
+	}
+	auto& stats = _gen.Stats();
+	stats._rsp[static_cast<int>(kind)]++;
+	stats._rtt[static_cast<int>(kind)].Record(Metrics::NowNs() - send_ns);
+}
+
+void SimUser::ScheduleSend() {
+	auto rate = _gen.Config()._msg_rate;
+	if (_b_closed || !_gen.Sending() || rate <= 0) {
+		return;
+	}
+	//发送间隔按指数分布，多个用户叠加后近似泊松到达
+	std::exponential_distribution<double> interval(rate);
+	auto delay = std::chrono::microseconds(static_cast<int64_t>(interval(_rand) * 1000000));
+	_send_timer.expires_after(delay);
+	auto self = shared_from_this();
+	_send_timer.async_wait([self](const boost::system::error_code& ec) {
+		if (ec || self->_b_closed || !self->_gen.Sending()) {
+			return;
+		}
+		self->SendRandom();
+		self->ScheduleSend();
+	});
+}
+
+void SimUser::SendRandom() {
+	auto& config = _gen.Config();
+	int total = config._weight_chat + config._weight_search + config._weight_add_friend + config._weight_heartbeat;
+	if (total <= 0) {
+		return;
+	}
+	int pick = std::uniform_int_distribution<int>(0, total - 1)(_rand);
+	if ((pick -= config._weight_chat) < 0) {
+		SendChat();
+	}
+	else if ((pick -= config._weight_search) < 0) {
+		SendSearch();
+	}
+	else if ((pick -= config._weight_add_friend) < 0) {
+		SendAddFriend();
+	}
+	else {
+		SendHeartbeat();
+	}
+}
+
+void SimUser::ScheduleHeartbeat() {
+	if (_b_closed || _gen.Config()._heartbeat_interval <= 0) {
+		return;
+	}
+	_heartbeat_timer.expires_after(std::chrono::seconds(_gen.Config()._heartbeat_interval));
+	auto self = shared_from_this();
+	_heartbeat_timer.async_wait([self](const boost::system::error_code& ec) {
+		if (ec || self->_b_closed) {
+			return;
+		}
+		self->SendHeartbeat();
+		self->ScheduleHeartbeat();
+	});
+}
+
+void SimUser::SendChat() {
+	int touid = _gen.GetUid(_gen.PeerOf(_index));
+	//聊天对象还没有登录成功
+	if (touid == 0) {
+		return;
+	}
+	auto now = Metrics::NowNs();
+	client::TextChatMsgReq req;
+	req.fromuid = _uid;
+	req.touid = touid;
+	client::TextChatData data;
+	data.msgid = std::to_string(_uid) + "-" + std::to_string(++_seq);
+	data.content = CONTENT_TAG + std::to_string(now) + " " + std::to_string(_server) + " ";
+	auto content_bytes = static_cast<std::size_t>(_gen.Config()._content_bytes);
+	if (data.content.size() < content_bytes) {
+		data.content.append(content_bytes - data.content.size(), 'x');
+	}
+	req.text_array.push_back(data);
+	SendMsg(req, ID_TEXT_CHAT_MSG_REQ);
+	_pending[static_cast<int>(ReqKind::Chat)].push_back(now);
+	if (_gen.InWindow(now)) {
+		_gen.Stats()._sent[static_cast<int>(ReqKind::Chat)]++;
+	}
+}
+
+void SimUser::SendSearch() {
+	int peer_uid = _gen.GetUid(_gen.PeerOf(_index));
+	client::SearchUserReq req;
+	req.uid = std::to_string(peer_uid != 0 ? peer_uid : _uid);
+	auto now = Metrics::NowNs();
+	SendMsg(req, ID_SEARCH_USER_REQ);
+	_pending[static_cast<int>(ReqKind::Search)].push_back(now);
+	if (_gen.InWindow(now)) {
+		_gen.Stats()._sent[static_cast<int>(ReqKind::Search)]++;
+	}
+}
+
+void SimUser::SendAddFriend() {
+	int touid = _gen.GetUid(_gen.PeerOf(_index));
+	if (touid == 0) {
+		return;
+	}
+	client::AddFriendApplyReq req;
+	req.uid = _uid;
+	req.applyname = "loadgen_" + std::to_string(_uid);
+	req.bakname = "loadgen_" + std::to_string(touid);
+	req.touid = touid;
+	auto now = Metrics::NowNs();
+	SendMsg(req, ID_ADD_FRIEND_REQ);
+	_pending[static_cast<int>(ReqKind::AddFriend)].push_back(now);
+	if (_gen.InWindow(now)) {
+		_gen.Stats()._sent[static_cast<int>(ReqKind::AddFriend)]++;
+	}
+}
+
+void SimUser::SendHeartbeat() {
+	client::HeartBeatReq req;
+	req.fromuid = _uid;
+	auto now = Metrics::NowNs();
+	SendMsg(req, ID_HEART_BEAT_REQ);
+	_pending[static_cast<int>(ReqKind::HeartBeat)].push_back(now);
+	if (_gen.InWindow(now)) {
+		_gen.Stats()._sent[static_cast<int>(ReqKind::HeartBeat)]++;
+	}
+}
+
+template <typename Msg>
+void SimUser::SendMsg(const Msg& msg, short msg_id) {
+	if (_b_closed) {
+		return;
+	}
+	auto codec = _gen.Config()._codec;
+	std::string body = EncodeClientMsg(codec, msg);
+	//与CSession相同的4字节头部: 消息id(含标志位) + 消息体长度，均为网络字节序
+	unsigned short flag_id = static_cast<unsigned short>(msg_id);
+	if (codec == ClientCodec::Proto) {
+		flag_id |= HEAD_PROTO_FLAG;
+	}
+	std::string frame(HEAD_TOTAL_LEN, '\0');
+	unsigned short net_id = boost::asio::detail::socket_ops::host_to_network_short(flag_id);
+	unsigned short net_len = boost::asio::detail::socket_ops::host_to_network_short(
+		static_cast<unsigned short>(body.size()));
+	memcpy(&frame[0], &net_id, HEAD_ID_LEN);
+	memcpy(&frame[HEAD_ID_LEN], &net_len, HEAD_DATA_LEN);
+	frame.append(body);
+
+	_write_que.push_back(std::move(frame));
+	if (_write_que.size() == 1) {
+		Write();
+	}
+}
+
+void SimUser::Write() {
+	auto self = shared_from_this();
+	boost::asio::async_write(_socket, boost::asio::buffer(_write_que.front()),
+		[self](const boost::system::error_code& ec, std::size_t bytes) {
+			if (ec) {
+				if (!self->_b_closed) {
+					LOG_WARN("user " << self->_index << " write failed, error is " << ec.message());
+					self->_gen.Stats()._disconnected++;
+					self->Close();
+				}
+				return;
+			}
+			self->_gen.Stats()._bytes_sent += bytes;
+			self->_write_que.pop_front();
+			if (!self->_write_que.empty()) {
+				self->Write();
+			}
+		});
+}
+
+void SimUser::Close() {
+	if (_b_closed) {
+		return;
+	}
+	_b_closed = true;
+	boost::system::error_code ignored;
+	_send_timer.cancel();
+	_heartbeat_timer.cancel();
+	_resolver.cancel();
+	_http_socket.close(ignored);
+	//正在进行的写操作仍然引用队首的数据，发送队列随对象一起释放
+	_socket.close(ignored);
+}
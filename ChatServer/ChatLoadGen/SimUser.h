@@ -0,0 +1,75 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include "LoadGen.h"
+#include "../ClientMsg.h"
+
+// 一个模拟用户，所有操作都在所属io_context的线程中执行
+// 流程: http登录GateServer -> 连接返回的chat server -> MSG_CHAT_LOGIN -> 按比例随机发送消息
+class SimUser :public std::enable_shared_from_this<SimUser>
+{
+public:
+	SimUser(boost::asio::io_context& io_context, LoadGen& gen, int index);
+	// delay_ms后开始登录
+	void Start(int delay_ms);
+	void Stop();
+
+private:
+	void HttpLogin();
+	void OnHttpLogin(const boost::system::error_code& ec);
+	void ConnectChat(const std::string& host, const std::string& port);
+	void ChatLogin();
+	void LoginFailed(const std::string& reason);
+
+	void AsyncRead();
+	// 解析读缓冲区中所有完整的消息
+	bool ParseFrames();
+	void HandleMsg(short msg_id, unsigned short flags, const std::string& body);
+	void OnLoginRsp(const client::ChatLoginRsp& rsp);
+	void OnTextNotify(const client::NotifyTextChatMsg& notify);
+	void OnRsp(ReqKind kind);
+
+	void ScheduleSend();
+	void SendRandom();
+	void ScheduleHeartbeat();
+	void SendChat();
+	void SendSearch();
+	void SendAddFriend();
+	void SendHeartbeat();
+	template <typename Msg>
+	void SendMsg(const Msg& msg, short msg_id);
+	void Write();
+	void Close();
+
+	boost::asio::io_context& _io_context;
+	LoadGen& _gen;
+	int _index;
+	int _uid;
+	int _server;
+	std::string _token;
+	int64_t _login_start;
+	bool _b_logged_in;
+	bool _b_closed;
+
+	boost::asio::ip::tcp::resolver _resolver;
+	boost::asio::ip::tcp::socket _http_socket;
+	boost::beast::flat_buffer _http_buffer;
+	boost::beast::http::request<boost::beast::http::string_body> _http_req;
+	boost::beast::http::response<boost::beast::http::string_body> _http_rsp;
+
+	boost::asio::ip::tcp::socket _socket;
+	std::vector<char> _read_buf;
+	std::size_t _read_len;
+	std::deque<std::string> _write_que;
+
+	boost::asio::steady_timer _send_timer;
+	boost::asio::steady_timer _heartbeat_timer;
+	std::mt19937 _rand;
+	uint64_t _seq;
+	// 各类请求尚未收到回包的发送时间，服务器按顺序回包
+	std::deque<int64_t> _pending[static_cast<int>(ReqKind::Count)];
+};
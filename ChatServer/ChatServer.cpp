@@ -1,9 +1,12 @@
 #include "LogicSystem.h"
+#include "Logger.h"
 #include <csignal>
 #include <thread>
 #include <mutex>
 #include "AsioIOServicePool.h"
 #include "CServer.h"
+#include "MetricsServer.h"
+#include "OverloadCtrl.h"
 #include "ConfigMgr.h"
 #include "RedisMgr.h"
 #include "ChatServiceImpl.h"
@@ -20,6 +23,7 @@ int main()
 	SetConsoleOutputCP(CP_UTF8); // 设置控制台输出为 UTF - 8 编码
 	auto& cfg = ConfigMgr::Inst();
 	auto server_name = cfg["SelfServer"]["Name"];
+	Logger::Inst().Init(server_name);
 	try {
 		auto pool = AsioIOServicePool::GetInstance();
 		// 将当前服务器的登录数初始化为0（写入Redis）
@@ -36,6 +40,22 @@ int main()
 		//启动定时器
 		pointer_server->StartTimer();
 
+		//过载保护，在主io_context上评估，在每个io线程上探测事件循环延迟
+		std::vector<boost::asio::io_context*> io_contexts;
+		for (std::size_t i = 0; i < pool->Size(); ++i) {
+			io_contexts.push_back(&pool->GetIOService(i));
+		}
+		OverloadCtrl::Inst().Start(io_context, io_contexts);
+
+		//指标导出，未配置端口时不启动
+		std::shared_ptr<MetricsServer> metrics_server;
+		auto metrics_port = cfg["Metrics"]["Port"];
+		if (!metrics_port.empty()) {
+			metrics_server = std::make_shared<MetricsServer>(io_context, static_cast<unsigned short>(atoi(metrics_port.c_str())));
+			metrics_server->SetServer(pointer_server);
+			metrics_server->Start();
+		}
+
 		//定义一个GrpcServer
 		std::string server_address(cfg["SelfServer"]["Host"] + ":" + cfg["SelfServer"]["RPCPort"]);
 		ChatServiceImpl service;
@@ -49,7 +69,7 @@ int main()
 		
 		// 构建并启动gRPC服务器
 		std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
-		std::cout << "RPC Server listening on " << server_address << std::endl;
+		LOG_INFO("RPC Server listening on " << server_address);
 
 		//单独启动一个线程处理grpc服务
 		std::thread  grpc_server_thread([&server]() {
@@ -71,11 +91,13 @@ int main()
 
 		grpc_server_thread.join();  // 等待gRPC线程退出
 		pointer_server->StopTimer(); // 停止TCP服务器的定时器
+		Logger::Inst().Stop();
 		return 0;
 	}
 	catch (std::exception& e) {
-		std::cerr << "Exception: " << e.what() << endl;
+		LOG_ERROR("Exception: " << e.what());
 	}
+	Logger::Inst().Stop();
 
 }
 
@@ -1,4 +1,5 @@
 #include "ChatServiceImpl.h"
+#include "Logger.h"
 #include "UserMgr.h"
 #include "CSession.h"
 #include <json/json.h>
@@ -30,18 +31,16 @@ Status ChatServiceImpl::NotifyAddFriend(ServerContext* context, const AddFriendR
 	}
 	
 	//ڴֱӷ֪ͨԷ
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success;
-	rtvalue["applyuid"] = request->applyuid();
-	rtvalue["name"] = request->name();
-	rtvalue["desc"] = request->desc();
-	rtvalue["icon"] = request->icon();
-	rtvalue["sex"] = request->sex();
-	rtvalue["nick"] = request->nick();
-
-	std::string return_str = rtvalue.toStyledString();
-
-	session->Send(return_str, ID_NOTIFY_ADD_FRIEND_REQ);
+	client::NotifyAddFriend notify;
+	notify.error = ErrorCodes::Success;
+	notify.applyuid = request->applyuid();
+	notify.name = request->name();
+	notify.desc = request->desc();
+	notify.icon = request->icon();
+	notify.sex = request->sex();
+	notify.nick = request->nick();
+
+	session->SendMsg(notify, ID_NOTIFY_ADD_FRIEND_REQ);
 	return Status::OK;
 }
 
@@ -64,27 +63,25 @@ Status ChatServiceImpl::NotifyAuthFriend(ServerContext* context, const AuthFrien
 	}
 
 	//ڴֱӷ֪ͨԷ
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success;
-	rtvalue["fromuid"] = request->fromuid();
-	rtvalue["touid"] = request->touid();
+	client::NotifyAuthFriend notify;
+	notify.error = ErrorCodes::Success;
+	notify.fromuid = request->fromuid();
+	notify.touid = request->touid();
 
 	std::string base_key = USER_BASE_INFO + std::to_string(fromuid);
 	auto user_info = std::make_shared<UserInfo>();
 	bool b_info = GetBaseInfo(base_key, fromuid, user_info);
 	if (b_info) {
-		rtvalue["name"] = user_info->name;
-		rtvalue["nick"] = user_info->nick;
-		rtvalue["icon"] = user_info->icon;
-		rtvalue["sex"] = user_info->sex;
+		notify.name = user_info->name;
+		notify.nick = user_info->nick;
+		notify.icon = user_info->icon;
+		notify.sex = user_info->sex;
 	}
 	else {
-		rtvalue["error"] = ErrorCodes::UidInvalid;
+		notify.error = ErrorCodes::UidInvalid;
 	}
 
-	std::string return_str = rtvalue.toStyledString();
-
-	session->Send(return_str, ID_NOTIFY_AUTH_FRIEND_REQ);
+	session->SendMsg(notify, ID_NOTIFY_AUTH_FRIEND_REQ);
 	return Status::OK;
 }
 
@@ -101,24 +98,20 @@ Status ChatServiceImpl::NotifyTextChatMsg(::grpc::ServerContext* context,
 	}
 
 	//ڴֱӷ֪ͨԷ
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success;
-	rtvalue["fromuid"] = request->fromuid();
-	rtvalue["touid"] = request->touid();
+	client::NotifyTextChatMsg notify;
+	notify.error = ErrorCodes::Success;
+	notify.fromuid = request->fromuid();
+	notify.touid = request->touid();
 
 	//֯Ϊ
-	Json::Value text_array;
 	for (auto& msg : request->textmsgs()) {
-		Json::Value element;
-		element["content"] = msg.msgcontent();
-		element["msgid"] = msg.msgid();
-		text_array.append(element);
+		client::TextChatData element;
+		element.content = msg.msgcontent();
+		element.msgid = msg.msgid();
+		notify.text_array.push_back(std::move(element));
 	}
-	rtvalue["text_array"] = text_array;
-
-	std::string return_str = rtvalue.toStyledString();
 
-	session->Send(return_str, ID_NOTIFY_TEXT_CHAT_MSG_REQ);
+	session->SendMsg(notify, ID_NOTIFY_TEXT_CHAT_MSG_REQ);
 	return Status::OK;
 }
 
@@ -140,8 +133,8 @@ bool ChatServiceImpl::GetBaseInfo(std::string base_key, int uid, std::shared_ptr
 		userinfo->desc = root["desc"].asString();
 		userinfo->sex = root["sex"].asInt();
 		userinfo->icon = root["icon"].asString();
-		std::cout << "user login uid is  " << userinfo->uid << " name  is "
-			<< userinfo->name << " pwd is " << userinfo->pwd << " email is " << userinfo->email << endl;
+		LOG_DEBUG("user login uid is  " << userinfo->uid << " name  is "
+			<< userinfo->name << " pwd is " << userinfo->pwd << " email is " << userinfo->email);
 	}
 	else {
 		//redisûѯmysql
@@ -190,7 +183,7 @@ Status ChatServiceImpl::NotifyKickUser(::grpc::ServerContext* context,
 	//ڴֱӷ֪ͨԷ
 	session->NotifyOffline(uid);
 	//ɵ
-	_p_server->ClearSession(session->GetSessionId());
+	_p_server->ClearSession(session->GetConnId());
 
 	return Status::OK;
 }
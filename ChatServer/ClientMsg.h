@@ -0,0 +1,603 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <json/json.h>
+#include <json/value.h>
+#include <json/reader.h>
+#include "ProtoWire.h"
+#include "const.h"
+
+// 客户端消息类型，字段与client.proto一一对应
+// 每个消息通过Visit列出字段(protobuf字段号, json key, 成员)，json和protobuf两种编码共用这一份描述
+namespace client {
+
+struct TextChatData {
+	std::string msgid;
+	std::string content;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "msgid", msgid);
+		v.Field(2, "content", content);
+	}
+};
+
+struct ApplyInfo {
+	int32_t uid = 0;
+	std::string name;
+	std::string nick;
+	std::string icon;
+	int32_t sex = 0;
+	std::string desc;
+	int32_t status = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "uid", uid);
+		v.Field(2, "name", name);
+		v.Field(3, "nick", nick);
+		v.Field(4, "icon", icon);
+		v.Field(5, "sex", sex);
+		v.Field(6, "desc", desc);
+		v.Field(7, "status", status);
+	}
+};
+
+struct FriendInfo {
+	int32_t uid = 0;
+	std::string name;
+	std::string nick;
+	std::string icon;
+	int32_t sex = 0;
+	std::string desc;
+	std::string back;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "uid", uid);
+		v.Field(2, "name", name);
+		v.Field(3, "nick", nick);
+		v.Field(4, "icon", icon);
+		v.Field(5, "sex", sex);
+		v.Field(6, "desc", desc);
+		v.Field(7, "back", back);
+	}
+};
+
+// MSG_CHAT_LOGIN
+struct ChatLoginReq {
+	int32_t uid = 0;
+	std::string token;
+	bool ext_head = false;
+	std::string compress;
+	// 客户端希望之后改用的编码("proto")，登录请求本身按json发送，旧版本服务器忽略该字段
+	std::string codec;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "uid", uid);
+		v.Field(2, "token", token);
+		v.Field(3, "ext_head", ext_head);
+		v.Field(4, "compress", compress);
+		v.Field(5, "codec", codec);
+	}
+};
+
+// MSG_CHAT_LOGIN_RSP
+struct ChatLoginRsp {
+	int32_t error = 0;
+	int32_t uid = 0;
+	std::string pwd;
+	std::string name;
+	std::string email;
+	std::string nick;
+	std::string desc;
+	int32_t sex = 0;
+	std::string icon;
+	std::vector<ApplyInfo> apply_list;
+	std::vector<FriendInfo> friend_list;
+	std::string compress;
+	// 服务器过载拒绝登录(error为ServerBusy)时，建议客户端重试的间隔(秒)
+	int32_t retry_after = 0;
+	// 服务器接受的扩展头部，客户端收到后才发送超过MAX_LENGTH的消息
+	bool ext_head = false;
+	// 会话之后使用的编码，客户端收到"proto"后才按protobuf发送
+	std::string codec;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "uid", uid);
+		v.Field(3, "pwd", pwd);
+		v.Field(4, "name", name);
+		v.Field(5, "email", email);
+		v.Field(6, "nick", nick);
+		v.Field(7, "desc", desc);
+		v.Field(8, "sex", sex);
+		v.Field(9, "icon", icon);
+		v.Field(10, "apply_list", apply_list);
+		v.Field(11, "friend_list", friend_list);
+		v.Field(12, "compress", compress);
+		v.Field(13, "retry_after", retry_after);
+		v.Field(14, "ext_head", ext_head);
+		v.Field(15, "codec", codec);
+	}
+};
+
+// ID_SEARCH_USER_REQ，uid可以是用户id也可以是用户名
+struct SearchUserReq {
+	std::string uid;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "uid", uid);
+	}
+};
+
+// ID_SEARCH_USER_RSP
+struct SearchUserRsp {
+	int32_t error = 0;
+	int32_t uid = 0;
+	std::string pwd;
+	std::string name;
+	std::string email;
+	std::string nick;
+	std::string desc;
+	int32_t sex = 0;
+	std::string icon;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "uid", uid);
+		v.Field(3, "pwd", pwd);
+		v.Field(4, "name", name);
+		v.Field(5, "email", email);
+		v.Field(6, "nick", nick);
+		v.Field(7, "desc", desc);
+		v.Field(8, "sex", sex);
+		v.Field(9, "icon", icon);
+	}
+};
+
+// ID_ADD_FRIEND_REQ
+struct AddFriendApplyReq {
+	int32_t uid = 0;
+	std::string applyname;
+	std::string bakname;
+	int32_t touid = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "uid", uid);
+		v.Field(2, "applyname", applyname);
+		v.Field(3, "bakname", bakname);
+		v.Field(4, "touid", touid);
+	}
+};
+
+// ID_ADD_FRIEND_RSP
+struct AddFriendApplyRsp {
+	int32_t error = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+	}
+};
+
+// ID_NOTIFY_ADD_FRIEND_REQ
+struct NotifyAddFriend {
+	int32_t error = 0;
+	int32_t applyuid = 0;
+	std::string name;
+	std::string desc;
+	std::string icon;
+	int32_t sex = 0;
+	std::string nick;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "applyuid", applyuid);
+		v.Field(3, "name", name);
+		v.Field(4, "desc", desc);
+		v.Field(5, "icon", icon);
+		v.Field(6, "sex", sex);
+		v.Field(7, "nick", nick);
+	}
+};
+
+// ID_AUTH_FRIEND_REQ
+struct AuthFriendApplyReq {
+	int32_t fromuid = 0;
+	int32_t touid = 0;
+	std::string back;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "fromuid", fromuid);
+		v.Field(2, "touid", touid);
+		v.Field(3, "back", back);
+	}
+};
+
+// ID_AUTH_FRIEND_RSP
+struct AuthFriendApplyRsp {
+	int32_t error = 0;
+	int32_t uid = 0;
+	std::string name;
+	std::string nick;
+	std::string icon;
+	int32_t sex = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "uid", uid);
+		v.Field(3, "name", name);
+		v.Field(4, "nick", nick);
+		v.Field(5, "icon", icon);
+		v.Field(6, "sex", sex);
+	}
+};
+
+// ID_NOTIFY_AUTH_FRIEND_REQ
+struct NotifyAuthFriend {
+	int32_t error = 0;
+	int32_t fromuid = 0;
+	int32_t touid = 0;
+	std::string name;
+	std::string nick;
+	std::string icon;
+	int32_t sex = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "fromuid", fromuid);
+		v.Field(3, "touid", touid);
+		v.Field(4, "name", name);
+		v.Field(5, "nick", nick);
+		v.Field(6, "icon", icon);
+		v.Field(7, "sex", sex);
+	}
+};
+
+// ID_TEXT_CHAT_MSG_REQ
+struct TextChatMsgReq {
+	int32_t fromuid = 0;
+	int32_t touid = 0;
+	std::vector<TextChatData> text_array;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "fromuid", fromuid);
+		v.Field(2, "touid", touid);
+		v.Field(3, "text_array", text_array);
+	}
+};
+
+// ID_TEXT_CHAT_MSG_RSP，同时用于ID_NOTIFY_TEXT_CHAT_MSG_REQ
+struct TextChatMsgRsp {
+	int32_t error = 0;
+	int32_t fromuid = 0;
+	int32_t touid = 0;
+	std::vector<TextChatData> text_array;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "fromuid", fromuid);
+		v.Field(3, "touid", touid);
+		v.Field(4, "text_array", text_array);
+	}
+};
+typedef TextChatMsgRsp NotifyTextChatMsg;
+
+// ID_NOTIFY_OFF_LINE_REQ
+struct NotifyOffline {
+	int32_t error = 0;
+	int32_t uid = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "uid", uid);
+	}
+};
+
+// ID_HEART_BEAT_REQ
+struct HeartBeatReq {
+	int32_t fromuid = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "fromuid", fromuid);
+	}
+};
+
+// ID_HEARTBEAT_RSP
+struct HeartBeatRsp {
+	int32_t error = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+	}
+};
+
+// 请求未被处理时的回包，使用请求对应的回包id，只带error字段
+struct ErrorRsp {
+	int32_t error = 0;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+	}
+};
+
+// ID_NOTIFY_SYSTEM_MSG_REQ
+struct NotifySystemMsg {
+	int32_t error = 0;
+	int32_t type = 0;
+	std::string content;
+	template <typename V> void Visit(V& v) {
+		v.Field(1, "error", error);
+		v.Field(2, "type", type);
+		v.Field(3, "content", content);
+	}
+};
+
+}
+
+// 以下为两种编码的实现，逻辑层只需要使用EncodeClientMsg/DecodeClientMsg
+namespace client_codec {
+
+template <typename Msg> void EncodeProto(const Msg& msg, std::string& out);
+template <typename Msg> bool DecodeProto(const char* data, std::size_t len, Msg& msg);
+template <typename Msg> void ToJson(const Msg& msg, Json::Value& root);
+template <typename Msg> void FromJson(const Json::Value& root, Msg& msg);
+
+// protobuf编码，与proto3一致，默认值的字段不写出
+class ProtoEncoder {
+public:
+	explicit ProtoEncoder(std::string& out) :_out(out) {}
+
+	void Field(int tag, const char*, int32_t& value) {
+		if (value != 0) {
+			proto_wire::PutKey(_out, tag, proto_wire::WIRE_VARINT);
+			//负数按64位符号扩展，与int32的编码规则一致
+			proto_wire::PutVarint(_out, static_cast<uint64_t>(static_cast<int64_t>(value)));
+		}
+	}
+
+	void Field(int tag, const char*, bool& value) {
+		if (value) {
+			proto_wire::PutKey(_out, tag, proto_wire::WIRE_VARINT);
+			proto_wire::PutVarint(_out, 1);
+		}
+	}
+
+	void Field(int tag, const char*, std::string& value) {
+		if (!value.empty()) {
+			proto_wire::PutKey(_out, tag, proto_wire::WIRE_LEN);
+			proto_wire::PutVarint(_out, value.size());
+			_out.append(value);
+		}
+	}
+
+	template <typename T>
+	void Field(int tag, const char*, std::vector<T>& values) {
+		std::string nested;
+		for (auto& value : values) {
+			nested.clear();
+			EncodeProto(value, nested);
+			proto_wire::PutKey(_out, tag, proto_wire::WIRE_LEN);
+			proto_wire::PutVarint(_out, nested.size());
+			_out.append(nested);
+		}
+	}
+
+private:
+	std::string& _out;
+};
+
+// 解码一个已经读出的字段，字段号不匹配的成员跳过，未知字段整体忽略
+class ProtoDecoder {
+public:
+	ProtoDecoder(int tag, int type, uint64_t varint, const char* data, std::size_t len)
+		:_tag(tag), _type(type), _varint(varint), _data(data), _len(len), _ok(true) {}
+
+	void Field(int tag, const char*, int32_t& value) {
+		if (Match(tag, proto_wire::WIRE_VARINT)) {
+			value = static_cast<int32_t>(_varint);
+		}
+	}
+
+	void Field(int tag, const char*, bool& value) {
+		if (Match(tag, proto_wire::WIRE_VARINT)) {
+			value = _varint != 0;
+		}
+	}
+
+	void Field(int tag, const char*, std::string& value) {
+		if (Match(tag, proto_wire::WIRE_LEN)) {
+			value.assign(_data, _len);
+		}
+	}
+
+	template <typename T>
+	void Field(int tag, const char*, std::vector<T>& values) {
+		if (Match(tag, proto_wire::WIRE_LEN)) {
+			values.emplace_back();
+			_ok = DecodeProto(_data, _len, values.back());
+		}
+	}
+
+	bool Ok() const {
+		return _ok;
+	}
+
+private:
+	bool Match(int tag, int type) {
+		if (tag != _tag) {
+			return false;
+		}
+		//字段号相同但类型不符说明数据损坏
+		if (type != _type) {
+			_ok = false;
+			return false;
+		}
+		return true;
+	}
+
+	int _tag;
+	int _type;
+	uint64_t _varint;
+	const char* _data;
+	std::size_t _len;
+	bool _ok;
+};
+
+// json编码，字段全部写出，与原来手工拼装的json保持一致
+class JsonEncoder {
+public:
+	explicit JsonEncoder(Json::Value& root) :_root(root) {}
+
+	void Field(int, const char* name, int32_t& value) {
+		_root[name] = value;
+	}
+
+	void Field(int, const char* name, bool& value) {
+		_root[name] = value;
+	}
+
+	void Field(int, const char* name, std::string& value) {
+		_root[name] = value;
+	}
+
+	template <typename T>
+	void Field(int, const char* name, std::vector<T>& values) {
+		Json::Value array(Json::arrayValue);
+		for (auto& value : values) {
+			Json::Value obj;
+			ToJson(value, obj);
+			array.append(obj);
+		}
+		_root[name] = array;
+	}
+
+private:
+	Json::Value& _root;
+};
+
+// json解码，缺少的字段保持默认值，类型不符的字段忽略，不会抛出异常
+class JsonDecoder {
+public:
+	explicit JsonDecoder(const Json::Value& root) :_root(root) {}
+
+	void Field(int, const char* name, int32_t& value) {
+		const Json::Value& item = _root[name];
+		if (item.isConvertibleTo(Json::intValue)) {
+			value = item.asInt();
+		}
+	}
+
+	void Field(int, const char* name, bool& value) {
+		const Json::Value& item = _root[name];
+		if (item.isConvertibleTo(Json::booleanValue)) {
+			value = item.asBool();
+		}
+	}
+
+	void Field(int, const char* name, std::string& value) {
+		const Json::Value& item = _root[name];
+		if (item.isConvertibleTo(Json::stringValue)) {
+			value = item.asString();
+		}
+	}
+
+	template <typename T>
+	void Field(int, const char* name, std::vector<T>& values) {
+		const Json::Value& array = _root[name];
+		if (!array.isArray()) {
+			return;
+		}
+		for (const auto& item : array) {
+			values.emplace_back();
+			FromJson(item, values.back());
+		}
+	}
+
+private:
+	const Json::Value& _root;
+};
+
+// 编码器不修改消息，Visit只有非const版本，这里去掉const
+template <typename Msg>
+void EncodeProto(const Msg& msg, std::string& out) {
+	ProtoEncoder encoder(out);
+	const_cast<Msg&>(msg).Visit(encoder);
+}
+
+template <typename Msg>
+bool DecodeProto(const char* data, std::size_t len, Msg& msg) {
+	proto_wire::Reader reader(data, len);
+	while (!reader.Done()) {
+		int tag = 0;
+		int type = 0;
+		uint64_t varint = 0;
+		const char* field_data = nullptr;
+		std::size_t field_len = 0;
+		if (!reader.Next(tag, type, varint, field_data, field_len)) {
+			return false;
+		}
+		ProtoDecoder decoder(tag, type, varint, field_data, field_len);
+		msg.Visit(decoder);
+		if (!decoder.Ok()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename Msg>
+void ToJson(const Msg& msg, Json::Value& root) {
+	JsonEncoder encoder(root);
+	const_cast<Msg&>(msg).Visit(encoder);
+}
+
+template <typename Msg>
+void FromJson(const Json::Value& root, Msg& msg) {
+	if (!root.isObject()) {
+		return;
+	}
+	JsonDecoder decoder(root);
+	msg.Visit(decoder);
+}
+
+}
+
+// 按会话的编码方式序列化消息
+template <typename Msg>
+std::string EncodeClientMsg(ClientCodec codec, const Msg& msg) {
+	std::string out;
+	if (codec == ClientCodec::Proto) {
+		client_codec::EncodeProto(msg, out);
+		return out;
+	}
+	Json::Value root;
+	client_codec::ToJson(msg, root);
+	return root.toStyledString();
+}
+
+// 按消息的编码方式解析消息，数据损坏时返回false
+// 直接解析接收缓冲区中的消息体，不需要先拷贝成std::string
+template <typename Msg>
+bool DecodeClientMsg(ClientCodec codec, const char* data, std::size_t len, Msg& msg) {
+	if (codec == ClientCodec::Proto) {
+		return client_codec::DecodeProto(data, len, msg);
+	}
+	Json::Reader reader;
+	Json::Value root;
+	if (!reader.parse(data, data + len, root)) {
+		return false;
+	}
+	client_codec::FromJson(root, msg);
+	return true;
+}
+
+template <typename Msg>
+bool DecodeClientMsg(ClientCodec codec, const std::string& data, Msg& msg) {
+	return DecodeClientMsg(codec, data.data(), data.size(), msg);
+}
+
+// 客户端请求的描述: 请求id、请求类型、回包id、回包类型，编译期确定
+// 逻辑层按描述生成分发函数，解析请求、调用处理函数、发送回包
+// 编码方式(json/protobuf)由登录时协商，两种编码共用消息类型中Visit的字段描述
+template <short ReqId, typename Req, short RspId, typename Rsp>
+struct MsgDesc {
+	static const short REQ_ID = ReqId;
+	static const short RSP_ID = RspId;
+	typedef Req ReqType;
+	typedef Rsp RspType;
+};
+
+// 客户端请求消息id的范围，逻辑层按 msg_id - MSG_ID_BEGIN 建立分发表
+const short MSG_ID_BEGIN = MSG_CHAT_LOGIN;
+const short MSG_ID_END = ID_NOTIFY_SYSTEM_MSG_REQ + 1;
+
+namespace client {
+
+typedef MsgDesc<MSG_CHAT_LOGIN, ChatLoginReq, MSG_CHAT_LOGIN_RSP, ChatLoginRsp> ChatLoginDesc;
+typedef MsgDesc<ID_SEARCH_USER_REQ, SearchUserReq, ID_SEARCH_USER_RSP, SearchUserRsp> SearchUserDesc;
+typedef MsgDesc<ID_ADD_FRIEND_REQ, AddFriendApplyReq, ID_ADD_FRIEND_RSP, AddFriendApplyRsp> AddFriendApplyDesc;
+typedef MsgDesc<ID_AUTH_FRIEND_REQ, AuthFriendApplyReq, ID_AUTH_FRIEND_RSP, AuthFriendApplyRsp> AuthFriendApplyDesc;
+typedef MsgDesc<ID_TEXT_CHAT_MSG_REQ, TextChatMsgReq, ID_TEXT_CHAT_MSG_RSP, TextChatMsgRsp> TextChatDesc;
+typedef MsgDesc<ID_HEART_BEAT_REQ, HeartBeatReq, ID_HEARTBEAT_RSP, HeartBeatRsp> HeartBeatDesc;
+
+}
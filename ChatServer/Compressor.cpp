@@ -0,0 +1,47 @@
+#include "Compressor.h"
+#include <zlib.h>
+#include <cstdint>
+
+bool Compressor::Deflate(const char* data, std::size_t len, int level, std::string& out) {
+	if (len > UINT32_MAX) {
+		return false;
+	}
+
+	uLongf dest_len = compressBound(static_cast<uLong>(len));
+	out.resize(4 + dest_len);
+	//前4字节为大端的原始长度
+	out[0] = static_cast<char>((len >> 24) & 0xff);
+	out[1] = static_cast<char>((len >> 16) & 0xff);
+	out[2] = static_cast<char>((len >> 8) & 0xff);
+	out[3] = static_cast<char>(len & 0xff);
+	int ret = compress2(reinterpret_cast<Bytef*>(&out[4]), &dest_len,
+		reinterpret_cast<const Bytef*>(data), static_cast<uLong>(len), level);
+	if (ret != Z_OK || 4 + dest_len >= len) {
+		return false;
+	}
+	out.resize(4 + dest_len);
+	return true;
+}
+
+bool Compressor::Inflate(const char* data, std::size_t len, std::size_t max_len, std::string& out) {
+	if (len <= 4) {
+		return false;
+	}
+
+	auto bytes = reinterpret_cast<const unsigned char*>(data);
+	std::size_t raw_len = (static_cast<std::size_t>(bytes[0]) << 24) | (static_cast<std::size_t>(bytes[1]) << 16)
+		| (static_cast<std::size_t>(bytes[2]) << 8) | static_cast<std::size_t>(bytes[3]);
+	//原始长度由对端填写，先校验再分配，防止构造的小包撑爆内存
+	if (raw_len == 0 || raw_len > max_len) {
+		return false;
+	}
+
+	out.resize(raw_len);
+	uLongf dest_len = static_cast<uLongf>(raw_len);
+	int ret = uncompress(reinterpret_cast<Bytef*>(&out[0]), &dest_len,
+		reinterpret_cast<const Bytef*>(data + 4), static_cast<uLong>(len - 4));
+	if (ret != Z_OK || dest_len != raw_len) {
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// 消息体压缩，格式与Qt的qCompress/qUncompress一致，客户端不需要额外的依赖
+// 压缩后的数据: 4字节大端的原始长度 + zlib流
+class Compressor
+{
+public:
+	// 压缩失败或者压缩后没有变小时返回false，调用方按原文发送
+	static bool Deflate(const char* data, std::size_t len, int level, std::string& out);
+	// 原始长度超过max_len或者数据损坏时返回false
+	static bool Inflate(const char* data, std::size_t len, std::size_t max_len, std::string& out);
+};
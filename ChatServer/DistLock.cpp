@@ -23,24 +23,19 @@ static std::string generateUUID() {
 	return to_string(uuid);
 }
 
+std::string DistLock::newIdentifier() {
+    return generateUUID();
+}
+
 // ԻȡΨһʶUUIDȡʧ򷵻ؿַ
 std::string DistLock::acquireLock(redisContext* context, const std::string& lockName,
     int lockTimeout, int acquireTimeout) {
     std::string identifier = generateUUID();
-    std::string lockKey = "lock:" + lockName;
     auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(acquireTimeout);
 
     while (std::chrono::steady_clock::now() < endTime) {
-        // ʹ SET ԼSET lockKey identifier NX EX lockTimeout
-        redisReply* reply = (redisReply*)redisCommand(context, "SET %s %s NX EX %d",
-            lockKey.c_str(), identifier.c_str(), lockTimeout);
-        if (reply != nullptr) {
-            // жϷؽǷΪ OK
-            if (reply->type == REDIS_REPLY_STATUS && std::string(reply->str) == "OK") {
-                freeReplyObject(reply);
-                return identifier;
-            }
-            freeReplyObject(reply);
+        if (tryLock(context, lockName, identifier, lockTimeout)) {
+            return identifier;
         }
         // ͣ 1 ԣֹæȴ
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -48,6 +43,21 @@ std::string DistLock::acquireLock(redisContext* context, const std::string& lock
     return "";
 }
 
+bool DistLock::tryLock(redisContext* context, const std::string& lockName,
+    const std::string& identifier, int lockTimeout) {
+    std::string lockKey = "lock:" + lockName;
+    // ʹ SET ԼSET lockKey identifier NX EX lockTimeout
+    redisReply* reply = (redisReply*)redisCommand(context, "SET %s %s NX EX %d",
+        lockKey.c_str(), identifier.c_str(), lockTimeout);
+    if (reply == nullptr) {
+        return false;
+    }
+    // жϷؽǷΪ OK
+    bool success = reply->type == REDIS_REPLY_STATUS && std::string(reply->str) == "OK";
+    freeReplyObject(reply);
+    return success;
+}
+
 // ͷֻĳ߲ͷţǷɹ
 bool DistLock::releaseLock(redisContext* context, const std::string& lockName,
     const std::string& identifier) {
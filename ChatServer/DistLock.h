@@ -9,6 +9,13 @@ public:
 	std::string acquireLock(redisContext* context, const std::string& lockName,
 		int lockTimeout, int acquireTimeout);
 
+	// 只尝试加锁一次，成功返回true，重试和等待由调用方决定
+	bool tryLock(redisContext* context, const std::string& lockName,
+		const std::string& identifier, int lockTimeout);
+
+	// 生成锁的唯一标识符
+	static std::string newIdentifier();
+
 	bool releaseLock(redisContext* context, const std::string& lockName,
 		const std::string& identifier);
 private:
@@ -0,0 +1,140 @@
+#include "LogicLanes.h"
+#include "ConfigMgr.h"
+#include "Logger.h"
+#include <sstream>
+#include <string>
+
+namespace {
+
+int GetInt(SectionInfo& section, const std::string& key, int def) {
+	auto value = section[key];
+	return value.empty() ? def : std::stoi(value);
+}
+
+}
+
+LaneConfig::LaneConfig() :_max_inflight(64), _low_inflight(32) {
+	auto section = ConfigMgr::Inst()["LogicLanes"];
+	_lanes.fill(MsgLane::Normal);
+	//默认心跳为High，登录、搜索、好友申请和认证为Low，聊天为Normal
+	std::string high = section["High"].empty() ? "1023" : section["High"];
+	std::string low = section["Low"].empty() ? "1005,1007,1009,1013" : section["Low"];
+	auto assign = [this](const std::string& ids, MsgLane lane) {
+		std::stringstream ss(ids);
+		std::string item;
+		while (std::getline(ss, item, ',')) {
+			if (item.empty()) {
+				continue;
+			}
+			int msg_id = std::stoi(item);
+			if (msg_id < MSG_ID_BEGIN || msg_id >= MSG_ID_END) {
+				LOG_WARN("LogicLanes msg id " << msg_id << " out of range, ignored");
+				continue;
+			}
+			_lanes[msg_id - MSG_ID_BEGIN] = lane;
+		}
+	};
+	assign(high, MsgLane::High);
+	assign(low, MsgLane::Low);
+
+	//权重至少为1，否则该优先级永远取不出消息
+	_weights[static_cast<int>(MsgLane::High)] = (std::max)(1, GetInt(section, "WeightHigh", 8));
+	_weights[static_cast<int>(MsgLane::Normal)] = (std::max)(1, GetInt(section, "WeightNormal", 4));
+	_weights[static_cast<int>(MsgLane::Low)] = (std::max)(1, GetInt(section, "WeightLow", 1));
+	_max_inflight = (std::max)(1, GetInt(section, "MaxInflight", _max_inflight));
+	_low_inflight = (std::min)(_max_inflight, (std::max)(1, GetInt(section, "LowInflight", _max_inflight / 2)));
+}
+
+const LaneConfig& LaneConfig::Inst() {
+	static LaneConfig cfg;
+	return cfg;
+}
+
+MsgLane LaneConfig::LaneOf(short msg_id) const {
+	if (msg_id < MSG_ID_BEGIN || msg_id >= MSG_ID_END) {
+		return MsgLane::Normal;
+	}
+	return _lanes[msg_id - MSG_ID_BEGIN];
+}
+
+const char* LaneConfig::LaneName(MsgLane lane) {
+	switch (lane) {
+	case MsgLane::High:
+		return "high";
+	case MsgLane::Normal:
+		return "normal";
+	case MsgLane::Low:
+		return "low";
+	default:
+		return "unknown";
+	}
+}
+
+LogicLanes::LogicLanes() :_config(LaneConfig::Inst()), _total_inflight(0), _cur(0) {
+	auto& metrics = Metrics::Inst();
+	for (int i = 0; i < LANE_COUNT; ++i) {
+		_deficit[i] = 0;
+		_inflight[i] = 0;
+		std::string prefix = std::string("chat_logic_lane_") + LaneConfig::LaneName(static_cast<MsgLane>(i));
+		_depth[i] = &metrics.GetGauge(prefix + "_sessions", "Sessions waiting in this logic lane.");
+		_served[i] = &metrics.GetGauge(prefix + "_served_total", "Messages taken from this logic lane.");
+		_skipped[i] = &metrics.GetGauge(prefix + "_skipped_total",
+			"Times this lane had runnable sessions but a lower priority lane was served instead.");
+	}
+}
+
+void LogicLanes::Push(MsgLane lane, std::shared_ptr<CSession> session) {
+	int index = static_cast<int>(lane);
+	_ques[index].push_back(std::move(session));
+	_depth[index]->Add(1);
+}
+
+bool LogicLanes::Eligible(int lane) const {
+	if (_ques[lane].empty()) {
+		return false;
+	}
+	return lane != static_cast<int>(MsgLane::Low) || _inflight[lane] < _config._low_inflight;
+}
+
+bool LogicLanes::Pop(MsgLane& lane, std::shared_ptr<CSession>& session) {
+	bool any = false;
+	for (int i = 0; i < LANE_COUNT; ++i) {
+		any = any || Eligible(i);
+	}
+	if (!any || _total_inflight >= _config._max_inflight) {
+		return false;
+	}
+
+	//跳过的优先级清空额度，轮到时重新按权重补充
+	while (!Eligible(_cur)) {
+		_deficit[_cur] = 0;
+		_cur = (_cur + 1) % LANE_COUNT;
+	}
+	if (_deficit[_cur] <= 0) {
+		_deficit[_cur] = _config._weights[_cur];
+	}
+
+	session = std::move(_ques[_cur].front());
+	_ques[_cur].pop_front();
+	lane = static_cast<MsgLane>(_cur);
+	--_deficit[_cur];
+	++_inflight[_cur];
+	++_total_inflight;
+	_depth[_cur]->Add(-1);
+	_served[_cur]->Add(1);
+	//更高优先级有可以处理的会话，却因为额度用完轮到了低优先级
+	for (int i = 0; i < _cur; ++i) {
+		if (Eligible(i)) {
+			_skipped[i]->Add(1);
+		}
+	}
+	if (_deficit[_cur] <= 0) {
+		_cur = (_cur + 1) % LANE_COUNT;
+	}
+	return true;
+}
+
+void LogicLanes::Done(MsgLane lane) {
+	--_inflight[static_cast<int>(lane)];
+	--_total_inflight;
+}
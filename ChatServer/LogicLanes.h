@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <deque>
+#include <memory>
+#include "const.h"
+#include "ClientMsg.h"
+#include "Metrics.h"
+
+class CSession;
+
+// 逻辑层的优先级: 心跳最高，聊天次之，登录、搜索、好友申请这类要访问mysql的请求最低
+enum class MsgLane : int {
+	High = 0,
+	Normal = 1,
+	Low = 2,
+	Count = 3,
+};
+
+const int LANE_COUNT = static_cast<int>(MsgLane::Count);
+
+// 优先级配置，首次使用时从config.ini的[LogicLanes]段读取
+struct LaneConfig {
+	static const LaneConfig& Inst();
+	MsgLane LaneOf(short msg_id) const;
+	static const char* LaneName(MsgLane lane);
+	// 消息id到优先级的映射，下标为 msg_id - MSG_ID_BEGIN，High和Low中没有列出的消息为Normal
+	std::array<MsgLane, MSG_ID_END - MSG_ID_BEGIN> _lanes;
+	// 各优先级每轮最多取出的消息数
+	int _weights[LANE_COUNT];
+	// 每个逻辑线程同时处理的消息上限(包括挂起等待redis、mysql、grpc的)
+	int _max_inflight;
+	// Low优先级最多占用的处理数，慢请求堆积时仍给心跳和聊天留出余量
+	int _low_inflight;
+private:
+	LaneConfig();
+};
+
+// 一个逻辑线程上按优先级排队的会话，只在该逻辑线程中访问，不加锁
+// 1. 会话在某个优先级上有待处理的消息时排入对应的队列，每次取出只处理一条，
+//    处理完还有消息时重新排到队尾，同一优先级的会话轮流处理
+// 2. 优先级之间按权重做差额轮询(deficit round robin，每条消息计1)，空队列不累积额度
+// 3. 有可以处理的会话，却因为额度用完而让低优先级先被取出时记一次跳过，用于调整权重
+//    处理数已满、Low达到占用上限时没有任何优先级被取出，不计跳过
+class LogicLanes {
+public:
+	LogicLanes();
+	void Push(MsgLane lane, std::shared_ptr<CSession> session);
+	// 取出下一个要处理的会话并占用一个处理数，没有可以处理的会话时返回false
+	bool Pop(MsgLane& lane, std::shared_ptr<CSession>& session);
+	// 一条消息处理完成，释放处理数
+	void Done(MsgLane lane);
+private:
+	bool Eligible(int lane) const;
+
+	const LaneConfig& _config;
+	std::deque<std::shared_ptr<CSession>> _ques[LANE_COUNT];
+	int _deficit[LANE_COUNT];
+	int _inflight[LANE_COUNT];
+	int _total_inflight;
+	int _cur;
+	// 全部逻辑线程共享的指标: 排队的会话数、取出的消息数、被低优先级插队的次数
+	MetricGauge* _depth[LANE_COUNT];
+	MetricGauge* _served[LANE_COUNT];
+	MetricGauge* _skipped[LANE_COUNT];
+};
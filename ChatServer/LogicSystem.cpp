@@ -1,4 +1,5 @@
 #include "LogicSystem.h"
+#include "Logger.h"
 #include "StatusGrpcClient.h"
 #include "MysqlMgr.h"
 #include "const.h"
@@ -8,177 +9,341 @@
 #include "DistLock.h"
 #include <string>
 #include "CServer.h"
+#include "ConfigMgr.h"
+#include "OverloadCtrl.h"
+#include "RateLimiter.h"
 
 using namespace std;
 
-LogicSystem::LogicSystem() :_b_stop(false), _p_server(nullptr) {
+static std::size_t WorkerCountFromConfig() {
+	auto workers = ConfigMgr::Inst()["LogicSystem"]["Workers"];
+	std::size_t size = workers.empty() ? 4 : std::stoul(workers);
+	if (size == 0) {
+		size = std::thread::hardware_concurrency();
+	}
+	// hardware_concurrency ܷ0
+	return size == 0 ? 4 : size;
+}
+
+LogicSystem::LogicSystem() :_que_size(0), _max_que(MAX_RECVQUE), _overflow(OverflowPolicy::Reject),
+	_overflow_count(Metrics::Inst().GetGauge("chat_logic_queue_overflow_total",
+	"Messages rejected or shed because the logic queue was full.")), _p_server(nullptr) {
+	auto max_que = ConfigMgr::Inst()["LogicSystem"]["MaxQueue"];
+	if (!max_que.empty()) {
+		_max_que = (std::max)(static_cast<int64_t>(1), static_cast<int64_t>(std::stoll(max_que)));
+	}
+	if (ConfigMgr::Inst()["LogicSystem"]["Overflow"] == "shed") {
+		_overflow = OverflowPolicy::Shed;
+	}
+	Metrics::Inst().AddGauge("chat_logic_queue_depth", "Messages waiting in the logic queue.", [this]() {
+		return static_cast<double>(_que_size.load(std::memory_order_relaxed));
+	});
+
+	//עô߼̣֮߳_dispatchersֻ
+	_dispatchers.fill(nullptr);
+	_rsp_ids.fill(0);
 	RegisterCallBacks();
-	_worker_thread = std::thread(&LogicSystem::DealMsg, this);
+	std::size_t size = WorkerCountFromConfig();
+	for (std::size_t i = 0; i < size; ++i) {
+		//һ߼̶߳յȫϢÿ_inbox޷
+		_workers.push_back(std::unique_ptr<LogicWorker>(new LogicWorker(static_cast<std::size_t>(_max_que))));
+	}
+	for (auto& worker : _workers) {
+		auto* p_worker = worker.get();
+		p_worker->_thread = std::thread([p_worker]() {
+			p_worker->_io_context.run();
+		});
+	}
+	LOG_INFO("LogicSystem start " << size << " workers");
 }
 
 LogicSystem::~LogicSystem() {
-	_b_stop = true;
-	_consume.notify_one();
-	_worker_thread.join();
+	//ֹio_context˳ͶݵϢ͹еЭȫִ߳˳
+	for (auto& worker : _workers) {
+		worker->_work.reset();
+	}
+	for (auto& worker : _workers) {
+		worker->_thread.join();
+	}
 }
 
 void LogicSystem::PostMsgToQue(shared_ptr < LogicNode> msg) {
-	std::unique_lock<std::mutex> unique_lk(_mutex);
-	_msg_que.push(msg);
-	//0Ϊ1֪ͨź
-	if (_msg_que.size() == 1) {
-		unique_lk.unlock();
-		_consume.notify_one();
+	//ʱµĵ¼Ŷӣֱӻظԣѵ¼ûϢճ
+	if (msg->_recvnode->_msg_id == MSG_CHAT_LOGIN && OverloadCtrl::Inst().Overloaded()) {
+		RejectLogin(msg);
+		return;
+	}
+	//ռλʱ˻
+	if (_que_size.fetch_add(1, std::memory_order_relaxed) >= _max_que) {
+		_que_size.fetch_sub(1, std::memory_order_relaxed);
+		Overflow(msg);
+		return;
+	}
+
+	//¼ǰûuidid䣬¼uid
+	auto& session = msg->_session;
+	int uid = session->GetUserId();
+	uint64_t key = uid != 0 ? static_cast<uint64_t>(uid) : session->GetConnId();
+	auto& worker = *_workers[key % _workers.size()];
+	//_inboxСޣռλɹһ㲻
+	if (!worker._inbox.TryPush(msg)) {
+		_que_size.fetch_sub(1, std::memory_order_relaxed);
+		Overflow(msg);
+		return;
+	}
+	//_inboxӿձΪǿʱͶһΣ߼߳ȡ֮ǰϢͶ
+	if (!worker._b_drain_posted.exchange(true, std::memory_order_acq_rel)) {
+		boost::asio::post(worker._io_context, [this, &worker]() {
+			Drain(worker);
+		});
 	}
 }
 
+void LogicSystem::Drain(LogicWorker& worker) {
+	//־ȡ֮ϢͶݣ©
+	worker._b_drain_posted.exchange(false, std::memory_order_acq_rel);
+	//һȡDRAIN_BATCHϢʱʱ䲻ŶӵĻỰ
+	const int DRAIN_BATCH = 256;
+	shared_ptr<LogicNode> msg;
+	int count = 0;
+	while (count < DRAIN_BATCH && worker._inbox.Pop(msg)) {
+		++count;
+		auto lane = LaneConfig::Inst().LaneOf(msg->_recvnode->_msg_id);
+		auto session = msg->_session;
+		//ỰڸȼѾŶӻڴ(߼߳)ʱֻŶӣǰһ˳
+		//ͬһỰͬһȼͬʱֻһ¼л߼߳Ҳ
+		if (session->PushLogicMsg(lane, std::move(msg))) {
+			worker._lanes.Push(lane, std::move(session));
+		}
+	}
+	Schedule(worker);
+	if (count == DRAIN_BATCH && !worker._b_drain_posted.exchange(true, std::memory_order_acq_rel)) {
+		boost::asio::post(worker._io_context, [this, &worker]() {
+			Drain(worker);
+		});
+	}
+}
 
-void LogicSystem::SetServer(std::shared_ptr<CServer> pserver) {
-	_p_server = pserver;
+void LogicSystem::RejectLogin(const shared_ptr<LogicNode>& msg) {
+	auto& ctrl = OverloadCtrl::Inst();
+	ctrl.CountRejectLogin();
+	LOG_WARN("server overloaded, reject login, session id is " << msg->_session->GetSessionId());
+	//ذ͵¼һ
+	msg->_session->SetCodec(msg->_recvnode->_codec);
+	client::ChatLoginRsp rsp;
+	rsp.error = ErrorCodes::ServerBusy;
+	rsp.retry_after = ctrl.RetryAfter();
+	msg->_session->SendMsg(rsp, MSG_CHAT_LOGIN_RSP);
 }
 
+void LogicSystem::Overflow(const shared_ptr<LogicNode>& msg) {
+	_overflow_count.Add(1);
+	auto msg_id = msg->_recvnode->_msg_id;
+	LOG_WARN("logic queue full, " << (_overflow == OverflowPolicy::Reject ? "reject" : "shed")
+		<< " msg id " << msg_id << ", session id is " << msg->_session->GetSessionId());
+	if (_overflow == OverflowPolicy::Shed) {
+		return;
+	}
+	RejectMsg(msg->_session, msg_id, ErrorCodes::ServerBusy);
+}
 
-void LogicSystem::DealMsg() {
-	for (;;) {
-		std::unique_lock<std::mutex> unique_lk(_mutex);
-		//ж϶Ϊȴͷ
-		while (_msg_que.empty() && !_b_stop) {
-			_consume.wait(unique_lk);
-		}
+void LogicSystem::RejectMsg(const shared_ptr<CSession>& session, short msg_id, int error) {
+	if (msg_id < MSG_ID_BEGIN || msg_id >= MSG_ID_END) {
+		return;
+	}
+	short rsp_id = _rsp_ids[msg_id - MSG_ID_BEGIN];
+	if (rsp_id == 0) {
+		return;
+	}
+	//ذerrorֶαһ£ͻ˰ԭذõ
+	client::ErrorRsp rsp;
+	rsp.error = error;
+	session->SendMsg(rsp, rsp_id);
+}
 
-		//жǷΪر״̬߼ִ˳ѭ
-		if (_b_stop) {
-			while (!_msg_que.empty()) {
-				auto msg_node = _msg_que.front();
-				cout << "recv_msg id  is " << msg_node->_recvnode->_msg_id << endl;
-				auto call_back_iter = _fun_callbacks.find(msg_node->_recvnode->_msg_id);
-				if (call_back_iter == _fun_callbacks.end()) {
-					_msg_que.pop();
-					continue;
-				}
-				call_back_iter->second(msg_node->_session, msg_node->_recvnode->_msg_id,
-					std::string(msg_node->_recvnode->_data, msg_node->_recvnode->_cur_len));
-				_msg_que.pop();
-			}
-			break;
+void LogicSystem::PostTask(int uid, std::function<void(boost::asio::yield_context)> task) {
+	auto& worker = *_workers[static_cast<uint64_t>(uid) % _workers.size()];
+	auto runner = [task](boost::asio::yield_context yield) {
+		try {
+			task(yield);
 		}
-
-		//ûͣ˵
-		auto msg_node = _msg_que.front();
-		cout << "recv_msg id  is " << msg_node->_recvnode->_msg_id << endl;
-		auto call_back_iter = _fun_callbacks.find(msg_node->_recvnode->_msg_id);
-		if (call_back_iter == _fun_callbacks.end()) {
-			_msg_que.pop();
-			std::cout << "msg id [" << msg_node->_recvnode->_msg_id << "] handler not found" << std::endl;
-			continue;
+		catch (std::exception& e) {
+			LOG_ERROR("logic task exception: " << e.what());
 		}
-		call_back_iter->second(msg_node->_session, msg_node->_recvnode->_msg_id,
-			std::string(msg_node->_recvnode->_data, msg_node->_recvnode->_cur_len));
-		_msg_que.pop();
-	}
+	};
+	//Ͷݵ߼̣߳߼߳Э
+	boost::asio::post(worker._io_context, [&worker, runner]() {
+#if BOOST_VERSION >= 108000
+		boost::asio::spawn(worker._io_context, runner, boost::asio::detached);
+#else
+		boost::asio::spawn(worker._io_context, runner);
+#endif
+	});
 }
 
-void LogicSystem::RegisterCallBacks() {
-	_fun_callbacks[MSG_CHAT_LOGIN] = std::bind(&LogicSystem::LoginHandler, this,
-		placeholders::_1, placeholders::_2, placeholders::_3);
-
-	_fun_callbacks[ID_SEARCH_USER_REQ] = std::bind(&LogicSystem::SearchInfo, this,
-		placeholders::_1, placeholders::_2, placeholders::_3);
+void LogicSystem::SetServer(std::shared_ptr<CServer> pserver) {
+	_p_server = pserver;
+}
 
-	_fun_callbacks[ID_ADD_FRIEND_REQ] = std::bind(&LogicSystem::AddFriendApply, this,
-		placeholders::_1, placeholders::_2, placeholders::_3);
 
-	_fun_callbacks[ID_AUTH_FRIEND_REQ] = std::bind(&LogicSystem::AuthFriendApply, this,
-		placeholders::_1, placeholders::_2, placeholders::_3);
+void LogicSystem::Schedule(LogicWorker& worker) {
+	MsgLane lane;
+	shared_ptr<CSession> session;
+	while (worker._lanes.Pop(lane, session)) {
+		SpawnHandler(worker, lane, std::move(session));
+	}
+}
 
-	_fun_callbacks[ID_TEXT_CHAT_MSG_REQ] = std::bind(&LogicSystem::DealChatTextMsg, this,
-		placeholders::_1, placeholders::_2, placeholders::_3);
+void LogicSystem::SpawnHandler(LogicWorker& worker, MsgLane lane, shared_ptr<CSession> session) {
+	auto runner = [this, &worker, lane, session](boost::asio::yield_context yield) {
+		auto msg_node = session->PopLogicMsg(lane);
+		if (msg_node) {
+			_que_size.fetch_sub(1, std::memory_order_relaxed);
+			try {
+				HandleMsg(msg_node, yield);
+			}
+			catch (std::exception& e) {
+				LOG_ERROR("handle msg exception: " << e.what() << ", session id is " << session->GetSessionId());
+			}
+		}
+		//һóϢʱŵβͬȼỰ
+		worker._lanes.Done(lane);
+		if (session->FinishLogicMsg(lane)) {
+			worker._lanes.Push(lane, session);
+		}
+		Schedule(worker);
+	};
+#if BOOST_VERSION >= 108000
+	boost::asio::spawn(worker._io_context, std::move(runner), boost::asio::detached);
+#else
+	boost::asio::spawn(worker._io_context, std::move(runner));
+#endif
+}
 
-	_fun_callbacks[ID_HEART_BEAT_REQ] = std::bind(&LogicSystem::HeartBeatHandler, this,
-		placeholders::_1, placeholders::_2, placeholders::_3);
+void LogicSystem::HandleMsg(const shared_ptr<LogicNode>& msg_node, boost::asio::yield_context yield) {
+	auto msg_id = msg_node->_recvnode->_msg_id;
+	LOG_TRACE("recv_msg id  is " << msg_id);
+	MsgDispatcher dispatcher = nullptr;
+	if (msg_id >= MSG_ID_BEGIN && msg_id < MSG_ID_END) {
+		dispatcher = _dispatchers[msg_id - MSG_ID_BEGIN];
+	}
+	if (dispatcher == nullptr) {
+		LOG_ERROR("msg id [" << msg_id << "] handler not found");
+		return;
+	}
+	//ŶӺʱ֮ǰ¼redisʱ
+	auto start = Metrics::NowNs();
+	Metrics::Inst().RecordMsg(MsgPhase::QueueWait, msg_id, start - msg_node->_enqueue_ns);
+	OverloadCtrl::Inst().Record(OverloadSignal::QueueDelay, start - msg_node->_enqueue_ns);
+	//clusterΧҪredisЭм
+	if (RateLimitConfig::Inst().HasCluster(msg_id)
+		&& !RateLimiter::Inst().AsyncAllowCluster(msg_node->_session->GetUserId(), msg_id, yield)) {
+		RateLimiter::Inst().CountReject();
+		RejectMsg(msg_node->_session, msg_id, ErrorCodes::RateLimited);
+		return;
+	}
+	//msg_nodeڴڼһֱЧϢֱӴӽսڵ
+	dispatcher(this, msg_node->_session, msg_node->_recvnode->_codec,
+		msg_node->_recvnode->_data, msg_node->_recvnode->_cur_len, yield);
+	Metrics::Inst().RecordMsg(MsgPhase::Handle, msg_id, Metrics::NowNs() - start);
 }
 
-void LogicSystem::LoginHandler(shared_ptr<CSession> session, const short& msg_id, const string& msg_data) {
-	Json::Reader reader;
-	Json::Value root;
-	reader.parse(msg_data, root);
-	auto uid = root["uid"].asInt();
-	auto token = root["token"].asString();
-	std::cout << "user login uid is  " << uid << " user token  is "
-		<< token << endl;
-
-	Json::Value  rtvalue;
-	Defer defer([this, &rtvalue, session]() {
-		std::string return_str = rtvalue.toStyledString();
-		session->Send(return_str, MSG_CHAT_LOGIN_RSP);
-		});
+void LogicSystem::RegisterCallBacks() {
+	Register<client::ChatLoginDesc, &LogicSystem::LoginHandler>();
+	Register<client::SearchUserDesc, &LogicSystem::SearchInfo>();
+	Register<client::AddFriendApplyDesc, &LogicSystem::AddFriendApply>();
+	Register<client::AuthFriendApplyDesc, &LogicSystem::AuthFriendApply>();
+	Register<client::TextChatDesc, &LogicSystem::DealChatTextMsg>();
+	Register<client::HeartBeatDesc, &LogicSystem::HeartBeatHandler>();
+}
 
+void LogicSystem::LoginHandler(shared_ptr<CSession> session, const client::ChatLoginReq& req, client::ChatLoginRsp& rsp,
+	boost::asio::yield_context yield) {
+	auto uid = req.uid;
+	auto& token = req.token;
+	LOG_INFO("user login uid is  " << uid << " user token  is "
+		<< token);
 
 	//redisȡûtokenǷȷ
 	std::string uid_str = std::to_string(uid);
 	std::string token_key = USERTOKENPREFIX + uid_str;
 	std::string token_value = "";
-	bool success = RedisMgr::GetInstance()->Get(token_key, token_value);
+	bool success = RedisMgr::GetInstance()->AsyncGet(token_key, token_value, yield);
 	if (!success) {
-		rtvalue["error"] = ErrorCodes::UidInvalid;
+		rsp.error = ErrorCodes::UidInvalid;
 		return;
 	}
 
 	if (token_value != token) {
-		rtvalue["error"] = ErrorCodes::TokenInvalid;
+		rsp.error = ErrorCodes::TokenInvalid;
 		return;
 	}
 
-	rtvalue["error"] = ErrorCodes::Success;
+	//tokenУͨſչͷMAX_LENGTHĻذ(б)ʹ32λȷ
+	//ذдϷܵĽͻյŷչͷ
+	session->SetExtHead(req.ext_head);
+	rsp.ext_head = req.ext_head;
+	//ͻѹҷʱ¼ذ(б)Ͱѹ
+	//ͬtokenУͨУʧܵӲѹյ
+	if (req.compress == "deflate" && SessionConfig::Inst()._compress) {
+		session->SetCompress(true);
+		rsp.compress = "deflate";
+	}
+	//json¼Ŀͻprotobuf¼ذprotobufͣذȷϺͻ˲л
+	//ʶֶεľɰ汾ȷϣͻ˼ʹjson
+	if (req.codec == "proto") {
+		session->SetCodec(ClientCodec::Proto);
+	}
+	rsp.codec = session->GetCodec() == ClientCodec::Proto ? "proto" : "json";
+	rsp.error = ErrorCodes::Success;
 
 
 	std::string base_key = USER_BASE_INFO + uid_str;
 	auto user_info = std::make_shared<UserInfo>();
-	bool b_base = GetBaseInfo(base_key, uid, user_info);
+	bool b_base = GetBaseInfo(base_key, uid, user_info, yield);
 	if (!b_base) {
-		rtvalue["error"] = ErrorCodes::UidInvalid;
+		rsp.error = ErrorCodes::UidInvalid;
 		return;
 	}
-	rtvalue["uid"] = uid;
-	rtvalue["pwd"] = user_info->pwd;
-	rtvalue["name"] = user_info->name;
-	rtvalue["email"] = user_info->email;
-	rtvalue["nick"] = user_info->nick;
-	rtvalue["desc"] = user_info->desc;
-	rtvalue["sex"] = user_info->sex;
-	rtvalue["icon"] = user_info->icon;
+	rsp.uid = uid;
+	rsp.pwd = user_info->pwd;
+	rsp.name = user_info->name;
+	rsp.email = user_info->email;
+	rsp.nick = user_info->nick;
+	rsp.desc = user_info->desc;
+	rsp.sex = user_info->sex;
+	rsp.icon = user_info->icon;
 
 	//ݿȡб
 	std::vector<std::shared_ptr<ApplyInfo>> apply_list;
-	auto b_apply = GetFriendApplyInfo(uid, apply_list);
+	auto b_apply = GetFriendApplyInfo(uid, apply_list, yield);
 	if (b_apply) {
 		for (auto& apply : apply_list) {
-			Json::Value obj;
-			obj["name"] = apply->_name;
-			obj["uid"] = apply->_uid;
-			obj["icon"] = apply->_icon;
-			obj["nick"] = apply->_nick;
-			obj["sex"] = apply->_sex;
-			obj["desc"] = apply->_desc;
-			obj["status"] = apply->_status;
-			
-			rtvalue["apply_list"].append(obj);
+			client::ApplyInfo obj;
+			obj.name = apply->_name;
+			obj.uid = apply->_uid;
+			obj.icon = apply->_icon;
+			obj.nick = apply->_nick;
+			obj.sex = apply->_sex;
+			obj.desc = apply->_desc;
+			obj.status = apply->_status;
+			rsp.apply_list.push_back(std::move(obj));
 		}
 	}
 
 	//ȡб
 	std::vector<std::shared_ptr<UserInfo>> friend_list;
-	bool b_friend_list = GetFriendList(uid, friend_list);
+	bool b_friend_list = GetFriendList(uid, friend_list, yield);
 	for (auto& friend_ele : friend_list) {
-		Json::Value obj;
-		obj["name"] = friend_ele->name;
-		obj["uid"] = friend_ele->uid;
-		obj["icon"] = friend_ele->icon;
-		obj["nick"] = friend_ele->nick;
-		obj["sex"] = friend_ele->sex;
-		obj["desc"] = friend_ele->desc;
-		obj["back"] = friend_ele->back;
-		rtvalue["friend_list"].append(obj);
+		client::FriendInfo obj;
+		obj.name = friend_ele->name;
+		obj.uid = friend_ele->uid;
+		obj.icon = friend_ele->icon;
+		obj.nick = friend_ele->nick;
+		obj.sex = friend_ele->sex;
+		obj.desc = friend_ele->desc;
+		obj.back = friend_ele->back;
+		rsp.friend_list.push_back(std::move(obj));
 	}
 
 	auto server_name = ConfigMgr::Inst().GetValue("SelfServer", "Name");
@@ -186,16 +351,17 @@ void LogicSystem::LoginHandler(shared_ptr<CSession> session, const short& msg_id
 		//˴ӷֲʽø̶߳ռ¼
 		//ƴûipӦkey
 		auto lock_key = LOCK_PREFIX + uid_str;
-		auto identifier = RedisMgr::GetInstance()->acquireLock(lock_key, LOCK_TIME_OUT, ACQUIRE_TIME_OUT);
-		//defer
-		Defer defer2([this, identifier, lock_key]() {
-			RedisMgr::GetInstance()->releaseLock(lock_key, identifier);
+		//ڼЭ̹߼̼߳ûϢ
+		auto identifier = RedisMgr::GetInstance()->AsyncAcquireLock(lock_key, LOCK_TIME_OUT, ACQUIRE_TIME_OUT, yield);
+		//deferǰػ׳쳣ʱͬͷţвܹЭֻ̣ύȴظ
+		Defer defer2([identifier, lock_key]() {
+			RedisMgr::GetInstance()->PostReleaseLock(lock_key, identifier);
 			});
 		//˴жϸûǷڱ𴦻߱¼
 
 		std::string uid_ip_value = "";
 		auto uid_ip_key = USERIPPREFIX + uid_str;
-		bool b_ip = RedisMgr::GetInstance()->Get(uid_ip_key, uid_ip_value);
+		bool b_ip = RedisMgr::GetInstance()->AsyncGet(uid_ip_key, uid_ip_value, yield);
 		//˵ûѾ¼ˣ˴Ӧߵ֮ǰû¼״̬
 		if (b_ip) {
 			//ȡǰipϢ
@@ -210,7 +376,7 @@ void LogicSystem::LoginHandler(shared_ptr<CSession> session, const short& msg_id
 				if (old_session) {
 					old_session->NotifyOffline(uid);
 					//ɵ
-					_p_server->ClearSession(old_session->GetSessionId());
+					_p_server->ClearSession(old_session->GetConnId());
 				}
 
 			}
@@ -219,7 +385,7 @@ void LogicSystem::LoginHandler(shared_ptr<CSession> session, const short& msg_id
 				//֪ͨ
 				KickUserReq kick_req;
 				kick_req.set_uid(uid);
-				ChatGrpcClient::GetInstance()->NotifyKickUser(uid_ip_value, kick_req);
+				ChatGrpcClient::GetInstance()->AsyncNotifyKickUser(uid_ip_value, kick_req, yield);
 			}
 		}
 
@@ -227,70 +393,53 @@ void LogicSystem::LoginHandler(shared_ptr<CSession> session, const short& msg_id
 		session->SetUserId(uid);
 		//Ϊûõ¼ip server
 		std::string  ipkey = USERIPPREFIX + uid_str;
-		RedisMgr::GetInstance()->Set(ipkey, server_name);
+		RedisMgr::GetInstance()->AsyncSet(ipkey, server_name, yield);
 		//uidsession󶨹,Ժ˲
 		UserMgr::GetInstance()->SetUserSession(uid, session);
 		std::string  uid_session_key = USER_SESSION_PREFIX + uid_str;
-		RedisMgr::GetInstance()->Set(uid_session_key, session->GetSessionId());
+		RedisMgr::GetInstance()->AsyncSet(uid_session_key, session->GetSessionId(), yield);
 
 	}
 
 	return;
 }
 
-void LogicSystem::SearchInfo(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data)
+void LogicSystem::SearchInfo(std::shared_ptr<CSession> session, const client::SearchUserReq& req, client::SearchUserRsp& rsp,
+	boost::asio::yield_context yield)
 {
-	Json::Reader reader;
-	Json::Value root;
-	reader.parse(msg_data, root);
-	auto uid_str = root["uid"].asString();
-	std::cout << "user SearchInfo uid is  " << uid_str << endl;
-
-	Json::Value  rtvalue;
-
-	Defer defer([this, &rtvalue, session]() {
-		std::string return_str = rtvalue.toStyledString();
-		session->Send(return_str, ID_SEARCH_USER_RSP);
-		});
+	auto& uid_str = req.uid;
+	LOG_DEBUG("user SearchInfo uid is  " << uid_str);
 
 	bool b_digit = isPureDigit(uid_str);
 	if (b_digit) {
-		GetUserByUid(uid_str, rtvalue);
+		GetUserByUid(uid_str, rsp, yield);
 	}
 	else {
-		GetUserByName(uid_str, rtvalue);
+		GetUserByName(uid_str, rsp, yield);
 	}
 	return;
 }
 
-void LogicSystem::AddFriendApply(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data)
+void LogicSystem::AddFriendApply(std::shared_ptr<CSession> session, const client::AddFriendApplyReq& req,
+	client::AddFriendApplyRsp& rsp, boost::asio::yield_context yield)
 {
-	Json::Reader reader;
-	Json::Value root;
-	reader.parse(msg_data, root);
-	
-	auto uid = root["uid"].asInt();
-	auto applyname = root["applyname"].asString();
-	auto bakname = root["bakname"].asString(); // עϢ
-	auto touid = root["touid"].asInt();
+	auto uid = req.uid;
+	auto& applyname = req.applyname;
+	auto& bakname = req.bakname; // עϢ
+	auto touid = req.touid;
 	
-	std::cout << "user login uid is  " << uid << " applyname  is " << applyname << " bakname is " << bakname << " touid is " << touid << endl;
+	LOG_DEBUG("user login uid is  " << uid << " applyname  is " << applyname << " bakname is " << bakname << " touid is " << touid);
 
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success; // ĬΪɹ
-	Defer defer([this, &rtvalue, session]() {
-		std::string return_str = rtvalue.toStyledString();
-		session->Send(return_str, ID_ADD_FRIEND_RSP);
-	});
+	rsp.error = ErrorCodes::Success; // ĬΪɹ
 
 	// 1. ȸݿ
-	MysqlMgr::GetInstance()->AddFriendApply(uid, touid);
+	MysqlMgr::GetInstance()->AsyncAddFriendApply(uid, touid, yield);
 
 	// 2. ѯredis touidӦserver ip
 	auto to_str = std::to_string(touid);
 	auto to_ip_key = USERIPPREFIX + to_str;
 	std::string to_ip_value = "";
-	bool b_ip = RedisMgr::GetInstance()->Get(to_ip_key, to_ip_value);
+	bool b_ip = RedisMgr::GetInstance()->AsyncGet(to_ip_key, to_ip_value, yield);
 	if (!b_ip) {
 		return;
 	}
@@ -301,7 +450,7 @@ void LogicSystem::AddFriendApply(std::shared_ptr<CSession> session, const short&
 	// 3. ȡߵĻϢ
 	std::string base_key = USER_BASE_INFO + std::to_string(uid);
 	auto apply_info = std::make_shared<UserInfo>();
-	bool b_info = GetBaseInfo(base_key, uid, apply_info);
+	bool b_info = GetBaseInfo(base_key, uid, apply_info, yield);
 
 	// 4. Ŀûڷѡ֪ͨʽ
 	if (to_ip_value == self_name) { 
@@ -310,18 +459,17 @@ void LogicSystem::AddFriendApply(std::shared_ptr<CSession> session, const short&
 		auto session = UserMgr::GetInstance()->GetSession(touid);
 		if (session) {
 			//ڴֱӷ֪ͨԷ
-			Json::Value  notify;
-			notify["error"] = ErrorCodes::Success;
-			notify["applyuid"] = uid;
-			notify["name"] = applyname;
-			notify["desc"] = "";
+			client::NotifyAddFriend notify;
+			notify.error = ErrorCodes::Success;
+			notify.applyuid = uid;
+			notify.name = applyname;
+			notify.desc = "";
 			if (b_info) {
-				notify["icon"] = apply_info->icon;
-				notify["sex"] = apply_info->sex;
-				notify["nick"] = apply_info->nick;
+				notify.icon = apply_info->icon;
+				notify.sex = apply_info->sex;
+				notify.nick = apply_info->nick;
 			}
-			std::string return_str = notify.toStyledString();
-			session->Send(return_str, ID_NOTIFY_ADD_FRIEND_REQ);
+			session->SendMsg(notify, ID_NOTIFY_ADD_FRIEND_REQ);
 		}
 
 		return;
@@ -341,54 +489,45 @@ void LogicSystem::AddFriendApply(std::shared_ptr<CSession> session, const short&
 	}
 
 	//֪ͨ
-	ChatGrpcClient::GetInstance()->NotifyAddFriend(to_ip_value, add_req);
+	ChatGrpcClient::GetInstance()->AsyncNotifyAddFriend(to_ip_value, add_req, yield);
 }
 
-void LogicSystem::AuthFriendApply(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data) {
-
-	Json::Reader reader;
-	Json::Value root;
-	reader.parse(msg_data, root);
+void LogicSystem::AuthFriendApply(std::shared_ptr<CSession> session, const client::AuthFriendApplyReq& req,
+	client::AuthFriendApplyRsp& rsp, boost::asio::yield_context yield) {
 
-	auto uid = root["fromuid"].asInt();
-	auto touid = root["touid"].asInt();
-	auto back_name = root["back"].asString();
-	std::cout << "from " << uid << " auth friend to " << touid << std::endl;
+	auto uid = req.fromuid;
+	auto touid = req.touid;
+	auto& back_name = req.back;
+	LOG_DEBUG("from " << uid << " auth friend to " << touid);
 
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success;
+	rsp.error = ErrorCodes::Success;
 	auto user_info = std::make_shared<UserInfo>();
 
 	std::string base_key = USER_BASE_INFO + std::to_string(touid);
-	bool b_info = GetBaseInfo(base_key, touid, user_info);
+	bool b_info = GetBaseInfo(base_key, touid, user_info, yield);
 	if (b_info) {
-		rtvalue["name"] = user_info->name;
-		rtvalue["nick"] = user_info->nick;
-		rtvalue["icon"] = user_info->icon;
-		rtvalue["sex"] = user_info->sex;
-		rtvalue["uid"] = touid;
+		rsp.name = user_info->name;
+		rsp.nick = user_info->nick;
+		rsp.icon = user_info->icon;
+		rsp.sex = user_info->sex;
+		rsp.uid = touid;
 	}
 	else {
-		rtvalue["error"] = ErrorCodes::UidInvalid;
+		rsp.error = ErrorCodes::UidInvalid;
 	}
 
 
-	Defer defer([this, &rtvalue, session]() {
-		std::string return_str = rtvalue.toStyledString();
-		session->Send(return_str, ID_AUTH_FRIEND_RSP);
-		});
-
 	//ȸݿ
-	MysqlMgr::GetInstance()->AuthFriendApply(uid, touid);
+	MysqlMgr::GetInstance()->AsyncAuthFriendApply(uid, touid, yield);
 
 	//ݿӺ
-	MysqlMgr::GetInstance()->AddFriend(uid, touid, back_name);
+	MysqlMgr::GetInstance()->AsyncAddFriend(uid, touid, back_name, yield);
 
 	//ѯredis touidӦserver ip
 	auto to_str = std::to_string(touid);
 	auto to_ip_key = USERIPPREFIX + to_str;
 	std::string to_ip_value = "";
-	bool b_ip = RedisMgr::GetInstance()->Get(to_ip_key, to_ip_value);
+	bool b_ip = RedisMgr::GetInstance()->AsyncGet(to_ip_key, to_ip_value, yield);
 	if (!b_ip) {
 		return;
 	}
@@ -400,26 +539,24 @@ void LogicSystem::AuthFriendApply(std::shared_ptr<CSession> session, const short
 		auto session = UserMgr::GetInstance()->GetSession(touid);
 		if (session) {
 			//ڴֱӷ֪ͨԷ
-			Json::Value  notify;
-			notify["error"] = ErrorCodes::Success;
-			notify["fromuid"] = uid;
-			notify["touid"] = touid;
+			client::NotifyAuthFriend notify;
+			notify.error = ErrorCodes::Success;
+			notify.fromuid = uid;
+			notify.touid = touid;
 			std::string base_key = USER_BASE_INFO + std::to_string(uid);
 			auto user_info = std::make_shared<UserInfo>();
-			bool b_info = GetBaseInfo(base_key, uid, user_info);
+			bool b_info = GetBaseInfo(base_key, uid, user_info, yield);
 			if (b_info) {
-				notify["name"] = user_info->name;
-				notify["nick"] = user_info->nick;
-				notify["icon"] = user_info->icon;
-				notify["sex"] = user_info->sex;
+				notify.name = user_info->name;
+				notify.nick = user_info->nick;
+				notify.icon = user_info->icon;
+				notify.sex = user_info->sex;
 			}
 			else {
-				notify["error"] = ErrorCodes::UidInvalid;
+				notify.error = ErrorCodes::UidInvalid;
 			}
 
-
-			std::string return_str = notify.toStyledString();
-			session->Send(return_str, ID_NOTIFY_AUTH_FRIEND_REQ);
+			session->SendMsg(notify, ID_NOTIFY_AUTH_FRIEND_REQ);
 		}
 
 		return;
@@ -431,36 +568,25 @@ void LogicSystem::AuthFriendApply(std::shared_ptr<CSession> session, const short
 	auth_req.set_touid(touid);
 
 	//֪ͨ
-	ChatGrpcClient::GetInstance()->NotifyAuthFriend(to_ip_value, auth_req);
+	ChatGrpcClient::GetInstance()->AsyncNotifyAuthFriend(to_ip_value, auth_req, yield);
 }
 
-void LogicSystem::DealChatTextMsg(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data) {
-	Json::Reader reader;
-	Json::Value root;
-	reader.parse(msg_data, root);
+void LogicSystem::DealChatTextMsg(std::shared_ptr<CSession> session, const client::TextChatMsgReq& req,
+	client::TextChatMsgRsp& rsp, boost::asio::yield_context yield) {
+	auto uid = req.fromuid;
+	auto touid = req.touid;
 
-	auto uid = root["fromuid"].asInt();
-	auto touid = root["touid"].asInt();
-
-	const Json::Value  arrays = root["text_array"];
-
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success;
-	rtvalue["text_array"] = arrays;
-	rtvalue["fromuid"] = uid;
-	rtvalue["touid"] = touid;
-
-	Defer defer([this, &rtvalue, session]() {
-		std::string return_str = rtvalue.toStyledString();
-		session->Send(return_str, ID_TEXT_CHAT_MSG_RSP);
-		});
+	rsp.error = ErrorCodes::Success;
+	rsp.text_array = req.text_array;
+	rsp.fromuid = uid;
+	rsp.touid = touid;
 
 
 	//ѯredis touidӦserver ip
 	auto to_str = std::to_string(touid);
 	auto to_ip_key = USERIPPREFIX + to_str;
 	std::string to_ip_value = "";
-	bool b_ip = RedisMgr::GetInstance()->Get(to_ip_key, to_ip_value);
+	bool b_ip = RedisMgr::GetInstance()->AsyncGet(to_ip_key, to_ip_value, yield);
 	if (!b_ip) {
 		return;
 	}
@@ -469,11 +595,12 @@ void LogicSystem::DealChatTextMsg(std::shared_ptr<CSession> session, const short
 	auto self_name = cfg["SelfServer"]["Name"];
 	//ֱ֪ͨԷ֤ͨϢ
 	if (to_ip_value == self_name) {
-		auto session = UserMgr::GetInstance()->GetSession(touid);
-		if (session) {
+		auto to_session = UserMgr::GetInstance()->GetSession(touid);
+		if (to_session) {
 			//ڴֱӷ֪ͨԷ
-			std::string return_str = rtvalue.toStyledString();
-			session->Send(return_str, ID_NOTIFY_TEXT_CHAT_MSG_REQ);
+			to_session->SendMsg(rsp, ID_NOTIFY_TEXT_CHAT_MSG_REQ);
+			//ԷѹʱͣȡͷԷָ
+			to_session->ThrottlePeer(session);
 		}
 
 		return;
@@ -483,30 +610,25 @@ void LogicSystem::DealChatTextMsg(std::shared_ptr<CSession> session, const short
 	TextChatMsgReq text_msg_req;
 	text_msg_req.set_fromuid(uid);
 	text_msg_req.set_touid(touid);
-	for (const auto& txt_obj : arrays) {
-		auto content = txt_obj["content"].asString();
-		auto msgid = txt_obj["msgid"].asString();
-		std::cout << "content is " << content << std::endl;
-		std::cout << "msgid is " << msgid << std::endl;
+	for (const auto& txt_obj : req.text_array) {
+		LOG_TRACE("content is " << txt_obj.content);
+		LOG_TRACE("msgid is " << txt_obj.msgid);
 		auto* text_msg = text_msg_req.add_textmsgs();
-		text_msg->set_msgid(msgid);
-		text_msg->set_msgcontent(content);
+		text_msg->set_msgid(txt_obj.msgid);
+		text_msg->set_msgcontent(txt_obj.content);
 	}
 
 
 	//֪ͨ todo...
-	ChatGrpcClient::GetInstance()->NotifyTextChatMsg(to_ip_value, text_msg_req, rtvalue);
+	ChatGrpcClient::GetInstance()->AsyncNotifyTextChatMsg(to_ip_value, text_msg_req, yield);
 }
 
-void LogicSystem::HeartBeatHandler(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data) {
-	Json::Reader reader;
-	Json::Value root;
-	reader.parse(msg_data, root);
-	auto uid = root["fromuid"].asInt();
-	std::cout << "receive heart beat msg, uid is " << uid << std::endl;
-	Json::Value  rtvalue;
-	rtvalue["error"] = ErrorCodes::Success;
-	session->Send(rtvalue.toStyledString(), ID_HEARTBEAT_RSP);
+void LogicSystem::HeartBeatHandler(std::shared_ptr<CSession> session, const client::HeartBeatReq& req,
+	client::HeartBeatRsp& rsp, boost::asio::yield_context yield) {
+	//һCSessionioֱ߳ӻظֻѹϢŻᵽ
+	auto uid = req.fromuid;
+	LOG_TRACE("receive heart beat msg, uid is " << uid);
+	rsp.error = ErrorCodes::Success;
 }
 
 bool LogicSystem::isPureDigit(const std::string& str)
@@ -519,15 +641,15 @@ bool LogicSystem::isPureDigit(const std::string& str)
 	return true;
 }
 
-void LogicSystem::GetUserByUid(std::string uid_str, Json::Value& rtvalue)
+void LogicSystem::GetUserByUid(std::string uid_str, client::SearchUserRsp& rsp, boost::asio::yield_context yield)
 {
-	rtvalue["error"] = ErrorCodes::Success;
+	rsp.error = ErrorCodes::Success;
 
 	std::string base_key = USER_BASE_INFO + uid_str;
 
 	//ȲredisвѯûϢ
 	std::string info_str = "";
-	bool b_base = RedisMgr::GetInstance()->Get(base_key, info_str);
+	bool b_base = RedisMgr::GetInstance()->AsyncGet(base_key, info_str, yield);
 	if (b_base) {
 		Json::Reader reader;
 		Json::Value root;
@@ -540,17 +662,17 @@ void LogicSystem::GetUserByUid(std::string uid_str, Json::Value& rtvalue)
 		auto desc = root["desc"].asString();
 		auto sex = root["sex"].asInt();
 		auto icon = root["icon"].asString();
-		std::cout << "user  uid is  " << uid << " name  is "
-			<< name << " pwd is " << pwd << " email is " << email << " icon is " << icon << endl;
-
-		rtvalue["uid"] = uid;
-		rtvalue["pwd"] = pwd;
-		rtvalue["name"] = name;
-		rtvalue["email"] = email;
-		rtvalue["nick"] = nick;
-		rtvalue["desc"] = desc;
-		rtvalue["sex"] = sex;
-		rtvalue["icon"] = icon;
+		LOG_DEBUG("user  uid is  " << uid << " name  is "
+			<< name << " pwd is " << pwd << " email is " << email << " icon is " << icon);
+
+		rsp.uid = uid;
+		rsp.pwd = pwd;
+		rsp.name = name;
+		rsp.email = email;
+		rsp.nick = nick;
+		rsp.desc = desc;
+		rsp.sex = sex;
+		rsp.icon = icon;
 		return;
 	}
 
@@ -558,9 +680,9 @@ void LogicSystem::GetUserByUid(std::string uid_str, Json::Value& rtvalue)
 	//redisûѯmysql
 	//ѯݿ
 	std::shared_ptr<UserInfo> user_info = nullptr;
-	user_info = MysqlMgr::GetInstance()->GetUser(uid);
+	user_info = MysqlMgr::GetInstance()->AsyncGetUser(uid, yield);
 	if (user_info == nullptr) {
-		rtvalue["error"] = ErrorCodes::UidInvalid;
+		rsp.error = ErrorCodes::UidInvalid;
 		return;
 	}
 
@@ -575,28 +697,28 @@ void LogicSystem::GetUserByUid(std::string uid_str, Json::Value& rtvalue)
 	redis_root["sex"] = user_info->sex;
 	redis_root["icon"] = user_info->icon;
 
-	RedisMgr::GetInstance()->Set(base_key, redis_root.toStyledString());
+	RedisMgr::GetInstance()->AsyncSet(base_key, redis_root.toStyledString(), yield);
 
 	//
-	rtvalue["uid"] = user_info->uid;
-	rtvalue["pwd"] = user_info->pwd;
-	rtvalue["name"] = user_info->name;
-	rtvalue["email"] = user_info->email;
-	rtvalue["nick"] = user_info->nick;
-	rtvalue["desc"] = user_info->desc;
-	rtvalue["sex"] = user_info->sex;
-	rtvalue["icon"] = user_info->icon;
+	rsp.uid = user_info->uid;
+	rsp.pwd = user_info->pwd;
+	rsp.name = user_info->name;
+	rsp.email = user_info->email;
+	rsp.nick = user_info->nick;
+	rsp.desc = user_info->desc;
+	rsp.sex = user_info->sex;
+	rsp.icon = user_info->icon;
 }
 
-void LogicSystem::GetUserByName(std::string name, Json::Value& rtvalue)
+void LogicSystem::GetUserByName(std::string name, client::SearchUserRsp& rsp, boost::asio::yield_context yield)
 {
-	rtvalue["error"] = ErrorCodes::Success;
+	rsp.error = ErrorCodes::Success;
 
 	std::string base_key = NAME_INFO + name;
 
 	//ȲredisвѯûϢ
 	std::string info_str = "";
-	bool b_base = RedisMgr::GetInstance()->Get(base_key, info_str);
+	bool b_base = RedisMgr::GetInstance()->AsyncGet(base_key, info_str, yield);
 	if (b_base) {
 		Json::Reader reader;
 		Json::Value root;
@@ -608,25 +730,25 @@ void LogicSystem::GetUserByName(std::string name, Json::Value& rtvalue)
 		auto nick = root["nick"].asString();
 		auto desc = root["desc"].asString();
 		auto sex = root["sex"].asInt();
-		std::cout << "user  uid is  " << uid << " name  is "
-			<< name << " pwd is " << pwd << " email is " << email << endl;
-
-		rtvalue["uid"] = uid;
-		rtvalue["pwd"] = pwd;
-		rtvalue["name"] = name;
-		rtvalue["email"] = email;
-		rtvalue["nick"] = nick;
-		rtvalue["desc"] = desc;
-		rtvalue["sex"] = sex;
+		LOG_DEBUG("user  uid is  " << uid << " name  is "
+			<< name << " pwd is " << pwd << " email is " << email);
+
+		rsp.uid = uid;
+		rsp.pwd = pwd;
+		rsp.name = name;
+		rsp.email = email;
+		rsp.nick = nick;
+		rsp.desc = desc;
+		rsp.sex = sex;
 		return;
 	}
 
 	//redisûѯmysql
 	//ѯݿ
 	std::shared_ptr<UserInfo> user_info = nullptr;
-	user_info = MysqlMgr::GetInstance()->GetUser(name);
+	user_info = MysqlMgr::GetInstance()->AsyncGetUser(name, yield);
 	if (user_info == nullptr) {
-		rtvalue["error"] = ErrorCodes::UidInvalid;
+		rsp.error = ErrorCodes::UidInvalid;
 		return;
 	}
 
@@ -640,23 +762,23 @@ void LogicSystem::GetUserByName(std::string name, Json::Value& rtvalue)
 	redis_root["desc"] = user_info->desc;
 	redis_root["sex"] = user_info->sex;
 
-	RedisMgr::GetInstance()->Set(base_key, redis_root.toStyledString());
+	RedisMgr::GetInstance()->AsyncSet(base_key, redis_root.toStyledString(), yield);
 
 	//
-	rtvalue["uid"] = user_info->uid;
-	rtvalue["pwd"] = user_info->pwd;
-	rtvalue["name"] = user_info->name;
-	rtvalue["email"] = user_info->email;
-	rtvalue["nick"] = user_info->nick;
-	rtvalue["desc"] = user_info->desc;
-	rtvalue["sex"] = user_info->sex;
+	rsp.uid = user_info->uid;
+	rsp.pwd = user_info->pwd;
+	rsp.name = user_info->name;
+	rsp.email = user_info->email;
+	rsp.nick = user_info->nick;
+	rsp.desc = user_info->desc;
+	rsp.sex = user_info->sex;
 }
 
-bool LogicSystem::GetBaseInfo(std::string base_key, int uid, std::shared_ptr<UserInfo>& userinfo)
+bool LogicSystem::GetBaseInfo(std::string base_key, int uid, std::shared_ptr<UserInfo>& userinfo, boost::asio::yield_context yield)
 {
 	//ȲredisвѯûϢ
 	std::string info_str = "";
-	bool b_base = RedisMgr::GetInstance()->Get(base_key, info_str);
+	bool b_base = RedisMgr::GetInstance()->AsyncGet(base_key, info_str, yield);
 	if (b_base) {
 		Json::Reader reader;
 		Json::Value root;
@@ -669,14 +791,14 @@ bool LogicSystem::GetBaseInfo(std::string base_key, int uid, std::shared_ptr<Use
 		userinfo->desc = root["desc"].asString();
 		userinfo->sex = root["sex"].asInt();
 		userinfo->icon = root["icon"].asString();
-		std::cout << "user login uid is  " << userinfo->uid << " name  is "
-			<< userinfo->name << " pwd is " << userinfo->pwd << " email is " << userinfo->email << endl;
+		LOG_DEBUG("user login uid is  " << userinfo->uid << " name  is "
+			<< userinfo->name << " pwd is " << userinfo->pwd << " email is " << userinfo->email);
 	}
 	else {
 		//redisûѯmysql
 		//ѯݿ
 		std::shared_ptr<UserInfo> user_info = nullptr;
-		user_info = MysqlMgr::GetInstance()->GetUser(uid);
+		user_info = MysqlMgr::GetInstance()->AsyncGetUser(uid, yield);
 		if (user_info == nullptr) {
 			return false;
 		}
@@ -693,18 +815,18 @@ bool LogicSystem::GetBaseInfo(std::string base_key, int uid, std::shared_ptr<Use
 		redis_root["desc"] = userinfo->desc;
 		redis_root["sex"] = userinfo->sex;
 		redis_root["icon"] = userinfo->icon;
-		RedisMgr::GetInstance()->Set(base_key, redis_root.toStyledString());
+		RedisMgr::GetInstance()->AsyncSet(base_key, redis_root.toStyledString(), yield);
 	}
 
 	return true;
 }
 
-bool LogicSystem::GetFriendApplyInfo(int to_uid, std::vector<std::shared_ptr<ApplyInfo>>& list) {
+bool LogicSystem::GetFriendApplyInfo(int to_uid, std::vector<std::shared_ptr<ApplyInfo>>& list, boost::asio::yield_context yield) {
 	//mysqlȡб
-	return MysqlMgr::GetInstance()->GetApplyList(to_uid, list, 0, 10);
+	return MysqlMgr::GetInstance()->AsyncGetApplyList(to_uid, list, 0, 10, yield);
 }
 
-bool LogicSystem::GetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo>>& user_list) {
+bool LogicSystem::GetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo>>& user_list, boost::asio::yield_context yield) {
 	//mysqlȡб
-	return MysqlMgr::GetInstance()->GetFriendList(self_id, user_list);
+	return MysqlMgr::GetInstance()->AsyncGetFriendList(self_id, user_list, yield);
 }
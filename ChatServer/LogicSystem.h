@@ -1,7 +1,12 @@
 #pragma once
 #include "Singleton.h"
+#include "Logger.h"
 #include <queue>
 #include <thread>
+#include <vector>
+#include <array>
+#include <boost/asio.hpp>
+#include <boost/asio/spawn.hpp>
 #include "CSession.h"
 #include <map>
 #include <functional>
@@ -11,38 +16,128 @@
 #include <json/reader.h>
 #include <unordered_map>
 #include "data.h"
+#include "ClientMsg.h"
+#include "Metrics.h"
+#include "LogicLanes.h"
+#include "MpscRing.h"
+#include <atomic>
 
 class CServer;
-typedef  function<void(shared_ptr<CSession>, const short &msg_id, const string &msg_data)> FunCallBack;
+class LogicSystem;
+// 一个逻辑线程，运行自己的io_context，消息处理函数以协程的方式在上面执行
+// 同一个用户的消息固定由同一个逻辑线程处理
+// io线程把消息放入_inbox，逻辑线程批量取出后按会话和优先级排入_lanes
+struct LogicWorker {
+	explicit LogicWorker(std::size_t inbox_capacity) :_work(boost::asio::make_work_guard(_io_context)),
+		_inbox(inbox_capacity), _b_drain_posted(false) {}
+	boost::asio::io_context _io_context;
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> _work;
+	std::thread _thread;
+	MpscRing<shared_ptr<LogicNode>> _inbox;
+	// 是否已投递取_inbox的任务，_inbox从空变为非空时才需要投递
+	std::atomic<bool> _b_drain_posted;
+	// 只在本逻辑线程中访问
+	LogicLanes _lanes;
+};
+
+// 逻辑队列满时的处理方式
+enum class OverflowPolicy {
+	// 用请求对应的回包回复ServerBusy错误，客户端可以稍后重试
+	Reject,
+	// 直接丢弃，不回包
+	Shed,
+};
+
+// 分发函数，按消息描述生成，解析请求后调用处理函数并发送回包
+// 消息体直接引用接收缓冲区，处理函数运行在协程中，通过yield等待redis、mysql、grpc的异步调用
+typedef void (*MsgDispatcher)(LogicSystem* self, const shared_ptr<CSession>& session, ClientCodec codec,
+	const char* data, std::size_t len, boost::asio::yield_context yield);
 class LogicSystem:public Singleton<LogicSystem>
 {
 	friend class Singleton<LogicSystem>;
 public:
 	~LogicSystem();
+	// 已登录的会话按uid分配逻辑线程，未登录的按连接id分配，可以在任意io线程调用，不加锁
+	// 等待处理的消息超过[LogicSystem] MaxQueue时按Overflow配置拒绝或丢弃
+	// 消息按[LogicLanes]配置分到不同的优先级，同一会话同一优先级的消息按顺序逐条处理，
+	// 不同优先级之间不保证顺序，例如心跳不会排在同一会话耗时的登录之后
 	void PostMsgToQue(shared_ptr < LogicNode> msg);
 	void SetServer(std::shared_ptr<CServer> pserver);
+	// 不处理请求，用请求对应的回包id回复错误码，可以在任意线程调用
+	void RejectMsg(const shared_ptr<CSession>& session, short msg_id, int error);
+	// 在uid对应的逻辑线程上以协程方式执行task，可以在任意线程调用
+	// 用于io线程上需要访问redis的操作，io线程只投递，不等待回复
+	void PostTask(int uid, std::function<void(boost::asio::yield_context)> task);
 private:
 	LogicSystem();
-	void DealMsg();
+	// 在逻辑线程上批量取出_inbox中的消息，排入会话和优先级队列
+	void Drain(LogicWorker& worker);
+	// 逻辑队列满时按配置拒绝或丢弃消息
+	void Overflow(const shared_ptr<LogicNode>& msg);
+	// 过载时拒绝登录，回复ServerBusy和建议的重试间隔
+	void RejectLogin(const shared_ptr<LogicNode>& msg);
+	// 在逻辑线程上按优先级取出会话并启动处理协程，直到没有会话或者处理数已满
+	void Schedule(LogicWorker& worker);
+	// 处理会话在该优先级上的一条消息，处理完还有消息时重新排队
+	void SpawnHandler(LogicWorker& worker, MsgLane lane, shared_ptr<CSession> session);
+	// 调用消息对应的分发函数，并记录排队和处理耗时(处理耗时包含协程挂起等待的时间)
+	void HandleMsg(const shared_ptr<LogicNode>& msg_node, boost::asio::yield_context yield);
 	void RegisterCallBacks();
-	void LoginHandler(shared_ptr<CSession> session, const short &msg_id, const string &msg_data);
-	void SearchInfo(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data);
-	void AddFriendApply(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data);
-	void AuthFriendApply(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data);
-	void DealChatTextMsg(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data);
-	void HeartBeatHandler(std::shared_ptr<CSession> session, const short& msg_id, const string& msg_data);
+
+	// 处理函数的类型由消息描述决定: 收到解析好的请求，填写回包
+	template <typename Desc>
+	struct Handler {
+		typedef void (LogicSystem::*Type)(shared_ptr<CSession> session, const typename Desc::ReqType& req,
+			typename Desc::RspType& rsp, boost::asio::yield_context yield);
+	};
+	// 按消息的编码(json/protobuf)解析成请求类型，调用处理函数，处理完后发送回包
+	template <typename Desc, typename Handler<Desc>::Type handler>
+	static void Dispatch(LogicSystem* self, const shared_ptr<CSession>& session, ClientCodec codec,
+		const char* data, std::size_t len, boost::asio::yield_context yield) {
+		typename Desc::ReqType req;
+		if (!DecodeClientMsg(codec, data, len, req)) {
+			LOG_ERROR("decode msg failed, msg id is " << Desc::REQ_ID << ", session id is " << session->GetSessionId());
+			return;
+		}
+		//登录消息的编码决定会话之后回包的编码，登录请求中的codec可以在登录成功后改为protobuf
+		if (Desc::REQ_ID == MSG_CHAT_LOGIN) {
+			session->SetCodec(codec);
+		}
+		typename Desc::RspType rsp;
+		(self->*handler)(session, req, rsp, yield);
+		session->SendMsg(rsp, Desc::RSP_ID);
+	}
+	// 注册到分发表，分发时按 msg_id - MSG_ID_BEGIN 直接取分发函数
+	template <typename Desc, typename Handler<Desc>::Type handler>
+	void Register() {
+		static_assert(Desc::REQ_ID >= MSG_ID_BEGIN && Desc::REQ_ID < MSG_ID_END, "msg id out of dispatch table");
+		_dispatchers[Desc::REQ_ID - MSG_ID_BEGIN] = &Dispatch<Desc, handler>;
+		_rsp_ids[Desc::REQ_ID - MSG_ID_BEGIN] = Desc::RSP_ID;
+	}
+	void LoginHandler(shared_ptr<CSession> session, const client::ChatLoginReq& req, client::ChatLoginRsp& rsp, boost::asio::yield_context yield);
+	void SearchInfo(std::shared_ptr<CSession> session, const client::SearchUserReq& req, client::SearchUserRsp& rsp, boost::asio::yield_context yield);
+	void AddFriendApply(std::shared_ptr<CSession> session, const client::AddFriendApplyReq& req, client::AddFriendApplyRsp& rsp, boost::asio::yield_context yield);
+	void AuthFriendApply(std::shared_ptr<CSession> session, const client::AuthFriendApplyReq& req, client::AuthFriendApplyRsp& rsp, boost::asio::yield_context yield);
+	void DealChatTextMsg(std::shared_ptr<CSession> session, const client::TextChatMsgReq& req, client::TextChatMsgRsp& rsp, boost::asio::yield_context yield);
+	void HeartBeatHandler(std::shared_ptr<CSession> session, const client::HeartBeatReq& req, client::HeartBeatRsp& rsp, boost::asio::yield_context yield);
 	bool isPureDigit(const std::string& str);
-	void GetUserByUid(std::string uid_str, Json::Value& rtvalue);
-	void GetUserByName(std::string name, Json::Value& rtvalue);
-	bool GetBaseInfo(std::string base_key, int uid, std::shared_ptr<UserInfo> &userinfo);
-	bool GetFriendApplyInfo(int to_uid, std::vector<std::shared_ptr<ApplyInfo>>& list);
-	bool GetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo>> & user_list);
-	std::thread _worker_thread;
-	std::queue<shared_ptr<LogicNode>> _msg_que;
-	std::mutex _mutex;
-	std::condition_variable _consume;
-	bool _b_stop;
-	std::map<short, FunCallBack> _fun_callbacks;
+	void GetUserByUid(std::string uid_str, client::SearchUserRsp& rsp, boost::asio::yield_context yield);
+	void GetUserByName(std::string name, client::SearchUserRsp& rsp, boost::asio::yield_context yield);
+	bool GetBaseInfo(std::string base_key, int uid, std::shared_ptr<UserInfo> &userinfo, boost::asio::yield_context yield);
+	bool GetFriendApplyInfo(int to_uid, std::vector<std::shared_ptr<ApplyInfo>>& list, boost::asio::yield_context yield);
+	bool GetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo>> & user_list, boost::asio::yield_context yield);
+	// 等待处理的消息数(全部逻辑线程之和)，投递时先占位再判断是否超过_max_que
+	std::atomic<int64_t> _que_size;
+	int64_t _max_que;
+	OverflowPolicy _overflow;
+	// 因队列满被拒绝或丢弃的消息数
+	MetricGauge& _overflow_count;
+	// 逻辑线程个数由[LogicSystem] Workers配置，创建后不再变化
+	std::vector<std::unique_ptr<LogicWorker>> _workers;
+	// 分发表，下标为 msg_id - MSG_ID_BEGIN，没有处理函数的位置为nullptr
+	// 构造完成后只读，多个逻辑线程并发查找不需要加锁
+	std::array<MsgDispatcher, MSG_ID_END - MSG_ID_BEGIN> _dispatchers;
+	// 请求对应的回包id，拒绝请求时使用，和_dispatchers同时注册，构造完成后只读
+	std::array<short, MSG_ID_END - MSG_ID_BEGIN> _rsp_ids;
 	std::shared_ptr<CServer> _p_server;
 };
-
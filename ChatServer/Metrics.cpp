@@ -0,0 +1,264 @@
+#include "Metrics.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+int HighBit(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index = 0;
+	_BitScanReverse64(&index, value);
+	return static_cast<int>(index);
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+const char* PhaseName(int phase) {
+	switch (static_cast<MsgPhase>(phase)) {
+	case MsgPhase::QueueWait:
+		return "queue_wait";
+	case MsgPhase::Handle:
+		return "handle";
+	case MsgPhase::Send:
+		return "send";
+	default:
+		return "unknown";
+	}
+}
+
+void AppendNumber(std::string& out, double value) {
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "%.12g", value);
+	out += buf;
+}
+
+void AppendHeader(std::string& out, const std::string& name, const std::string& help, const char* type) {
+	out += "# HELP " + name + " " + help + "\n";
+	out += "# TYPE " + name + " " + type + "\n";
+}
+
+// 导出的le边界，2^10纳秒(约1微秒)到2^35纳秒(约34秒)之间的2的幂，都落在桶的边界上
+const int EXPORT_MIN_BITS = 10;
+const int EXPORT_MAX_BITS = 35;
+
+const double EXPORT_QUANTILES[] = { 0.5, 0.99, 0.999 };
+
+}
+
+LatencyHistogram::LatencyHistogram() :_count(0), _sum(0), _max(0) {
+	for (auto& count : _counts) {
+		count.store(0, std::memory_order_relaxed);
+	}
+}
+
+int LatencyHistogram::BucketIndex(uint64_t ns) {
+	if (ns < static_cast<uint64_t>(SUB_COUNT)) {
+		return static_cast<int>(ns);
+	}
+	int msb = HighBit(ns);
+	if (msb >= MAX_BITS) {
+		return BUCKET_COUNT - 1;
+	}
+	int shift = msb - SUB_BITS;
+	return (shift + 1) * SUB_COUNT + static_cast<int>((ns >> shift) - SUB_COUNT);
+}
+
+uint64_t LatencyHistogram::BucketUpper(int index) {
+	if (index < SUB_COUNT) {
+		return static_cast<uint64_t>(index) + 1;
+	}
+	int shift = index / SUB_COUNT - 1;
+	return static_cast<uint64_t>(index % SUB_COUNT + SUB_COUNT + 1) << shift;
+}
+
+void LatencyHistogram::Record(int64_t ns) {
+	uint64_t value = ns < 0 ? 0 : static_cast<uint64_t>(ns);
+	_counts[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(value, std::memory_order_relaxed);
+	//最大值很少被刷新，先读一次避免每次都做CAS
+	uint64_t cur_max = _max.load(std::memory_order_relaxed);
+	while (value > cur_max && !_max.compare_exchange_weak(cur_max, value, std::memory_order_relaxed)) {
+	}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+	Snapshot snap;
+	snap._counts.resize(BUCKET_COUNT);
+	//各字段分别读取，并发记录时总数与分桶之和可能有少量出入，按分桶重新累计
+	uint64_t count = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i) {
+		snap._counts[i] = _counts[i].load(std::memory_order_relaxed);
+		count += snap._counts[i];
+	}
+	snap._count = count;
+	snap._sum = _sum.load(std::memory_order_relaxed);
+	snap._max = _max.load(std::memory_order_relaxed);
+	return snap;
+}
+
+uint64_t LatencyHistogram::Snapshot::Quantile(double q) const {
+	if (_count == 0) {
+		return 0;
+	}
+	auto rank = static_cast<uint64_t>(std::ceil(q * _count));
+	if (rank == 0) {
+		rank = 1;
+	}
+	uint64_t seen = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i) {
+		seen += _counts[i];
+		if (seen >= rank) {
+			auto upper = BucketUpper(i) - 1;
+			return upper < _max ? upper : _max;
+		}
+	}
+	return _max;
+}
+
+uint64_t LatencyHistogram::Snapshot::CountBelow(uint64_t limit) const {
+	uint64_t count = 0;
+	for (int i = 0; i < BUCKET_COUNT && BucketUpper(i) <= limit; ++i) {
+		count += _counts[i];
+	}
+	return count;
+}
+
+Metrics& Metrics::Inst() {
+	static Metrics* inst = new Metrics();
+	return *inst;
+}
+
+Metrics::Metrics() {
+	for (auto& msg : _msgs) {
+		msg.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+int64_t Metrics::NowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Metrics::RecordMsg(MsgPhase phase, short msg_id, int64_t ns) {
+	auto index = static_cast<unsigned short>(msg_id) % MAX_MSG_ID;
+	auto* msg = _msgs[index].load(std::memory_order_acquire);
+	if (msg == nullptr) {
+		//首次出现的消息id，多个线程同时创建时只保留一个
+		auto* created = new MsgHistograms();
+		if (_msgs[index].compare_exchange_strong(msg, created, std::memory_order_acq_rel)) {
+			msg = created;
+		}
+		else {
+			delete created;
+		}
+	}
+	msg->_phases[static_cast<int>(phase)].Record(ns);
+}
+
+LatencyHistogram& Metrics::GetHistogram(const std::string& name, const std::string& help) {
+	std::lock_guard<std::mutex> lock(_mtx);
+	for (auto& item : _histograms) {
+		if (item._name == name) {
+			return *item._metric;
+		}
+	}
+	_histograms.push_back({ name, help, std::unique_ptr<LatencyHistogram>(new LatencyHistogram()) });
+	return *_histograms.back()._metric;
+}
+
+MetricGauge& Metrics::GetGauge(const std::string& name, const std::string& help) {
+	std::lock_guard<std::mutex> lock(_mtx);
+	for (auto& item : _gauges) {
+		if (item._name == name) {
+			return *item._metric;
+		}
+	}
+	_gauges.push_back({ name, help, std::unique_ptr<MetricGauge>(new MetricGauge()) });
+	return *_gauges.back()._metric;
+}
+
+void Metrics::AddGauge(const std::string& name, const std::string& help, std::function<double()> fn) {
+	std::lock_guard<std::mutex> lock(_mtx);
+	_callbacks.push_back({ name, help, std::move(fn) });
+}
+
+void Metrics::ExportHistogram(std::string& out, std::string& quantile_out, const std::string& name,
+	const std::string& labels, const LatencyHistogram::Snapshot& snap) {
+	std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+	for (int bits = EXPORT_MIN_BITS; bits <= EXPORT_MAX_BITS; ++bits) {
+		uint64_t limit = uint64_t(1) << bits;
+		out += name + "_bucket" + prefix + "le=\"";
+		AppendNumber(out, limit / 1e9);
+		out += "\"} " + std::to_string(snap.CountBelow(limit)) + "\n";
+	}
+	out += name + "_bucket" + prefix + "le=\"+Inf\"} " + std::to_string(snap._count) + "\n";
+	std::string braces = labels.empty() ? "" : "{" + labels + "}";
+	out += name + "_sum" + braces + " ";
+	AppendNumber(out, snap._sum / 1e9);
+	out += "\n";
+	out += name + "_count" + braces + " " + std::to_string(snap._count) + "\n";
+
+	for (auto q : EXPORT_QUANTILES) {
+		quantile_out += name + "_quantile" + prefix + "quantile=\"";
+		AppendNumber(quantile_out, q);
+		quantile_out += "\"} ";
+		AppendNumber(quantile_out, snap.Quantile(q) / 1e9);
+		quantile_out += "\n";
+	}
+}
+
+void Metrics::ExportMsg(std::string& out) {
+	const std::string name = "chat_msg_latency_seconds";
+	std::string samples;
+	std::string quantiles;
+	for (int id = 0; id < MAX_MSG_ID; ++id) {
+		auto* msg = _msgs[id].load(std::memory_order_acquire);
+		if (msg == nullptr) {
+			continue;
+		}
+		for (int phase = 0; phase < static_cast<int>(MsgPhase::Count); ++phase) {
+			auto snap = msg->_phases[phase].GetSnapshot();
+			if (snap._count == 0) {
+				continue;
+			}
+			std::string labels = "msg_id=\"" + std::to_string(id) + "\",phase=\"" + PhaseName(phase) + "\"";
+			ExportHistogram(samples, quantiles, name, labels, snap);
+		}
+	}
+	AppendHeader(out, name, "Latency of client messages by msg id and phase (queue_wait, handle, send).", "histogram");
+	out += samples;
+	AppendHeader(out, name + "_quantile", "Quantiles of chat_msg_latency_seconds since start.", "gauge");
+	out += quantiles;
+}
+
+std::string Metrics::Export() {
+	std::string out;
+	out.reserve(64 * 1024);
+	ExportMsg(out);
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	for (auto& item : _histograms) {
+		std::string quantiles;
+		AppendHeader(out, item._name, item._help, "histogram");
+		ExportHistogram(out, quantiles, item._name, "", item._metric->GetSnapshot());
+		AppendHeader(out, item._name + "_quantile", "Quantiles of " + item._name + " since start.", "gauge");
+		out += quantiles;
+	}
+	for (auto& item : _gauges) {
+		AppendHeader(out, item._name, item._help, "gauge");
+		out += item._name + " " + std::to_string(item._metric->Get()) + "\n";
+	}
+	for (auto& item : _callbacks) {
+		AppendHeader(out, item._name, item._help, "gauge");
+		out += item._name + " ";
+		AppendNumber(out, item._fn());
+		out += "\n";
+	}
+	return out;
+}
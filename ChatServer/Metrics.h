@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// 对数分桶的延迟直方图(HDR风格)，单位纳秒
+// 每个2的幂区间再等分为2^SUB_BITS个子桶，记录值的相对误差不超过1/2^SUB_BITS
+// 记录只做几次relaxed原子加，可以在任意线程无锁调用
+class LatencyHistogram {
+public:
+	static const int SUB_BITS = 3;
+	static const int SUB_COUNT = 1 << SUB_BITS;
+	// 超过2^MAX_BITS纳秒(约18分钟)的值计入最后一个桶
+	static const int MAX_BITS = 40;
+	static const int BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+	LatencyHistogram();
+	void Record(int64_t ns);
+
+	// 某一时刻的副本，导出和计算分位数都在副本上进行
+	struct Snapshot {
+		std::vector<uint64_t> _counts;
+		uint64_t _count;
+		uint64_t _sum;
+		uint64_t _max;
+		// q取0~1，返回对应分位数所在桶的上界(纳秒)，不超过记录到的最大值
+		uint64_t Quantile(double q) const;
+		// 小于等于limit(纳秒)的记录数，limit需要落在桶的边界上
+		uint64_t CountBelow(uint64_t limit) const;
+	};
+	Snapshot GetSnapshot() const;
+
+	static int BucketIndex(uint64_t ns);
+	// 桶中记录值的上界(不含)
+	static uint64_t BucketUpper(int index);
+
+private:
+	std::atomic<uint64_t> _counts[BUCKET_COUNT];
+	std::atomic<uint64_t> _count;
+	std::atomic<uint64_t> _sum;
+	std::atomic<uint64_t> _max;
+};
+
+// 由调用方增减的整数指标，例如队列深度、积压字节数
+class MetricGauge {
+public:
+	MetricGauge() :_value(0) {}
+	void Add(int64_t delta) {
+		_value.fetch_add(delta, std::memory_order_relaxed);
+	}
+	void Set(int64_t value) {
+		_value.store(value, std::memory_order_relaxed);
+	}
+	int64_t Get() const {
+		return _value.load(std::memory_order_relaxed);
+	}
+private:
+	std::atomic<int64_t> _value;
+};
+
+// 消息处理的阶段: 在逻辑队列中等待、处理函数执行、从组包到写完成
+enum class MsgPhase : int {
+	QueueWait = 0,
+	Handle = 1,
+	Send = 2,
+	Count = 3,
+};
+
+// 进程内指标注册表，按Prometheus文本格式导出
+// 1. 按消息id和阶段记录的延迟直方图，首次记录时创建
+// 2. 具名直方图和整数指标，注册后一直有效，调用方保存引用，不要在热路径上按名字查找
+// 3. 回调指标，导出时调用回调取值，适合会话数、连接池占用这类已有数据
+class Metrics
+{
+public:
+	// 不会被析构，静态对象析构时仍然可以记录
+	static Metrics& Inst();
+	Metrics(const Metrics&) = delete;
+	Metrics& operator=(const Metrics&) = delete;
+
+	static int64_t NowNs();
+
+	void RecordMsg(MsgPhase phase, short msg_id, int64_t ns);
+	// 同名的直方图/指标只创建一次，多次调用返回同一个对象
+	LatencyHistogram& GetHistogram(const std::string& name, const std::string& help);
+	MetricGauge& GetGauge(const std::string& name, const std::string& help);
+	// 回调在导出线程中执行，需要自己保证线程安全，并且不能阻塞
+	void AddGauge(const std::string& name, const std::string& help, std::function<double()> fn);
+
+	// Prometheus文本格式
+	std::string Export();
+
+private:
+	Metrics();
+	// 消息id去掉头部标志位后最多13位
+	static const int MAX_MSG_ID = 1 << 13;
+	struct MsgHistograms {
+		LatencyHistogram _phases[static_cast<int>(MsgPhase::Count)];
+	};
+	template <typename T>
+	struct Named {
+		std::string _name;
+		std::string _help;
+		std::unique_ptr<T> _metric;
+	};
+	struct CallbackGauge {
+		std::string _name;
+		std::string _help;
+		std::function<double()> _fn;
+	};
+	void ExportMsg(std::string& out);
+	// 直方图样本写入out，p50/p99/p999写入quantile_out(名字加_quantile后缀的gauge)
+	static void ExportHistogram(std::string& out, std::string& quantile_out, const std::string& name,
+		const std::string& labels, const LatencyHistogram::Snapshot& snap);
+
+	std::atomic<MsgHistograms*> _msgs[MAX_MSG_ID];
+	std::mutex _mtx;
+	std::vector<Named<LatencyHistogram>> _histograms;
+	std::vector<Named<MetricGauge>> _gauges;
+	std::vector<CallbackGauge> _callbacks;
+};
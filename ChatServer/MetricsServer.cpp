@@ -0,0 +1,142 @@
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include "Logger.h"
+#include "CServer.h"
+#include <cstdlib>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// 一次抓取一个连接，回包后关闭
+class MetricsConnection :public std::enable_shared_from_this<MetricsConnection>
+{
+public:
+	MetricsConnection(tcp::socket socket, std::weak_ptr<CServer> server) :_socket(std::move(socket)),
+		_server(std::move(server)), _deadline(_socket.get_executor(), std::chrono::seconds(10)) {
+	}
+
+	void Start() {
+		auto self = shared_from_this();
+		http::async_read(_socket, _buffer, _request, [self](beast::error_code ec, std::size_t) {
+			if (ec) {
+				LOG_DEBUG("metrics read failed, error is " << ec.message());
+				return;
+			}
+			self->HandleReq();
+		});
+		_deadline.async_wait([self](beast::error_code ec) {
+			if (!ec) {
+				//超时未完成的请求直接关闭
+				self->_socket.close(ec);
+			}
+		});
+	}
+
+private:
+	void HandleReq() {
+		_response.version(_request.version());
+		_response.keep_alive(false);
+		_response.set(http::field::server, "ChatServer");
+		auto target = _request.target();
+		if (_request.method() == http::verb::post && (target == "/notice" || target.starts_with("/notice?"))) {
+			HandleNotice(target);
+		}
+		else if (_request.method() != http::verb::get || target != "/metrics") {
+			Reply(http::status::not_found, "not found\n");
+		}
+		else {
+			_response.result(http::status::ok);
+			_response.set(http::field::content_type, "text/plain; version=0.0.4");
+			_response.body() = Metrics::Inst().Export();
+		}
+		_response.prepare_payload();
+
+		auto self = shared_from_this();
+		http::async_write(_socket, _response, [self](beast::error_code ec, std::size_t) {
+			self->_socket.shutdown(tcp::socket::shutdown_send, ec);
+			self->_deadline.cancel();
+		});
+	}
+
+	// POST /notice?type=N，公告内容为请求体，超过短头部长度时返回413
+	void HandleNotice(beast::string_view target) {
+		beast::error_code ec;
+		auto remote = _socket.remote_endpoint(ec);
+		if (ec || !remote.address().is_loopback()) {
+			Reply(http::status::forbidden, "forbidden\n");
+			return;
+		}
+		auto server = _server.lock();
+		if (!server) {
+			Reply(http::status::service_unavailable, "server not ready\n");
+			return;
+		}
+		int notice_type = 0;
+		auto pos = target.find("type=");
+		if (pos != beast::string_view::npos) {
+			notice_type = atoi(std::string(target.substr(pos + 5)).c_str());
+		}
+		if (_request.body().empty()) {
+			Reply(http::status::bad_request, "empty notice\n");
+			return;
+		}
+		if (!server->BroadcastNotice(notice_type, _request.body())) {
+			Reply(http::status::payload_too_large, "notice too long\n");
+			return;
+		}
+		LOG_INFO("broadcast notice, type is " << notice_type << ", length is " << _request.body().length());
+		Reply(http::status::ok, "ok\n");
+	}
+
+	void Reply(http::status status, const char* text) {
+		_response.result(status);
+		_response.set(http::field::content_type, "text/plain");
+		_response.body() = text;
+	}
+
+	tcp::socket _socket;
+	std::weak_ptr<CServer> _server;
+	beast::flat_buffer _buffer{ 8192 };
+	http::request<http::string_body> _request;
+	http::response<http::string_body> _response;
+	boost::asio::steady_timer _deadline;
+};
+
+}
+
+MetricsServer::MetricsServer(boost::asio::io_context& io_context, unsigned short port)
+	:_io_context(io_context), _acceptor(io_context, tcp::endpoint(tcp::v4(), port)) {
+	LOG_INFO("metrics server listen on port : " << port);
+}
+
+void MetricsServer::Start() {
+	StartAccept();
+}
+
+void MetricsServer::SetServer(std::shared_ptr<CServer> server) {
+	_server = server;
+}
+
+void MetricsServer::Stop() {
+	boost::system::error_code ec;
+	_acceptor.close(ec);
+}
+
+void MetricsServer::StartAccept() {
+	auto self = shared_from_this();
+	_acceptor.async_accept(_io_context, [self](beast::error_code ec, tcp::socket socket) {
+		if (ec == boost::asio::error::operation_aborted) {
+			return;
+		}
+		if (!ec) {
+			std::make_shared<MetricsConnection>(std::move(socket), self->_server)->Start();
+		}
+		else {
+			LOG_WARN("metrics accept failed, error is " << ec.message());
+		}
+		self->StartAccept();
+	});
+}
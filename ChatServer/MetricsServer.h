@@ -0,0 +1,24 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <memory>
+
+class CServer;
+
+// 指标导出的http服务，GET /metrics 返回Metrics::Export()的内容，供Prometheus抓取
+// 另外提供运维入口 POST /notice?type=N，请求体为公告内容，广播给所有在线用户，只接受本机请求
+// 运行在主io_context上，不占用处理客户端连接的io线程
+class MetricsServer :public std::enable_shared_from_this<MetricsServer>
+{
+public:
+	MetricsServer(boost::asio::io_context& io_context, unsigned short port);
+	void Start();
+	void Stop();
+	// 注册后才处理 /notice 请求
+	void SetServer(std::shared_ptr<CServer> server);
+private:
+	void StartAccept();
+	boost::asio::io_context& _io_context;
+	boost::asio::ip::tcp::acceptor _acceptor;
+	std::weak_ptr<CServer> _server;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+
+// 多生产者单消费者无锁队列(Vyukov)
+// 1. Push可以在任意线程调用，只有一次原子exchange，不会阻塞
+// 2. Pop只能在唯一的消费者线程调用
+// 3. 生产者在exchange之后、链接next之前的短暂窗口内，消费者会暂时看不到后续元素，
+//    调用方需要在Push完成后再通知消费者(例如投递到消费者的io_context)
+// 4. 每次Push分配一个链表节点，可以传入MsgPoolAllocator让节点从内存池分配
+template <typename T, typename Alloc = std::allocator<T>>
+class MpscQueue
+{
+public:
+	MpscQueue() :_head(&_stub), _tail(&_stub) {
+		_stub._next.store(nullptr, std::memory_order_relaxed);
+	}
+
+	~MpscQueue() {
+		T value;
+		while (Pop(value)) {
+		}
+		if (_tail != &_stub) {
+			DestroyNode(_tail);
+		}
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	void Push(T value) {
+		Node* node = NodeTraits::allocate(_alloc, 1);
+		NodeTraits::construct(_alloc, node, std::move(value));
+		Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+		prev->_next.store(node, std::memory_order_release);
+	}
+
+	bool Pop(T& value) {
+		Node* tail = _tail;
+		Node* next = tail->_next.load(std::memory_order_acquire);
+		if (next == nullptr) {
+			return false;
+		}
+		//next成为新的哨兵，取走它的值后释放旧的哨兵
+		value = std::move(next->_value);
+		next->_value = T();
+		_tail = next;
+		if (tail != &_stub) {
+			DestroyNode(tail);
+		}
+		return true;
+	}
+
+	// 只能在消费者线程调用
+	bool Empty() const {
+		return _tail->_next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	struct Node {
+		Node() :_next(nullptr) {}
+		explicit Node(T value) :_next(nullptr), _value(std::move(value)) {}
+		std::atomic<Node*> _next;
+		T _value;
+	};
+	using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+	using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+	void DestroyNode(Node* node) {
+		NodeTraits::destroy(_alloc, node);
+		NodeTraits::deallocate(_alloc, node, 1);
+	}
+
+	std::atomic<Node*> _head;
+	Node* _tail;
+	Node _stub;
+	NodeAlloc _alloc;
+};
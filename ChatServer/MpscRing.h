@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// 有界的多生产者单消费者环形队列(Vyukov bounded queue)
+// 1. 容量在构造时确定，向上取整到2的幂，队列满时TryPush直接返回false，由调用方决定丢弃还是拒绝
+// 2. TryPush可以在任意线程调用，只有一次CAS，不分配内存也不加锁
+// 3. Pop只能在唯一的消费者线程调用
+// 4. 生产者CAS占位之后、写入序号之前的短暂窗口内，消费者会暂时看不到该位置及之后的元素，
+//    调用方需要在TryPush完成后再通知消费者(例如投递到消费者的io_context)
+template <typename T>
+class MpscRing
+{
+public:
+	explicit MpscRing(std::size_t capacity) :_mask(RoundUp(capacity) - 1),
+		_cells(new Cell[_mask + 1]), _enqueue_pos(0), _dequeue_pos(0) {
+		for (std::size_t i = 0; i <= _mask; ++i) {
+			_cells[i]._seq.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MpscRing(const MpscRing&) = delete;
+	MpscRing& operator=(const MpscRing&) = delete;
+
+	bool TryPush(T value) {
+		Cell* cell = nullptr;
+		std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+		for (;;) {
+			cell = &_cells[pos & _mask];
+			std::size_t seq = cell->_seq.load(std::memory_order_acquire);
+			intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if (dif == 0) {
+				if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (dif < 0) {
+				//该位置上一轮的元素还没有被取走，队列已满
+				return false;
+			}
+			else {
+				pos = _enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		cell->_value = std::move(value);
+		cell->_seq.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& value) {
+		Cell* cell = &_cells[_dequeue_pos & _mask];
+		if (cell->_seq.load(std::memory_order_acquire) != _dequeue_pos + 1) {
+			return false;
+		}
+		value = std::move(cell->_value);
+		cell->_value = T();
+		//下一轮的生产者可以使用该位置
+		cell->_seq.store(_dequeue_pos + _mask + 1, std::memory_order_release);
+		++_dequeue_pos;
+		return true;
+	}
+
+	std::size_t Capacity() const {
+		return _mask + 1;
+	}
+
+private:
+	static std::size_t RoundUp(std::size_t capacity) {
+		std::size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		return size;
+	}
+
+	struct Cell {
+		std::atomic<std::size_t> _seq;
+		T _value;
+	};
+
+	const std::size_t _mask;
+	std::unique_ptr<Cell[]> _cells;
+	// 生产者和消费者的位置用填充隔开，避免在同一缓存行上互相失效
+	char _pad0[64];
+	std::atomic<std::size_t> _enqueue_pos;
+	char _pad1[64];
+	std::size_t _dequeue_pos;
+};
@@ -1,14 +1,86 @@
 #include "MsgNode.h"
-RecvNode::RecvNode(short max_len, short msg_id):MsgNode(max_len),
-_msg_id(msg_id){
+#include "Metrics.h"
+#include "Logger.h"
+RecvNode::RecvNode(int max_len, short msg_id):MsgNode(max_len),
+_msg_id(msg_id), _codec(ClientCodec::Json){
 
 }
 
+RecvNode::RecvNode(std::shared_ptr<char> holder, char* data, int len, short msg_id)
+	:MsgNode(holder, data, len), _msg_id(msg_id), _codec(ClientCodec::Json) {
+
+}
+
+int ParseMsgHead(const char* head, std::size_t len, std::size_t max_ext_length,
+	short& msg_id, std::size_t& msg_len, unsigned short& flags)
+{
+	if (len < HEAD_TOTAL_LEN) {
+		return 0;
+	}
+
+	//ȡͷMSGIDݣֽתΪֽ
+	unsigned short raw_id = 0;
+	memcpy(&raw_id, head, HEAD_ID_LEN);
+	raw_id = boost::asio::detail::socket_ops::network_to_host_short(raw_id);
+	msg_id = static_cast<short>(raw_id & ~(HEAD_EXT_FLAG | HEAD_COMPRESS_FLAG | HEAD_PROTO_FLAG));
+	//idǷ
+	if (msg_id > MAX_LENGTH) {
+		LOG_ERROR("invalid msg_id is " << msg_id);
+		return -1;
+	}
+	flags = raw_id & (HEAD_COMPRESS_FLAG | HEAD_PROTO_FLAG);
+
+	if (!(raw_id & HEAD_EXT_FLAG)) {
+		short short_len = 0;
+		memcpy(&short_len, head + HEAD_ID_LEN, HEAD_DATA_LEN);
+		short_len = boost::asio::detail::socket_ops::network_to_host_short(short_len);
+		//ȷǷ
+		if (short_len < 0 || short_len > MAX_LENGTH) {
+			LOG_ERROR("invalid data length is " << short_len);
+			return -1;
+		}
+		msg_len = short_len;
+		return HEAD_TOTAL_LEN;
+	}
+
+	//ûЭչͷ
+	if (max_ext_length == 0) {
+		LOG_ERROR("ext head not accepted, msg_id is " << msg_id);
+		return -1;
+	}
+
+	//չͷֶΪ4ֽ
+	if (len < HEAD_EXT_TOTAL_LEN) {
+		return 0;
+	}
+
+	uint32_t ext_len = 0;
+	memcpy(&ext_len, head + HEAD_ID_LEN, HEAD_EXT_DATA_LEN);
+	ext_len = boost::asio::detail::socket_ops::network_to_host_long(ext_len);
+	if (ext_len > max_ext_length) {
+		LOG_ERROR("invalid ext data length is " << ext_len);
+		return -1;
+	}
+	msg_len = ext_len;
+	return HEAD_EXT_TOTAL_LEN;
+}
+
+SendNode::SendNode(const char* msg, int max_len, short msg_id, bool ext_head, unsigned short flags)
+	:MsgNode(max_len + (ext_head ? HEAD_EXT_TOTAL_LEN : HEAD_TOTAL_LEN)), _msg_id(msg_id), _create_ns(Metrics::NowNs()){
+	unsigned short flag_id = static_cast<unsigned short>(msg_id) | flags;
+	if (ext_head) {
+		//չͷidλλֶΪ4ֽ
+		unsigned short ext_id = flag_id | HEAD_EXT_FLAG;
+		ext_id = boost::asio::detail::socket_ops::host_to_network_short(ext_id);
+		memcpy(_data, &ext_id, HEAD_ID_LEN);
+		uint32_t ext_len = boost::asio::detail::socket_ops::host_to_network_long(max_len);
+		memcpy(_data + HEAD_ID_LEN, &ext_len, HEAD_EXT_DATA_LEN);
+		memcpy(_data + HEAD_EXT_TOTAL_LEN, msg, max_len);
+		return;
+	}
 
-SendNode::SendNode(const char* msg, short max_len, short msg_id):MsgNode(max_len + HEAD_TOTAL_LEN)
-, _msg_id(msg_id){
 	//ȷid, תΪֽ
-	short msg_id_host = boost::asio::detail::socket_ops::host_to_network_short(msg_id);
+	unsigned short msg_id_host = boost::asio::detail::socket_ops::host_to_network_short(flag_id);
 	memcpy(_data, &msg_id_host, HEAD_ID_LEN);
 	//תΪֽ
 	short max_len_host = boost::asio::detail::socket_ops::host_to_network_short(max_len);
@@ -3,20 +3,25 @@
 #include "const.h"
 #include <iostream>
 #include <boost/asio.hpp>
+#include "MsgPool.h"
 using namespace std;
 using boost::asio::ip::tcp;
 class LogicSystem;
 class MsgNode
 {
 public:
-	MsgNode(short max_len) :_total_len(max_len), _cur_len(0) {
-		_data = new char[_total_len + 1]();
+	//从内存池分配，不做清零，使用方按_cur_len读取
+	MsgNode(int max_len) :_total_len(max_len), _cur_len(0) {
+		_data = MsgPool::Inst().Allocate(_total_len + 1);
 		_data[_total_len] = '\0';
 	}
 
+	//写完成或者逻辑层处理完后释放节点，内存归还内存池
 	~MsgNode() {
-		std::cout << "destruct MsgNode" << endl;
-		delete[] _data;
+		//引用接收缓冲区的切片不持有内存
+		if (!_holder) {
+			MsgPool::Inst().Free(_data, _total_len + 1);
+		}
 	}
 
 	void Clear() {
@@ -24,24 +29,50 @@ public:
 		_cur_len = 0;
 	}
 
-	short _cur_len;
-	short _total_len;
+	//扩展头部的消息体长度为32位，这里不能再用short
+	int _cur_len;
+	int _total_len;
 	char* _data;
+protected:
+	//引用接收缓冲区中的一段内存，holder保证内存在节点销毁前有效
+	MsgNode(std::shared_ptr<char> holder, char* data, int len) :_cur_len(len), _total_len(len),
+		_data(data), _holder(holder) {
+	}
+	std::shared_ptr<char> _holder;
 };
 
 class RecvNode :public MsgNode {
 	friend class LogicSystem;
 public:
-	RecvNode(short max_len, short msg_id);
+	RecvNode(int max_len, short msg_id);
+	//切片节点，消息体直接引用接收缓冲区，不拷贝
+	RecvNode(std::shared_ptr<char> holder, char* data, int len, short msg_id);
+	//消息体的编码方式，由头部的HEAD_PROTO_FLAG决定
+	void SetCodec(ClientCodec codec) { _codec = codec; }
 private:
 	short _msg_id;
+	ClientCodec _codec;
 };
 
+// 解析消息头部，返回头部长度(普通头部或扩展头部)，数据不足返回0，头部非法返回-1
+// flags为头部中的HEAD_COMPRESS_FLAG、HEAD_PROTO_FLAG，是否允许压缩由调用方检查
+// max_ext_length为0表示不接受扩展头部，读到长度字段之前即返回-1
+int ParseMsgHead(const char* head, std::size_t len, std::size_t max_ext_length,
+	short& msg_id, std::size_t& msg_len, unsigned short& flags);
+
 class SendNode:public MsgNode {
 	friend class LogicSystem;
 public:
-	SendNode(const char* msg,short max_len, short msg_id);
+	//ext_head为true时使用扩展头部(id最高位置位，长度字段4字节)，需要客户端在登录时协商
+	//flags为HEAD_COMPRESS_FLAG、HEAD_PROTO_FLAG的组合，写入消息id的高位
+	SendNode(const char* msg, int max_len, short msg_id, bool ext_head = false, unsigned short flags = 0);
+	short GetMsgId() const { return _msg_id; }
+	//组包时间(Metrics::NowNs)，写完成时统计发送耗时，常量帧为0
+	int64_t GetCreateTime() const { return _create_ns; }
+	//预先组好、反复发送的常量帧(如心跳回包)，组包时间没有意义，写完成时不统计发送耗时
+	void SetConstant() { _create_ns = 0; }
 private:
 	short _msg_id;
+	int64_t _create_ns;
 };
 
@@ -0,0 +1,214 @@
+#include "MsgPool.h"
+#include "ConfigMgr.h"
+#include <algorithm>
+
+// 每个线程每个级别最多缓存的字节数
+static const std::size_t LOCAL_CACHE_BYTES = 256 * 1024;
+
+// 线程本地缓存，线程退出时把空闲块归还给全局链表
+struct MsgPoolLocalCache {
+	MsgPoolLocalCache() :_alloc_count(0), _hit_count(0), _miss_count(0), _oversize_count(0),
+		_bytes_held(0), _bytes_in_use(0) {
+		MsgPool::Inst().RegisterCache(this);
+	}
+
+	~MsgPoolLocalCache() {
+		auto& pool = MsgPool::Inst();
+		for (int cls = 0; cls < static_cast<int>(MsgPool::CLASS_COUNT); ++cls) {
+			pool.Spill(cls, _lists[cls], 0);
+		}
+		pool.UnregisterCache(this);
+	}
+
+	std::vector<char*> _lists[MsgPool::CLASS_COUNT];
+	std::atomic<uint64_t> _alloc_count;
+	std::atomic<uint64_t> _hit_count;
+	std::atomic<uint64_t> _miss_count;
+	std::atomic<uint64_t> _oversize_count;
+	//本线程缓存的字节数，以及本线程分配/释放导致的使用量变化(可能为负，汇总后才有意义)
+	std::atomic<int64_t> _bytes_held;
+	std::atomic<int64_t> _bytes_in_use;
+};
+
+static MsgPoolLocalCache& LocalCache() {
+	thread_local MsgPoolLocalCache cache;
+	return cache;
+}
+
+// 只有本线程写，relaxed即可
+static void Add(std::atomic<uint64_t>& counter, uint64_t v) {
+	counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+static void Add(std::atomic<int64_t>& counter, int64_t v) {
+	counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+MsgPool& MsgPool::Inst() {
+	static MsgPool pool;
+	return pool;
+}
+
+MsgPool::MsgPool() :_max_hold_bytes(64 * 1024 * 1024), _global_bytes(0), _retired() {
+	auto hold = ConfigMgr::Inst()["MsgPool"]["MaxHoldBytes"];
+	if (!hold.empty()) {
+		_max_hold_bytes = std::stoll(hold);
+	}
+}
+
+MsgPool::~MsgPool() {
+	for (auto& list : _global) {
+		std::lock_guard<std::mutex> lock(list._mtx);
+		for (auto* block : list._blocks) {
+			delete[] block;
+		}
+		list._blocks.clear();
+	}
+}
+
+int MsgPool::SizeClass(std::size_t size) {
+	if (size > MAX_BLOCK) {
+		return -1;
+	}
+
+	int cls = 0;
+	std::size_t block = MIN_BLOCK;
+	while (block < size) {
+		block <<= 1;
+		++cls;
+	}
+	return cls;
+}
+
+std::size_t MsgPool::ClassSize(int cls) {
+	return MIN_BLOCK << cls;
+}
+
+char* MsgPool::Allocate(std::size_t size) {
+	auto& cache = LocalCache();
+	Add(cache._alloc_count, 1);
+	int cls = SizeClass(size);
+	//超出最大级别，直接向系统申请
+	if (cls < 0) {
+		Add(cache._oversize_count, 1);
+		Add(cache._miss_count, 1);
+		Add(cache._bytes_in_use, static_cast<int64_t>(size));
+		return new char[size];
+	}
+
+	auto block_size = static_cast<int64_t>(ClassSize(cls));
+	Add(cache._bytes_in_use, block_size);
+	auto& local = cache._lists[cls];
+	if (local.empty()) {
+		Refill(cls, local);
+	}
+
+	if (local.empty()) {
+		Add(cache._miss_count, 1);
+		return new char[block_size];
+	}
+
+	Add(cache._hit_count, 1);
+	Add(cache._bytes_held, -block_size);
+	char* block = local.back();
+	local.pop_back();
+	return block;
+}
+
+void MsgPool::Free(char* ptr, std::size_t size) {
+	if (ptr == nullptr) {
+		return;
+	}
+
+	auto& cache = LocalCache();
+	int cls = SizeClass(size);
+	if (cls < 0) {
+		Add(cache._bytes_in_use, -static_cast<int64_t>(size));
+		delete[] ptr;
+		return;
+	}
+
+	auto block_size = ClassSize(cls);
+	Add(cache._bytes_in_use, -static_cast<int64_t>(block_size));
+	Add(cache._bytes_held, static_cast<int64_t>(block_size));
+	auto& local = cache._lists[cls];
+	local.push_back(ptr);
+	//线程缓存满了，归还一半给全局链表
+	auto capacity = (std::max)(LOCAL_CACHE_BYTES / block_size, static_cast<std::size_t>(4));
+	if (local.size() > capacity) {
+		Spill(cls, local, capacity / 2);
+	}
+}
+
+void MsgPool::Refill(int cls, std::vector<char*>& local) {
+	auto block_size = ClassSize(cls);
+	auto batch = (std::max)(LOCAL_CACHE_BYTES / block_size / 2, static_cast<std::size_t>(2));
+	auto& list = _global[cls];
+	std::size_t moved = 0;
+	{
+		std::lock_guard<std::mutex> lock(list._mtx);
+		moved = (std::min)(batch, list._blocks.size());
+		local.insert(local.end(), list._blocks.end() - moved, list._blocks.end());
+		list._blocks.resize(list._blocks.size() - moved);
+	}
+
+	auto bytes = static_cast<int64_t>(moved * block_size);
+	_global_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+	Add(LocalCache()._bytes_held, bytes);
+}
+
+void MsgPool::Spill(int cls, std::vector<char*>& local, std::size_t keep) {
+	if (local.size() <= keep) {
+		return;
+	}
+
+	auto block_size = static_cast<int64_t>(ClassSize(cls));
+	auto count = local.size() - keep;
+	Add(LocalCache()._bytes_held, -static_cast<int64_t>(count) * block_size);
+
+	//全局缓存超过上限的部分直接释放
+	auto room = (_max_hold_bytes - _global_bytes.load(std::memory_order_relaxed)) / block_size;
+	auto to_global = static_cast<std::size_t>((std::max)(static_cast<int64_t>(0),
+		(std::min)(room, static_cast<int64_t>(count))));
+	if (to_global > 0) {
+		auto& list = _global[cls];
+		std::lock_guard<std::mutex> lock(list._mtx);
+		list._blocks.insert(list._blocks.end(), local.end() - to_global, local.end());
+	}
+	_global_bytes.fetch_add(static_cast<int64_t>(to_global) * block_size, std::memory_order_relaxed);
+
+	for (std::size_t i = keep; i < local.size() - to_global; ++i) {
+		delete[] local[i];
+	}
+	local.resize(keep);
+}
+
+void MsgPool::RegisterCache(MsgPoolLocalCache* cache) {
+	std::lock_guard<std::mutex> lock(_cache_mtx);
+	_caches.push_back(cache);
+}
+
+void MsgPool::UnregisterCache(MsgPoolLocalCache* cache) {
+	std::lock_guard<std::mutex> lock(_cache_mtx);
+	_retired._alloc_count += cache->_alloc_count;
+	_retired._hit_count += cache->_hit_count;
+	_retired._miss_count += cache->_miss_count;
+	_retired._oversize_count += cache->_oversize_count;
+	_retired._bytes_in_use += cache->_bytes_in_use;
+	_caches.erase(std::remove(_caches.begin(), _caches.end(), cache), _caches.end());
+}
+
+MsgPool::Stats MsgPool::GetStats() const {
+	std::lock_guard<std::mutex> lock(_cache_mtx);
+	Stats stats = _retired;
+	stats._bytes_held = _global_bytes.load(std::memory_order_relaxed);
+	for (auto* cache : _caches) {
+		stats._alloc_count += cache->_alloc_count.load(std::memory_order_relaxed);
+		stats._hit_count += cache->_hit_count.load(std::memory_order_relaxed);
+		stats._miss_count += cache->_miss_count.load(std::memory_order_relaxed);
+		stats._oversize_count += cache->_oversize_count.load(std::memory_order_relaxed);
+		stats._bytes_held += cache->_bytes_held.load(std::memory_order_relaxed);
+		stats._bytes_in_use += cache->_bytes_in_use.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
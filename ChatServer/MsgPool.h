@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+struct MsgPoolLocalCache;
+
+// 消息缓冲区内存池
+// 1. 按大小分级(64B ~ 64KB)，超过最大级别的直接向系统申请
+// 2. 每个线程有自己的空闲链表缓存，io_context各自跑在独立线程上，因此相当于每个io_context一份
+// 3. 线程缓存满了批量归还到全局链表，空了从全局链表批量取，全局链表按级别加锁
+// 4. 分配出的内存不做清零
+class MsgPool
+{
+public:
+	struct Stats {
+		uint64_t _alloc_count;   // 分配次数
+		uint64_t _hit_count;     // 命中空闲链表的次数
+		uint64_t _miss_count;    // 向系统申请的次数
+		uint64_t _oversize_count;// 超过最大级别的分配次数
+		int64_t _bytes_held;     // 池中缓存的空闲内存字节数
+		int64_t _bytes_in_use;   // 已分配给消息使用的字节数
+		double HitRate() const {
+			return _alloc_count == 0 ? 0.0 : static_cast<double>(_hit_count) / _alloc_count;
+		}
+	};
+
+	static MsgPool& Inst();
+	~MsgPool();
+	MsgPool(const MsgPool&) = delete;
+	MsgPool& operator=(const MsgPool&) = delete;
+
+	char* Allocate(std::size_t size);
+	// size必须与Allocate时传入的大小一致
+	void Free(char* ptr, std::size_t size);
+	Stats GetStats() const;
+
+	static const std::size_t MIN_BLOCK = 64;
+	static const std::size_t CLASS_COUNT = 11;  // 64B ~ 64KB
+	static const std::size_t MAX_BLOCK = MIN_BLOCK << (CLASS_COUNT - 1);
+
+private:
+	MsgPool();
+	friend struct MsgPoolLocalCache;
+	static int SizeClass(std::size_t size);
+	static std::size_t ClassSize(int cls);
+	// 线程缓存与全局链表之间批量搬运
+	void Refill(int cls, std::vector<char*>& local);
+	void Spill(int cls, std::vector<char*>& local, std::size_t keep);
+	// 线程缓存的注册与注销，注销时把统计数据合并到_retired
+	void RegisterCache(MsgPoolLocalCache* cache);
+	void UnregisterCache(MsgPoolLocalCache* cache);
+
+	struct FreeList {
+		std::mutex _mtx;
+		std::vector<char*> _blocks;
+	};
+	FreeList _global[CLASS_COUNT];
+	// 全局链表最多缓存的字节数，超过后直接释放
+	int64_t _max_hold_bytes;
+	std::atomic<int64_t> _global_bytes;
+
+	//各线程的统计只由本线程写，读取时汇总，避免热路径上争用同一个原子变量
+	mutable std::mutex _cache_mtx;
+	std::vector<MsgPoolLocalCache*> _caches;
+	Stats _retired;
+};
+
+// 供allocate_shared使用的分配器，让节点对象和shared_ptr控制块也从内存池分配
+template <typename T>
+class MsgPoolAllocator {
+public:
+	using value_type = T;
+	MsgPoolAllocator() = default;
+	template <typename U>
+	MsgPoolAllocator(const MsgPoolAllocator<U>&) {}
+
+	T* allocate(std::size_t n) {
+		return reinterpret_cast<T*>(MsgPool::Inst().Allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, std::size_t n) {
+		MsgPool::Inst().Free(reinterpret_cast<char*>(p), n * sizeof(T));
+	}
+
+	template <typename U>
+	bool operator==(const MsgPoolAllocator<U>&) const { return true; }
+	template <typename U>
+	bool operator!=(const MsgPoolAllocator<U>&) const { return false; }
+};
+
+// 从内存池创建节点，用法同make_shared
+template <typename T, typename... Args>
+std::shared_ptr<T> MakePooled(Args&&... args) {
+	return std::allocate_shared<T>(MsgPoolAllocator<T>(), std::forward<Args>(args)...);
+}
@@ -1,4 +1,5 @@
 #include "MysqlDao.h"
+#include "Logger.h"
 #include "ConfigMgr.h"
 
 MysqlDao::MysqlDao()
@@ -9,7 +10,17 @@ MysqlDao::MysqlDao()
 	const auto& pwd = cfg["Mysql"]["Passwd"];
 	const auto& schema = cfg["Mysql"]["Schema"];
 	const auto& user = cfg["Mysql"]["User"];
-	pool_.reset(new MySqlPool(host+":"+port, user, pwd,schema, 5));
+	//ÿ߼߳ͬʱռһӣӦ߼߳
+	const auto& pool_size = cfg["Mysql"]["PoolSize"];
+	pool_.reset(new MySqlPool(host+":"+port, user, pwd,schema, pool_size.empty() ? 5 : atoi(pool_size.c_str())));
+
+	auto* pool = pool_.get();
+	Metrics::Inst().AddGauge("chat_mysql_pool_size", "Configured mysql connection pool size.", [pool]() {
+		return static_cast<double>(pool->PoolSize());
+	});
+	Metrics::Inst().AddGauge("chat_mysql_pool_idle", "Idle mysql connections in the pool.", [pool]() {
+		return static_cast<double>(pool->IdleCount());
+	});
 }
 
 MysqlDao::~MysqlDao(){
@@ -40,7 +51,7 @@ int MysqlDao::RegUser(const std::string& name, const std::string& email, const s
 	  std::unique_ptr<sql::ResultSet> res(stmtResult->executeQuery("SELECT @result AS result"));
 	  if (res->next()) {
 	       int result = res->getInt("result");
-	      std::cout << "Result: " << result << std::endl;
+	      LOG_DEBUG("Result: " << result);
 		  pool_->returnConnection(std::move(con));
 		  return result;
 	  }
@@ -49,9 +60,8 @@ int MysqlDao::RegUser(const std::string& name, const std::string& email, const s
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return -1;
 	}
 }
@@ -74,7 +84,7 @@ bool MysqlDao::CheckEmail(const std::string& name, const std::string& email) {
 
 		// 
 		while (res->next()) {
-			std::cout << "Check Email: " << res->getString("email") << std::endl;
+			LOG_DEBUG("Check Email: " << res->getString("email"));
 			if (email != res->getString("email")) {
 				pool_->returnConnection(std::move(con));
 				return false;
@@ -86,9 +96,8 @@ bool MysqlDao::CheckEmail(const std::string& name, const std::string& email) {
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -110,15 +119,14 @@ bool MysqlDao::UpdatePwd(const std::string& name, const std::string& newpwd) {
 		// ִи
 		int updateCount = pstmt->executeUpdate();
 
-		std::cout << "Updated rows: " << updateCount << std::endl;
+		LOG_DEBUG("Updated rows: " << updateCount);
 		pool_->returnConnection(std::move(con));
 		return true;
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -145,7 +153,7 @@ bool MysqlDao::CheckPwd(const std::string& name, const std::string& pwd, UserInf
 		while (res->next()) {
 			origin_pwd = res->getString("pwd");
 			// ѯ
-			std::cout << "Password: " << origin_pwd << std::endl;
+			LOG_DEBUG("Password: " << origin_pwd);
 			break;
 		}
 
@@ -159,9 +167,8 @@ bool MysqlDao::CheckPwd(const std::string& name, const std::string& pwd, UserInf
 		return true;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -191,9 +198,8 @@ bool MysqlDao::AddFriendApply(const int& from, const int& to)
 		return true;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 	// ĬϷسɹ
@@ -225,9 +231,8 @@ bool MysqlDao::AuthFriendApply(const int& from, const int& to) {
 		return true;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 
@@ -282,7 +287,7 @@ bool MysqlDao::AddFriend(const int& from, const int& to, std::string back_name)
 
 		// ύ
 		con->_con->commit();
-		std::cout << "addfriend insert friends success" << std::endl;
+		LOG_DEBUG("addfriend insert friends success");
 
 		return true;
 	}
@@ -291,9 +296,8 @@ bool MysqlDao::AddFriend(const int& from, const int& to, std::string back_name)
 		if (con) {
 			con->_con->rollback();
 		}
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 
@@ -336,9 +340,8 @@ std::shared_ptr<UserInfo> MysqlDao::GetUser(int uid)
 		return user_ptr;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return nullptr;
 	}
 }
@@ -377,9 +380,8 @@ std::shared_ptr<UserInfo> MysqlDao::GetUser(std::string name)
 		return user_ptr;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return nullptr;
 	}
 }
@@ -420,9 +422,8 @@ bool MysqlDao::GetApplyList(int touid, std::vector<std::shared_ptr<ApplyInfo>>&
 		return true;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -463,9 +464,8 @@ bool MysqlDao::GetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo>
 		return true;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 
@@ -1,5 +1,8 @@
 #pragma once
 #include "const.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "OverloadCtrl.h"
 #include <thread>
 #include <jdbc/mysql_driver.h>
 #include <jdbc/mysql_connection.h>
@@ -22,7 +25,8 @@ public:
 class MySqlPool {
 public:
 	MySqlPool(const std::string& url, const std::string& user, const std::string& pass, const std::string& schema, int poolSize)
-		: url_(url), user_(user), pass_(pass), schema_(schema), poolSize_(poolSize), b_stop_(false), _fail_count(0){
+		: url_(url), user_(user), pass_(pass), schema_(schema), poolSize_(poolSize), b_stop_(false), _fail_count(0),
+		_wait_hist(&Metrics::Inst().GetHistogram("chat_mysql_pool_wait_seconds", "Time spent waiting for a mysql connection.")){
 		try {
 			for (int i = 0; i < poolSize_; ++i) {
 				sql::mysql::MySQL_Driver* driver = sql::mysql::get_mysql_driver_instance();
@@ -33,7 +37,7 @@ public:
 				// ʱתΪ
 				long long timestamp = std::chrono::duration_cast<std::chrono::seconds>(currentTime).count();
 				pool_.push(std::make_unique<SqlConnection>(con, timestamp));
-				std::cout << "mysql connection init success" << std::endl;
+				LOG_INFO("mysql connection init success");
 			}
 
 			_check_thread = 	std::thread([this]() {
@@ -52,7 +56,7 @@ public:
 		}
 		catch (sql::SQLException& e) {
 			// 쳣
-			std::cout << "mysql pool init failed, error is " << e.what()<< std::endl;
+			LOG_ERROR("mysql pool init failed, error is " << e.what());
 		}
 	}
 
@@ -91,7 +95,7 @@ public:
 					con->_last_oper_time = timestamp;
 				}
 				catch (sql::SQLException& e) {
-					std::cout << "Error keeping connection alive: " << e.what() << std::endl;
+					LOG_ERROR("Error keeping connection alive: " << e.what());
 					healthy = false;
 					_fail_count++;
 				}
@@ -131,12 +135,12 @@ public:
 				std::lock_guard<std::mutex> guard(mutex_);
 				pool_.push(std::move(newCon));
 			}
-			std::cout << "mysql connection reconnect success" << std::endl;
+			LOG_INFO("mysql connection reconnect success");
 			return true;
 
 		}
 		catch (sql::SQLException& e) {
-			std::cout << "Reconnect failed, error is " << e.what() << std::endl;
+			LOG_ERROR("Reconnect failed, error is " << e.what());
 			return false;
 		}
 	}
@@ -167,7 +171,7 @@ public:
 				//std::cout << "execute timer alive query , cur is " << timestamp << std::endl;
 			}
 			catch (sql::SQLException& e) {
-				std::cout << "Error keeping connection alive: " << e.what() << std::endl;
+				LOG_ERROR("Error keeping connection alive: " << e.what());
 				// ´Ӳ滻ɵ
 				sql::mysql::MySQL_Driver* driver = sql::mysql::get_mysql_driver_instance();
 				auto* newcon = driver->connect(url_, user_, pass_);
@@ -179,12 +183,16 @@ public:
 	}
 
 	std::unique_ptr<SqlConnection> getConnection() {
+		auto start = Metrics::NowNs();
 		std::unique_lock<std::mutex> lock(mutex_);
 		cond_.wait(lock, [this] { 
 			if (b_stop_) {
 				return true;
 			}		
 			return !pool_.empty(); });
+		auto wait = Metrics::NowNs() - start;
+		_wait_hist->Record(wait);
+		OverloadCtrl::Inst().Record(OverloadSignal::MysqlWait, wait);
 		if (b_stop_) {
 			return nullptr;
 		}
@@ -193,6 +201,16 @@ public:
 		return con;
 	}
 
+	// ӳռ
+	size_t IdleCount() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return pool_.size();
+	}
+
+	size_t PoolSize() const {
+		return poolSize_;
+	}
+
 	void returnConnection(std::unique_ptr<SqlConnection> con) {
 		std::unique_lock<std::mutex> lock(mutex_);
 		if (b_stop_) {
@@ -226,6 +244,8 @@ private:
 	std::atomic<bool> b_stop_;
 	std::thread _check_thread;
 	std::atomic<int> _fail_count;
+	// getConnectionĵȴʱ
+	LatencyHistogram* _wait_hist;
 };
 
 
@@ -56,3 +56,47 @@ bool MysqlMgr::GetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo>
 	return _dao.GetFriendList(self_id, user_info);
 }
 
+
+bool MysqlMgr::AsyncAddFriendApply(int from, int to, boost::asio::yield_context yield) {
+	return AsyncCall<bool>([this, from, to]() {
+		return _dao.AddFriendApply(from, to);
+	}, yield);
+}
+
+bool MysqlMgr::AsyncAuthFriendApply(int from, int to, boost::asio::yield_context yield) {
+	return AsyncCall<bool>([this, from, to]() {
+		return _dao.AuthFriendApply(from, to);
+	}, yield);
+}
+
+bool MysqlMgr::AsyncAddFriend(int from, int to, const std::string& back_name, boost::asio::yield_context yield) {
+	return AsyncCall<bool>([this, from, to, &back_name]() {
+		return _dao.AddFriend(from, to, back_name);
+	}, yield);
+}
+
+std::shared_ptr<UserInfo> MysqlMgr::AsyncGetUser(int uid, boost::asio::yield_context yield) {
+	return AsyncCall<std::shared_ptr<UserInfo>>([this, uid]() {
+		return _dao.GetUser(uid);
+	}, yield);
+}
+
+std::shared_ptr<UserInfo> MysqlMgr::AsyncGetUser(const std::string& name, boost::asio::yield_context yield) {
+	return AsyncCall<std::shared_ptr<UserInfo>>([this, &name]() {
+		return _dao.GetUser(name);
+	}, yield);
+}
+
+bool MysqlMgr::AsyncGetApplyList(int touid, std::vector<std::shared_ptr<ApplyInfo>>& applyList, int begin, int limit,
+	boost::asio::yield_context yield) {
+	return AsyncCall<bool>([this, touid, &applyList, begin, limit]() {
+		return _dao.GetApplyList(touid, applyList, begin, limit);
+	}, yield);
+}
+
+bool MysqlMgr::AsyncGetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo> >& user_info,
+	boost::asio::yield_context yield) {
+	return AsyncCall<bool>([this, self_id, &user_info]() {
+		return _dao.GetFriendList(self_id, user_info);
+	}, yield);
+}
@@ -2,6 +2,7 @@
 #include "const.h"
 #include "MysqlDao.h"
 #include "Singleton.h"
+#include "AsyncCall.h"
 #include <vector>
 
 class MysqlMgr: public Singleton<MysqlMgr>
@@ -20,6 +21,17 @@ public:
 	std::shared_ptr<UserInfo> GetUser(std::string name);
 	bool GetApplyList(int touid, std::vector<std::shared_ptr<ApplyInfo>>& applyList, int begin, int limit=10);
 	bool GetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo> >& user_info);
+
+	// 逻辑层协程使用的异步版本，查询在BlockingPool上执行，等待期间逻辑线程可以处理其他消息
+	bool AsyncAddFriendApply(int from, int to, boost::asio::yield_context yield);
+	bool AsyncAuthFriendApply(int from, int to, boost::asio::yield_context yield);
+	bool AsyncAddFriend(int from, int to, const std::string& back_name, boost::asio::yield_context yield);
+	std::shared_ptr<UserInfo> AsyncGetUser(int uid, boost::asio::yield_context yield);
+	std::shared_ptr<UserInfo> AsyncGetUser(const std::string& name, boost::asio::yield_context yield);
+	bool AsyncGetApplyList(int touid, std::vector<std::shared_ptr<ApplyInfo>>& applyList, int begin, int limit,
+		boost::asio::yield_context yield);
+	bool AsyncGetFriendList(int self_id, std::vector<std::shared_ptr<UserInfo> >& user_info,
+		boost::asio::yield_context yield);
 private:
 	MysqlMgr();
 	MysqlDao  _dao;
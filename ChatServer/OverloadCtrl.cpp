@@ -0,0 +1,159 @@
+#include "OverloadCtrl.h"
+#include "ConfigMgr.h"
+#include "Logger.h"
+#include <string>
+
+namespace {
+
+int64_t GetInt(SectionInfo& section, const std::string& key, int64_t def) {
+	auto value = section[key];
+	return value.empty() ? def : std::stoll(value);
+}
+
+const char* SignalName(int signal) {
+	switch (static_cast<OverloadSignal>(signal)) {
+	case OverloadSignal::QueueDelay:
+		return "queue_delay";
+	case OverloadSignal::RedisWait:
+		return "redis_wait";
+	case OverloadSignal::MysqlWait:
+		return "mysql_wait";
+	case OverloadSignal::IoLag:
+		return "io_lag";
+	default:
+		return "unknown";
+	}
+}
+
+}
+
+OverloadCtrl& OverloadCtrl::Inst() {
+	static OverloadCtrl* inst = new OverloadCtrl();
+	return *inst;
+}
+
+OverloadCtrl::OverloadCtrl() :_b_enable(false), _interval(200), _recover_ratio(0.5), _recover_periods(5),
+_retry_after(5), _b_overloaded(false), _calm_periods(0),
+_active(Metrics::Inst().GetGauge("chat_overload_active", "1 while the server is shedding new connections and logins.")),
+_transitions(Metrics::Inst().GetGauge("chat_overload_transitions_total", "Times the server entered the overloaded state.")),
+_reject_accept(Metrics::Inst().GetGauge("chat_overload_rejected_accept_total", "Connections rejected while overloaded.")),
+_reject_login(Metrics::Inst().GetGauge("chat_overload_rejected_login_total", "Logins rejected while overloaded.")) {
+	auto section = ConfigMgr::Inst()["Overload"];
+	_b_enable = section["Enable"] == "true";
+	_interval = std::chrono::milliseconds((std::max)(static_cast<int64_t>(10), GetInt(section, "Interval", 200)));
+	const int64_t ms = 1000 * 1000;
+	_thresholds[static_cast<int>(OverloadSignal::QueueDelay)] = GetInt(section, "QueueDelay", 500) * ms;
+	//redis、mysql连接池分别配置，未配置时都使用PoolWait
+	auto pool_wait = GetInt(section, "PoolWait", 200);
+	_thresholds[static_cast<int>(OverloadSignal::RedisWait)] = GetInt(section, "RedisPoolWait", pool_wait) * ms;
+	_thresholds[static_cast<int>(OverloadSignal::MysqlWait)] = GetInt(section, "MysqlPoolWait", pool_wait) * ms;
+	_thresholds[static_cast<int>(OverloadSignal::IoLag)] = GetInt(section, "IoLag", 100) * ms;
+	if (!section["RecoverRatio"].empty()) {
+		_recover_ratio = std::stod(section["RecoverRatio"]);
+	}
+	_recover_periods = static_cast<int>((std::max)(static_cast<int64_t>(1), GetInt(section, "RecoverPeriods", 5)));
+	_retry_after = static_cast<int>(GetInt(section, "RetryAfter", 5));
+
+	for (int i = 0; i < static_cast<int>(OverloadSignal::Count); ++i) {
+		_peaks[i].store(0, std::memory_order_relaxed);
+		_signal_ms[i] = &Metrics::Inst().GetGauge(std::string("chat_overload_") + SignalName(i) + "_ms",
+			"Peak value of this overload signal in the last evaluation period.");
+	}
+}
+
+void OverloadCtrl::Start(boost::asio::io_context& main_io, const std::vector<boost::asio::io_context*>& io_contexts) {
+	if (!_b_enable) {
+		LOG_INFO("OverloadCtrl disabled");
+		return;
+	}
+	_eval_timer.reset(new boost::asio::steady_timer(main_io));
+	WaitEvaluate();
+	for (auto* io_context : io_contexts) {
+		_probes.push_back(std::unique_ptr<boost::asio::steady_timer>(new boost::asio::steady_timer(*io_context)));
+	}
+	for (std::size_t i = 0; i < _probes.size(); ++i) {
+		WaitProbe(i);
+	}
+	LOG_INFO("OverloadCtrl start, interval " << _interval.count() << " ms, " << _probes.size() << " io probes");
+}
+
+void OverloadCtrl::Record(OverloadSignal signal, int64_t ns) {
+	if (!_b_enable) {
+		return;
+	}
+	auto& peak = _peaks[static_cast<int>(signal)];
+	int64_t cur = peak.load(std::memory_order_relaxed);
+	while (ns > cur && !peak.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {
+	}
+}
+
+void OverloadCtrl::CountRejectAccept() {
+	_reject_accept.Add(1);
+}
+
+void OverloadCtrl::CountRejectLogin() {
+	_reject_login.Add(1);
+}
+
+void OverloadCtrl::WaitEvaluate() {
+	_eval_timer->expires_after(_interval);
+	_eval_timer->async_wait([this](const boost::system::error_code& ec) {
+		if (ec) {
+			return;
+		}
+		Evaluate();
+		WaitEvaluate();
+	});
+}
+
+void OverloadCtrl::Evaluate() {
+	bool over = false;
+	bool calm = true;
+	int trigger = -1;
+	for (int i = 0; i < static_cast<int>(OverloadSignal::Count); ++i) {
+		int64_t peak = _peaks[i].exchange(0, std::memory_order_relaxed);
+		_signal_ms[i]->Set(peak / (1000 * 1000));
+		if (_thresholds[i] <= 0) {
+			continue;
+		}
+		if (peak > _thresholds[i]) {
+			over = true;
+			trigger = trigger < 0 ? i : trigger;
+		}
+		if (peak > _thresholds[i] * _recover_ratio) {
+			calm = false;
+		}
+	}
+
+	if (!Overloaded()) {
+		if (over) {
+			_b_overloaded.store(true, std::memory_order_relaxed);
+			_calm_periods = 0;
+			_active.Set(1);
+			_transitions.Add(1);
+			LOG_WARN("server overloaded, triggered by " << SignalName(trigger) << ", reject new connections and logins");
+		}
+		return;
+	}
+
+	_calm_periods = calm ? _calm_periods + 1 : 0;
+	if (_calm_periods >= _recover_periods) {
+		_b_overloaded.store(false, std::memory_order_relaxed);
+		_active.Set(0);
+		LOG_INFO("server recovered from overload");
+	}
+}
+
+void OverloadCtrl::WaitProbe(std::size_t index) {
+	auto& probe = *_probes[index];
+	probe.expires_after(_interval);
+	probe.async_wait([this, index](const boost::system::error_code& ec) {
+		if (ec) {
+			return;
+		}
+		auto& probe = *_probes[index];
+		auto lag = std::chrono::steady_clock::now() - probe.expiry();
+		Record(OverloadSignal::IoLag, std::chrono::duration_cast<std::chrono::nanoseconds>(lag).count());
+		WaitProbe(index);
+	});
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "Metrics.h"
+
+// 过载判断使用的信号
+enum class OverloadSignal : int {
+	// 消息在逻辑队列中的等待时间
+	QueueDelay = 0,
+	// 等待redis、mysql连接的时间
+	RedisWait = 1,
+	MysqlWait = 2,
+	// io线程事件循环的延迟，定时器实际触发时间和预定时间之差
+	IoLag = 3,
+	Count = 4,
+};
+
+// 过载保护，配置从config.ini的[Overload]段读取
+// 1. 各信号在任意线程记录，每个评估周期取最大值，任一信号超过阈值即进入过载
+// 2. 全部信号回落到阈值的RecoverRatio以下并持续RecoverPeriods个周期后解除，避免在阈值附近反复切换
+// 3. 过载期间拒绝新连接和新的登录，回复带重试间隔的错误，已登录用户的聊天和心跳照常处理
+class OverloadCtrl
+{
+public:
+	// 不会被析构，退出时io线程中仍可能在记录
+	static OverloadCtrl& Inst();
+	OverloadCtrl(const OverloadCtrl&) = delete;
+	OverloadCtrl& operator=(const OverloadCtrl&) = delete;
+
+	// 在main_io上周期评估，在pool的每个io_context上探测事件循环延迟，未启用时什么也不做
+	void Start(boost::asio::io_context& main_io, const std::vector<boost::asio::io_context*>& io_contexts);
+	void Record(OverloadSignal signal, int64_t ns);
+	bool Overloaded() const {
+		return _b_overloaded.load(std::memory_order_relaxed);
+	}
+	// 建议客户端重试的间隔(秒)
+	int RetryAfter() const {
+		return _retry_after;
+	}
+	// 过载期间拒绝新连接/新登录时调用，计入指标
+	void CountRejectAccept();
+	void CountRejectLogin();
+
+private:
+	OverloadCtrl();
+	void WaitEvaluate();
+	void Evaluate();
+	void WaitProbe(std::size_t index);
+
+	bool _b_enable;
+	std::chrono::milliseconds _interval;
+	// 各信号的阈值(纳秒)，0表示不检查
+	int64_t _thresholds[static_cast<int>(OverloadSignal::Count)];
+	double _recover_ratio;
+	int _recover_periods;
+	int _retry_after;
+
+	// 本周期内的最大值，评估时取出并清零
+	std::atomic<int64_t> _peaks[static_cast<int>(OverloadSignal::Count)];
+	std::atomic<bool> _b_overloaded;
+	// 连续低于恢复线的周期数，只在评估时访问
+	int _calm_periods;
+	std::unique_ptr<boost::asio::steady_timer> _eval_timer;
+	std::vector<std::unique_ptr<boost::asio::steady_timer>> _probes;
+
+	MetricGauge& _active;
+	MetricGauge& _transitions;
+	MetricGauge& _reject_accept;
+	MetricGauge& _reject_login;
+	// 上一个周期各信号的最大值(毫秒)
+	MetricGauge* _signal_ms[static_cast<int>(OverloadSignal::Count)];
+};
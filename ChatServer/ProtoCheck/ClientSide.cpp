@@ -0,0 +1,115 @@
+#include "ProtoSchema.h"
+#include "../ProtoWire.h"
+#include "../../llfcchat/protofields.h"
+#include <map>
+
+namespace {
+
+FieldKind KindOf(FieldType type) {
+	switch (type) {
+	case FIELD_BOOL: return FieldKind::Bool;
+	case FIELD_STRING: return FieldKind::String;
+	case FIELD_MESSAGE: return FieldKind::Message;
+	default: return FieldKind::Int32;
+	}
+}
+
+void SchemaOfFields(const ProtoField* fields, MsgSchema& schema) {
+	for (const ProtoField* field = fields; field->tag != 0; ++field) {
+		FieldSchema item{ field->tag, field->name, KindOf(field->type), {} };
+		if (field->type == FIELD_MESSAGE) {
+			SchemaOfFields(field->sub, item.sub);
+		}
+		schema.push_back(item);
+	}
+}
+
+const ProtoField* FindField(const ProtoField* fields, int tag) {
+	for (const ProtoField* field = fields; field->tag != 0; ++field) {
+		if (field->tag == tag) {
+			return field;
+		}
+	}
+	return nullptr;
+}
+
+void PutBytes(std::string& out, int tag, const char* data, std::size_t len) {
+	proto_wire::PutKey(out, tag, proto_wire::WIRE_LEN);
+	proto_wire::PutVarint(out, len);
+	out.append(data, len);
+}
+
+// ProtoCodec先解码成json再按字段表顺序编码，这里省去json，每个字段直接保留编码结果
+bool ReencodeFields(const char* data, std::size_t len, const ProtoField* fields, std::string& out) {
+	std::map<int, std::string> parts;
+	proto_wire::Reader reader(data, len);
+	while (!reader.Done()) {
+		int tag = 0;
+		int type = 0;
+		uint64_t varint = 0;
+		const char* field_data = nullptr;
+		std::size_t field_len = 0;
+		if (!reader.Next(tag, type, varint, field_data, field_len)) {
+			return false;
+		}
+		const ProtoField* field = FindField(fields, tag);
+		if (field == nullptr) {
+			continue;
+		}
+
+		std::string part;
+		if (type == proto_wire::WIRE_VARINT && field->type == FIELD_INT32) {
+			int32_t value = static_cast<int32_t>(varint);
+			if (value != 0) {
+				proto_wire::PutKey(part, tag, proto_wire::WIRE_VARINT);
+				proto_wire::PutVarint(part, static_cast<uint64_t>(static_cast<int64_t>(value)));
+			}
+			parts[tag] = part;
+		}
+		else if (type == proto_wire::WIRE_VARINT && field->type == FIELD_BOOL) {
+			if (varint != 0) {
+				proto_wire::PutKey(part, tag, proto_wire::WIRE_VARINT);
+				proto_wire::PutVarint(part, 1);
+			}
+			parts[tag] = part;
+		}
+		else if (type == proto_wire::WIRE_LEN && field->type == FIELD_STRING) {
+			if (field_len != 0) {
+				PutBytes(part, tag, field_data, field_len);
+			}
+			parts[tag] = part;
+		}
+		else if (type == proto_wire::WIRE_LEN && field->type == FIELD_MESSAGE) {
+			std::string sub;
+			if (!ReencodeFields(field_data, field_len, field->sub, sub)) {
+				return false;
+			}
+			PutBytes(parts[tag], tag, sub.data(), sub.size());
+		}
+	}
+
+	for (const ProtoField* field = fields; field->tag != 0; ++field) {
+		out.append(parts[field->tag]);
+	}
+	return true;
+}
+
+}
+
+namespace client_side {
+
+bool SchemaOf(int msg_id, MsgSchema& schema) {
+	const ProtoField* fields = FieldsOf(static_cast<ReqId>(msg_id));
+	if (fields == nullptr) {
+		return false;
+	}
+	SchemaOfFields(fields, schema);
+	return true;
+}
+
+bool Reencode(int msg_id, const std::string& in, std::string& out) {
+	const ProtoField* fields = FieldsOf(static_cast<ReqId>(msg_id));
+	return fields != nullptr && ReencodeFields(in.data(), in.size(), fields, out);
+}
+
+}
@@ -0,0 +1,125 @@
+#include "ProtoSchema.h"
+#include <iostream>
+
+namespace {
+
+const char* KindName(FieldKind kind) {
+	switch (kind) {
+	case FieldKind::Int32: return "int32";
+	case FieldKind::Bool: return "bool";
+	case FieldKind::String: return "string";
+	default: return "repeated message";
+	}
+}
+
+// 字段号、字段名、类型逐个比对，嵌套消息递归比对
+bool SameSchema(const MsgSchema& lhs, const MsgSchema& rhs, const std::string& path, std::string& err) {
+	if (lhs.size() != rhs.size()) {
+		err = path + " field count " + std::to_string(lhs.size()) + " vs " + std::to_string(rhs.size());
+		return false;
+	}
+	for (std::size_t i = 0; i < lhs.size(); ++i) {
+		const FieldSchema& l = lhs[i];
+		const FieldSchema& r = rhs[i];
+		if (l.tag != r.tag || l.name != r.name || l.kind != r.kind) {
+			err = path + " field " + std::to_string(l.tag) + " " + l.name + " " + KindName(l.kind)
+				+ " vs " + std::to_string(r.tag) + " " + r.name + " " + KindName(r.kind);
+			return false;
+		}
+		if (!SameSchema(l.sub, r.sub, path + "." + l.name, err)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 同一份字节在服务器、客户端、client.proto三处解码后重新编码，结果都要与原字节一致
+bool RoundTrip(int msg_id, const std::string& proto_name, const std::string& bytes, std::string& err) {
+	std::string out;
+	if (!server_side::Reencode(msg_id, bytes, out) || out != bytes) {
+		err = "server reencode mismatch";
+		return false;
+	}
+	out.clear();
+	if (!client_side::Reencode(msg_id, bytes, out) || out != bytes) {
+		err = "client reencode mismatch";
+		return false;
+	}
+	out.clear();
+	if (!proto_side::Reencode(proto_name, bytes, out, err)) {
+		return false;
+	}
+	if (out != bytes) {
+		err = "client.proto reencode mismatch";
+		return false;
+	}
+	return true;
+}
+
+bool CheckMsg(int msg_id, std::string& err) {
+	std::string proto_name;
+	MsgSchema server_schema;
+	MsgSchema client_schema;
+	bool in_server = server_side::SchemaOf(msg_id, proto_name, server_schema);
+	bool in_client = client_side::SchemaOf(msg_id, client_schema);
+	if (!in_server || !in_client) {
+		//两边都没有定义的id是空号
+		if (in_server != in_client) {
+			err = in_server ? "missing in client" : "missing in server";
+			return false;
+		}
+		return true;
+	}
+
+	MsgSchema proto_schema;
+	if (!proto_side::SchemaOf(proto_name, proto_schema, err)) {
+		return false;
+	}
+	if (!SameSchema(server_schema, client_schema, "server/client " + proto_name, err)
+		|| !SameSchema(server_schema, proto_schema, "server/proto " + proto_name, err)) {
+		return false;
+	}
+
+	std::string bytes;
+	server_side::Sample(msg_id, bytes);
+	if (!RoundTrip(msg_id, proto_name, bytes, err)) {
+		err = "server sample: " + err;
+		return false;
+	}
+	bytes.clear();
+	proto_side::Sample(proto_name, bytes);
+	if (!RoundTrip(msg_id, proto_name, bytes, err)) {
+		err = "client.proto sample: " + err;
+		return false;
+	}
+	return true;
+}
+
+}
+
+// 用法: ProtoCheck [client.desc]
+// client.desc由 protoc --descriptor_set_out=client.desc client.proto 生成
+// 对MSG_ID_BEGIN到MSG_ID_END的每个消息id比对三处字段定义，并做字节级的往返编解码，有不一致时返回1
+int main(int argc, char* argv[])
+{
+	std::string desc_path = argc > 1 ? argv[1] : "client.desc";
+	std::string err;
+	if (!proto_side::Load(desc_path, err)) {
+		std::cout << err << std::endl;
+		return 1;
+	}
+
+	int begin = 0;
+	int end = 0;
+	server_side::IdRange(begin, end);
+	int failed = 0;
+	for (int msg_id = begin; msg_id < end; ++msg_id) {
+		err.clear();
+		if (!CheckMsg(msg_id, err)) {
+			std::cout << "msg id " << msg_id << " FAILED: " << err << std::endl;
+			++failed;
+		}
+	}
+	std::cout << "checked msg id [" << begin << ", " << end << "), failed " << failed << std::endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// 服务器ClientMsg.h、客户端llfcchat/protofields.h、client.proto三处各自描述客户端消息，
+// 这里统一转换成同一种字段描述再比对
+// 服务器和客户端的消息id定义在全局命名空间中同名，两侧分别放在ServerSide.cpp、ClientSide.cpp中，
+// 通过这里的接口交换数据，不在同一个编译单元中引用
+enum class FieldKind {
+	Int32,
+	Bool,
+	String,
+	Message, // repeated的嵌套消息
+};
+
+struct FieldSchema {
+	int tag;
+	std::string name;
+	FieldKind kind;
+	std::vector<FieldSchema> sub; // Message的元素字段
+};
+
+typedef std::vector<FieldSchema> MsgSchema;
+
+// 服务器侧，消息类型取自ClientMsg.h，编解码使用EncodeProto/DecodeProto
+namespace server_side {
+	// 客户端消息id范围[begin, end)，即MSG_ID_BEGIN、MSG_ID_END
+	void IdRange(int& begin, int& end);
+	// id没有对应的消息类型时返回false，proto_name为client.proto中的消息全名
+	bool SchemaOf(int msg_id, std::string& proto_name, MsgSchema& schema);
+	// 每个字段填上非默认值(int32正负交替，repeated两个元素)后编码
+	bool Sample(int msg_id, std::string& bytes);
+	// 解码后重新编码，数据损坏时返回false
+	bool Reencode(int msg_id, const std::string& in, std::string& out);
+}
+
+// 客户端侧，字段表取自llfcchat/protofields.h
+namespace client_side {
+	bool SchemaOf(int msg_id, MsgSchema& schema);
+	// 按ProtoCodec的规则解码后重新编码: 标量字段后出现的覆盖先出现的，默认值不编码，repeated按出现顺序追加
+	bool Reencode(int msg_id, const std::string& in, std::string& out);
+}
+
+// client.proto侧，从protoc --descriptor_set_out生成的描述文件加载，使用DynamicMessage编解码
+namespace proto_side {
+	bool Load(const std::string& desc_path, std::string& err);
+	bool SchemaOf(const std::string& proto_name, MsgSchema& schema, std::string& err);
+	bool Sample(const std::string& proto_name, std::string& bytes);
+	// 解析后重新序列化，出现client.proto中没有定义的字段时返回false
+	bool Reencode(const std::string& proto_name, const std::string& in, std::string& out, std::string& err);
+}
@@ -0,0 +1,164 @@
+#include "ProtoSchema.h"
+#include <fstream>
+#include <memory>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+
+using google::protobuf::Descriptor;
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Message;
+using google::protobuf::Reflection;
+
+namespace {
+
+google::protobuf::DescriptorPool& Pool() {
+	static google::protobuf::DescriptorPool pool;
+	return pool;
+}
+
+google::protobuf::DynamicMessageFactory& Factory() {
+	static google::protobuf::DynamicMessageFactory factory(&Pool());
+	return factory;
+}
+
+std::unique_ptr<Message> NewMessage(const std::string& proto_name) {
+	const Descriptor* desc = Pool().FindMessageTypeByName(proto_name);
+	if (desc == nullptr) {
+		return nullptr;
+	}
+	return std::unique_ptr<Message>(Factory().GetPrototype(desc)->New());
+}
+
+bool SchemaOfDesc(const Descriptor* desc, MsgSchema& schema, std::string& err) {
+	for (int i = 0; i < desc->field_count(); ++i) {
+		const FieldDescriptor* field = desc->field(i);
+		FieldSchema item{ field->number(), field->name(), FieldKind::Int32, {} };
+		switch (field->type()) {
+		case FieldDescriptor::TYPE_INT32: item.kind = FieldKind::Int32; break;
+		case FieldDescriptor::TYPE_BOOL: item.kind = FieldKind::Bool; break;
+		case FieldDescriptor::TYPE_STRING: item.kind = FieldKind::String; break;
+		case FieldDescriptor::TYPE_MESSAGE:
+			item.kind = FieldKind::Message;
+			if (!SchemaOfDesc(field->message_type(), item.sub, err)) {
+				return false;
+			}
+			break;
+		default:
+			err = field->full_name() + " type not supported by ProtoWire";
+			return false;
+		}
+		//客户端消息只用到单值的int32、bool、string和repeated的嵌套消息
+		if (field->is_repeated() != (item.kind == FieldKind::Message)) {
+			err = field->full_name() + " repeated mismatch";
+			return false;
+		}
+		schema.push_back(item);
+	}
+	return true;
+}
+
+void FillSample(Message& msg) {
+	const Reflection* reflection = msg.GetReflection();
+	const Descriptor* desc = msg.GetDescriptor();
+	for (int i = 0; i < desc->field_count(); ++i) {
+		const FieldDescriptor* field = desc->field(i);
+		int tag = field->number();
+		switch (field->cpp_type()) {
+		case FieldDescriptor::CPPTYPE_INT32:
+			reflection->SetInt32(&msg, field, tag % 2 ? -(tag * 100 + 3) : tag * 100 + 3);
+			break;
+		case FieldDescriptor::CPPTYPE_BOOL:
+			reflection->SetBool(&msg, field, true);
+			break;
+		case FieldDescriptor::CPPTYPE_STRING:
+			reflection->SetString(&msg, field, field->name() + "#" + std::to_string(tag));
+			break;
+		case FieldDescriptor::CPPTYPE_MESSAGE:
+			if (field->is_repeated()) {
+				FillSample(*reflection->AddMessage(&msg, field, &Factory()));
+				FillSample(*reflection->AddMessage(&msg, field, &Factory()));
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+bool HasUnknown(const Message& msg) {
+	const Reflection* reflection = msg.GetReflection();
+	if (!reflection->GetUnknownFields(msg).empty()) {
+		return true;
+	}
+	const Descriptor* desc = msg.GetDescriptor();
+	for (int i = 0; i < desc->field_count(); ++i) {
+		const FieldDescriptor* field = desc->field(i);
+		if (field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE || !field->is_repeated()) {
+			continue;
+		}
+		for (int j = 0; j < reflection->FieldSize(msg, field); ++j) {
+			if (HasUnknown(reflection->GetRepeatedMessage(msg, field, j))) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+}
+
+namespace proto_side {
+
+bool Load(const std::string& desc_path, std::string& err) {
+	std::ifstream in(desc_path, std::ios::binary);
+	google::protobuf::FileDescriptorSet set;
+	if (!in || !set.ParseFromIstream(&in)) {
+		err = "read descriptor set failed: " + desc_path;
+		return false;
+	}
+	for (const auto& file : set.file()) {
+		if (Pool().BuildFile(file) == nullptr) {
+			err = "build descriptor failed: " + file.name();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SchemaOf(const std::string& proto_name, MsgSchema& schema, std::string& err) {
+	const Descriptor* desc = Pool().FindMessageTypeByName(proto_name);
+	if (desc == nullptr) {
+		err = proto_name + " not found in client.proto";
+		return false;
+	}
+	return SchemaOfDesc(desc, schema, err);
+}
+
+bool Sample(const std::string& proto_name, std::string& bytes) {
+	auto msg = NewMessage(proto_name);
+	if (!msg) {
+		return false;
+	}
+	FillSample(*msg);
+	return msg->SerializeToString(&bytes);
+}
+
+bool Reencode(const std::string& proto_name, const std::string& in, std::string& out, std::string& err) {
+	auto msg = NewMessage(proto_name);
+	if (!msg) {
+		err = proto_name + " not found in client.proto";
+		return false;
+	}
+	if (!msg->ParseFromString(in)) {
+		err = "parse failed";
+		return false;
+	}
+	if (HasUnknown(*msg)) {
+		err = "fields not defined in client.proto";
+		return false;
+	}
+	return msg->SerializeToString(&out);
+}
+
+}
@@ -0,0 +1,162 @@
+#include "ProtoSchema.h"
+#include "../ClientMsg.h"
+
+namespace {
+
+// 记录Visit列出的字段
+class SchemaVisitor {
+public:
+	explicit SchemaVisitor(MsgSchema& schema) :_schema(schema) {}
+
+	void Field(int tag, const char* name, int32_t&) {
+		_schema.push_back(FieldSchema{ tag, name, FieldKind::Int32, {} });
+	}
+
+	void Field(int tag, const char* name, bool&) {
+		_schema.push_back(FieldSchema{ tag, name, FieldKind::Bool, {} });
+	}
+
+	void Field(int tag, const char* name, std::string&) {
+		_schema.push_back(FieldSchema{ tag, name, FieldKind::String, {} });
+	}
+
+	template <typename T>
+	void Field(int tag, const char* name, std::vector<T>&) {
+		FieldSchema field{ tag, name, FieldKind::Message, {} };
+		T item;
+		SchemaVisitor sub(field.sub);
+		item.Visit(sub);
+		_schema.push_back(field);
+	}
+
+private:
+	MsgSchema& _schema;
+};
+
+// 所有字段填上非默认值，保证每个字段都会被编码
+class SampleVisitor {
+public:
+	void Field(int tag, const char*, int32_t& value) {
+		//奇数字段号取负数，覆盖int32负数按10字节varint编码的情况
+		value = tag % 2 ? -(tag * 100 + 1) : tag * 100 + 1;
+	}
+
+	void Field(int, const char*, bool& value) {
+		value = true;
+	}
+
+	void Field(int tag, const char* name, std::string& value) {
+		value = std::string(name) + "-" + std::to_string(tag);
+	}
+
+	template <typename T>
+	void Field(int, const char*, std::vector<T>& values) {
+		values.resize(2);
+		for (auto& value : values) {
+			value.Visit(*this);
+		}
+	}
+};
+
+template <typename Msg>
+void SchemaOfMsg(MsgSchema& schema) {
+	Msg msg;
+	SchemaVisitor visitor(schema);
+	msg.Visit(visitor);
+}
+
+template <typename Msg>
+void SampleOfMsg(std::string& bytes) {
+	Msg msg;
+	SampleVisitor visitor;
+	msg.Visit(visitor);
+	client_codec::EncodeProto(msg, bytes);
+}
+
+template <typename Msg>
+bool ReencodeMsg(const std::string& in, std::string& out) {
+	Msg msg;
+	if (!client_codec::DecodeProto(in.data(), in.size(), msg)) {
+		return false;
+	}
+	client_codec::EncodeProto(msg, out);
+	return true;
+}
+
+struct ServerMsg {
+	int msg_id;
+	const char* proto_name;
+	void(*schema)(MsgSchema&);
+	void(*sample)(std::string&);
+	bool(*reencode)(const std::string&, std::string&);
+};
+
+template <typename Msg>
+ServerMsg Entry(int msg_id, const char* proto_name) {
+	return ServerMsg{ msg_id, proto_name, &SchemaOfMsg<Msg>, &SampleOfMsg<Msg>, &ReencodeMsg<Msg> };
+}
+
+// 请求和回包取自分发表使用的MsgDesc，服务器主动推送的消息按发送处使用的类型列出
+const ServerMsg SERVER_MSGS[] = {
+	Entry<client::ChatLoginDesc::ReqType>(client::ChatLoginDesc::REQ_ID, "client.ChatLoginReq"),
+	Entry<client::ChatLoginDesc::RspType>(client::ChatLoginDesc::RSP_ID, "client.ChatLoginRsp"),
+	Entry<client::SearchUserDesc::ReqType>(client::SearchUserDesc::REQ_ID, "client.SearchUserReq"),
+	Entry<client::SearchUserDesc::RspType>(client::SearchUserDesc::RSP_ID, "client.SearchUserRsp"),
+	Entry<client::AddFriendApplyDesc::ReqType>(client::AddFriendApplyDesc::REQ_ID, "client.AddFriendApplyReq"),
+	Entry<client::AddFriendApplyDesc::RspType>(client::AddFriendApplyDesc::RSP_ID, "client.AddFriendApplyRsp"),
+	Entry<client::NotifyAddFriend>(ID_NOTIFY_ADD_FRIEND_REQ, "client.NotifyAddFriend"),
+	Entry<client::AuthFriendApplyDesc::ReqType>(client::AuthFriendApplyDesc::REQ_ID, "client.AuthFriendApplyReq"),
+	Entry<client::AuthFriendApplyDesc::RspType>(client::AuthFriendApplyDesc::RSP_ID, "client.AuthFriendApplyRsp"),
+	Entry<client::NotifyAuthFriend>(ID_NOTIFY_AUTH_FRIEND_REQ, "client.NotifyAuthFriend"),
+	Entry<client::TextChatDesc::ReqType>(client::TextChatDesc::REQ_ID, "client.TextChatMsgReq"),
+	Entry<client::TextChatDesc::RspType>(client::TextChatDesc::RSP_ID, "client.TextChatMsgRsp"),
+	Entry<client::TextChatMsgRsp>(ID_NOTIFY_TEXT_CHAT_MSG_REQ, "client.TextChatMsgRsp"),
+	Entry<client::NotifyOffline>(ID_NOTIFY_OFF_LINE_REQ, "client.NotifyOffline"),
+	Entry<client::HeartBeatDesc::ReqType>(client::HeartBeatDesc::REQ_ID, "client.HeartBeatReq"),
+	Entry<client::HeartBeatDesc::RspType>(client::HeartBeatDesc::RSP_ID, "client.HeartBeatRsp"),
+	Entry<client::NotifySystemMsg>(ID_NOTIFY_SYSTEM_MSG_REQ, "client.NotifySystemMsg"),
+};
+
+const ServerMsg* Find(int msg_id) {
+	for (const auto& msg : SERVER_MSGS) {
+		if (msg.msg_id == msg_id) {
+			return &msg;
+		}
+	}
+	return nullptr;
+}
+
+}
+
+namespace server_side {
+
+void IdRange(int& begin, int& end) {
+	begin = MSG_ID_BEGIN;
+	end = MSG_ID_END;
+}
+
+bool SchemaOf(int msg_id, std::string& proto_name, MsgSchema& schema) {
+	auto msg = Find(msg_id);
+	if (msg == nullptr) {
+		return false;
+	}
+	proto_name = msg->proto_name;
+	msg->schema(schema);
+	return true;
+}
+
+bool Sample(int msg_id, std::string& bytes) {
+	auto msg = Find(msg_id);
+	if (msg == nullptr) {
+		return false;
+	}
+	msg->sample(bytes);
+	return true;
+}
+
+bool Reencode(int msg_id, const std::string& in, std::string& out) {
+	auto msg = Find(msg_id);
+	return msg != nullptr && msg->reencode(in, out);
+}
+
+}
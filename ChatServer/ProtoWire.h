@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// protobuf二进制编码的最小实现，只覆盖客户端消息用到的varint和length-delimited两种类型
+// 编码结果与protoc生成的代码一致，客户端不需要引入protobuf库
+namespace proto_wire {
+
+enum WireType {
+	WIRE_VARINT = 0,
+	WIRE_FIXED64 = 1,
+	WIRE_LEN = 2,
+	WIRE_FIXED32 = 5,
+};
+
+inline void PutVarint(std::string& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+inline void PutKey(std::string& out, int tag, WireType type) {
+	PutVarint(out, (static_cast<uint64_t>(tag) << 3) | type);
+}
+
+// 顺序读取字段，Next返回false表示数据损坏
+class Reader {
+public:
+	Reader(const char* data, std::size_t len) :_ptr(data), _end(data + len) {}
+
+	bool Done() const {
+		return _ptr >= _end;
+	}
+
+	bool ReadVarint(uint64_t& value) {
+		value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (_ptr >= _end) {
+				return false;
+			}
+			auto byte = static_cast<unsigned char>(*_ptr++);
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// 读取一个字段，varint的值放在varint中，length-delimited的内容放在data/len中
+	bool Next(int& tag, int& type, uint64_t& varint, const char*& data, std::size_t& len) {
+		uint64_t key = 0;
+		if (!ReadVarint(key)) {
+			return false;
+		}
+		tag = static_cast<int>(key >> 3);
+		type = static_cast<int>(key & 0x7);
+		switch (type) {
+		case WIRE_VARINT:
+			return ReadVarint(varint);
+		case WIRE_LEN:
+			if (!ReadVarint(varint) || varint > static_cast<uint64_t>(_end - _ptr)) {
+				return false;
+			}
+			data = _ptr;
+			len = static_cast<std::size_t>(varint);
+			_ptr += len;
+			return true;
+		case WIRE_FIXED64:
+			return Skip(8);
+		case WIRE_FIXED32:
+			return Skip(4);
+		default:
+			return false;
+		}
+	}
+
+private:
+	bool Skip(std::size_t len) {
+		if (static_cast<std::size_t>(_end - _ptr) < len) {
+			return false;
+		}
+		_ptr += len;
+		return true;
+	}
+
+	const char* _ptr;
+	const char* _end;
+};
+
+}
@@ -0,0 +1,176 @@
+#include "RateLimiter.h"
+#include "ConfigMgr.h"
+#include "Logger.h"
+#include "RedisMgr.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+bool TokenBucket::TryTake(double rate, double burst, int64_t now_ns) {
+	if (!_b_init) {
+		_tokens = burst;
+		_last_ns = now_ns;
+		_b_init = true;
+	}
+	else if (now_ns > _last_ns) {
+		_tokens = (std::min)(burst, _tokens + (now_ns - _last_ns) * rate / 1e9);
+		_last_ns = now_ns;
+	}
+	if (_tokens < 1) {
+		return false;
+	}
+	_tokens -= 1;
+	return true;
+}
+
+bool TokenBucket::Full(double rate, double burst, int64_t now_ns) const {
+	return !_b_init || _tokens + (now_ns - _last_ns) * rate / 1e9 >= burst;
+}
+
+RateLimitConfig::RateLimitConfig() {
+	_has_cluster.fill(false);
+	auto section = ConfigMgr::Inst()["RateLimit"];
+	for (auto& item : section._section_datas) {
+		int msg_id = std::atoi(item.first.c_str());
+		if (msg_id < MSG_ID_BEGIN || msg_id >= MSG_ID_END) {
+			LOG_WARN("RateLimit msg id " << item.first << " out of range, ignored");
+			continue;
+		}
+		auto& rules = _rules[msg_id - MSG_ID_BEGIN];
+		std::stringstream ss(item.second);
+		std::string text;
+		while (std::getline(ss, text, ',')) {
+			//范围:每秒令牌数:桶容量
+			auto first = text.find(':');
+			auto second = text.find(':', first == std::string::npos ? first : first + 1);
+			if (first == std::string::npos || second == std::string::npos) {
+				LOG_WARN("RateLimit rule " << text << " of msg id " << msg_id << " is invalid, ignored");
+				continue;
+			}
+			auto scope = text.substr(0, first);
+			scope.erase(std::remove(scope.begin(), scope.end(), ' '), scope.end());
+			LimitRule rule;
+			if (scope == "session") {
+				rule._scope = LimitScope::Session;
+			}
+			else if (scope == "uid") {
+				rule._scope = LimitScope::Uid;
+			}
+			else if (scope == "cluster") {
+				rule._scope = LimitScope::Cluster;
+			}
+			else {
+				LOG_WARN("RateLimit scope " << scope << " of msg id " << msg_id << " is invalid, ignored");
+				continue;
+			}
+			try {
+				rule._rate = std::stod(text.substr(first + 1, second - first - 1));
+				rule._burst = (std::max)(1.0, std::stod(text.substr(second + 1)));
+			}
+			catch (const std::invalid_argument&) {
+				LOG_WARN("RateLimit " << item.first << " rule " << text << " is not a number, ignored");
+				continue;
+			}
+			catch (const std::out_of_range&) {
+				LOG_WARN("RateLimit " << item.first << " rule " << text << " is out of range, ignored");
+				continue;
+			}
+			auto same = std::find_if(rules.begin(), rules.end(), [&rule](const LimitRule& other) {
+				return other._scope == rule._scope;
+			});
+			if (same != rules.end() || rule._rate <= 0) {
+				continue;
+			}
+			rules.push_back(rule);
+			if (rule._scope == LimitScope::Cluster) {
+				_has_cluster[msg_id - MSG_ID_BEGIN] = true;
+			}
+			LOG_INFO("RateLimit msg id " << msg_id << " " << scope << " rate " << rule._rate << " burst " << rule._burst);
+		}
+	}
+}
+
+const RateLimitConfig& RateLimitConfig::Inst() {
+	static RateLimitConfig cfg;
+	return cfg;
+}
+
+const std::vector<LimitRule>& RateLimitConfig::Rules(short msg_id) const {
+	if (msg_id < MSG_ID_BEGIN || msg_id >= MSG_ID_END) {
+		return _empty;
+	}
+	return _rules[msg_id - MSG_ID_BEGIN];
+}
+
+bool RateLimitConfig::HasCluster(short msg_id) const {
+	return msg_id >= MSG_ID_BEGIN && msg_id < MSG_ID_END && _has_cluster[msg_id - MSG_ID_BEGIN];
+}
+
+bool SessionLimiter::Allow(short msg_id, int uid) {
+	auto& rules = RateLimitConfig::Inst().Rules(msg_id);
+	if (rules.empty()) {
+		return true;
+	}
+	auto now = Metrics::NowNs();
+	for (auto& rule : rules) {
+		if (rule._scope == LimitScope::Session) {
+			if (!_buckets[msg_id - MSG_ID_BEGIN].TryTake(rule._rate, rule._burst, now)) {
+				return false;
+			}
+		}
+		else if (rule._scope == LimitScope::Uid && uid != 0) {
+			if (!RateLimiter::Inst().AllowUid(uid, msg_id, rule, now)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+RateLimiter& RateLimiter::Inst() {
+	static RateLimiter* inst = new RateLimiter();
+	return *inst;
+}
+
+RateLimiter::RateLimiter() :_rejected(Metrics::Inst().GetGauge("chat_ratelimit_rejected_total",
+	"Requests rejected by per-session, per-uid or cluster token buckets.")) {
+}
+
+bool RateLimiter::AllowUid(int uid, short msg_id, const LimitRule& rule, int64_t now_ns) {
+	uint64_t key = static_cast<uint64_t>(uid) << 16 | static_cast<uint64_t>(msg_id - MSG_ID_BEGIN);
+	return _uid_buckets.Update(key, [&rule, now_ns](TokenBucket& bucket) {
+		return bucket.TryTake(rule._rate, rule._burst, now_ns);
+	});
+}
+
+bool RateLimiter::AsyncAllowCluster(int uid, short msg_id, boost::asio::yield_context yield) {
+	if (uid == 0) {
+		return true;
+	}
+	for (auto& rule : RateLimitConfig::Inst().Rules(msg_id)) {
+		if (rule._scope != LimitScope::Cluster) {
+			continue;
+		}
+		auto key = RATE_LIMIT_PREFIX + std::to_string(msg_id) + "_" + std::to_string(uid);
+		return RedisMgr::GetInstance()->AsyncTakeToken(key, rule._rate, rule._burst, yield);
+	}
+	return true;
+}
+
+void RateLimiter::Purge() {
+	auto now = Metrics::NowNs();
+	auto& cfg = RateLimitConfig::Inst();
+	auto count = _uid_buckets.RemoveIf([now, &cfg](uint64_t key, const TokenBucket& bucket) {
+		short msg_id = static_cast<short>((key & 0xFFFF) + MSG_ID_BEGIN);
+		for (auto& rule : cfg.Rules(msg_id)) {
+			if (rule._scope == LimitScope::Uid) {
+				return bucket.Full(rule._rate, rule._burst, now);
+			}
+		}
+		return true;
+	});
+	if (count > 0) {
+		LOG_DEBUG("RateLimiter purge " << count << " idle uid buckets");
+	}
+}
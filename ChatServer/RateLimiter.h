@@ -0,0 +1,90 @@
+#pragma once
+#include <boost/asio/spawn.hpp>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "const.h"
+#include "ClientMsg.h"
+#include "ShardedMap.h"
+#include "Metrics.h"
+
+// 令牌桶，按纳秒时间补充令牌，非线程安全
+class TokenBucket {
+public:
+	TokenBucket() :_tokens(0), _last_ns(0), _b_init(false) {}
+	// 取一个令牌，首次使用时桶是满的
+	bool TryTake(double rate, double burst, int64_t now_ns);
+	// 补满后和从未使用过没有区别，可以回收
+	bool Full(double rate, double burst, int64_t now_ns) const;
+private:
+	double _tokens;
+	int64_t _last_ns;
+	bool _b_init;
+};
+
+// 限流的范围
+enum class LimitScope {
+	// 单个连接，在会话所在io线程检查
+	Session,
+	// 单个用户在本服务器上的全部连接，登录后才检查
+	Uid,
+	// 单个用户在全部chat server上的请求，令牌桶存放在redis中，由逻辑层检查
+	Cluster,
+};
+
+struct LimitRule {
+	LimitScope _scope;
+	// 每秒补充的令牌数
+	double _rate;
+	// 桶容量，允许的突发请求数
+	double _burst;
+};
+
+// 限流配置，首次使用时从config.ini的[RateLimit]段读取
+// 每行为 消息id = 范围:每秒令牌数:桶容量，多条规则用逗号分隔，例如 1007 = session:5:10,uid:10:20
+// 同一消息每种范围只取第一条规则，没有配置的消息不限流
+struct RateLimitConfig {
+	static const RateLimitConfig& Inst();
+	// 下标为 msg_id - MSG_ID_BEGIN
+	const std::vector<LimitRule>& Rules(short msg_id) const;
+	bool HasCluster(short msg_id) const;
+private:
+	RateLimitConfig();
+	std::array<std::vector<LimitRule>, MSG_ID_END - MSG_ID_BEGIN> _rules;
+	std::array<bool, MSG_ID_END - MSG_ID_BEGIN> _has_cluster;
+	std::vector<LimitRule> _empty;
+};
+
+// 本地限流(session、uid范围)，嵌入CSession中，在消息投递到逻辑层之前检查
+// 会话级的令牌桶只在会话所在io线程访问，不加锁；uid级的令牌桶全部io线程共享，按uid分段加锁
+class SessionLimiter {
+public:
+	// uid为0(未登录)时只检查session范围的规则
+	bool Allow(short msg_id, int uid);
+private:
+	std::array<TokenBucket, MSG_ID_END - MSG_ID_BEGIN> _buckets;
+};
+
+class RateLimiter
+{
+public:
+	// 不会被析构，进程退出时io线程中仍可能在检查
+	static RateLimiter& Inst();
+	RateLimiter(const RateLimiter&) = delete;
+	RateLimiter& operator=(const RateLimiter&) = delete;
+
+	bool AllowUid(int uid, short msg_id, const LimitRule& rule, int64_t now_ns);
+	// 在逻辑层协程中检查cluster范围的规则，redis出错时放行，避免redis故障导致全部请求被拒绝
+	bool AsyncAllowCluster(int uid, short msg_id, boost::asio::yield_context yield);
+	// 回收已经补满的uid令牌桶，由CServer的定时器定期调用
+	void Purge();
+	// 被限流的请求数
+	void CountReject() {
+		_rejected.Add(1);
+	}
+private:
+	RateLimiter();
+	// key为 uid << 16 | (msg_id - MSG_ID_BEGIN)
+	ShardedMap<uint64_t, TokenBucket> _uid_buckets;
+	MetricGauge& _rejected;
+};
@@ -0,0 +1,94 @@
+#include "RecvRingBuffer.h"
+#include "MsgPool.h"
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+
+RecvRingBuffer::RecvRingBuffer(std::size_t capacity):_block(AllocBlock(capacity)), _capacity(capacity),
+_read_pos(0), _write_pos(0), _need_len(0)
+{
+}
+
+RecvRingBuffer::~RecvRingBuffer() {
+
+}
+
+boost::asio::mutable_buffer RecvRingBuffer::Prepare() {
+	//数据已经全部解析且没有切片引用，直接回绕到起始位置
+	if (_read_pos == _write_pos && Exclusive()) {
+		_read_pos = 0;
+		_write_pos = 0;
+	}
+
+	//剩余空间不足1/4，或者装不下下一个完整消息，则整理内存
+	bool low_room = _capacity - _write_pos < _capacity / 4;
+	bool not_fit = _read_pos + _need_len > _capacity;
+	if (low_room || not_fit) {
+		Relocate((std::max)(_capacity, _need_len));
+	}
+
+	return boost::asio::buffer(_block.get() + _write_pos, _capacity - _write_pos);
+}
+
+void RecvRingBuffer::Commit(std::size_t len) {
+	_write_pos += len;
+}
+
+const char* RecvRingBuffer::ReadPtr() const {
+	return _block.get() + _read_pos;
+}
+
+std::size_t RecvRingBuffer::Readable() const {
+	return _write_pos - _read_pos;
+}
+
+void RecvRingBuffer::Consume(std::size_t len) {
+	_read_pos += len;
+	_need_len = 0;
+}
+
+void RecvRingBuffer::Reserve(std::size_t len) {
+	_need_len = len;
+}
+
+const std::shared_ptr<char>& RecvRingBuffer::Block() const {
+	return _block;
+}
+
+std::size_t RecvRingBuffer::Capacity() const {
+	return _capacity;
+}
+
+void RecvRingBuffer::Relocate(std::size_t capacity) {
+	std::size_t unread = _write_pos - _read_pos;
+	if (Exclusive() && capacity <= _capacity) {
+		::memmove(_block.get(), _block.get() + _read_pos, unread);
+	}
+	else {
+		auto block = AllocBlock(capacity);
+		::memcpy(block.get(), _block.get() + _read_pos, unread);
+		_block = block;
+		_capacity = capacity;
+	}
+
+	_read_pos = 0;
+	_write_pos = unread;
+}
+
+bool RecvRingBuffer::Exclusive() const {
+	//其他线程只会减少引用计数，不会增加，所以use_count为1之后不会再变
+	//use_count是relaxed读，补一个acquire屏障，与逻辑线程释放切片时引用计数递减的release配对，
+	//保证逻辑线程对这块内存的读取都发生在下面的覆盖写之前
+	if (_block.use_count() != 1) {
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return true;
+}
+
+std::shared_ptr<char> RecvRingBuffer::AllocBlock(std::size_t capacity) {
+	//从内存池分配，不做清零，写入前的内容不会被读取
+	return std::shared_ptr<char>(MsgPool::Inst().Allocate(capacity), [capacity](char* block) {
+		MsgPool::Inst().Free(block, capacity);
+		}, MsgPoolAllocator<char>());
+}
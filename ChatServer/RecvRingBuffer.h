@@ -0,0 +1,43 @@
+#pragma once
+#include <memory>
+#include <boost/asio.hpp>
+
+// 会话接收缓冲区
+// 1. 每次 async_read_some 尽量读满剩余空间，一次读取可以包含多个完整消息
+// 2. 解析出的消息体以切片形式(引用同一块内存)交给逻辑层，不再额外拷贝
+// 3. 当前内存块没有被逻辑层引用时直接回绕复用，否则换一块新内存，只搬移未解析完的残余数据
+class RecvRingBuffer
+{
+public:
+	explicit RecvRingBuffer(std::size_t capacity);
+	~RecvRingBuffer();
+
+	// 获取可写区域，必要时回绕或者更换内存块
+	boost::asio::mutable_buffer Prepare();
+	// 提交本次读取到的字节数
+	void Commit(std::size_t len);
+	// 未解析数据的起始位置和长度
+	const char* ReadPtr() const;
+	std::size_t Readable() const;
+	// 标记已解析的字节
+	void Consume(std::size_t len);
+	// 下一个完整消息需要的总长度(头部+消息体)，保证下次Prepare后内存连续
+	void Reserve(std::size_t len);
+	// 当前内存块，切片通过持有它来延长内存的生命周期
+	const std::shared_ptr<char>& Block() const;
+	// 当前内存块大小，超过该大小的消息不在缓冲区中拼接
+	std::size_t Capacity() const;
+
+private:
+	// 将未解析数据搬移到内存块起始位置(或新的内存块)
+	void Relocate(std::size_t capacity);
+	// 逻辑层已经释放了所有切片，内存块只被接收缓冲区引用，可以原地复用
+	bool Exclusive() const;
+	static std::shared_ptr<char> AllocBlock(std::size_t capacity);
+
+	std::shared_ptr<char> _block;
+	std::size_t _capacity;
+	std::size_t _read_pos;
+	std::size_t _write_pos;
+	std::size_t _need_len;
+};
@@ -0,0 +1,503 @@
+#include "RedisClient.h"
+#include "AsioIOServicePool.h"
+#include "ConfigMgr.h"
+#include "Logger.h"
+#include "OverloadCtrl.h"
+#include <chrono>
+
+namespace {
+
+// 单个批量字符串的上限，和redis的proto-max-bulk-len默认值一致
+const long long MAX_BULK_LEN = 512LL * 1024 * 1024;
+// 数组嵌套的最大层数，chat server用到的命令最多两层
+const int MAX_DEPTH = 8;
+const std::size_t READ_BUF_SIZE = 16 * 1024;
+
+bool ParseInt(const char* data, std::size_t len, long long& value) {
+	if (len == 0) {
+		return false;
+	}
+	bool negative = data[0] == '-';
+	std::size_t i = negative ? 1 : 0;
+	if (i == len) {
+		return false;
+	}
+	long long result = 0;
+	for (; i < len; ++i) {
+		if (data[i] < '0' || data[i] > '9') {
+			return false;
+		}
+		result = result * 10 + (data[i] - '0');
+	}
+	value = negative ? -result : result;
+	return true;
+}
+
+}
+
+void RespParser::Feed(const char* data, std::size_t len) {
+	//已经解析的数据超过一半时整体前移，避免缓冲区无限增长
+	if (_pos > 0 && _pos * 2 >= _buf.size()) {
+		_buf.erase(0, _pos);
+		_pos = 0;
+	}
+	_buf.append(data, len);
+}
+
+int RespParser::Next(RedisReply& reply) {
+	std::size_t pos = _pos;
+	int ret = Parse(pos, reply, 0);
+	if (ret > 0) {
+		_pos = pos;
+	}
+	return ret;
+}
+
+void RespParser::Reset() {
+	_buf.clear();
+	_pos = 0;
+}
+
+void RespParser::Format(const std::vector<std::string>& args, std::string& out) {
+	out += '*';
+	out += std::to_string(args.size());
+	out += "\r\n";
+	for (auto& arg : args) {
+		out += '$';
+		out += std::to_string(arg.size());
+		out += "\r\n";
+		out += arg;
+		out += "\r\n";
+	}
+}
+
+bool RespParser::ReadLine(std::size_t& pos, std::size_t& begin, std::size_t& len) const {
+	auto end = _buf.find("\r\n", pos);
+	if (end == std::string::npos) {
+		return false;
+	}
+	begin = pos;
+	len = end - pos;
+	pos = end + 2;
+	return true;
+}
+
+int RespParser::Parse(std::size_t& pos, RedisReply& reply, int depth) {
+	if (pos >= _buf.size()) {
+		return 0;
+	}
+	char type = _buf[pos];
+	std::size_t cur = pos + 1;
+	std::size_t begin = 0;
+	std::size_t len = 0;
+	if (!ReadLine(cur, begin, len)) {
+		return 0;
+	}
+	const char* line = _buf.data() + begin;
+
+	switch (type) {
+	case '+':
+	case '-':
+		reply.type = type == '+' ? REDIS_REPLY_STATUS : REDIS_REPLY_ERROR;
+		reply.str.assign(line, len);
+		break;
+	case ':':
+		reply.type = REDIS_REPLY_INTEGER;
+		if (!ParseInt(line, len, reply.integer)) {
+			return -1;
+		}
+		break;
+	case '$': {
+		long long bulk_len = 0;
+		if (!ParseInt(line, len, bulk_len) || bulk_len < -1 || bulk_len > MAX_BULK_LEN) {
+			return -1;
+		}
+		if (bulk_len == -1) {
+			reply.type = REDIS_REPLY_NIL;
+			break;
+		}
+		//消息体和结尾的\r\n都收全了才解析
+		if (_buf.size() - cur < static_cast<std::size_t>(bulk_len) + 2) {
+			return 0;
+		}
+		if (_buf[cur + bulk_len] != '\r' || _buf[cur + bulk_len + 1] != '\n') {
+			return -1;
+		}
+		reply.type = REDIS_REPLY_STRING;
+		reply.str.assign(_buf.data() + cur, static_cast<std::size_t>(bulk_len));
+		cur += static_cast<std::size_t>(bulk_len) + 2;
+		break;
+	}
+	case '*': {
+		long long count = 0;
+		if (depth >= MAX_DEPTH || !ParseInt(line, len, count) || count < -1) {
+			return -1;
+		}
+		if (count == -1) {
+			reply.type = REDIS_REPLY_NIL;
+			break;
+		}
+		reply.type = REDIS_REPLY_ARRAY;
+		reply.elements.clear();
+		reply.elements.reserve(static_cast<std::size_t>((std::min)(count, 1024LL)));
+		for (long long i = 0; i < count; ++i) {
+			reply.elements.emplace_back();
+			int ret = Parse(cur, reply.elements.back(), depth + 1);
+			if (ret <= 0) {
+				return ret;
+			}
+		}
+		break;
+	}
+	default:
+		return -1;
+	}
+
+	pos = cur;
+	return 1;
+}
+
+RedisConn::RedisConn(boost::asio::io_context& io_context, const boost::asio::ip::tcp::endpoint& endpoint,
+	const std::string& pwd, int64_t timeout_ns) :_io_context(io_context), _socket(io_context), _endpoint(endpoint),
+	_pwd(pwd), _timeout_ns(timeout_ns), _state(State::Broken), _generation(0), _b_ready(false),
+	_b_drain_posted(false), _b_writing(false), _reconnect_timer(io_context), _watch_timer(io_context) {
+}
+
+void RedisConn::Start() {
+	boost::asio::post(_io_context, [this]() {
+		Connect();
+		WaitWatch();
+	});
+}
+
+bool RedisConn::Stopped() const {
+	return _io_context.stopped();
+}
+
+void RedisConn::Submit(RedisRequest req) {
+	//io线程已经停止时不会再有人处理，直接以失败结束，避免调用方一直挂起
+	if (Stopped()) {
+		req._cb(nullptr);
+		return;
+	}
+	_submit_que.Push(std::move(req));
+	if (_b_drain_posted.exchange(true, std::memory_order_acq_rel)) {
+		return;
+	}
+	boost::asio::post(_io_context, [this]() {
+		Drain();
+	});
+}
+
+void RedisConn::Drain() {
+	//先清标志再取，清标志之后完成的Push会重新投递，不会漏掉命令
+	_b_drain_posted.exchange(false, std::memory_order_acq_rel);
+	RedisRequest req;
+	while (_submit_que.Pop(req)) {
+		Pending pending{ std::move(req._cb), req._start_ns };
+		//等待重连期间不排队，直接失败
+		if (_state == State::Broken) {
+			Complete(pending, nullptr);
+			continue;
+		}
+		_write_buf += req._cmd;
+		_pending.push_back(std::move(pending));
+	}
+	Flush();
+}
+
+void RedisConn::Connect() {
+	++_generation;
+	_state = State::Connecting;
+	_parser.Reset();
+	_read_buf = std::make_shared<std::vector<char>>(READ_BUF_SIZE);
+	//认证命令排在最前面，连接建立后和之前积压的命令一起发出
+	if (!_pwd.empty()) {
+		RespParser::Format({ "AUTH", _pwd }, _write_buf);
+		auto generation = _generation;
+		_pending.push_back(Pending{ [this, generation](RedisReplyPtr reply) {
+			if (reply && reply->type == REDIS_REPLY_ERROR && generation == _generation) {
+				Reset("auth failed, " + reply->str);
+			}
+		}, Metrics::NowNs() });
+	}
+
+	auto generation = _generation;
+	_socket.async_connect(_endpoint, [this, generation](const boost::system::error_code& ec) {
+		if (generation != _generation) {
+			return;
+		}
+		if (ec) {
+			Reset("connect failed, " + ec.message());
+			return;
+		}
+		boost::system::error_code opt_ec;
+		_socket.set_option(boost::asio::ip::tcp::no_delay(true), opt_ec);
+		_state = State::Ready;
+		_b_ready.store(true, std::memory_order_relaxed);
+		LOG_INFO("redis conn " << _endpoint << " connected");
+		ReadLoop();
+		Flush();
+	});
+}
+
+void RedisConn::Flush() {
+	if (_state != State::Ready || _b_writing || _write_buf.empty()) {
+		return;
+	}
+	//写缓冲区交给写操作持有，之后提交的命令追加到新的缓冲区，等这次写完再发
+	auto writing = std::make_shared<std::string>();
+	writing->swap(_write_buf);
+	_b_writing = true;
+	auto generation = _generation;
+	boost::asio::async_write(_socket, boost::asio::buffer(*writing),
+		[this, generation, writing](const boost::system::error_code& ec, std::size_t) {
+		if (generation != _generation) {
+			return;
+		}
+		_b_writing = false;
+		if (ec) {
+			Reset("write failed, " + ec.message());
+			return;
+		}
+		Flush();
+	});
+}
+
+void RedisConn::ReadLoop() {
+	auto buf = _read_buf;
+	auto generation = _generation;
+	_socket.async_read_some(boost::asio::buffer(*buf),
+		[this, generation, buf](const boost::system::error_code& ec, std::size_t bytes_transfered) {
+		if (generation != _generation) {
+			return;
+		}
+		if (ec) {
+			Reset("read failed, " + ec.message());
+			return;
+		}
+		_parser.Feed(buf->data(), bytes_transfered);
+		for (;;) {
+			auto reply = std::make_shared<RedisReply>();
+			int ret = _parser.Next(*reply);
+			if (ret == 0) {
+				break;
+			}
+			if (ret < 0 || _pending.empty()) {
+				Reset(ret < 0 ? "protocol error" : "unexpected reply");
+				return;
+			}
+			auto pending = std::move(_pending.front());
+			_pending.pop_front();
+			Complete(pending, std::move(reply));
+			//回调中可能重置了连接
+			if (generation != _generation) {
+				return;
+			}
+		}
+		ReadLoop();
+	});
+}
+
+void RedisConn::Complete(Pending& pending, RedisReplyPtr reply) {
+	try {
+		pending._cb(std::move(reply));
+	}
+	catch (std::exception& e) {
+		LOG_ERROR("redis callback exception: " << e.what());
+	}
+}
+
+void RedisConn::Reset(const std::string& reason) {
+	if (_state == State::Broken) {
+		return;
+	}
+	LOG_WARN("redis conn " << _endpoint << " reset, " << reason << ", " << _pending.size() << " commands failed");
+	++_generation;
+	_state = State::Broken;
+	_b_ready.store(false, std::memory_order_relaxed);
+	boost::system::error_code ec;
+	_socket.close(ec);
+	_write_buf.clear();
+	_b_writing = false;
+	_parser.Reset();
+	//先整体取出再回调，回调中提交的新命令不会混进来
+	std::deque<Pending> failed;
+	failed.swap(_pending);
+	for (auto& pending : failed) {
+		Complete(pending, nullptr);
+	}
+
+	_reconnect_timer.expires_after(std::chrono::seconds(1));
+	_reconnect_timer.async_wait([this](const boost::system::error_code& ec) {
+		if (ec) {
+			return;
+		}
+		Connect();
+	});
+}
+
+void RedisConn::WaitWatch() {
+	_watch_timer.expires_after(std::chrono::seconds(1));
+	_watch_timer.async_wait([this](const boost::system::error_code& ec) {
+		if (ec) {
+			return;
+		}
+		//回复按顺序返回，只需要检查最早的命令
+		if (!_pending.empty() && Metrics::NowNs() - _pending.front()._start_ns > _timeout_ns) {
+			Reset("command timeout");
+		}
+		WaitWatch();
+	});
+}
+
+RedisClient& RedisClient::Inst() {
+	static RedisClient* inst = new RedisClient();
+	return *inst;
+}
+
+RedisClient::RedisClient() :_next(0), _timeout_ns(3000LL * 1000 * 1000), _inflight(0),
+_latency(Metrics::Inst().GetHistogram("chat_redis_cmd_seconds",
+	"Time from submitting a pipelined redis command to receiving its reply.")) {
+	auto section = ConfigMgr::Inst()["Redis"];
+	auto host = section["Host"];
+	auto port = section["Port"];
+	auto pwd = section["Passwd"];
+	auto conns = section["AsyncConns"];
+	auto timeout = section["CommandTimeout"];
+	std::size_t conn_count = conns.empty() ? 2 : (std::max)(1, std::stoi(conns));
+	if (!timeout.empty()) {
+		_timeout_ns = std::stoll(timeout) * 1000 * 1000;
+	}
+
+	auto pool = AsioIOServicePool::GetInstance();
+	//启动时解析一次地址，之后重连都使用该地址
+	boost::asio::ip::tcp::resolver resolver(pool->GetIOService(0));
+	boost::system::error_code ec;
+	auto results = resolver.resolve(host, port, ec);
+	if (ec || results.empty()) {
+		LOG_ERROR("resolve redis address " << host << ":" << port << " failed, " << ec.message());
+		return;
+	}
+	auto endpoint = results.begin()->endpoint();
+	for (std::size_t i = 0; i < conn_count; ++i) {
+		_conns.emplace_back(new RedisConn(pool->GetIOService(i % pool->Size()), endpoint, pwd, _timeout_ns));
+		_conns.back()->Start();
+	}
+
+	Metrics::Inst().AddGauge("chat_redis_inflight", "Redis commands submitted and not yet answered.", [this]() {
+		return static_cast<double>(_inflight.load(std::memory_order_relaxed));
+	});
+	Metrics::Inst().AddGauge("chat_redis_conn_ready", "Pipelined redis connections that are connected.", [this]() {
+		double ready = 0;
+		for (auto& conn : _conns) {
+			ready += conn->Ready() ? 1 : 0;
+		}
+		return ready;
+	});
+	LOG_INFO("RedisClient start " << conn_count << " conns to " << endpoint);
+}
+
+RedisConn* RedisClient::Pick() {
+	if (_conns.empty()) {
+		return nullptr;
+	}
+	//优先选已经连上的连接，都没连上时按轮询提交，命令在重连期间失败
+	std::size_t start = _next.fetch_add(1, std::memory_order_relaxed);
+	for (std::size_t i = 0; i < _conns.size(); ++i) {
+		auto& conn = _conns[(start + i) % _conns.size()];
+		if (conn->Ready()) {
+			return conn.get();
+		}
+	}
+	return _conns[start % _conns.size()].get();
+}
+
+RedisRequest RedisClient::MakeRequest(const std::vector<std::string>& args, RedisCallback cb) {
+	RedisRequest req;
+	RespParser::Format(args, req._cmd);
+	req._start_ns = Metrics::NowNs();
+	_inflight.fetch_add(1, std::memory_order_relaxed);
+	auto start = req._start_ns;
+	req._cb = [this, start, cb](RedisReplyPtr reply) {
+		_inflight.fetch_sub(1, std::memory_order_relaxed);
+		auto cost = Metrics::NowNs() - start;
+		_latency.Record(cost);
+		OverloadCtrl::Inst().Record(OverloadSignal::RedisWait, cost);
+		cb(std::move(reply));
+	};
+	return req;
+}
+
+void RedisClient::Command(std::vector<std::string> args, RedisCallback cb) {
+	auto* conn = Pick();
+	if (conn == nullptr) {
+		cb(nullptr);
+		return;
+	}
+	conn->Submit(MakeRequest(args, std::move(cb)));
+}
+
+std::future<RedisReplyPtr> RedisClient::Command(std::vector<std::string> args) {
+	auto promise = std::make_shared<std::promise<RedisReplyPtr>>();
+	auto future = promise->get_future();
+	Command(std::move(args), [promise](RedisReplyPtr reply) {
+		promise->set_value(std::move(reply));
+	});
+	return future;
+}
+
+RedisReplyPtr RedisClient::AsyncCommand(std::vector<std::string> args, boost::asio::yield_context yield) {
+	return boost::asio::async_initiate<boost::asio::yield_context, void(RedisReplyPtr)>(
+		[this](auto handler, std::vector<std::string> args) {
+			auto ex = boost::asio::get_associated_executor(handler);
+			//回调需要可拷贝，协程的handler和work_guard只能移动，放到shared_ptr中
+			using Handler = decltype(handler);
+			using Work = decltype(boost::asio::make_work_guard(ex));
+			auto shared_handler = std::make_shared<Handler>(std::move(handler));
+			auto work = std::make_shared<Work>(boost::asio::make_work_guard(ex));
+			Command(std::move(args), [shared_handler, work](RedisReplyPtr reply) {
+				//回到协程所在的执行器上恢复
+				boost::asio::post(work->get_executor(), [shared_handler, reply]() mutable {
+					(*shared_handler)(std::move(reply));
+				});
+				work->reset();
+			});
+		}, yield, std::move(args));
+}
+
+bool RedisClient::Wait(std::vector<std::string> args, RedisReplyPtr& reply) {
+	//io线程之间互相等待对方的连接会死锁，io线程上一律不等待
+	if (AsioIOServicePool::GetInstance()->InPoolThread()) {
+		return false;
+	}
+	RedisConn* target = nullptr;
+	std::size_t start = _next.fetch_add(1, std::memory_order_relaxed);
+	for (std::size_t i = 0; i < _conns.size(); ++i) {
+		auto& conn = _conns[(start + i) % _conns.size()];
+		if (conn->Stopped()) {
+			continue;
+		}
+		if (target == nullptr || (!target->Ready() && conn->Ready())) {
+			target = conn.get();
+		}
+	}
+	if (target == nullptr) {
+		return false;
+	}
+
+	auto promise = std::make_shared<std::promise<RedisReplyPtr>>();
+	auto future = promise->get_future();
+	target->Submit(MakeRequest(args, [promise](RedisReplyPtr reply) {
+		promise->set_value(std::move(reply));
+	}));
+	//超时检查由连接负责，这里多等1秒，只防止io线程在等待期间被停止
+	auto wait = std::chrono::nanoseconds(_timeout_ns) + std::chrono::seconds(1);
+	if (future.wait_for(wait) != std::future_status::ready) {
+		LOG_WARN("redis command wait timeout");
+		reply = nullptr;
+		return true;
+	}
+	reply = future.get();
+	return true;
+}
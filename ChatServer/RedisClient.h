@@ -0,0 +1,147 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "hiredis.h"
+#include "MpscQueue.h"
+#include "Metrics.h"
+
+// redis回复，type沿用hiredis的REDIS_REPLY_*，字段名和redisReply保持一致，便于从同步接口迁移
+struct RedisReply {
+	int type = REDIS_REPLY_NIL;
+	long long integer = 0;
+	// 字符串、状态和错误信息
+	std::string str;
+	std::vector<RedisReply> elements;
+};
+typedef std::shared_ptr<RedisReply> RedisReplyPtr;
+// 命令完成的回调，连接出错、超时时reply为空，在连接所在的io线程执行，不能阻塞
+typedef std::function<void(RedisReplyPtr)> RedisCallback;
+
+// RESP协议解析，数据按收到的顺序追加，每次取出一个完整的回复
+class RespParser {
+public:
+	RespParser() :_pos(0) {}
+	void Feed(const char* data, std::size_t len);
+	// 取出一个完整的回复返回1，数据不足返回0，协议错误返回-1
+	int Next(RedisReply& reply);
+	void Reset();
+	// 把命令按RESP数组格式追加到out
+	static void Format(const std::vector<std::string>& args, std::string& out);
+private:
+	// 从pos开始解析一个回复，成功时pos移动到回复之后
+	int Parse(std::size_t& pos, RedisReply& reply, int depth);
+	// 读取以\r\n结尾的一行，不包含\r\n
+	bool ReadLine(std::size_t& pos, std::size_t& begin, std::size_t& len) const;
+	std::string _buf;
+	// 已经解析到的位置，之前的数据在下次追加时丢弃
+	std::size_t _pos;
+};
+
+struct RedisRequest {
+	// 已经按RESP格式编码的命令
+	std::string _cmd;
+	RedisCallback _cb;
+	int64_t _start_ns = 0;
+};
+
+// 一条redis连接，绑定在AsioIOServicePool的一个io_context上
+// 1. 任意线程提交命令，只压入无锁队列，空->非空时投递一次，由io线程批量取出
+// 2. io线程把取出的命令合并成一次写入，不等前面的回复，回复按发送顺序依次对应等待队列中的回调
+// 3. 连接出错或最早的命令超时时，等待中的命令全部以空回复结束，1秒后重连
+class RedisConn {
+public:
+	RedisConn(boost::asio::io_context& io_context, const boost::asio::ip::tcp::endpoint& endpoint,
+		const std::string& pwd, int64_t timeout_ns);
+	RedisConn(const RedisConn&) = delete;
+	RedisConn& operator=(const RedisConn&) = delete;
+	void Start();
+	void Submit(RedisRequest req);
+	bool Stopped() const;
+	bool Ready() const {
+		return _b_ready.load(std::memory_order_relaxed);
+	}
+private:
+	enum class State {
+		Connecting,
+		Ready,
+		Broken,
+	};
+	struct Pending {
+		RedisCallback _cb;
+		int64_t _start_ns;
+	};
+	// 以下函数只在io线程调用
+	void Connect();
+	void Drain();
+	void Flush();
+	void ReadLoop();
+	void Complete(Pending& pending, RedisReplyPtr reply);
+	void Reset(const std::string& reason);
+	void WaitWatch();
+
+	boost::asio::io_context& _io_context;
+	boost::asio::ip::tcp::socket _socket;
+	boost::asio::ip::tcp::endpoint _endpoint;
+	std::string _pwd;
+	int64_t _timeout_ns;
+	State _state;
+	// 每次重置加1，旧连接上迟到的回调据此忽略
+	uint64_t _generation;
+	std::atomic<bool> _b_ready;
+	// 其他线程提交的命令
+	MpscQueue<RedisRequest> _submit_que;
+	std::atomic<bool> _b_drain_posted;
+	// 等待写出的命令，写操作进行中时继续追加，写完后一次发出
+	std::string _write_buf;
+	bool _b_writing;
+	// 已经提交、等待回复的命令，按发送顺序排列
+	std::deque<Pending> _pending;
+	// 读缓冲区随连接重建，避免旧连接上被取消的读操作写入新连接的数据
+	std::shared_ptr<std::vector<char>> _read_buf;
+	RespParser _parser;
+	boost::asio::steady_timer _reconnect_timer;
+	// 每秒检查一次最早的命令是否超时
+	boost::asio::steady_timer _watch_timer;
+};
+
+// 异步redis客户端，配置从config.ini的[Redis]段读取
+// AsyncConns条连接轮流分配到AsioIOServicePool的io_context上，多个调用方的命令在同一条连接上流水线发送
+// 提供回调、future、协程三种调用方式，RedisMgr的同步接口基于它实现
+// 每次提交可能分到不同的连接，只有等前一条命令回复后再提交，才能保证两条命令的执行顺序
+class RedisClient
+{
+public:
+	// 不会被析构，进程退出时io线程中仍可能有命令在完成
+	static RedisClient& Inst();
+	RedisClient(const RedisClient&) = delete;
+	RedisClient& operator=(const RedisClient&) = delete;
+
+	void Command(std::vector<std::string> args, RedisCallback cb);
+	std::future<RedisReplyPtr> Command(std::vector<std::string> args);
+	// 逻辑层协程使用，等待回复期间不占用逻辑线程，回复后回到协程所在的线程继续执行
+	RedisReplyPtr AsyncCommand(std::vector<std::string> args, boost::asio::yield_context yield);
+	// 同步等待回复，最多等待命令超时时间
+	// 在io线程上调用时返回false，由调用方改用阻塞连接: 等待的连接可能在另一个io线程上，而那个io线程也可能正在等待本线程的连接
+	// io线程都已经停止时同样返回false
+	bool Wait(std::vector<std::string> args, RedisReplyPtr& reply);
+private:
+	RedisClient();
+	RedisConn* Pick();
+	RedisRequest MakeRequest(const std::vector<std::string>& args, RedisCallback cb);
+
+	std::vector<std::unique_ptr<RedisConn>> _conns;
+	std::atomic<std::size_t> _next;
+	int64_t _timeout_ns;
+	// 已提交还没有完成的命令数
+	std::atomic<int64_t> _inflight;
+	LatencyHistogram& _latency;
+};
@@ -1,375 +1,277 @@
 #include "RedisMgr.h"
+#include "Logger.h"
 #include "const.h"
 #include "ConfigMgr.h"
 #include "DistLock.h"
+#include <chrono>
+#include <thread>
 RedisMgr::RedisMgr() {
 	auto& gCfgMgr = ConfigMgr::Inst();
 	auto host = gCfgMgr["Redis"]["Host"];
 	auto port = gCfgMgr["Redis"]["Port"];
 	auto pwd = gCfgMgr["Redis"]["Passwd"];
-	_con_pool.reset(new RedisConPool(10, host.c_str(), atoi(port.c_str()), pwd.c_str()));
+	auto pool_size = gCfgMgr["Redis"]["PoolSize"];
+	_con_pool.reset(new RedisConPool(pool_size.empty() ? 10 : atoi(pool_size.c_str()), host.c_str(), atoi(port.c_str()), pwd.c_str()));
+
+	auto* pool = _con_pool.get();
+	Metrics::Inst().AddGauge("chat_redis_pool_size", "Configured redis connection pool size.", [pool]() {
+		return static_cast<double>(pool->PoolSize());
+	});
+	Metrics::Inst().AddGauge("chat_redis_pool_idle", "Idle redis connections in the pool.", [pool]() {
+		return static_cast<double>(pool->IdleCount());
+	});
+	//启动时就建立流水线连接
+	RedisClient::Inst();
 }
 
 RedisMgr::~RedisMgr() {
 	
 }
 
+namespace {
 
+// 与DistLock使用相同的key，新旧版本的服务器之间同样互斥
+std::string LockKey(const std::string& lockName) {
+	return "lock:" + lockName;
+}
 
-bool RedisMgr::Get(const std::string& key, std::string& value)
-{
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-	 auto reply = (redisReply*)redisCommand(connect, "GET %s", key.c_str());
-	 if (reply == NULL) {
-		 std::cout << "[ GET  " << key << " ] failed" << std::endl;
-		// freeReplyObject(reply);
-		 _con_pool->returnConnection(connect);
-		  return false;
-	}
-
-	 if (reply->type != REDIS_REPLY_STRING) {
-		 std::cout << "[ GET  " << key << " ] failed" << std::endl;
-		 freeReplyObject(reply);
-		 _con_pool->returnConnection(connect);
-		 return false;
+// 只有锁的持有者才能删除锁
+const char* RELEASE_LOCK_SCRIPT = "if redis.call('get', KEYS[1]) == ARGV[1] then \
+	return redis.call('del', KEYS[1]) \
+	else \
+	return 0 \
+	end";
+
+//令牌数和上次补充时间存放在hash中，空闲到补满后过期删除
+const char* TAKE_TOKEN_SCRIPT = "local t = redis.call('TIME') \
+	local now = tonumber(t[1]) * 1000 + math.floor(tonumber(t[2]) / 1000) \
+	local rate = tonumber(ARGV[1]) \
+	local burst = tonumber(ARGV[2]) \
+	local b = redis.call('HMGET', KEYS[1], 'tokens', 'ts') \
+	local tokens = tonumber(b[1]) or burst \
+	local ts = tonumber(b[2]) or now \
+	tokens = math.min(burst, tokens + math.max(0, now - ts) * rate / 1000) \
+	local ok = 0 \
+	if tokens >= 1 then tokens = tokens - 1 ok = 1 end \
+	redis.call('HSET', KEYS[1], 'tokens', tostring(tokens), 'ts', now) \
+	redis.call('PEXPIRE', KEYS[1], math.ceil(burst / rate * 1000) + 1000) \
+	return ok";
+
+// 阻塞连接返回的redisReply转为RedisReply
+void CopyReply(const redisReply* src, RedisReply& dst) {
+	dst.type = src->type;
+	dst.integer = src->integer;
+	if (src->str != nullptr) {
+		dst.str.assign(src->str, src->len);
+	}
+	for (size_t i = 0; i < src->elements; ++i) {
+		dst.elements.emplace_back();
+		CopyReply(src->element[i], dst.elements.back());
 	}
-
-	 value = reply->str;
-	 freeReplyObject(reply);
-
-	 std::cout << "Succeed to execute command [ GET " << key << "  ]" << std::endl;
-	 _con_pool->returnConnection(connect);
-	 return true;
 }
 
-bool RedisMgr::Set(const std::string &key, const std::string &value){
-	//执行redis命令行
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
+// 以下为各命令回复的解析，同步和异步接口共用
+bool ParseGet(const std::string& key, const RedisReplyPtr& reply, std::string& value) {
+	if (reply == nullptr || reply->type != REDIS_REPLY_STRING) {
+		LOG_DEBUG("[ GET  " << key << " ] failed");
 		return false;
 	}
-	auto reply = (redisReply*)redisCommand(connect, "SET %s %s", key.c_str(), value.c_str());
+	value = reply->str;
+	LOG_DEBUG("Succeed to execute command [ GET " << key << "  ]");
+	return true;
+}
 
-	//如果返回NULL则说明执行失败
-	if (NULL == reply)
-	{
-		std::cout << "Execut command [ SET " << key << "  "<< value << " ] failure ! " << std::endl;
-		//freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
+bool ParseSet(const std::string& key, const std::string& value, const RedisReplyPtr& reply) {
+	if (reply == nullptr || !(reply->type == REDIS_REPLY_STATUS && (reply->str == "OK" || reply->str == "ok"))) {
+		LOG_ERROR("Execut command [ SET " << key << "  " << value << " ] failure ! ");
 		return false;
 	}
+	LOG_DEBUG("Execut command [ SET " << key << "  " << value << " ] success ! ");
+	return true;
+}
 
-	//如果执行失败则释放连接
-	if (!(reply->type == REDIS_REPLY_STATUS && (strcmp(reply->str, "OK") == 0 || strcmp(reply->str, "ok") == 0)))
-	{
-		std::cout << "Execut command [ SET " << key << "  " << value << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
+bool ParsePush(const char* cmd, const std::string& key, const std::string& value, const RedisReplyPtr& reply) {
+	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER || reply->integer <= 0) {
+		LOG_ERROR("Execut command [ " << cmd << " " << key << "  " << value << " ] failure ! ");
 		return false;
 	}
-
-	//执行成功 释放redisCommand执行后返回的redisReply所占用的内存
-	freeReplyObject(reply);
-	std::cout << "Execut command [ SET " << key << "  " << value << " ] success ! " << std::endl;
-	_con_pool->returnConnection(connect);
+	LOG_DEBUG("Execut command [ " << cmd << " " << key << "  " << value << " ] success ! ");
 	return true;
 }
 
-bool RedisMgr::LPush(const std::string &key, const std::string &value)
-{
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-	auto reply = (redisReply*)redisCommand(connect, "LPUSH %s %s", key.c_str(), value.c_str());
-	if (NULL == reply)
-	{
-		std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
+bool ParsePop(const char* cmd, const std::string& key, const RedisReplyPtr& reply, std::string& value) {
+	if (reply == nullptr || reply->type == REDIS_REPLY_NIL) {
+		LOG_DEBUG("Execut command [ " << cmd << " " << key << " ] failure ! ");
 		return false;
 	}
+	value = reply->str;
+	LOG_DEBUG("Execut command [ " << cmd << " " << key << " ] success ! ");
+	return true;
+}
 
-	if (reply->type != REDIS_REPLY_INTEGER || reply->integer <= 0) {
-		std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
+bool ParseHSet(const std::string& key, const std::string& hkey, const RedisReplyPtr& reply) {
+	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER) {
+		LOG_ERROR("Execut command [ HSet " << key << "  " << hkey << " ] failure ! ");
 		return false;
 	}
-
-	std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] success ! " << std::endl;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
+	LOG_DEBUG("Execut command [ HSet " << key << "  " << hkey << " ] success ! ");
 	return true;
 }
 
-bool RedisMgr::LPop(const std::string &key, std::string& value){
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-	auto reply = (redisReply*)redisCommand(connect, "LPOP %s ", key.c_str());
-	if (reply == nullptr ) {
-		std::cout << "Execut command [ LPOP " << key<<  " ] failure ! " << std::endl;
-		_con_pool->returnConnection(connect);
+bool ParseDel(const std::string& key, const RedisReplyPtr& reply) {
+	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER) {
+		LOG_ERROR("Execut command [ Del " << key << " ] failure ! ");
 		return false;
 	}
+	LOG_DEBUG("Execut command [ Del " << key << " ] success ! ");
+	return true;
+}
 
-	if (reply->type == REDIS_REPLY_NIL) {
-		std::cout << "Execut command [ LPOP " << key << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
-		return false;
-	}
+bool ParseTryLock(const RedisReplyPtr& reply) {
+	return reply != nullptr && reply->type == REDIS_REPLY_STATUS && reply->str == "OK";
+}
 
-	value = reply->str;
-	std::cout << "Execut command [ LPOP " << key <<  " ] success ! " << std::endl;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
-	return true;
+bool ParseReleaseLock(const RedisReplyPtr& reply) {
+	//返回1表示删除了锁
+	return reply != nullptr && reply->type == REDIS_REPLY_INTEGER && reply->integer == 1;
 }
 
-bool RedisMgr::RPush(const std::string& key, const std::string& value) {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
+// redis出错时放行
+bool ParseTakeToken(const std::string& key, const RedisReplyPtr& reply) {
+	if (reply == nullptr) {
+		LOG_WARN("[ TakeToken " << key << " ] failed");
+		return true;
 	}
-	auto reply = (redisReply*)redisCommand(connect, "RPUSH %s %s", key.c_str(), value.c_str());
-	if (NULL == reply)
-	{
-		std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
-		return false;
+	if (reply->type != REDIS_REPLY_INTEGER) {
+		LOG_WARN("[ TakeToken " << key << " ] failed, reply type is " << reply->type);
+		return true;
 	}
+	return reply->integer == 1;
+}
 
-	if (reply->type != REDIS_REPLY_INTEGER || reply->integer <= 0) {
-		std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
-		return false;
-	}
+std::vector<std::string> TakeTokenArgs(const std::string& key, double rate, double burst) {
+	return { "EVAL", TAKE_TOKEN_SCRIPT, "1", key, std::to_string(rate), std::to_string(burst) };
+}
 
-	std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] success ! " << std::endl;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
-	return true;
 }
-bool RedisMgr::RPop(const std::string& key, std::string& value) {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-	auto reply = (redisReply*)redisCommand(connect, "RPOP %s ", key.c_str());
-	if (reply == nullptr ) {
-		std::cout << "Execut command [ RPOP " << key << " ] failure ! " << std::endl;
-		_con_pool->returnConnection(connect);
-		return false;
-	}
 
-	if (reply->type == REDIS_REPLY_NIL) {
-		std::cout << "Execut command [ RPOP " << key << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
-		return false;
+RedisReplyPtr RedisMgr::Exec(const std::vector<std::string>& args) {
+	RedisReplyPtr reply;
+	if (RedisClient::Inst().Wait(args, reply)) {
+		return reply;
 	}
-	value = reply->str;
-	std::cout << "Execut command [ RPOP " << key << " ] success ! " << std::endl;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
-	return true;
+	return ExecBlocking(args);
 }
 
-bool RedisMgr::HSet(const std::string &key, const std::string &hkey, const std::string &value) {
+RedisReplyPtr RedisMgr::ExecBlocking(const std::vector<std::string>& args) {
 	auto connect = _con_pool->getConnection();
 	if (connect == nullptr) {
-		return false;
+		return nullptr;
 	}
-	auto reply = (redisReply*)redisCommand(connect, "HSET %s %s %s", key.c_str(), hkey.c_str(), value.c_str());
-	if (reply == nullptr ) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey <<"  " << value << " ] failure ! " << std::endl;
+	Defer defer([&connect, this]() {
 		_con_pool->returnConnection(connect);
-		return false;
-	}
+		});
 
-	if (reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
-		return false;
+	std::vector<const char*> argv;
+	std::vector<size_t> argvlen;
+	for (auto& arg : args) {
+		argv.push_back(arg.data());
+		argvlen.push_back(arg.size());
 	}
+	auto raw = (redisReply*)redisCommandArgv(connect, static_cast<int>(args.size()), argv.data(), argvlen.data());
+	if (raw == nullptr) {
+		return nullptr;
+	}
+	auto reply = std::make_shared<RedisReply>();
+	CopyReply(raw, *reply);
+	freeReplyObject(raw);
+	return reply;
+}
 
-	std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] success ! " << std::endl;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
-	return true;
+bool RedisMgr::Get(const std::string& key, std::string& value)
+{
+	return ParseGet(key, Exec({ "GET", key }), value);
 }
 
-bool RedisMgr::HSet(const char* key, const char* hkey, const char* hvalue, size_t hvaluelen)
+bool RedisMgr::Set(const std::string &key, const std::string &value){
+	return ParseSet(key, value, Exec({ "SET", key, value }));
+}
+
+bool RedisMgr::LPush(const std::string &key, const std::string &value)
 {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-	 const char* argv[4];
-	 size_t argvlen[4];
-	 argv[0] = "HSET";
-	argvlen[0] = 4;
-	argv[1] = key;
-	argvlen[1] = strlen(key);
-	argv[2] = hkey;
-	argvlen[2] = strlen(hkey);
-	argv[3] = hvalue;
-	argvlen[3] = hvaluelen;
-
-	auto reply = (redisReply*)redisCommandArgv(connect, 4, argv, argvlen);
-	if (reply == nullptr ) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! " << std::endl;
-		_con_pool->returnConnection(connect);
-		return false;
-	}
+	return ParsePush("LPUSH", key, value, Exec({ "LPUSH", key, value }));
+}
 
-	if (reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
-		return false;
-	}
-	std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] success ! " << std::endl;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
-	return true;
+bool RedisMgr::LPop(const std::string &key, std::string& value){
+	return ParsePop("LPOP", key, Exec({ "LPOP", key }), value);
 }
 
-std::string RedisMgr::HGet(const std::string &key, const std::string &hkey)
+bool RedisMgr::RPush(const std::string& key, const std::string& value) {
+	return ParsePush("RPUSH", key, value, Exec({ "RPUSH", key, value }));
+}
+
+bool RedisMgr::RPop(const std::string& key, std::string& value) {
+	return ParsePop("RPOP", key, Exec({ "RPOP", key }), value);
+}
+
+bool RedisMgr::HSet(const std::string &key, const std::string &hkey, const std::string &value) {
+	return ParseHSet(key, hkey, Exec({ "HSET", key, hkey, value }));
+}
+
+bool RedisMgr::HSet(const char* key, const char* hkey, const char* hvalue, size_t hvaluelen)
 {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return "";
-	}
-	const char* argv[3];
-	size_t argvlen[3];
-	argv[0] = "HGET";
-	argvlen[0] = 4;
-	argv[1] = key.c_str();
-	argvlen[1] = key.length();
-	argv[2] = hkey.c_str();
-	argvlen[2] = hkey.length();
-	
-	auto reply = (redisReply*)redisCommandArgv(connect, 3, argv, argvlen);
-	if (reply == nullptr ) {
-		std::cout << "Execut command [ HGet " << key << " "<< hkey <<"  ] failure ! " << std::endl;
-		_con_pool->returnConnection(connect);
-		return "";
-	}
+	return ParseHSet(key, hkey, Exec({ "HSET", key, hkey, std::string(hvalue, hvaluelen) }));
+}
 
-	if ( reply->type == REDIS_REPLY_NIL) {
-		freeReplyObject(reply);
-		std::cout << "Execut command [ HGet " << key << " " << hkey << "  ] failure ! " << std::endl;
-		_con_pool->returnConnection(connect);
+std::string RedisMgr::HGet(const std::string &key, const std::string &hkey)
+{
+	auto reply = Exec({ "HGET", key, hkey });
+	if (reply == nullptr || reply->type == REDIS_REPLY_NIL) {
+		LOG_DEBUG("Execut command [ HGet " << key << " " << hkey << "  ] failure ! ");
 		return "";
 	}
-
-	std::string value = reply->str;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
-	std::cout << "Execut command [ HGet " << key << " " << hkey << " ] success ! " << std::endl;
-	return value;
+	LOG_DEBUG("Execut command [ HGet " << key << " " << hkey << " ] success ! ");
+	return reply->str;
 }
 
 bool RedisMgr::HDel(const std::string& key, const std::string& field)
 {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-
-	Defer defer([&connect, this]() {
-		_con_pool->returnConnection(connect);
-		});
-
-	redisReply* reply = (redisReply*)redisCommand(connect, "HDEL %s %s", key.c_str(), field.c_str());
+	auto reply = Exec({ "HDEL", key, field });
 	if (reply == nullptr) {
-		std::cerr << "HDEL command failed" << std::endl;
+		LOG_ERROR("HDEL command failed");
 		return false;
 	}
-
-	bool success = false;
-	if (reply->type == REDIS_REPLY_INTEGER) {
-		success = reply->integer > 0;
-	}
-
-	freeReplyObject(reply);
-	return success;
+	return reply->type == REDIS_REPLY_INTEGER && reply->integer > 0;
 }
 
 bool RedisMgr::Del(const std::string &key)
 {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-	auto reply = (redisReply*)redisCommand(connect, "DEL %s", key.c_str());
-	if (reply == nullptr ) {
-		std::cout << "Execut command [ Del " << key <<  " ] failure ! " << std::endl;
-		_con_pool->returnConnection(connect);
-		return false;
-	}
-
-	if ( reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ Del " << key << " ] failure ! " << std::endl;
-		freeReplyObject(reply);
-		_con_pool->returnConnection(connect);
-		return false;
-	}
-
-	std::cout << "Execut command [ Del " << key << " ] success ! " << std::endl;
-	 freeReplyObject(reply);
-	 _con_pool->returnConnection(connect);
-	 return true;
+	return ParseDel(key, Exec({ "DEL", key }));
 }
 
 bool RedisMgr::ExistsKey(const std::string &key)
 {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
-	}
-
-	auto reply = (redisReply*)redisCommand(connect, "exists %s", key.c_str());
-	if (reply == nullptr ) {
-		std::cout << "Not Found [ Key " << key << " ]  ! " << std::endl;
-		_con_pool->returnConnection(connect);
-		return false;
-	}
-
-	if (reply->type != REDIS_REPLY_INTEGER || reply->integer == 0) {
-		std::cout << "Not Found [ Key " << key << " ]  ! " << std::endl;
-		_con_pool->returnConnection(connect);
-		freeReplyObject(reply);
+	auto reply = Exec({ "EXISTS", key });
+	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER || reply->integer == 0) {
+		LOG_DEBUG("Not Found [ Key " << key << " ]  ! ");
 		return false;
 	}
-	std::cout << " Found [ Key " << key << " ] exists ! " << std::endl;
-	freeReplyObject(reply);
-	_con_pool->returnConnection(connect);
+	LOG_DEBUG(" Found [ Key " << key << " ] exists ! ");
 	return true;
 }
 
 
 std::string RedisMgr::acquireLock(const std::string& lockName, int lockTimeout, int acquireTimeout) {
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return "";
+	std::string identifier = DistLock::newIdentifier();
+	auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(acquireTimeout);
+	while (std::chrono::steady_clock::now() < endTime) {
+		if (tryLock(lockName, identifier, lockTimeout)) {
+			return identifier;
+		}
+		// 暂停 1 毫秒后重试，防止忙等待
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
 	}
-
-	Defer defer([&connect, this]() {
-		_con_pool->returnConnection(connect);
-	});
-
-	return DistLock::Inst().acquireLock(connect, lockName, lockTimeout, acquireTimeout);
+	return "";
 }
 
 bool RedisMgr::releaseLock(const std::string& lockName,
@@ -377,17 +279,60 @@ bool RedisMgr::releaseLock(const std::string& lockName,
 	if (identifier.empty()) {
 		return true;
 	}
-	auto connect = _con_pool->getConnection();
-	if (connect == nullptr) {
-		return false;
+	return ParseReleaseLock(Exec({ "EVAL", RELEASE_LOCK_SCRIPT, "1", LockKey(lockName), identifier }));
+}
+
+bool RedisMgr::tryLock(const std::string& lockName, const std::string& identifier, int lockTimeout) {
+	return ParseTryLock(Exec({ "SET", LockKey(lockName), identifier, "NX", "EX", std::to_string(lockTimeout) }));
+}
+
+bool RedisMgr::AsyncGet(const std::string& key, std::string& value, boost::asio::yield_context yield) {
+	return ParseGet(key, RedisClient::Inst().AsyncCommand({ "GET", key }, yield), value);
+}
+
+bool RedisMgr::AsyncSet(const std::string& key, const std::string& value, boost::asio::yield_context yield) {
+	return ParseSet(key, value, RedisClient::Inst().AsyncCommand({ "SET", key, value }, yield));
+}
+
+std::string RedisMgr::AsyncAcquireLock(const std::string& lockName, int lockTimeout, int acquireTimeout,
+	boost::asio::yield_context yield) {
+	std::string identifier = DistLock::newIdentifier();
+	auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(acquireTimeout);
+	while (std::chrono::steady_clock::now() < endTime) {
+		auto reply = RedisClient::Inst().AsyncCommand(
+			{ "SET", LockKey(lockName), identifier, "NX", "EX", std::to_string(lockTimeout) }, yield);
+		if (ParseTryLock(reply)) {
+			return identifier;
+		}
+		AsyncSleep(1, yield);
 	}
+	return "";
+}
 
+bool RedisMgr::AsyncReleaseLock(const std::string& lockName, const std::string& identifier,
+	boost::asio::yield_context yield) {
+	if (identifier.empty()) {
+		return true;
+	}
+	return ParseReleaseLock(RedisClient::Inst().AsyncCommand(
+		{ "EVAL", RELEASE_LOCK_SCRIPT, "1", LockKey(lockName), identifier }, yield));
+}
 
-	Defer defer([&connect, this]() {
-		_con_pool->returnConnection(connect);
-		});
+void RedisMgr::PostReleaseLock(const std::string& lockName, const std::string& identifier) {
+	if (identifier.empty()) {
+		return;
+	}
+	RedisClient::Inst().Command({ "EVAL", RELEASE_LOCK_SCRIPT, "1", LockKey(lockName), identifier },
+		[lockName](RedisReplyPtr reply) {
+		//锁已过期或者redis出错，锁最终由LOCK_TIME_OUT过期释放
+		if (!ParseReleaseLock(reply)) {
+			LOG_WARN("release lock " << lockName << " failed");
+		}
+	});
+}
 
-	return DistLock::Inst().releaseLock(connect, lockName, identifier);
+bool RedisMgr::AsyncDel(const std::string& key, boost::asio::yield_context yield) {
+	return ParseDel(key, RedisClient::Inst().AsyncCommand({ "DEL", key }, yield));
 }
 
 void RedisMgr::IncreaseCount(std::string server_name)
@@ -457,3 +402,11 @@ void RedisMgr::DelCount(std::string server_name) {
 
 	RedisMgr::GetInstance()->HDel(LOGIN_COUNT, server_name);
 }
+
+bool RedisMgr::TakeToken(const std::string& key, double rate, double burst) {
+	return ParseTakeToken(key, Exec(TakeTokenArgs(key, rate, burst)));
+}
+
+bool RedisMgr::AsyncTakeToken(const std::string& key, double rate, double burst, boost::asio::yield_context yield) {
+	return ParseTakeToken(key, RedisClient::Inst().AsyncCommand(TakeTokenArgs(key, rate, burst), yield));
+}
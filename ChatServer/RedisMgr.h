@@ -1,15 +1,23 @@
 #pragma once
 #include "const.h"
+#include "Logger.h"
 #include "hiredis.h"
 #include <queue>
 #include <atomic>
 #include <mutex>
 #include "Singleton.h"
+#include "Metrics.h"
+#include "OverloadCtrl.h"
+#include "AsyncCall.h"
+#include "RedisClient.h"
 #include <cstring>
+#include <vector>
+// 阻塞连接池，RedisClient无法同步等待(在io线程上调用，或者io线程已经停止)时使用
 class RedisConPool {
 public:
 	RedisConPool(size_t poolSize, const char* host, int port, const char* pwd)
-		: poolSize_(poolSize), host_(host), port_(port), b_stop_(false), pwd_(pwd), counter_(0), fail_count_(0){
+		: poolSize_(poolSize), host_(host), port_(port), b_stop_(false), pwd_(pwd), counter_(0), fail_count_(0),
+		wait_hist_(&Metrics::Inst().GetHistogram("chat_redis_pool_wait_seconds", "Time spent waiting for a redis connection.")){
 		for (size_t i = 0; i < poolSize_; ++i) {
 			auto* context = redisConnect(host, port);
 			if (context == nullptr || context->err != 0) {
@@ -21,7 +29,7 @@ public:
 
 			auto reply = (redisReply*)redisCommand(context, "AUTH %s", pwd);
 			if (reply->type == REDIS_REPLY_ERROR) {
-				std::cout << "认证失败" << std::endl;
+				LOG_ERROR("认证失败");
 				//执行成功 释放redisCommand执行后返回的redisReply所占用的内存
 				freeReplyObject(reply);
 				continue;
@@ -29,7 +37,7 @@ public:
 
 			//执行成功 释放redisCommand执行后返回的redisReply所占用的内存
 			freeReplyObject(reply);
-			std::cout << "认证成功" << std::endl;
+			LOG_INFO("认证成功");
 			connections_.push(context);
 		}
 
@@ -61,6 +69,7 @@ public:
 	}
 
 	redisContext* getConnection() {
+		auto start = Metrics::NowNs();
 		std::unique_lock<std::mutex> lock(mutex_);
 		cond_.wait(lock, [this] { 
 			if (b_stop_) {
@@ -68,6 +77,9 @@ public:
 			}
 			return !connections_.empty(); 
 			});
+		auto wait = Metrics::NowNs() - start;
+		wait_hist_->Record(wait);
+		OverloadCtrl::Inst().Record(OverloadSignal::RedisWait, wait);
 		//如果停止则直接返回空指针
 		if (b_stop_) {
 			return  nullptr;
@@ -92,6 +104,16 @@ public:
 		return context;
 	}
 
+	// 空闲连接数，导出连接池占用情况
+	size_t IdleCount() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return connections_.size();
+	}
+
+	size_t PoolSize() const {
+		return poolSize_;
+	}
+
 	void returnConnection(redisContext* context) {
 		std::lock_guard<std::mutex> lock(mutex_);
 		if (b_stop_) {
@@ -120,7 +142,7 @@ private:
 
 		auto reply = (redisReply*)redisCommand(context, "AUTH %s", pwd_);
 		if (reply->type == REDIS_REPLY_ERROR) {
-			std::cout << "认证失败" << std::endl;
+			LOG_ERROR("认证失败");
 			//执行成功 释放redisCommand执行后返回的redisReply所占用的内存
 			freeReplyObject(reply);
 			redisFree(context);
@@ -129,7 +151,7 @@ private:
 
 		//执行成功 释放redisCommand执行后返回的redisReply所占用的内存
 		freeReplyObject(reply);
-		std::cout << "认证成功" << std::endl;
+		LOG_INFO("认证成功");
 		returnConnection(context);
 		return true;
 	}
@@ -157,7 +179,7 @@ private:
 					reply = (redisReply*)redisCommand(context, "PING");
 					// 2. 先看底层 I/O／协议层有没有错
 					if (context->err) {
-						std::cout << "Connection error: " << context->err << std::endl;
+						LOG_ERROR("Connection error: " << context->err);
 						if (reply) {
 							freeReplyObject(reply);
 						}
@@ -168,7 +190,7 @@ private:
 
 					// 3. 再看 Redis 自身返回的是不是 ERROR
 					if (!reply || reply->type == REDIS_REPLY_ERROR) {
-						std::cout << "reply is null, redis ping failed: " << std::endl;
+						LOG_ERROR("reply is null, redis ping failed: ");
 						if (reply) {
 							freeReplyObject(reply);
 						}
@@ -218,7 +240,7 @@ private:
 			try {
 				auto reply = (redisReply*)redisCommand(context, "PING");
 				if (!reply) {
-					std::cout << "reply is null, redis ping failed: " << std::endl;
+					LOG_ERROR("reply is null, redis ping failed: ");
 					connections_.push(context);
 					continue;
 				}
@@ -226,7 +248,7 @@ private:
 				connections_.push(context);
 			}
 			catch(std::exception& exp){
-				std::cout << "Error keeping connection alive: " << exp.what() << std::endl;
+				LOG_ERROR("Error keeping connection alive: " << exp.what());
 				redisFree(context);
 				context = redisConnect(host_, port_);
 				if (context == nullptr || context->err != 0) {
@@ -238,7 +260,7 @@ private:
 
 				auto reply = (redisReply*)redisCommand(context, "AUTH %s", pwd_);
 				if (reply->type == REDIS_REPLY_ERROR) {
-					std::cout << "认证失败" << std::endl;
+					LOG_ERROR("认证失败");
 					//执行成功 释放redisCommand执行后返回的redisReply所占用的内存
 					freeReplyObject(reply);
 					continue;
@@ -246,7 +268,7 @@ private:
 
 				//执行成功 释放redisCommand执行后返回的redisReply所占用的内存
 				freeReplyObject(reply);
-				std::cout << "认证成功" << std::endl;
+				LOG_INFO("认证成功");
 				connections_.push(context);
 			}
 		}
@@ -262,6 +284,8 @@ private:
 	std::condition_variable cond_;
 	std::thread  check_thread_;
 	int counter_;
+	// getConnection的等待耗时
+	LatencyHistogram* wait_hist_;
 };
 
 class RedisMgr: public Singleton<RedisMgr>, 
@@ -291,6 +315,23 @@ public:
 	std::string acquireLock(const std::string& lockName, int lockTimeout, int acquireTimeout);
 	// 释放指定锁名的锁
 	bool releaseLock(const std::string& lockName, const std::string& identifier);
+
+	// 逻辑层协程使用的异步版本，命令通过RedisClient流水线发送，不占用BlockingPool线程，等待期间逻辑线程可以处理其他消息
+	bool AsyncGet(const std::string& key, std::string& value, boost::asio::yield_context yield);
+	bool AsyncSet(const std::string& key, const std::string& value, boost::asio::yield_context yield);
+	// 加锁失败时挂起协程1毫秒后重试，重试间隔不占用任何线程
+	std::string AsyncAcquireLock(const std::string& lockName, int lockTimeout, int acquireTimeout,
+		boost::asio::yield_context yield);
+	bool AsyncReleaseLock(const std::string& lockName, const std::string& identifier,
+		boost::asio::yield_context yield);
+	// 提交释放锁的命令后立即返回，不等待回复，可以在任意线程调用
+	// 用于作用域结束时释放锁，协程提前返回、抛出异常时也不会阻塞线程
+	void PostReleaseLock(const std::string& lockName, const std::string& identifier);
+	bool AsyncDel(const std::string& key, boost::asio::yield_context yield);
+	// 从key对应的令牌桶中取一个令牌，桶按redis服务器的时间补充，多个chat server共享同一个桶
+	// 返回false表示令牌不足，redis出错时返回true
+	bool TakeToken(const std::string& key, double rate, double burst);
+	bool AsyncTakeToken(const std::string& key, double rate, double burst, boost::asio::yield_context yield);
 	
 	// 增加服务器计数
 	void IncreaseCount(std::string server_name);
@@ -302,6 +343,11 @@ public:
 	void DelCount(std::string server_name);
 private:
 	RedisMgr();
+	// 只尝试加锁一次
+	bool tryLock(const std::string& lockName, const std::string& identifier, int lockTimeout);
+	// 同步执行一条命令，通过RedisClient发送并等待回复，无法等待时改用阻塞连接，出错返回空
+	RedisReplyPtr Exec(const std::vector<std::string>& args);
+	RedisReplyPtr ExecBlocking(const std::vector<std::string>& args);
 	unique_ptr<RedisConPool>  _con_pool;
 };
 
@@ -0,0 +1,134 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// 分段加锁的并发哈希表
+// 1. 按key的哈希值分到SHARDS个分段，每个分段一把锁，不同分段的读写互不影响
+// 2. 遍历时逐个分段加锁，不会长时间阻塞其他线程
+// 3. SHARDS必须是2的幂
+template <typename K, typename V, std::size_t SHARDS = 64, typename Hash = std::hash<K>>
+class ShardedMap
+{
+	static_assert((SHARDS & (SHARDS - 1)) == 0, "SHARDS must be power of 2");
+public:
+	ShardedMap() = default;
+	ShardedMap(const ShardedMap&) = delete;
+	ShardedMap& operator=(const ShardedMap&) = delete;
+
+	// 插入或覆盖
+	void Insert(const K& key, const V& value) {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard._mtx);
+		shard._map[key] = value;
+	}
+
+	// 查找成功时拷贝到value
+	bool Find(const K& key, V& value) const {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard._mtx);
+		auto iter = shard._map.find(key);
+		if (iter == shard._map.end()) {
+			return false;
+		}
+		value = iter->second;
+		return true;
+	}
+
+	bool Contains(const K& key) const {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard._mtx);
+		return shard._map.find(key) != shard._map.end();
+	}
+
+	bool Erase(const K& key) {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard._mtx);
+		return shard._map.erase(key) > 0;
+	}
+
+	// pred(value)返回true时才删除，判断和删除在同一把锁内完成
+	template <typename Pred>
+	bool EraseIf(const K& key, Pred pred) {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard._mtx);
+		auto iter = shard._map.find(key);
+		if (iter == shard._map.end() || !pred(iter->second)) {
+			return false;
+		}
+		shard._map.erase(iter);
+		return true;
+	}
+
+	// 在分段锁内对key对应的值执行fn(value)并返回其结果，key不存在时先插入默认值
+	template <typename Fn>
+	auto Update(const K& key, Fn fn) -> decltype(fn(std::declval<V&>())) {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard._mtx);
+		return fn(shard._map[key]);
+	}
+
+	// 逐个分段删除pred(key, value)返回true的元素，返回删除的个数
+	template <typename Pred>
+	std::size_t RemoveIf(Pred pred) {
+		std::size_t count = 0;
+		for (auto& shard : _shards) {
+			std::lock_guard<std::mutex> lock(shard._mtx);
+			for (auto iter = shard._map.begin(); iter != shard._map.end();) {
+				if (pred(iter->first, iter->second)) {
+					iter = shard._map.erase(iter);
+					++count;
+				}
+				else {
+					++iter;
+				}
+			}
+		}
+		return count;
+	}
+
+	// 逐个分段遍历，fn(key, value)在分段锁内执行，不要在fn中再访问本表
+	template <typename Fn>
+	void ForEach(Fn fn) const {
+		for (auto& shard : _shards) {
+			std::lock_guard<std::mutex> lock(shard._mtx);
+			for (auto& item : shard._map) {
+				fn(item.first, item.second);
+			}
+		}
+	}
+
+	std::size_t Size() const {
+		std::size_t size = 0;
+		for (auto& shard : _shards) {
+			std::lock_guard<std::mutex> lock(shard._mtx);
+			size += shard._map.size();
+		}
+		return size;
+	}
+
+private:
+	struct Shard {
+		mutable std::mutex _mtx;
+		std::unordered_map<K, V, Hash> _map;
+	};
+
+	Shard& GetShard(const K& key) {
+		return _shards[ShardIndex(key)];
+	}
+
+	const Shard& GetShard(const K& key) const {
+		return _shards[ShardIndex(key)];
+	}
+
+	static std::size_t ShardIndex(const K& key) {
+		//标准库对整数的哈希可能就是原值，先打散再取高位，避免连续id集中在少数分段
+		uint64_t h = static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<std::size_t>(h >> 32) & (SHARDS - 1);
+	}
+
+	Shard _shards[SHARDS];
+};
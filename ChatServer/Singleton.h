@@ -2,6 +2,7 @@
 #include <memory>
 #include <mutex>
 #include <iostream>
+#include "Logger.h"
 using namespace std;
 
 template <typename T>
@@ -23,11 +24,11 @@ public:
 	}
 	
 	void PrintAddress() {
-		std::cout << _instance.get() << endl;
+		LOG_DEBUG(_instance.get());
 	}
 	
 	~Singleton() {
-		std::cout << "this is singleton destruct" << std::endl;
+		LOG_DEBUG("this is singleton destruct");
 	}
 };
 
@@ -0,0 +1,151 @@
+#include "TimingWheel.h"
+
+TimingWheel::TimingWheel(boost::asio::io_context& io_context, std::chrono::milliseconds tick, ExpireCallback callback)
+	:_timer(io_context), _tick(tick), _callback(callback), _now(0), _b_stop(false)
+{
+	for (auto& level : _slots) {
+		for (auto& head : level) {
+			head._prev = &head;
+			head._next = &head;
+		}
+	}
+}
+
+TimingWheel::~TimingWheel() {
+	//释放所有节点对持有对象的引用
+	for (auto& level : _slots) {
+		for (auto& head : level) {
+			while (head._next != &head) {
+				Cancel(head._next);
+			}
+		}
+	}
+}
+
+void TimingWheel::Start() {
+	_b_stop = false;
+	_timer.expires_after(_tick);
+	Wait();
+}
+
+void TimingWheel::Wait() {
+	_timer.async_wait([this](const boost::system::error_code& ec) {
+		if (ec || _b_stop) {
+			return;
+		}
+		OnTick();
+	});
+}
+
+void TimingWheel::Stop() {
+	_b_stop = true;
+	_timer.cancel();
+}
+
+void TimingWheel::Schedule(TimerNode* node, std::shared_ptr<void> holder, uint64_t ticks) {
+	uint64_t expire = _now + (ticks == 0 ? 1 : ticks);
+	if (node->Linked()) {
+		//到期时间没变不需要移动，同一个tick内的多次刷新都走这里
+		if (node->_expire == expire) {
+			return;
+		}
+		Unlink(node);
+	}
+	else {
+		node->_holder = std::move(holder);
+	}
+	node->_expire = expire;
+	Place(node);
+}
+
+void TimingWheel::Cancel(TimerNode* node) {
+	if (!node->Linked()) {
+		return;
+	}
+	Unlink(node);
+	node->_holder.reset();
+}
+
+uint64_t TimingWheel::Now() const {
+	return _now;
+}
+
+void TimingWheel::OnTick() {
+	Advance();
+	//按上次的到期时间累加，处理耗时不会让tick逐渐变慢
+	_timer.expires_at(_timer.expiry() + _tick);
+	Wait();
+}
+
+void TimingWheel::Advance() {
+	++_now;
+	//下层转完一圈，把上层当前槽的节点重新分配到下层
+	for (int level = 1; level < LEVELS; ++level) {
+		uint64_t low_mask = (uint64_t(1) << (SLOT_BITS * level)) - 1;
+		if ((_now & low_mask) != 0) {
+			break;
+		}
+		Cascade(level, (_now >> (SLOT_BITS * level)) & SLOT_MASK);
+	}
+
+	auto head = &_slots[0][_now & SLOT_MASK];
+	while (head->_next != head) {
+		auto node = head->_next;
+		Unlink(node);
+		auto holder = std::move(node->_holder);
+		//回调中可能重新调度该节点，所以先摘下再回调
+		_callback(node, std::move(holder));
+	}
+}
+
+void TimingWheel::Place(TimerNode* node) {
+	if (node->_expire < _now) {
+		node->_expire = _now;
+	}
+
+	uint64_t delta = node->_expire - _now;
+	for (int level = 0; level < LEVELS; ++level) {
+		uint64_t range = uint64_t(1) << (SLOT_BITS * (level + 1));
+		if (delta < range || level == LEVELS - 1) {
+			//超出最上层范围的挂在最上层，级联时会重新计算
+			uint64_t slot = (node->_expire >> (SLOT_BITS * level)) & SLOT_MASK;
+			Link(&_slots[level][slot], node);
+			return;
+		}
+	}
+}
+
+void TimingWheel::Cascade(int level, uint64_t slot) {
+	auto head = &_slots[level][slot];
+	//先把整条链表取下来，避免重新分配时又挂回同一个槽导致死循环
+	TimerNode list;
+	if (head->_next == head) {
+		return;
+	}
+	list._next = head->_next;
+	list._prev = head->_prev;
+	list._next->_prev = &list;
+	list._prev->_next = &list;
+	head->_next = head;
+	head->_prev = head;
+
+	while (list._next != &list) {
+		auto node = list._next;
+		Unlink(node);
+		Place(node);
+	}
+}
+
+void TimingWheel::Link(TimerNode* head, TimerNode* node) {
+	node->_prev = head->_prev;
+	node->_next = head;
+	head->_prev->_next = node;
+	head->_prev = node;
+}
+
+void TimingWheel::Unlink(TimerNode* node) {
+	node->_prev->_next = node->_next;
+	node->_next->_prev = node->_prev;
+	node->_prev = nullptr;
+	node->_next = nullptr;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+// 定时轮节点，嵌入在所属对象中，挂上/摘下只改指针，不做内存分配
+struct TimerNode {
+	TimerNode* _prev = nullptr;
+	TimerNode* _next = nullptr;
+	// 到期的tick
+	uint64_t _expire = 0;
+	// 挂在轮上期间持有所属对象，保证节点内存有效，摘下时释放
+	std::shared_ptr<void> _holder;
+	bool Linked() const { return _prev != nullptr; }
+};
+
+// 分层定时轮
+// 1. 每层64个槽，共5层，第0层一个槽对应一个tick，上层一个槽对应下层转一圈
+// 2. 低层转完一圈时，把上层对应槽中的节点重新分配到下层(级联)
+// 3. 重新调度只是把节点从原链表摘下再挂到新槽，O(1)；每个tick只遍历真正到期的节点
+// 4. 非线程安全，只能在所属io_context的线程中访问
+class TimingWheel
+{
+public:
+	// 到期回调，参数为到期的节点和节点挂上时传入的持有对象
+	using ExpireCallback = std::function<void(TimerNode*, std::shared_ptr<void>)>;
+
+	TimingWheel(boost::asio::io_context& io_context, std::chrono::milliseconds tick, ExpireCallback callback);
+	~TimingWheel();
+	TimingWheel(const TimingWheel&) = delete;
+	TimingWheel& operator=(const TimingWheel&) = delete;
+
+	void Start();
+	void Stop();
+	// ticks个tick后到期，节点已经在轮上时直接移到新位置
+	void Schedule(TimerNode* node, std::shared_ptr<void> holder, uint64_t ticks);
+	// 从轮上摘下并释放持有对象
+	void Cancel(TimerNode* node);
+	// 当前tick
+	uint64_t Now() const;
+
+private:
+	static const int SLOT_BITS = 6;
+	static const int SLOTS = 1 << SLOT_BITS;
+	static const uint64_t SLOT_MASK = SLOTS - 1;
+	static const int LEVELS = 5;
+
+	void Wait();
+	void OnTick();
+	// 前进一个tick，级联上层并触发第0层当前槽中的节点
+	void Advance();
+	// 根据到期时间挂到对应层的槽中
+	void Place(TimerNode* node);
+	void Cascade(int level, uint64_t slot);
+	static void Link(TimerNode* head, TimerNode* node);
+	static void Unlink(TimerNode* node);
+
+	boost::asio::steady_timer _timer;
+	std::chrono::milliseconds _tick;
+	ExpireCallback _callback;
+	uint64_t _now;
+	bool _b_stop;
+	// 每个槽是一个带哨兵的双向循环链表
+	TimerNode _slots[LEVELS][SLOTS];
+};
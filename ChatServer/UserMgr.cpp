@@ -3,43 +3,27 @@
 #include "RedisMgr.h"
 
 UserMgr:: ~ UserMgr(){
-	_uid_to_session.clear();
 }
 
 
 std::shared_ptr<CSession> UserMgr::GetSession(int uid)
 {
-	std::lock_guard<std::mutex> lock(_session_mtx);
-	auto iter = _uid_to_session.find(uid);
-	if (iter == _uid_to_session.end()) {
-		return nullptr;
-	}
-
-	return iter->second;
+	std::shared_ptr<CSession> session;
+	_uid_to_session.Find(uid, session);
+	return session;
 }
 
 void UserMgr::SetUserSession(int uid, std::shared_ptr<CSession> session)
 {
-	std::lock_guard<std::mutex> lock(_session_mtx);
-	_uid_to_session[uid] = session;
+	_uid_to_session.Insert(uid, session);
 }
 
-void UserMgr::RmvUserSession(int uid, std::string session_id)
+void UserMgr::RmvUserSession(int uid, uint64_t conn_id)
 { 
-	{
-		std::lock_guard<std::mutex> lock(_session_mtx);
-		auto iter = _uid_to_session.find(uid);
-		if (iter == _uid_to_session.end()) {
-			return;
-		}
-	
-		auto session_id_ = iter->second->GetSessionId();
-		//˵ط¼
-		if (session_id_ != session_id) {
-			return;
-		}
-		_uid_to_session.erase(uid);
-	}
+	//˵ط¼
+	_uid_to_session.EraseIf(uid, [conn_id](const std::shared_ptr<CSession>& session) {
+		return session->GetConnId() == conn_id;
+	});
 }
 
 UserMgr::UserMgr()
@@ -1,8 +1,8 @@
 #pragma once
 #include "Singleton.h"
-#include <unordered_map>
 #include <memory>
-#include <mutex>
+#include <cstdint>
+#include "ShardedMap.h"
 
 class CSession;
 class UserMgr: public Singleton<UserMgr>
@@ -12,10 +12,11 @@ public:
 	~UserMgr();
 	std::shared_ptr<CSession> GetSession(int uid);
 	void SetUserSession(int uid, std::shared_ptr<CSession> session);
-	void RmvUserSession(int uid, std::string session_id);
+	// ֻuidǰ󶨵conn_idӦĻỰʱƳ
+	void RmvUserSession(int uid, uint64_t conn_id);
 private:
 	UserMgr();
-	std::mutex _session_mtx;
-	std::unordered_map<int, std::shared_ptr<CSession>> _uid_to_session;
+	// uidֶμͶϢʱͬû֮䲻ͬһ
+	ShardedMap<int, std::shared_ptr<CSession>> _uid_to_session;
 };
 
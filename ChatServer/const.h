@@ -14,6 +14,8 @@ enum ErrorCodes {
 	PasswdInvalid = 1009,   //ʧ
 	TokenInvalid = 1010,   //TokenʧЧ
 	UidInvalid = 1011,  //uidЧ
+	ServerBusy = 1012,  //æ߼
+	RateLimited = 1013,  //Ƶ
 };
 
 
@@ -39,6 +41,16 @@ private:
 #define HEAD_ID_LEN 2
 //ͷݳ
 #define HEAD_DATA_LEN 2
+//չͷ־ϢidλʾֶΪ4ֽ
+#define HEAD_EXT_FLAG 0x8000
+//չͷݳ
+#define HEAD_EXT_DATA_LEN 4
+//չͷܳ
+#define HEAD_EXT_TOTAL_LEN 6
+//ѹ־ϢidĴθλʾϢ徭deflateѹҪڵ¼ʱЭ
+#define HEAD_COMPRESS_FLAG 0x4000
+//protobuf־ϢidĵλʾϢΪprotobuf(client.proto)Ϊjson
+#define HEAD_PROTO_FLAG 0x2000
 #define MAX_RECVQUE  10000
 #define MAX_SENDQUE 1000
 
@@ -59,6 +71,19 @@ enum MSG_IDS {
 	ID_NOTIFY_OFF_LINE_REQ = 1021, //֪ͨû
 	ID_HEART_BEAT_REQ = 1023,      //
 	ID_HEARTBEAT_RSP = 1024,       //ظ
+	ID_NOTIFY_SYSTEM_MSG_REQ = 1025, //֪ͨûϵͳ
+};
+
+//ͻϢ뷽ʽ¼ϢıỰ֮ذı
+enum class ClientCodec {
+	Json = 0,
+	Proto = 1,
+};
+
+//ϵͳ
+enum SystemNoticeType {
+	NOTICE_ANNOUNCEMENT = 1, //ͨ
+	NOTICE_MAINTENANCE = 2,  //ͣά
 };
 
 #define USERIPPREFIX  "uip_"
@@ -70,6 +95,7 @@ enum MSG_IDS {
 #define LOCK_PREFIX "lock_"
 #define USER_SESSION_PREFIX "usession_"
 #define LOCK_COUNT "lockcount"
+#define RATE_LIMIT_PREFIX "ratelimit_"
 
 //ֲʽĳʱ
 #define LOCK_TIME_OUT 10
@@ -1,4 +1,5 @@
 #include "AsioIOServicePool.h"
+#include "Logger.h"
 #include <iostream>
 using namespace std;
 
@@ -32,7 +33,7 @@ AsioIOServicePool::AsioIOServicePool(std::size_t size)
 
 AsioIOServicePool::~AsioIOServicePool() {
 	Stop(); //  RAII ƣȷʱԴȷͷ
-	std::cout << "AsioIOServicePool destruct" << std::endl;
+	LOG_INFO("AsioIOServicePool destruct");
 }
 
 // ȡIOʵ
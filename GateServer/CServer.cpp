@@ -1,4 +1,5 @@
 #include "CServer.h"
+#include "Logger.h"
 #include "HttpConnection.h"
 #include "AsioIOservicePool.h"
 
@@ -32,7 +33,7 @@ void CServer::Start() {
             self->Start(); 
         }
         catch (std::exception &exp) {
-            std::cout << "exception is" << exp.what() << std::endl; 
+            LOG_ERROR("exception is" << exp.what()); 
             self->Start(); 
         }
     });  
@@ -3,6 +3,7 @@
 #include <json/value.h>
 #include <json/reader.h>
 #include "CServer.h" 
+#include "Logger.h"
 #include "ConfigMgr.h"
 #include "RedisMgr.h"
 
@@ -12,18 +13,18 @@ void TestRedis() {
     redisContext* c = redisConnect("81.68.86.146", 6380);
     if (c->err)
     {
-        printf("Connect to redisServer faile:%s\n", c->errstr);
+        LOG_ERROR("Connect to redisServer faile:" << c->errstr);
         redisFree(c);        
         return;
     }
-    printf("Connect to redisServer Success\n");
+    LOG_INFO("Connect to redisServer Success");
     std::string redis_password = "123456";
     redisReply* r = (redisReply*)redisCommand(c, "AUTH %s", redis_password.c_str());
     if (r->type == REDIS_REPLY_ERROR) {
-        printf("Redis֤ʧܣ\n");
+        LOG_ERROR("Redis֤ʧܣ");
     }
     else {
-        printf("Redis֤ɹ\n");
+        LOG_INFO("Redis֤ɹ");
     }
     //Ϊrediskey
     const char* command1 = "set stest1 value1";
@@ -32,27 +33,27 @@ void TestRedis() {
     //NULL˵ִʧ
     if (NULL == r)
     {
-        printf("Execut command1 failure\n");
+        LOG_ERROR("Execut command1 failure");
         redisFree(c);        
         return;
     }
     //ִʧͷ
     if (!(r->type == REDIS_REPLY_STATUS && (strcmp(r->str, "OK") == 0 || strcmp(r->str, "ok") == 0)))
     {
-        printf("Failed to execute command[%s]\n", command1);
+        LOG_ERROR("Failed to execute command[" << command1 << "]");
         freeReplyObject(r);
         redisFree(c);       
         return;
     }
     //ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
     freeReplyObject(r);
-    printf("Succeed to execute command[%s]\n", command1);
+    LOG_INFO("Succeed to execute command[" << command1 << "]");
     const char* command2 = "strlen stest1";
     r = (redisReply*)redisCommand(c, command2);
     //Ͳ ͷ
     if (r->type != REDIS_REPLY_INTEGER)
     {
-        printf("Failed to execute command[%s]\n", command2);
+        LOG_ERROR("Failed to execute command[" << command2 << "]");
         freeReplyObject(r);
         redisFree(c);        
         return;
@@ -60,32 +61,32 @@ void TestRedis() {
     //ȡַ
     int length = r->integer;
     freeReplyObject(r);
-    printf("The length of 'stest1' is %d.\n", length);
-    printf("Succeed to execute command[%s]\n", command2);
+    LOG_INFO("The length of 'stest1' is " << length << ".");
+    LOG_INFO("Succeed to execute command[" << command2 << "]");
     //ȡredisֵϢ
     const char* command3 = "get stest1";
     r = (redisReply*)redisCommand(c, command3);
     if (r->type != REDIS_REPLY_STRING)
     {
-        printf("Failed to execute command[%s]\n", command3);
+        LOG_ERROR("Failed to execute command[" << command3 << "]");
         freeReplyObject(r);
         redisFree(c);        
         return;
     }
-    printf("The value of 'stest1' is %s\n", r->str);
+    LOG_INFO("The value of 'stest1' is " << r->str);
     freeReplyObject(r);
-    printf("Succeed to execute command[%s]\n", command3);
+    LOG_INFO("Succeed to execute command[" << command3 << "]");
     const char* command4 = "get stest2";
     r = (redisReply*)redisCommand(c, command4);
     if (r->type != REDIS_REPLY_NIL)
     {
-        printf("Failed to execute command[%s]\n", command4);
+        LOG_ERROR("Failed to execute command[" << command4 << "]");
         freeReplyObject(r);
         redisFree(c);       
         return;
     }
     freeReplyObject(r);
-    printf("Succeed to execute command[%s]\n", command4);
+    LOG_INFO("Succeed to execute command[" << command4 << "]");
     //ͷԴ
     redisFree(c);
 }
@@ -117,6 +118,7 @@ int main()
     auto& gCfgMgr = ConfigMgr::Inst(); //Ϊǵûпֻ
     std::string gate_port_str = gCfgMgr["GateServer"]["Port"];
     unsigned short gate_port = atoi(gate_port_str.c_str());
+    Logger::Inst().Init("gateserver");
 
     try
     {
@@ -131,12 +133,14 @@ int main()
             ioc.stop(); 
             }); 
         std::make_shared<CServer>(ioc, port)->Start(); 
-        std::cout << "Gate server listen on port: " << port << std::endl; 
+        LOG_INFO("Gate server listen on port: " << port); 
         ioc.run();
+        Logger::Inst().Stop();
     }
     catch (std::exception const& e)
     {
-        std::cerr << "Error: " << e.what() << std::endl;
+        LOG_ERROR("Error: " << e.what());
+        Logger::Inst().Stop();
         return EXIT_FAILURE;
     }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "HttpConnection.h"
+#include "Logger.h"
 #include "LogicSystem.h"
 
 HttpConnection::HttpConnection(boost::asio::io_context& ioc): _socket(ioc) {
@@ -10,7 +11,7 @@ void HttpConnection::Start() {
 	http::async_read(_socket, _buffer, _request, [self](beast::error_code ec, std::size_t bytes_transferred) {
 		try{
 			if (ec) { // Ϊec=һboolֵ
-				std::cout << "http read err is" << ec.what() << std::endl; 
+				LOG_WARN("http read err is" << ec.what()); 
 				return; 
 			}
 
@@ -20,7 +21,7 @@ void HttpConnection::Start() {
 			self->CheckDeadline(); 
 		}
 		catch(std::exception& exp) {
-			std::cout << "exception is " << exp.what() << std::endl; 
+			LOG_ERROR("exception is " << exp.what()); 
 		}
 	}); 
 }
@@ -0,0 +1,423 @@
+#include "Logger.h"
+#include "ConfigMgr.h"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <ctime>
+
+namespace {
+
+const char* LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+// 写线程每次从一个缓冲区最多取出的条数，避免一个繁忙线程长期占住写线程
+const std::size_t MAX_BATCH_PER_RING = LogRing::SIZE;
+
+int64_t NowMicros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t SteadySeconds() {
+	return std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 线程退出时通知写线程回收缓冲区
+struct LogRingHolder {
+	std::shared_ptr<LogRing> _ring;
+	~LogRingHolder() {
+		if (_ring) {
+			_ring->_b_closed.store(true, std::memory_order_release);
+		}
+	}
+};
+
+thread_local LogRingHolder t_ring_holder;
+
+const char* BaseName(const char* path) {
+	const char* base = path;
+	for (const char* p = path; *p; ++p) {
+		if (*p == '/' || *p == '\\') {
+			base = p + 1;
+		}
+	}
+	return base;
+}
+
+}
+
+LogStream& LogStream::operator<<(const char* str) {
+	if (str == nullptr) {
+		return *this << "(null)";
+	}
+	Append(str, std::strlen(str));
+	return *this;
+}
+
+LogStream& LogStream::operator<<(double value) {
+	char buf[32];
+	int len = std::snprintf(buf, sizeof(buf), "%g", value);
+	if (len > 0) {
+		Append(buf, static_cast<std::size_t>(len));
+	}
+	return *this;
+}
+
+LogStream& LogStream::operator<<(const void* ptr) {
+	char buf[32];
+	int len = std::snprintf(buf, sizeof(buf), "%p", ptr);
+	if (len > 0) {
+		Append(buf, static_cast<std::size_t>(len));
+	}
+	return *this;
+}
+
+void LogStream::Append(const char* data, std::size_t len) {
+	std::size_t left = CAPACITY - _len;
+	if (len > left) {
+		len = left;
+	}
+	std::memcpy(_buf + _len, data, len);
+	_len += len;
+}
+
+LogStream& LogStream::AppendInt(long long value) {
+	if (value < 0) {
+		Append("-", 1);
+		//先转成无符号再取反，最小负数也不会溢出
+		return AppendUInt(0ULL - static_cast<unsigned long long>(value));
+	}
+	return AppendUInt(static_cast<unsigned long long>(value));
+}
+
+LogStream& LogStream::AppendUInt(unsigned long long value) {
+	char buf[24];
+	char* end = buf + sizeof(buf);
+	char* p = end;
+	do {
+		*--p = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	Append(p, static_cast<std::size_t>(end - p));
+	return *this;
+}
+
+bool LogSite::Allow() {
+	uint32_t limit = Logger::Inst().RateLimit();
+	if (limit == 0) {
+		return true;
+	}
+	//按秒划分窗口，跨秒时由一个线程重置计数，并发下允许少量误差
+	int64_t now = SteadySeconds();
+	int64_t window = _window.load(std::memory_order_relaxed);
+	if (window != now && _window.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+		_count.store(0, std::memory_order_relaxed);
+	}
+	if (_count.fetch_add(1, std::memory_order_relaxed) < limit) {
+		return true;
+	}
+	_suppressed.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+bool LogRing::Push(const LogRecord& record) {
+	std::size_t tail = _tail.load(std::memory_order_relaxed);
+	if (tail - _head.load(std::memory_order_acquire) >= SIZE) {
+		return false;
+	}
+	LogRecord& slot = _records[tail % SIZE];
+	//只拷贝有效的文本长度
+	std::memcpy(&slot, &record, offsetof(LogRecord, _text) + record._len);
+	_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+std::size_t LogRing::PopTo(std::vector<LogRecord>& out, std::size_t max) {
+	std::size_t head = _head.load(std::memory_order_relaxed);
+	std::size_t tail = _tail.load(std::memory_order_acquire);
+	std::size_t count = std::min(tail - head, max);
+	for (std::size_t i = 0; i < count; ++i) {
+		const LogRecord& slot = _records[(head + i) % SIZE];
+		out.emplace_back();
+		std::memcpy(&out.back(), &slot, offsetof(LogRecord, _text) + slot._len);
+	}
+	_head.store(head + count, std::memory_order_release);
+	return count;
+}
+
+Logger& Logger::Inst() {
+	static Logger* logger = new Logger();
+	return *logger;
+}
+
+Logger::Logger() :_level(static_cast<int>(LogLevel::Trace)), _rate_limit(0), _b_running(false), _b_stop(false),
+	_thread_seq(0), _file(nullptr), _file_size(0), _max_file_size(0), _max_files(0), _flush_interval_ms(10),
+	_b_console(true), _cached_sec(-1) {
+	_cached_prefix[0] = '\0';
+}
+
+LogLevel Logger::ParseLevel(const std::string& name, LogLevel def) {
+	if (name == "trace") {
+		return LogLevel::Trace;
+	}
+	if (name == "debug") {
+		return LogLevel::Debug;
+	}
+	if (name == "info") {
+		return LogLevel::Info;
+	}
+	if (name == "warn") {
+		return LogLevel::Warn;
+	}
+	if (name == "error") {
+		return LogLevel::Error;
+	}
+	if (name == "off") {
+		return LogLevel::Off;
+	}
+	return def;
+}
+
+void Logger::Init(const std::string& name) {
+	if (_b_running.load()) {
+		return;
+	}
+	auto& cfg = ConfigMgr::Inst();
+	SetLevel(ParseLevel(cfg["Log"]["Level"], LogLevel::Info));
+	_dir = cfg["Log"]["Dir"];
+	if (_dir.empty()) {
+		_dir = "logs";
+	}
+	_name = name;
+	auto max_size = cfg["Log"]["MaxFileSize"];
+	_max_file_size = max_size.empty() ? 64ULL * 1024 * 1024 : std::strtoull(max_size.c_str(), nullptr, 10);
+	auto max_files = cfg["Log"]["MaxFiles"];
+	_max_files = max_files.empty() ? 5 : std::max(1, atoi(max_files.c_str()));
+	auto rate_limit = cfg["Log"]["RateLimit"];
+	_rate_limit = rate_limit.empty() ? 1000 : static_cast<uint32_t>(atoi(rate_limit.c_str()));
+	auto flush_interval = cfg["Log"]["FlushInterval"];
+	_flush_interval_ms = flush_interval.empty() ? 10 : std::max(1, atoi(flush_interval.c_str()));
+	_b_console = cfg["Log"]["Console"] == "true";
+
+	{
+		std::lock_guard<std::mutex> lock(_sync_mtx);
+		OpenFile();
+	}
+	_b_stop.store(false);
+	_b_running.store(true);
+	_writer = std::thread([this]() {
+		WriteLoop();
+	});
+}
+
+void Logger::Stop() {
+	if (!_b_running.exchange(false)) {
+		return;
+	}
+	//之后的日志改为同步输出，写线程取完缓冲区中剩余的日志后退出
+	{
+		std::lock_guard<std::mutex> lock(_wait_mtx);
+		_b_stop.store(true);
+	}
+	_wait_cond.notify_one();
+	if (_writer.joinable()) {
+		_writer.join();
+	}
+}
+
+LogRing* Logger::LocalRing() {
+	auto& ring = t_ring_holder._ring;
+	if (!ring) {
+		ring = std::make_shared<LogRing>(_thread_seq.fetch_add(1, std::memory_order_relaxed));
+		std::lock_guard<std::mutex> lock(_rings_mtx);
+		_rings.push_back(ring);
+	}
+	return ring.get();
+}
+
+void Logger::Write(LogLevel level, const char* file, int line, LogSite& site, const LogStream& stream) {
+	LogRecord record;
+	record._time_us = NowMicros();
+	record._file = file;
+	record._line = line;
+	record._level = level;
+	record._suppressed = site.TakeSuppressed();
+	record._len = static_cast<uint32_t>(stream.Size());
+	std::memcpy(record._text, stream.Data(), stream.Size());
+
+	if (!_b_running.load(std::memory_order_acquire)) {
+		//写线程未启动或已停止，同步输出
+		record._thread = 0;
+		std::vector<LogRecord> records(1, record);
+		std::lock_guard<std::mutex> lock(_sync_mtx);
+		Output(records, std::string());
+		return;
+	}
+
+	LogRing* ring = LocalRing();
+	record._thread = ring->Thread();
+	if (!ring->Push(record)) {
+		ring->_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	//写到一半时提前唤醒写线程，突发日志不必等满一个刷新间隔
+	if (ring->Size() == LogRing::SIZE / 2) {
+		_wait_cond.notify_one();
+	}
+}
+
+void Logger::WriteLoop() {
+	std::vector<LogRecord> batch;
+	batch.reserve(MAX_BATCH_PER_RING * 4);
+	std::vector<std::shared_ptr<LogRing>> rings;
+	std::string dropped_lines;
+	for (;;) {
+		//先看停止标记再取数据，保证停止前写入的日志都能取到
+		bool stopping = _b_stop.load();
+		{
+			std::lock_guard<std::mutex> lock(_rings_mtx);
+			//线程已退出且取空的缓冲区不再需要
+			_rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<LogRing>& ring) {
+				return ring->_b_closed.load(std::memory_order_acquire) && ring->Empty();
+			}), _rings.end());
+			rings = _rings;
+		}
+
+		batch.clear();
+		dropped_lines.clear();
+		for (auto& ring : rings) {
+			ring->PopTo(batch, MAX_BATCH_PER_RING);
+			uint64_t dropped = ring->_dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped > 0) {
+				WriteDropped(ring->Thread(), dropped, dropped_lines);
+			}
+		}
+
+		if (!batch.empty() || !dropped_lines.empty()) {
+			std::lock_guard<std::mutex> lock(_sync_mtx);
+			Output(batch, dropped_lines);
+			continue;
+		}
+
+		if (stopping) {
+			break;
+		}
+		std::unique_lock<std::mutex> lock(_wait_mtx);
+		_wait_cond.wait_for(lock, std::chrono::milliseconds(_flush_interval_ms), [this]() {
+			return _b_stop.load();
+		});
+	}
+
+	std::lock_guard<std::mutex> lock(_sync_mtx);
+	if (_file) {
+		std::fclose(_file);
+		_file = nullptr;
+	}
+}
+
+void Logger::WriteDropped(uint32_t thread, uint64_t dropped, std::string& out) {
+	char buf[96];
+	int len = std::snprintf(buf, sizeof(buf), "[logger] log buffer of thread %u full, dropped %llu records\n",
+		thread, static_cast<unsigned long long>(dropped));
+	if (len > 0) {
+		out.append(buf, static_cast<std::size_t>(len));
+	}
+}
+
+void Logger::Output(std::vector<LogRecord>& records, const std::string& prefix) {
+	//多个线程的日志合并后按时间排序，同一线程内的顺序不变
+	std::stable_sort(records.begin(), records.end(), [](const LogRecord& a, const LogRecord& b) {
+		return a._time_us < b._time_us;
+	});
+
+	std::string out(prefix);
+	out.reserve(prefix.size() + records.size() * 128);
+	for (auto& record : records) {
+		Format(record, out);
+	}
+	if (out.empty()) {
+		return;
+	}
+
+	if (_file) {
+		std::fwrite(out.data(), 1, out.size(), _file);
+		std::fflush(_file);
+		_file_size += out.size();
+		if (_file_size >= _max_file_size) {
+			RotateFile();
+		}
+	}
+	if (_b_console || !_file) {
+		std::fwrite(out.data(), 1, out.size(), stdout);
+		std::fflush(stdout);
+	}
+}
+
+void Logger::Format(const LogRecord& record, std::string& out) {
+	int64_t sec = record._time_us / 1000000;
+	if (sec != _cached_sec) {
+		std::time_t t = static_cast<std::time_t>(sec);
+		std::tm tm_time;
+#ifdef _WIN32
+		localtime_s(&tm_time, &t);
+#else
+		localtime_r(&t, &tm_time);
+#endif
+		std::strftime(_cached_prefix, sizeof(_cached_prefix), "%Y-%m-%d %H:%M:%S", &tm_time);
+		_cached_sec = sec;
+	}
+
+	char head[160];
+	int len = std::snprintf(head, sizeof(head), "%s.%06d %s [%u] %s:%d ", _cached_prefix,
+		static_cast<int>(record._time_us % 1000000), LEVEL_NAMES[static_cast<int>(record._level)],
+		record._thread, BaseName(record._file), record._line);
+	if (len > 0) {
+		out.append(head, std::min(static_cast<std::size_t>(len), sizeof(head) - 1));
+	}
+	out.append(record._text, record._len);
+	if (record._suppressed > 0) {
+		out.append(" [suppressed ");
+		out.append(std::to_string(record._suppressed));
+		out.append(" similar]");
+	}
+	out.push_back('\n');
+}
+
+void Logger::OpenFile() {
+	if (_name.empty()) {
+		return;
+	}
+	boost::system::error_code ec;
+	boost::filesystem::create_directories(_dir, ec);
+	auto path = (boost::filesystem::path(_dir) / (_name + ".log")).string();
+	_file = std::fopen(path.c_str(), "ab");
+	if (!_file) {
+		std::fprintf(stderr, "open log file %s failed, log to stdout\n", path.c_str());
+		return;
+	}
+	std::fseek(_file, 0, SEEK_END);
+	long size = std::ftell(_file);
+	_file_size = size > 0 ? static_cast<uint64_t>(size) : 0;
+}
+
+void Logger::RotateFile() {
+	std::fclose(_file);
+	_file = nullptr;
+	//name.log -> name.1.log -> ... -> name.N.log，最旧的删除
+	boost::filesystem::path dir(_dir);
+	boost::system::error_code ec;
+	auto rotated = [&](int index) {
+		return dir / (_name + "." + std::to_string(index) + ".log");
+	};
+	boost::filesystem::remove(rotated(_max_files), ec);
+	for (int i = _max_files - 1; i >= 1; --i) {
+		if (boost::filesystem::exists(rotated(i), ec)) {
+			boost::filesystem::rename(rotated(i), rotated(i + 1), ec);
+		}
+	}
+	boost::filesystem::rename(dir / (_name + ".log"), rotated(1), ec);
+	OpenFile();
+}
@@ -1,4 +1,5 @@
 #include "LogicSystem.h"
+#include "Logger.h"
 #include "HttpConnection.h"
 #include "VerifyGrpcClient.h"
 #include "RedisMgr.h"
@@ -23,14 +24,14 @@ LogicSystem::LogicSystem() {
 	// POST ģݿ洢̵ãemailѯûϢ
 	RegPost("/test_procedure", [](std::shared_ptr<HttpConnection> connection) {
 		auto body_str = boost::beast::buffers_to_string(connection->_request.body().data());
-		std::cout << "receive body is " << body_str << std::endl;
+		LOG_DEBUG("receive body is " << body_str);
 		connection->_response.set(http::field::content_type, "text/json");
 		Json::Value root;
 		Json::Reader reader;
 		Json::Value src_root;
 		bool parse_success = reader.parse(body_str, src_root);
 		if (!parse_success) {
-			std::cout << "Failed to parse JSON data!" << std::endl;
+			LOG_WARN("Failed to parse JSON data!");
 			root["error"] = ErrorCodes::Error_Json;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -38,7 +39,7 @@ LogicSystem::LogicSystem() {
 		}
 
 		if (!src_root.isMember("email")) {
-			std::cout << "Failed to parse JSON data!" << std::endl;
+			LOG_WARN("Failed to parse JSON data!");
 			root["error"] = ErrorCodes::Error_Json;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -49,7 +50,7 @@ LogicSystem::LogicSystem() {
 		int uid = 0;
 		std::string name = "";
 		//MysqlMgr::GetInstance()->TestProcedure(email, uid, name);
-		std::cout << "email is " << email << std::endl;
+		LOG_DEBUG("email is " << email);
 		root["error"] = ErrorCodes::Success;
 		root["email"] = src_root["email"];
 		root["name"] = name;
@@ -68,7 +69,7 @@ LogicSystem::LogicSystem() {
 		// 1. ȡPOSTĶݣתΪַΪJSONʽ
 		auto body_str = boost::beast::buffers_to_string(connection->_request.body().data());
 		// ԴӡյݣŲ
-		std::cout << "receive body is " << body_str << std::endl;
+		LOG_DEBUG("receive body is " << body_str);
 
 		// 2. Ӧͷ֪ͻӦΪJSONʽ
 		connection->_response.set(http::field::content_type, "text/json");
@@ -82,7 +83,7 @@ LogicSystem::LogicSystem() {
 
 		// 4. 쳣JSONʽ﷨󡢷Ǳ׼JSON
 		if (!parse_success) {
-			std::cout << "Failed to parse JSON data!" << std::endl;
+			LOG_WARN("Failed to parse JSON data!");
 			root["error"] = ErrorCodes::Error_Json; // JSONʧܴ
 			std::string jsonstr = root.toStyledString(); // תΪʽJSONַ
 			beast::ostream(connection->_response.body()) << jsonstr; // дӦ
@@ -91,7 +92,7 @@ LogicSystem::LogicSystem() {
 
 		// 5. У飺JSONǷemailֶ
 		if (!src_root.isMember("email")) {
-			std::cout << "Failed to parse JSON data! (missing email field)" << std::endl;
+			LOG_WARN("Failed to parse JSON data! (missing email field)");
 			root["error"] = ErrorCodes::Error_Json; // ȱٱҪJSON
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -105,7 +106,7 @@ LogicSystem::LogicSystem() {
 		GetVarifyRsp rsp = VerifyGrpcClient::GetInstance()->GetVarifyCode(email);
 
 		// Դӡַڸҵ
-		std::cout << "email is " << email << std::endl;
+		LOG_DEBUG("email is " << email);
 
 		// 8. ɹӦJSON루gRPCأַ
 		root["error"] = rsp.error(); // gRPCصĴ루ɹ/ʧܣ
@@ -119,14 +120,14 @@ LogicSystem::LogicSystem() {
 	//day11 עû߼
 	RegPost("/user_register", [](std::shared_ptr<HttpConnection> connection) {
 		auto body_str = boost::beast::buffers_to_string(connection->_request.body().data());
-		std::cout << "receive body is " << body_str << std::endl;
+		LOG_DEBUG("receive body is " << body_str);
 		connection->_response.set(http::field::content_type, "text/json");
 		Json::Value root;
 		Json::Reader reader;
 		Json::Value src_root;
 		bool parse_success = reader.parse(body_str, src_root);
 		if (!parse_success) {
-			std::cout << "Failed to parse JSON data!" << std::endl;
+			LOG_WARN("Failed to parse JSON data!");
 			root["error"] = ErrorCodes::Error_Json;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -140,7 +141,7 @@ LogicSystem::LogicSystem() {
 		auto icon = src_root["icon"].asString(); 
 
 		if (pwd != confirm) {
-			std::cout << "password err " << std::endl;
+			LOG_INFO("password err ");
 			root["error"] = ErrorCodes::PasswdErr;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -151,7 +152,7 @@ LogicSystem::LogicSystem() {
 		std::string  varify_code;
 		bool b_get_varify = RedisMgr::GetInstance()->Get(CODEPREFIX + src_root["email"].asString(), varify_code);
 		if (!b_get_varify) {
-			std::cout << " get varify code expired" << std::endl;
+			LOG_INFO(" get varify code expired");
 			root["error"] = ErrorCodes::VarifyExpired;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -159,7 +160,7 @@ LogicSystem::LogicSystem() {
 		}
 
 		if (varify_code != src_root["varifycode"].asString()) {
-			std::cout << " varify code error" << std::endl;
+			LOG_INFO(" varify code error");
 			root["error"] = ErrorCodes::VarifyCodeErr;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -169,7 +170,7 @@ LogicSystem::LogicSystem() {
 		//ݿжûǷ
 		int uid = MysqlMgr::GetInstance()->RegUser(name, email, pwd, icon);
 		if (uid == 0 || uid == -1) {
-			std::cout << " user or email exist" << std::endl;
+			LOG_INFO(" user or email exist");
 			root["error"] = ErrorCodes::UserExist;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -191,14 +192,14 @@ LogicSystem::LogicSystem() {
 	//ûص߼
 	RegPost("/reset_pwd", [](std::shared_ptr<HttpConnection> connection) {
 		auto body_str = boost::beast::buffers_to_string(connection->_request.body().data());
-		std::cout << "receive body is " << body_str << std::endl;
+		LOG_DEBUG("receive body is " << body_str);
 		connection->_response.set(http::field::content_type, "text/json");// ӦContent-TypeΪJSONʽ
 		Json::Value root;
 		Json::Reader reader;
 		Json::Value src_root;
 		bool parse_success = reader.parse(body_str, src_root);
 		if (!parse_success) {
-			std::cout << "Failed to parse JSON data!" << std::endl;
+			LOG_WARN("Failed to parse JSON data!");
 			root["error"] = ErrorCodes::Error_Json;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -214,7 +215,7 @@ LogicSystem::LogicSystem() {
 		std::string  varify_code;
 		bool b_get_varify = RedisMgr::GetInstance()->Get(CODEPREFIX + src_root["email"].asString(), varify_code);
 		if (!b_get_varify) {
-			std::cout << " get varify code expired" << std::endl;
+			LOG_INFO(" get varify code expired");
 			root["error"] = ErrorCodes::VarifyExpired;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -222,7 +223,7 @@ LogicSystem::LogicSystem() {
 		}
 
 		if (varify_code != src_root["varifycode"].asString()) {
-			std::cout << " varify code error" << std::endl;
+			LOG_INFO(" varify code error");
 			root["error"] = ErrorCodes::VarifyCodeErr;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -232,7 +233,7 @@ LogicSystem::LogicSystem() {
 		//ѯݿжûǷƥ
 		bool email_valid = MysqlMgr::GetInstance()->CheckEmail(name, email);
 		if (!email_valid) {
-			std::cout << " user email not match" << std::endl;
+			LOG_INFO(" user email not match");
 			root["error"] = ErrorCodes::EmailNotMatch;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -242,14 +243,14 @@ LogicSystem::LogicSystem() {
 		//Ϊ
 		bool b_up = MysqlMgr::GetInstance()->UpdatePwd(name, pwd);
 		if (!b_up) {
-			std::cout << " update pwd failed" << std::endl;
+			LOG_ERROR(" update pwd failed");
 			root["error"] = ErrorCodes::PasswdUpFailed;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
 			return true;
 		}
 
-		std::cout << "succeed to update password" << pwd << std::endl;
+		LOG_DEBUG("succeed to update password" << pwd);
 		root["error"] = 0;
 		root["email"] = email;
 		root["user"] = name;
@@ -265,14 +266,14 @@ LogicSystem::LogicSystem() {
 	//û¼߼
 	RegPost("/user_login", [](std::shared_ptr<HttpConnection> connection) {
 		auto body_str = boost::beast::buffers_to_string(connection->_request.body().data());
-		std::cout << "receive body is " << body_str << std::endl;
+		LOG_DEBUG("receive body is " << body_str);
 		connection->_response.set(http::field::content_type, "text/json");
 		Json::Value root;
 		Json::Reader reader;
 		Json::Value src_root;
 		bool parse_success = reader.parse(body_str, src_root);
 		if (!parse_success) {
-			std::cout << "Failed to parse JSON data!" << std::endl;
+			LOG_WARN("Failed to parse JSON data!");
 			root["error"] = ErrorCodes::Error_Json;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -285,7 +286,7 @@ LogicSystem::LogicSystem() {
 		//ѯݿжûǷƥ
 		bool pwd_valid = MysqlMgr::GetInstance()->CheckPwd(email, pwd, userInfo);
 		if (!pwd_valid) {
-			std::cout << " user pwd not match" << std::endl;
+			LOG_INFO(" user pwd not match");
 			root["error"] = ErrorCodes::PasswdInvalid;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
@@ -295,14 +296,14 @@ LogicSystem::LogicSystem() {
 		//ѯStatusServerҵʵ
 		auto reply = StatusGrpcClient::GetInstance()->GetChatServer(userInfo.uid);
 		if (reply.error()) {
-			std::cout << " grpc get chat server failed, error is " << reply.error() << std::endl;
+			LOG_ERROR(" grpc get chat server failed, error is " << reply.error());
 			root["error"] = ErrorCodes::RPCFailed;
 			std::string jsonstr = root.toStyledString();
 			beast::ostream(connection->_response.body()) << jsonstr;
 			return true;
 		}
 
-		std::cout << "succeed to load userinfo uid is " << userInfo.uid << std::endl;
+		LOG_INFO("succeed to load userinfo uid is " << userInfo.uid);
 		root["error"] = 0;
 		root["email"] = email;
 		root["uid"] = userInfo.uid;
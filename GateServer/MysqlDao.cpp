@@ -1,4 +1,5 @@
 #include "MysqlDao.h"
+#include "Logger.h"
 #include "ConfigMgr.h"
 
 MysqlDao::MysqlDao()
@@ -42,7 +43,7 @@ int MysqlDao::RegUser(const std::string& name, const std::string& email, const s
 		// ѯȡ洢̵ֵ
 		if (res->next()) {
 			int result = res->getInt("result");
-			std::cout << "Result: " << result << std::endl;
+			LOG_DEBUG("Result: " << result);
 			pool_->returnConnection(std::move(con)); // ݿӹ黹ӳ
 			return result;
 		}
@@ -51,9 +52,8 @@ int MysqlDao::RegUser(const std::string& name, const std::string& email, const s
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return -1;
 	}
 }
@@ -86,7 +86,7 @@ int MysqlDao::RegUserTransaction(const std::string& name, const std::string& ema
 		auto email_exist = res_email->next();
 		if (email_exist) {
 			con->_con->rollback();
-			std::cout << "email " << email << " exist";
+			LOG_DEBUG("email " << email << " exist");
 			return 0;
 		}
 
@@ -102,7 +102,7 @@ int MysqlDao::RegUserTransaction(const std::string& name, const std::string& ema
 		auto name_exist = res_name->next();
 		if (name_exist) {
 			con->_con->rollback();
-			std::cout << "name " << name << " exist";
+			LOG_DEBUG("name " << name << " exist");
 			return 0;
 		}
 
@@ -121,7 +121,7 @@ int MysqlDao::RegUserTransaction(const std::string& name, const std::string& ema
 			newId = res_uid->getInt("id");
 		}
 		else {
-			std::cout << "select id from user_id failed" << std::endl;
+			LOG_ERROR("select id from user_id failed");
 			con->_con->rollback();
 			return -1;
 		}
@@ -139,7 +139,7 @@ int MysqlDao::RegUserTransaction(const std::string& name, const std::string& ema
 		pstmt_insert->executeUpdate();
 		// ύ
 		con->_con->commit();
-		std::cout << "newuser insert into user success" << std::endl;
+		LOG_INFO("newuser insert into user success");
 		return newId;
 	}
 	catch (sql::SQLException& e) {
@@ -147,9 +147,8 @@ int MysqlDao::RegUserTransaction(const std::string& name, const std::string& ema
 		if (con) {
 			con->_con->rollback();
 		}
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return -1;
 	}
 }
@@ -172,7 +171,7 @@ bool MysqlDao::CheckEmail(const std::string& name, const std::string& email) {
 
 		// 
 		while (res->next()) {
-			std::cout << "Check Email: " << res->getString("email") << std::endl; 
+			LOG_DEBUG("Check Email: " << res->getString("email")); 
 			// Աݿе봫Ƿһ
 			if (email != res->getString("email")) { 
 				// ƥ黹Ӳfalse
@@ -187,9 +186,8 @@ bool MysqlDao::CheckEmail(const std::string& name, const std::string& email) {
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -211,15 +209,14 @@ bool MysqlDao::UpdatePwd(const std::string& name, const std::string& newpwd) {
 		// ִи
 		int updateCount = pstmt->executeUpdate();
 
-		std::cout << "Updated rows: " << updateCount << std::endl;
+		LOG_DEBUG("Updated rows: " << updateCount);
 		pool_->returnConnection(std::move(con));
 		return true;
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -246,7 +243,7 @@ bool MysqlDao::CheckPwd(const std::string& email, const std::string& pwd, UserIn
 		while (res->next()) {
 			origin_pwd = res->getString("pwd");
 			// ѯ
-			std::cout << "Password: " << origin_pwd << std::endl;
+			LOG_DEBUG("Password: " << origin_pwd);
 			break;
 		}
 
@@ -260,9 +257,8 @@ bool MysqlDao::CheckPwd(const std::string& email, const std::string& pwd, UserIn
 		return true;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
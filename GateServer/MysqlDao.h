@@ -1,5 +1,6 @@
 #pragma once
 #include "const.h"
+#include "Logger.h"
 #include <thread>
 #include <jdbc/mysql_driver.h>
 #include <jdbc/mysql_connection.h>
@@ -46,7 +47,7 @@ public:
 		}
 		catch (sql::SQLException& e) {
 			// 쳣
-			std::cout << "mysql pool init failed, error is " << e.what() << std::endl;
+			LOG_ERROR("mysql pool init failed, error is " << e.what());
 		}
 	}
 	// Ӽ߼ʱ̵߳ã֤ЧԣؽʧЧ
@@ -86,7 +87,7 @@ public:
 					con->_last_oper_time = timestamp;
 				}
 				catch (sql::SQLException& e) {
-					std::cout << "Error keeping connection alive: " << e.what() << std::endl;
+					LOG_ERROR("Error keeping connection alive: " << e.what());
 					healthy = false;
 					_fail_count++;
 				}
@@ -128,11 +129,11 @@ public:
 				pool_.push(std::move(newCon));
 			}
 
-			std::cout << "mysql connection reconnect success" << std::endl;
+			LOG_INFO("mysql connection reconnect success");
 			return true;
 		}
 		catch (sql::SQLException& e) {
-			std::cout << "Reconnect failed, error is " << e.what() << std::endl;
+			LOG_ERROR("Reconnect failed, error is " << e.what());
 			return false;
 		}
 	}
@@ -164,7 +165,7 @@ public:
 				//std::cout << "execute timer alive query , cur is " << timestamp << std::endl;
 			}
 			catch (sql::SQLException& e) {
-				std::cout << "Error keeping connection alive: " << e.what() << std::endl;
+				LOG_ERROR("Error keeping connection alive: " << e.what());
 				// ´Ӳ滻ɵ
 				sql::mysql::MySQL_Driver* driver = sql::mysql::get_mysql_driver_instance();
 				auto* newcon = driver->connect(url_, user_, pass_);
@@ -1,4 +1,5 @@
 #include "RedisMgr.h"
+#include "Logger.h"
 #include "ConfigMgr.h"
 
 // ֶдչ / ͨʽĳʼ߼ĬԱ޷ ģʽָԴ̳ϵ ⡣дĻᱨ
@@ -28,13 +29,13 @@ bool RedisMgr::Get(const std::string& key, std::string& value)
 	// ˴ִ "GET key"key.c_str() C++ַתΪCַhiredisҪ
 	auto reply = (redisReply*)redisCommand(connect, "GET %s", key.c_str());
 	if (reply == NULL) {
-		std::cout << "[ GET  " << key << " ] failed" << std::endl;
+		LOG_DEBUG("[ GET  " << key << " ] failed");
 		// freeReplyObject(reply); // ע˴⣡replyΪNULLʱûᴥδΪ
 		return false;
 	}
 
 	if (reply->type != REDIS_REPLY_STRING) {
-		std::cout << "[ GET  " << key << " ] failed" << std::endl;
+		LOG_DEBUG("[ GET  " << key << " ] failed");
 		//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 		freeReplyObject(reply);
 		return false;
@@ -43,7 +44,7 @@ bool RedisMgr::Get(const std::string& key, std::string& value)
 	value = reply->str;
 	freeReplyObject(reply);
 
-	std::cout << "Succeed to execute command [ GET " << key << "  ]" << std::endl;
+	LOG_DEBUG("Succeed to execute command [ GET " << key << "  ]");
 	return true;
 }
 
@@ -61,7 +62,7 @@ bool RedisMgr::Set(const std::string& key, const std::string& value) {
 	//NULL˵ִʧ
 	if (NULL == reply)
 	{
-		std::cout << "Execut command [ SET " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ SET " << key << "  " << value << " ] failure ! ");
 		// freeReplyObject(reply);
 		return false;
 	}
@@ -69,14 +70,14 @@ bool RedisMgr::Set(const std::string& key, const std::string& value) {
 	//ִʧͷ
 	if (!(reply->type == REDIS_REPLY_STATUS && (strcmp(reply->str, "OK") == 0 || strcmp(reply->str, "ok") == 0)))
 	{
-		std::cout << "Execut command [ SET " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ SET " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
 
 	//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 	freeReplyObject(reply);
-	std::cout << "Execut command [ SET " << key << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ SET " << key << "  " << value << " ] success ! ");
 	return true;
 }
 
@@ -89,14 +90,14 @@ bool RedisMgr::Auth(const std::string& password)
 	}
 	auto reply = (redisReply*)redisCommand(connect, "AUTH %s", password.c_str());
 	if (reply->type == REDIS_REPLY_ERROR) {
-		std::cout << "֤ʧ" << std::endl;
+		LOG_ERROR("֤ʧ");
 		freeReplyObject(reply);
 		return false;
 	}
 	else {
 		//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 		freeReplyObject(reply);
-		std::cout << "֤ɹ" << std::endl;
+		LOG_INFO("֤ɹ");
 		return true;
 	}
 }
@@ -111,19 +112,19 @@ bool RedisMgr::LPush(const std::string& key, const std::string& value)
 	auto reply = (redisReply*)redisCommand(connect, "LPUSH %s %s", key.c_str(), value.c_str());
 	if (NULL == reply)
 	{
-		std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ LPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
 	//  REDIS_REPLY_INTEGERͣ  Redis  LPUSH Ĺ̶Ӧͣʾִбĵǰȡ
 	// ִ LPUSH б³ȣ 0 
 	if (reply->type != REDIS_REPLY_INTEGER || reply->integer <= 0) {
-		std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ LPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
 
-	std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ LPUSH " << key << "  " << value << " ] success ! ");
 	freeReplyObject(reply);
 	return true;
 }
@@ -136,12 +137,12 @@ bool RedisMgr::LPop(const std::string& key, std::string& value) {
 	}
 	auto reply = (redisReply*)redisCommand(connect, "LPOP %s ", key.c_str());
 	if (reply == nullptr || reply->type == REDIS_REPLY_NIL) { // ִгɹݲ
-		std::cout << "Execut command [ LPOP " << key << " ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ LPOP " << key << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
 	value = reply->str; //  Redis صĵԪֵ0ֵ  ֱӸ
-	std::cout << "Execut command [ LPOP " << key << " ] success ! " << std::endl; 
+	LOG_DEBUG("Execut command [ LPOP " << key << " ] success ! "); 
 	freeReplyObject(reply);
 	return true;
 }
@@ -155,18 +156,18 @@ bool RedisMgr::RPush(const std::string& key, const std::string& value) {
 	auto reply = (redisReply*)redisCommand(connect, "RPUSH %s %s", key.c_str(), value.c_str());
 	if (NULL == reply)
 	{
-		std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ RPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
 
 	if (reply->type != REDIS_REPLY_INTEGER || reply->integer <= 0) {
-		std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ RPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
 
-	std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ RPUSH " << key << "  " << value << " ] success ! ");
 	freeReplyObject(reply);
 	return true;
 }
@@ -179,12 +180,12 @@ bool RedisMgr::RPop(const std::string& key, std::string& value) {
 	}
 	auto reply = (redisReply*)redisCommand(connect, "RPOP %s ", key.c_str());
 	if (reply == nullptr || reply->type == REDIS_REPLY_NIL) {
-		std::cout << "Execut command [ RPOP " << key << " ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ RPOP " << key << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
 	value = reply->str;
-	std::cout << "Execut command [ RPOP " << key << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ RPOP " << key << " ] success ! ");
 	freeReplyObject(reply);
 	return true;
 }
@@ -205,11 +206,11 @@ bool RedisMgr::HSet(const std::string& key, const std::string& hkey, const std::
 	}
 	auto reply = (redisReply*)redisCommand(connect, "HSET %s %s %s", key.c_str(), hkey.c_str(), value.c_str());
 	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
-	std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] success ! ");
 	freeReplyObject(reply);
 	return true;
 }
@@ -242,11 +243,11 @@ bool RedisMgr::HSet(const char* key, const char* hkey, const char* hvalue, size_
 	argvlen[3] = hvaluelen;
 	auto reply = (redisReply*)redisCommandArgv(connect, 4, argv, argvlen);
 	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
-	std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] success ! ");
 	freeReplyObject(reply);
 	return true;
 }
@@ -276,13 +277,13 @@ std::string RedisMgr::HGet(const std::string& key, const std::string& hkey)
 	auto reply = (redisReply*)redisCommandArgv(connect, 3, argv, argvlen);
 	if (reply == nullptr || reply->type == REDIS_REPLY_NIL) {
 		freeReplyObject(reply);
-		std::cout << "Execut command [ HGet " << key << " " << hkey << "  ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ HGet " << key << " " << hkey << "  ] failure ! ");
 		return "";
 	}
 
 	std::string value = reply->str;
 	freeReplyObject(reply);
-	std::cout << "Execut command [ HGet " << key << " " << hkey << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ HGet " << key << " " << hkey << " ] success ! ");
 	return value;
 }
 
@@ -295,11 +296,11 @@ bool RedisMgr::Del(const std::string& key)
 	}
 	auto reply = (redisReply*)redisCommand(connect, "DEL %s", key.c_str());
 	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ Del " << key << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ Del " << key << " ] failure ! ");
 		freeReplyObject(reply);
 		return false;
 	}
-	std::cout << "Execut command [ Del " << key << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ Del " << key << " ] success ! ");
 	freeReplyObject(reply);
 	return true;
 }
@@ -313,11 +314,11 @@ bool RedisMgr::ExistsKey(const std::string& key)
 	}
 	auto reply = (redisReply*)redisCommand(connect, "exists %s", key.c_str());
 	if (reply == nullptr || reply->type != REDIS_REPLY_INTEGER || reply->integer == 0) {
-		std::cout << "Not Found [ Key " << key << " ]  ! " << std::endl;
+		LOG_DEBUG("Not Found [ Key " << key << " ]  ! ");
 		freeReplyObject(reply);
 		return false;
 	}
-	std::cout << " Found [ Key " << key << " ] exists ! " << std::endl;
+	LOG_DEBUG(" Found [ Key " << key << " ] exists ! ");
 	freeReplyObject(reply);
 	return true;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "const.h"
+#include "Logger.h"
 
 // װredisӳ
 class RedisConPool {
@@ -17,7 +18,7 @@ public:
 
 			auto reply = (redisReply*)redisCommand(context, "AUTH %s", pwd);
 			if (reply->type == REDIS_REPLY_ERROR) {
-				std::cout << "֤ʧ" << std::endl;
+				LOG_ERROR("֤ʧ");
 				//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 				freeReplyObject(reply);
 				redisFree(context);
@@ -26,7 +27,7 @@ public:
 
 			//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 			freeReplyObject(reply);
-			std::cout << "֤ɹ" << std::endl;
+			LOG_INFO("֤ɹ");
 			connections_.push(context);
 		}
 	}
@@ -3,6 +3,7 @@
 #include <memory>
 #include <mutex>
 #include <iostream>
+#include "Logger.h"
 template <typename T>
 class Singleton {
 protected:
@@ -19,10 +20,10 @@ public:
         return _instance;
     }
     void PrintAddress() {
-        std::cout << _instance.get() << std::endl;
+        LOG_DEBUG(_instance.get());
     }
     ~Singleton() {
-        std::cout << "this is singleton destruct" << std::endl;
+        LOG_DEBUG("this is singleton destruct");
     }
 };
 template <typename T>
@@ -1,5 +1,6 @@
 ﻿#include "AsioIOServicePool.h"
 #include <iostream>
+#include "Logger.h"
 using namespace std;
 
 /**
@@ -32,7 +33,7 @@ AsioIOServicePool::AsioIOServicePool(std::size_t size)
 
 AsioIOServicePool::~AsioIOServicePool() {
 	Stop(); // 利用 RAII 机制，确保对象销毁时资源正确释放
-	std::cout << "AsioIOServicePool destruct" << std::endl;
+	LOG_INFO("AsioIOServicePool destruct");
 }
 
 boost::asio::io_context& AsioIOServicePool::GetIOService() {
@@ -1,10 +1,11 @@
 #include "ConfigMgr.h"
+#include "Logger.h"
 ConfigMgr::ConfigMgr(){
 	// ȡǰĿ¼  
 	boost::filesystem::path current_path = boost::filesystem::current_path();
 	// config.iniļ·  
 	boost::filesystem::path config_path = current_path / "config.ini";
-	std::cout << "Config path: " << config_path << std::endl;
+	LOG_INFO("Config path: " << config_path);
 
 	// ʹBoost.PropertyTreeȡINIļ  
 	boost::property_tree::ptree pt;
@@ -33,9 +34,9 @@ ConfigMgr::ConfigMgr(){
 	for (const auto& section_entry : _config_map) {
 		const std::string& section_name = section_entry.first;
 		SectionInfo section_config = section_entry.second;
-		std::cout << "[" << section_name << "]" << std::endl;
+		LOG_INFO("[" << section_name << "]");
 		for (const auto& key_value_pair : section_config._section_datas) {
-			std::cout << key_value_pair.first << "=" << key_value_pair.second << std::endl;
+			LOG_INFO(key_value_pair.first << "=" << key_value_pair.second);
 		}
 	}
 
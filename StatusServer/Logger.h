@@ -0,0 +1,268 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <type_traits>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+// 异步日志
+// 1. LOG_TRACE ~ LOG_ERROR按流的方式拼接内容，例如 LOG_INFO("uid is " << uid)
+// 2. 低于LOG_ACTIVE_LEVEL的宏在编译期展开为空，不会对参数求值；运行期级别由config.ini的[Log]Level控制
+// 3. 每个线程把日志写入自己的无锁环形缓冲区，后台写线程批量取出，按时间排序后写入文件，
+//    业务线程不加锁也不做io，缓冲区满时丢弃并计数
+// 4. 同一处日志每秒超过[Log]RateLimit条后不再输出，之后第一条输出时附带被抑制的条数
+// 5. Init之前和Stop之后的日志直接同步写到标准输出
+enum class LogLevel : int {
+	Trace = 0,
+	Debug = 1,
+	Info = 2,
+	Warn = 3,
+	Error = 4,
+	Off = 5,
+};
+
+#ifndef LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define LOG_ACTIVE_LEVEL 1
+#else
+#define LOG_ACTIVE_LEVEL 0
+#endif
+#endif
+
+// 一条日志的拼接缓冲区，放在调用方的栈上，超出容量的部分截断
+class LogStream {
+public:
+	static const std::size_t CAPACITY = 456;
+
+	LogStream() :_len(0) {}
+
+	LogStream& operator<<(const char* str);
+	LogStream& operator<<(char* str) {
+		return *this << static_cast<const char*>(str);
+	}
+	LogStream& operator<<(const std::string& str) {
+		Append(str.data(), str.size());
+		return *this;
+	}
+	LogStream& operator<<(char ch) {
+		Append(&ch, 1);
+		return *this;
+	}
+	LogStream& operator<<(bool value) {
+		return *this << (value ? "true" : "false");
+	}
+	LogStream& operator<<(short value) { return AppendInt(value); }
+	LogStream& operator<<(unsigned short value) { return AppendUInt(value); }
+	LogStream& operator<<(int value) { return AppendInt(value); }
+	LogStream& operator<<(unsigned int value) { return AppendUInt(value); }
+	LogStream& operator<<(long value) { return AppendInt(value); }
+	LogStream& operator<<(unsigned long value) { return AppendUInt(value); }
+	LogStream& operator<<(long long value) { return AppendInt(value); }
+	LogStream& operator<<(unsigned long long value) { return AppendUInt(value); }
+	LogStream& operator<<(double value);
+	LogStream& operator<<(const void* ptr);
+
+	template <typename T>
+	typename std::enable_if<std::is_enum<T>::value, LogStream&>::type operator<<(T value) {
+		return AppendInt(static_cast<long long>(value));
+	}
+
+	// 其余类型(endpoint、path等)借助ostringstream格式化，不在高频路径上使用
+	template <typename T>
+	typename std::enable_if<!std::is_enum<T>::value && !std::is_arithmetic<T>::value
+		&& !std::is_convertible<const T&, const char*>::value
+		&& !std::is_convertible<const T&, const void*>::value, LogStream&>::type
+		operator<<(const T& value) {
+		std::ostringstream oss;
+		oss << value;
+		return *this << oss.str();
+	}
+
+	const char* Data() const {
+		return _buf;
+	}
+
+	std::size_t Size() const {
+		return _len;
+	}
+
+private:
+	void Append(const char* data, std::size_t len);
+	LogStream& AppendInt(long long value);
+	LogStream& AppendUInt(unsigned long long value);
+
+	char _buf[CAPACITY];
+	std::size_t _len;
+};
+
+// 每个日志调用点一个，统计当前一秒内的输出条数，超过限额的丢弃并记录条数
+class LogSite {
+public:
+	LogSite() :_window(0), _count(0), _suppressed(0) {}
+	bool Allow();
+	// 取出并清零被抑制的条数
+	uint32_t TakeSuppressed() {
+		return _suppressed.exchange(0, std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<int64_t> _window;
+	std::atomic<uint32_t> _count;
+	std::atomic<uint32_t> _suppressed;
+};
+
+struct LogRecord {
+	int64_t _time_us;      // 系统时间，微秒
+	const char* _file;
+	int _line;
+	LogLevel _level;
+	uint32_t _thread;      // 日志线程序号
+	uint32_t _suppressed;  // 该调用点在此之前被限流丢弃的条数
+	uint32_t _len;
+	char _text[LogStream::CAPACITY];
+};
+
+// 单生产者单消费者环形缓冲区，生产者为所属线程，消费者为写线程
+class LogRing {
+public:
+	static const std::size_t SIZE = 512;
+
+	explicit LogRing(uint32_t thread) :_head(0), _tail(0), _dropped(0), _b_closed(false), _thread(thread) {}
+	// 缓冲区满时返回false
+	bool Push(const LogRecord& record);
+	// 写线程调用，最多取出max条追加到out
+	std::size_t PopTo(std::vector<LogRecord>& out, std::size_t max);
+	bool Empty() const {
+		return Size() == 0;
+	}
+	std::size_t Size() const {
+		return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+	}
+	uint32_t Thread() const {
+		return _thread;
+	}
+
+	std::atomic<uint64_t> _dropped;
+	std::atomic<bool> _b_closed;  // 所属线程已退出，取空后由写线程移除
+
+private:
+	// 读写位置分开放在不同缓存行，避免生产者和写线程互相干扰
+	std::atomic<std::size_t> _head;
+	char _pad0[64];
+	std::atomic<std::size_t> _tail;
+	char _pad1[64];
+	uint32_t _thread;
+	LogRecord _records[SIZE];
+};
+
+class Logger
+{
+public:
+	// 不会被析构，静态对象析构时仍然可以写日志
+	static Logger& Inst();
+	Logger(const Logger&) = delete;
+	Logger& operator=(const Logger&) = delete;
+
+	// 读取[Log]配置并启动写线程，日志文件为 Dir/name.log
+	void Init(const std::string& name);
+	// 写完缓冲区中剩余的日志后停止写线程
+	void Stop();
+
+	bool Enabled(LogLevel level) const {
+		return static_cast<int>(level) >= _level.load(std::memory_order_relaxed);
+	}
+	void SetLevel(LogLevel level) {
+		_level.store(static_cast<int>(level), std::memory_order_relaxed);
+	}
+	uint32_t RateLimit() const {
+		return _rate_limit;
+	}
+
+	void Write(LogLevel level, const char* file, int line, LogSite& site, const LogStream& stream);
+
+	static LogLevel ParseLevel(const std::string& name, LogLevel def);
+
+private:
+	Logger();
+	LogRing* LocalRing();
+	void WriteLoop();
+	// 把一批日志格式化后写入文件，prefix为写在前面的丢弃提示，调用方需持有_sync_mtx
+	void Output(std::vector<LogRecord>& records, const std::string& prefix);
+	void Format(const LogRecord& record, std::string& out);
+	void OpenFile();
+	void RotateFile();
+	void WriteDropped(uint32_t thread, uint64_t dropped, std::string& out);
+
+	std::atomic<int> _level;
+	uint32_t _rate_limit;
+	std::atomic<bool> _b_running;
+	std::atomic<bool> _b_stop;
+	std::atomic<uint32_t> _thread_seq;
+
+	std::mutex _rings_mtx;
+	std::vector<std::shared_ptr<LogRing>> _rings;
+
+	std::mutex _sync_mtx;      // 同步输出时保护文件和格式化缓存
+	std::mutex _wait_mtx;
+	std::condition_variable _wait_cond;
+	std::thread _writer;
+
+	std::string _dir;
+	std::string _name;
+	std::FILE* _file;
+	uint64_t _file_size;
+	uint64_t _max_file_size;
+	int _max_files;
+	int _flush_interval_ms;
+	bool _b_console;
+
+	int64_t _cached_sec;       // 最近一次格式化的秒数，同一秒内复用日期时间前缀
+	char _cached_prefix[32];
+};
+
+#define LOG_WRITE(level, ...) \
+	do { \
+		if (Logger::Inst().Enabled(level)) { \
+			static LogSite _log_site; \
+			if (_log_site.Allow()) { \
+				LogStream _log_stream; \
+				_log_stream << __VA_ARGS__; \
+				Logger::Inst().Write(level, __FILE__, __LINE__, _log_site, _log_stream); \
+			} \
+		} \
+	} while (0)
+
+#define LOG_DISABLED(...) do {} while (0)
+
+#if LOG_ACTIVE_LEVEL <= 0
+#define LOG_TRACE(...) LOG_WRITE(LogLevel::Trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= 1
+#define LOG_DEBUG(...) LOG_WRITE(LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= 2
+#define LOG_INFO(...) LOG_WRITE(LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= 3
+#define LOG_WARN(...) LOG_WRITE(LogLevel::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#define LOG_ERROR(...) LOG_WRITE(LogLevel::Error, __VA_ARGS__)
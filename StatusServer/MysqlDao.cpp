@@ -1,4 +1,5 @@
 #include "MysqlDao.h"
+#include "Logger.h"
 #include "ConfigMgr.h"
 
 MysqlDao::MysqlDao()
@@ -40,7 +41,7 @@ int MysqlDao::RegUser(const std::string& name, const std::string& email, const s
 	  unique_ptr<sql::ResultSet> res(stmtResult->executeQuery("SELECT @result AS result"));
 	  if (res->next()) {
 	       int result = res->getInt("result");
-	      cout << "Result: " << result << endl;
+	      LOG_DEBUG("Result: " << result);
 		  pool_->returnConnection(std::move(con));
 		  return result;
 	  }
@@ -49,9 +50,8 @@ int MysqlDao::RegUser(const std::string& name, const std::string& email, const s
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return -1;
 	}
 }
@@ -74,7 +74,7 @@ bool MysqlDao::CheckEmail(const std::string& name, const std::string& email) {
 
 		// 
 		while (res->next()) {
-			std::cout << "Check Email: " << res->getString("email") << std::endl;
+			LOG_DEBUG("Check Email: " << res->getString("email"));
 			if (email != res->getString("email")) {
 				pool_->returnConnection(std::move(con));
 				return false;
@@ -86,9 +86,8 @@ bool MysqlDao::CheckEmail(const std::string& name, const std::string& email) {
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -110,15 +109,14 @@ bool MysqlDao::UpdatePwd(const std::string& name, const std::string& newpwd) {
 		// ִи
 		int updateCount = pstmt->executeUpdate();
 
-		std::cout << "Updated rows: " << updateCount << std::endl;
+		LOG_DEBUG("Updated rows: " << updateCount);
 		pool_->returnConnection(std::move(con));
 		return true;
 	}
 	catch (sql::SQLException& e) {
 		pool_->returnConnection(std::move(con));
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -147,7 +145,7 @@ bool MysqlDao::CheckPwd(const std::string& name, const std::string& pwd, UserInf
 		while (res->next()) {
 			origin_pwd = res->getString("pwd");
 			// ѯ
-			std::cout << "Password: " << origin_pwd << std::endl;
+			LOG_DEBUG("Password: " << origin_pwd);
 			break;
 		}
 
@@ -161,9 +159,8 @@ bool MysqlDao::CheckPwd(const std::string& name, const std::string& pwd, UserInf
 		return true;
 	}
 	catch (sql::SQLException& e) {
-		std::cerr << "SQLException: " << e.what();
-		std::cerr << " (MySQL error code: " << e.getErrorCode();
-		std::cerr << ", SQLState: " << e.getSQLState() << " )" << std::endl;
+		LOG_ERROR("SQLException: " << e.what() << " (MySQL error code: " << e.getErrorCode()
+			<< ", SQLState: " << e.getSQLState() << " )");
 		return false;
 	}
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "const.h"
+#include "Logger.h"
 #include <thread>
 
 class SqlConnection {
@@ -36,7 +37,7 @@ public:
 		}
 		catch (sql::SQLException& e) {
 			// 쳣
-			std::cout << "mysql pool init failed, error is " << e.what()<< std::endl;
+			LOG_ERROR("mysql pool init failed, error is " << e.what());
 		}
 	}
 
@@ -65,7 +66,7 @@ public:
 				//std::cout << "execute timer alive query , cur is " << timestamp << std::endl;
 			}
 			catch (sql::SQLException& e) {
-				std::cout << "Error keeping connection alive: " << e.what() << std::endl;
+				LOG_ERROR("Error keeping connection alive: " << e.what());
 				// ´Ӳ滻ɵ
 				sql::mysql::MySQL_Driver* driver = sql::mysql::get_mysql_driver_instance();
 				auto* newcon = driver->connect(url_, user_, pass_);
@@ -1,4 +1,5 @@
 #include "RedisMgr.h"
+#include "Logger.h"
 #include "const.h"
 #include "ConfigMgr.h"
 #include "DistLock.h"
@@ -24,14 +25,14 @@ bool RedisMgr::Get(const std::string& key, std::string& value)
 	}
 	 auto reply = (redisReply*)redisCommand(connect, "GET %s", key.c_str());
 	 if (reply == NULL) {
-		 std::cout << "[ GET  " << key << " ] failed" << std::endl;
+		 LOG_DEBUG("[ GET  " << key << " ] failed");
 		// freeReplyObject(reply);
 		 _con_pool->returnConnection(connect);
 		  return false;
 	}
 
 	 if (reply->type != REDIS_REPLY_STRING) {
-		 std::cout << "[ GET  " << key << " ] failed" << std::endl;
+		 LOG_DEBUG("[ GET  " << key << " ] failed");
 		 freeReplyObject(reply);
 		 _con_pool->returnConnection(connect);
 		 return false;
@@ -40,7 +41,7 @@ bool RedisMgr::Get(const std::string& key, std::string& value)
 	 value = reply->str;
 	 freeReplyObject(reply);
 
-	 std::cout << "Succeed to execute command [ GET " << key << "  ]" << std::endl;
+	 LOG_DEBUG("Succeed to execute command [ GET " << key << "  ]");
 	 _con_pool->returnConnection(connect);
 	 return true;
 }
@@ -56,7 +57,7 @@ bool RedisMgr::Set(const std::string &key, const std::string &value){
 	//NULL˵ִʧ
 	if (NULL == reply)
 	{
-		std::cout << "Execut command [ SET " << key << "  "<< value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ SET " << key << "  "<< value << " ] failure ! ");
 		//freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
@@ -65,7 +66,7 @@ bool RedisMgr::Set(const std::string &key, const std::string &value){
 	//ִʧͷ
 	if (!(reply->type == REDIS_REPLY_STATUS && (strcmp(reply->str, "OK") == 0 || strcmp(reply->str, "ok") == 0)))
 	{
-		std::cout << "Execut command [ SET " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ SET " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
@@ -73,7 +74,7 @@ bool RedisMgr::Set(const std::string &key, const std::string &value){
 
 	//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 	freeReplyObject(reply);
-	std::cout << "Execut command [ SET " << key << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ SET " << key << "  " << value << " ] success ! ");
 	_con_pool->returnConnection(connect);
 	return true;
 }
@@ -87,20 +88,20 @@ bool RedisMgr::LPush(const std::string &key, const std::string &value)
 	auto reply = (redisReply*)redisCommand(connect, "LPUSH %s %s", key.c_str(), value.c_str());
 	if (NULL == reply)
 	{
-		std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ LPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if (reply->type != REDIS_REPLY_INTEGER || reply->integer <= 0) {
-		std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ LPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
-	std::cout << "Execut command [ LPUSH " << key << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ LPUSH " << key << "  " << value << " ] success ! ");
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
 	return true;
@@ -113,20 +114,20 @@ bool RedisMgr::LPop(const std::string &key, std::string& value){
 	}
 	auto reply = (redisReply*)redisCommand(connect, "LPOP %s ", key.c_str());
 	if (reply == nullptr ) {
-		std::cout << "Execut command [ LPOP " << key<<  " ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ LPOP " << key<<  " ] failure ! ");
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if (reply->type == REDIS_REPLY_NIL) {
-		std::cout << "Execut command [ LPOP " << key << " ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ LPOP " << key << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	value = reply->str;
-	std::cout << "Execut command [ LPOP " << key <<  " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ LPOP " << key <<  " ] success ! ");
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
 	return true;
@@ -140,20 +141,20 @@ bool RedisMgr::RPush(const std::string& key, const std::string& value) {
 	auto reply = (redisReply*)redisCommand(connect, "RPUSH %s %s", key.c_str(), value.c_str());
 	if (NULL == reply)
 	{
-		std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ RPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if (reply->type != REDIS_REPLY_INTEGER || reply->integer <= 0) {
-		std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ RPUSH " << key << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
-	std::cout << "Execut command [ RPUSH " << key << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ RPUSH " << key << "  " << value << " ] success ! ");
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
 	return true;
@@ -165,19 +166,19 @@ bool RedisMgr::RPop(const std::string& key, std::string& value) {
 	}
 	auto reply = (redisReply*)redisCommand(connect, "RPOP %s ", key.c_str());
 	if (reply == nullptr ) {
-		std::cout << "Execut command [ RPOP " << key << " ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ RPOP " << key << " ] failure ! ");
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if (reply->type == REDIS_REPLY_NIL) {
-		std::cout << "Execut command [ RPOP " << key << " ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ RPOP " << key << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 	value = reply->str;
-	std::cout << "Execut command [ RPOP " << key << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ RPOP " << key << " ] success ! ");
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
 	return true;
@@ -190,19 +191,19 @@ bool RedisMgr::HSet(const std::string &key, const std::string &hkey, const std::
 	}
 	auto reply = (redisReply*)redisCommand(connect, "HSET %s %s %s", key.c_str(), hkey.c_str(), value.c_str());
 	if (reply == nullptr ) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey <<"  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ HSet " << key << "  " << hkey <<"  " << value << " ] failure ! ");
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if (reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
-	std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ HSet " << key << "  " << hkey << "  " << value << " ] success ! ");
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
 	return true;
@@ -227,18 +228,18 @@ bool RedisMgr::HSet(const char* key, const char* hkey, const char* hvalue, size_
 
 	auto reply = (redisReply*)redisCommandArgv(connect, 4, argv, argvlen);
 	if (reply == nullptr ) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! ");
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if (reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
-	std::cout << "Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ HSet " << key << "  " << hkey << "  " << hvalue << " ] success ! ");
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
 	return true;
@@ -261,14 +262,14 @@ std::string RedisMgr::HGet(const std::string &key, const std::string &hkey)
 	
 	auto reply = (redisReply*)redisCommandArgv(connect, 3, argv, argvlen);
 	if (reply == nullptr ) {
-		std::cout << "Execut command [ HGet " << key << " "<< hkey <<"  ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ HGet " << key << " "<< hkey <<"  ] failure ! ");
 		_con_pool->returnConnection(connect);
 		return "";
 	}
 
 	if ( reply->type == REDIS_REPLY_NIL) {
 		freeReplyObject(reply);
-		std::cout << "Execut command [ HGet " << key << " " << hkey << "  ] failure ! " << std::endl;
+		LOG_DEBUG("Execut command [ HGet " << key << " " << hkey << "  ] failure ! ");
 		_con_pool->returnConnection(connect);
 		return "";
 	}
@@ -276,7 +277,7 @@ std::string RedisMgr::HGet(const std::string &key, const std::string &hkey)
 	std::string value = reply->str;
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
-	std::cout << "Execut command [ HGet " << key << " " << hkey << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ HGet " << key << " " << hkey << " ] success ! ");
 	return value;
 }
 
@@ -293,7 +294,7 @@ bool RedisMgr::HDel(const std::string& key, const std::string& field)
 
 	redisReply* reply = (redisReply*)redisCommand(connect, "HDEL %s %s", key.c_str(), field.c_str());
 	if (reply == nullptr) {
-		std::cerr << "HDEL command failed" << std::endl;
+		LOG_ERROR("HDEL command failed");
 		return false;
 	}
 
@@ -314,19 +315,19 @@ bool RedisMgr::Del(const std::string &key)
 	}
 	auto reply = (redisReply*)redisCommand(connect, "DEL %s", key.c_str());
 	if (reply == nullptr ) {
-		std::cout << "Execut command [ Del " << key <<  " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ Del " << key <<  " ] failure ! ");
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if ( reply->type != REDIS_REPLY_INTEGER) {
-		std::cout << "Execut command [ Del " << key << " ] failure ! " << std::endl;
+		LOG_ERROR("Execut command [ Del " << key << " ] failure ! ");
 		freeReplyObject(reply);
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
-	std::cout << "Execut command [ Del " << key << " ] success ! " << std::endl;
+	LOG_DEBUG("Execut command [ Del " << key << " ] success ! ");
 	 freeReplyObject(reply);
 	 _con_pool->returnConnection(connect);
 	 return true;
@@ -341,18 +342,18 @@ bool RedisMgr::ExistsKey(const std::string &key)
 
 	auto reply = (redisReply*)redisCommand(connect, "exists %s", key.c_str());
 	if (reply == nullptr ) {
-		std::cout << "Not Found [ Key " << key << " ]  ! " << std::endl;
+		LOG_DEBUG("Not Found [ Key " << key << " ]  ! ");
 		_con_pool->returnConnection(connect);
 		return false;
 	}
 
 	if (reply->type != REDIS_REPLY_INTEGER || reply->integer == 0) {
-		std::cout << "Not Found [ Key " << key << " ]  ! " << std::endl;
+		LOG_DEBUG("Not Found [ Key " << key << " ]  ! ");
 		_con_pool->returnConnection(connect);
 		freeReplyObject(reply);
 		return false;
 	}
-	std::cout << " Found [ Key " << key << " ] exists ! " << std::endl;
+	LOG_DEBUG(" Found [ Key " << key << " ] exists ! ");
 	freeReplyObject(reply);
 	_con_pool->returnConnection(connect);
 	return true;
@@ -1,5 +1,6 @@
 #pragma once
 #include "const.h"
+#include "Logger.h"
 #include "hiredis.h"
 #include <queue>
 #include <atomic>
@@ -20,7 +21,7 @@ public:
 
 			auto reply = (redisReply*)redisCommand(context, "AUTH %s", pwd);
 			if (reply->type == REDIS_REPLY_ERROR) {
-				std::cout << "֤ʧ" << std::endl;
+				LOG_ERROR("֤ʧ");
 				//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 				freeReplyObject(reply);
 				continue;
@@ -28,7 +29,7 @@ public:
 
 			//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 			freeReplyObject(reply);
-			std::cout << "֤ɹ" << std::endl;
+			LOG_INFO("֤ɹ");
 			connections_.push(context);
 		}
 
@@ -129,7 +130,7 @@ private:
 				reply = (redisReply*)redisCommand(context, "PING");
 				//2. ȿײ I/O Эûд
 				if (context->err) {
-					std::cout << "Connection error:" << context->err << std::endl;
+					LOG_ERROR("Connection error:" << context->err);
 					if (reply) {
 						freeReplyObject(reply);
 					}
@@ -141,7 +142,7 @@ private:
 
 				//3. ٿRedisصǲERROR
 				if (!reply || reply->type == REDIS_REPLY_ERROR) {
-					std::cout << "reply is null,  redis ping failed: " << std::endl;
+					LOG_ERROR("reply is null,  redis ping failed: ");
 					if (reply) {
 						freeReplyObject(reply);
 					}
@@ -189,7 +190,7 @@ private:
 
 		auto reply = (redisReply*)redisCommand(context, "AUTH %s", pwd_);
 		if (reply->type == REDIS_REPLY_ERROR) {
-			std::cout << "֤ʧ" << std::endl;
+			LOG_ERROR("֤ʧ");
 			//ִͷŲ
 			freeReplyObject(reply);
 			redisFree(context);
@@ -198,7 +199,7 @@ private:
 
 		//ִгɹͷredisCommandִк󷵻صredisReplyռõڴ
 		freeReplyObject(reply);
-		std::cout << "֤ɹ" << std::endl;
+		LOG_INFO("֤ɹ");
 		returnConnection(context);
 		return true;
 	}
@@ -215,7 +216,7 @@ private:
 			try {
 				auto reply = (redisReply*)redisCommand(context, "PING");
 				if (!reply) {
-					std::cout << "reply is null, redis ping failed: " << std::endl;
+					LOG_ERROR("reply is null, redis ping failed: ");
 					connections_.push(context);
 					continue;
 				}
@@ -223,7 +224,7 @@ private:
 				connections_.push(context);
 			}
 			catch(std::exception& exp){
-				std::cout << "Error keeping connection alive: " << exp.what() << std::endl;
+				LOG_ERROR("Error keeping connection alive: " << exp.what());
 				redisFree(context);
 				context = redisConnect(host_, port_);
 				if (context == nullptr || context->err != 0) {
@@ -235,7 +236,7 @@ private:
 
 				auto reply = (redisReply*)redisCommand(context, "AUTH %s", pwd_);
 				if (reply->type == REDIS_REPLY_ERROR) {
-					std::cout << "֤ʧ" << std::endl;
+					LOG_ERROR("֤ʧ");
 					//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 					freeReplyObject(reply);
 					continue;
@@ -243,7 +244,7 @@ private:
 
 				//ִгɹ ͷredisCommandִк󷵻صredisReplyռõڴ
 				freeReplyObject(reply);
-				std::cout << "֤ɹ" << std::endl;
+				LOG_INFO("֤ɹ");
 				connections_.push(context);
 			}
 		}
@@ -2,6 +2,7 @@
 #include <memory>
 #include <mutex>
 #include <iostream>
+#include "Logger.h"
 using namespace std;
 template <typename T>
 class Singleton {
@@ -21,10 +22,10 @@ public:
 		return _instance;
 	}
 	void PrintAddress() {
-		std::cout << _instance.get() << endl;
+		LOG_DEBUG(_instance.get());
 	}
 	~Singleton() {
-		std::cout << "this is singleton destruct" << std::endl;
+		LOG_DEBUG("this is singleton destruct");
 	}
 };
 
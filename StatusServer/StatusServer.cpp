@@ -3,6 +3,7 @@
 #include <json/value.h>
 #include <json/reader.h>
 #include "const.h"
+#include "Logger.h"
 #include "ConfigMgr.h"
 #include "hiredis.h"
 #include "RedisMgr.h"
@@ -24,7 +25,7 @@ void RunServer() {
     builder.RegisterService(&service);
     // 构建并启动gRPC服务器
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
-    std::cout << "Server listening on " << server_address << std::endl;
+    LOG_INFO("Server listening on " << server_address);
     // 创建Boost.Asio的io_context
     boost::asio::io_context io_context;
     // 创建signal_set用于捕获SIGINT
@@ -32,7 +33,7 @@ void RunServer() {
     // 设置异步等待SIGINT信号
     signals.async_wait([&server](const boost::system::error_code& error, int signal_number) {
         if (!error) {
-            std::cout << "Shutting down server..." << std::endl;
+            LOG_INFO("Shutting down server...");
             server->Shutdown(); // 优雅地关闭服务器
         }
         });
@@ -44,12 +45,15 @@ void RunServer() {
 }
 
 int main(int argc, char** argv) {
+    Logger::Inst().Init("statusserver");
     try {
         RunServer();
     }
     catch (std::exception const& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        LOG_ERROR("Error: " << e.what());
+        Logger::Inst().Stop();
         return EXIT_FAILURE;
     }
+    Logger::Inst().Stop();
     return 0;
 }
\ No newline at end of file
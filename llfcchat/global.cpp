@@ -2,6 +2,8 @@
 
 QString gate_url_prefix = "";
 
+bool chat_proto_codec = false;
+
 std::function<void(QWidget*)> repolish = [](QWidget *w) {
     w->style()->unpolish(w); // 移除当前的
     w->style()->polish(w); // 刷新为现在的
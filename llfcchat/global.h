@@ -11,37 +11,13 @@
 #include <QDir>
 #include <QSettings>
 #include <mutex>
+#include "reqid.h"
 
 // repolish用来根据属性刷新qss
 extern std::function<void(QWidget*)> repolish;
 
 extern std::function<QString(QString)> xorString;
 
-// ReqId 是业务操作的 “数字身份证”，用于区分请求 / 响应 / 通知类型、关联请求与处理逻辑、统一网络协议的标识解析，是客户端与服务器之间通信的 “业务指令码”。
-// _REQ：客户端 “发请求” 的标识 _RSP：服务器 “回响应” 的标识 _NOTIFY_：服务器 “推通知” 的标识
-enum ReqId{
-    ID_GET_VARIFY_CODE = 1001, //获取验证码
-    ID_REG_USER = 1002, //注册用户
-    ID_RESET_PWD = 1003, //重置密码
-    ID_LOGIN_USER = 1004, //用户登录
-    ID_CHAT_LOGIN = 1005, //登陆聊天服务器
-    ID_CHAT_LOGIN_RSP= 1006, //登陆聊天服务器回包
-    ID_SEARCH_USER_REQ = 1007, //用户搜索请求
-    ID_SEARCH_USER_RSP = 1008, //搜索用户回包
-    ID_ADD_FRIEND_REQ = 1009,  //添加好友申请
-    ID_ADD_FRIEND_RSP = 1010, //申请添加好友回复
-    ID_NOTIFY_ADD_FRIEND_REQ = 1011,  //通知用户添加好友申请
-    ID_AUTH_FRIEND_REQ = 1013,  //认证好友请求
-    ID_AUTH_FRIEND_RSP = 1014,  //认证好友回复
-    ID_NOTIFY_AUTH_FRIEND_REQ = 1015, //通知用户认证好友申请
-    ID_TEXT_CHAT_MSG_REQ  = 1017,  //文本聊天信息请求
-    ID_TEXT_CHAT_MSG_RSP  = 1018,  //文本聊天信息回复
-    ID_NOTIFY_TEXT_CHAT_MSG_REQ = 1019, //通知用户文本聊天信息
-    ID_NOTIFY_OFF_LINE_REQ = 1021, //通知用户下线
-    ID_HEART_BEAT_REQ = 1023,      //心跳请求
-    ID_HEARTBEAT_RSP = 1024,       //心跳回复
-};
-
 enum ErrorCodes{
     SUCCESS = 0,
     ERR_JSON = 1, //Json解析失败
@@ -73,6 +49,9 @@ enum ClickLbState{
 
 extern QString gate_url_prefix;
 
+//是否请求ChatServer改用protobuf编码消息体，读取自config.ini，服务器在登录回包中确认后才切换
+extern bool chat_proto_codec;
+
 
 struct ServerInfo{
     QString Host;
@@ -154,5 +133,20 @@ const std::vector<QString> names = {
 
 const int CHAT_COUNT_PER_PAGE = 13;
 
+//普通头部消息体最大长度，超过时使用扩展头部
+const int MAX_LENGTH = 1024*2;
+//普通头部长度 id(2) + len(2)
+const int HEAD_TOTAL_LEN = 4;
+//扩展头部长度 id(2) + len(4)
+const int HEAD_EXT_TOTAL_LEN = 6;
+//扩展头部标志，置于消息id的最高位
+const quint16 HEAD_EXT_FLAG = 0x8000;
+//压缩标志，置于消息id的次高位，消息体为qCompress的结果
+const quint16 HEAD_COMPRESS_FLAG = 0x4000;
+//协商压缩后超过该长度的消息才压缩
+const int COMPRESS_MIN_BYTES = 256;
+//protobuf标志，置于消息id的第三高位，消息体为client.proto中对应消息的二进制编码
+const quint16 HEAD_PROTO_FLAG = 0x2000;
+
 
 #endif // GLOBAL_H
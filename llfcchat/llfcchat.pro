@@ -43,6 +43,7 @@ SOURCES += \
         mainwindow.cpp \
         messagetextedit.cpp \
         picturebubble.cpp \
+        protocodec.cpp \
         registerdialog.cpp \
         resetdialog.cpp \
         searchlist.cpp \
@@ -86,7 +87,10 @@ HEADERS += \
         mainwindow.h \
         messagetextedit.h \
         picturebubble.h \
+        protocodec.h \
+        protofields.h \
         registerdialog.h \
+        reqid.h \
         resetdialog.h \
         searchlist.h \
         singleton.h \
@@ -231,6 +231,14 @@ void LoginDialog::slot_tcp_con_finish(bool bsuccess)
         QJsonObject jsonObj;
         jsonObj["uid"] = _uid;
         jsonObj["token"] = _token;
+        //支持扩展头部，服务器可以发送超过MAX_LENGTH的回包(好友列表等)，在登录回包中确认后客户端也可以发送
+        jsonObj["ext_head"] = true;
+        //请求压缩，服务器在登录回包中确认后双方对较大的消息压缩发送
+        jsonObj["compress"] = "deflate";
+        //配置为protobuf时请求服务器切换，登录请求本身按json发送，服务器在回包中确认后才切换
+        if(chat_proto_codec){
+            jsonObj["codec"] = "proto";
+        }
 
         QJsonDocument doc(jsonObj);
         QByteArray jsonData = doc.toJson(QJsonDocument::Indented); // 将 JSON 文档转为带缩进的字节数组（QByteArray），方便调试和服务器解析。
@@ -30,6 +30,7 @@ int main(int argc, char *argv[])
     QString gate_host = settings.value("GateServer/host").toString();
     QString gate_port = settings.value("GateServer/port").toString();
     gate_url_prefix = "http://"+gate_host+":"+gate_port;
+    chat_proto_codec = settings.value("ChatServer/codec").toString() == "proto";
 
     MainWindow w;
     w.show();
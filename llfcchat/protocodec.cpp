@@ -0,0 +1,251 @@
+#include "protocodec.h"
+#include "protofields.h"
+#include <QJsonArray>
+
+namespace {
+
+enum WireType {
+    WIRE_VARINT = 0,
+    WIRE_FIXED64 = 1,
+    WIRE_LEN = 2,
+    WIRE_FIXED32 = 5,
+};
+
+void PutVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+void PutKey(QByteArray& out, int tag, WireType type)
+{
+    PutVarint(out, (static_cast<quint64>(tag) << 3) | type);
+}
+
+void PutBytes(QByteArray& out, int tag, const QByteArray& bytes)
+{
+    PutKey(out, tag, WIRE_LEN);
+    PutVarint(out, static_cast<quint64>(bytes.size()));
+    out.append(bytes);
+}
+
+// 界面构造json时数字和字符串混用(如搜索时uid为字符串)，按字段类型转换
+int ToInt(const QJsonValue& value)
+{
+    if (value.isString()) {
+        return value.toString().toInt();
+    }
+    if (value.isBool()) {
+        return value.toBool() ? 1 : 0;
+    }
+    return value.toInt();
+}
+
+QString ToString(const QJsonValue& value)
+{
+    if (value.isDouble()) {
+        return QString::number(value.toInt());
+    }
+    return value.toString();
+}
+
+// proto3只编码非默认值，int32负数按int64符号扩展为10字节varint
+void EncodeObject(const QJsonObject& obj, const ProtoField* fields, QByteArray& out)
+{
+    for (const ProtoField* field = fields; field->tag != 0; ++field) {
+        QJsonValue value = obj.value(field->name);
+        if (value.isUndefined() || value.isNull()) {
+            continue;
+        }
+        switch (field->type) {
+        case FIELD_INT32: {
+            int v = ToInt(value);
+            if (v != 0) {
+                PutKey(out, field->tag, WIRE_VARINT);
+                PutVarint(out, static_cast<quint64>(static_cast<qint64>(v)));
+            }
+            break;
+        }
+        case FIELD_BOOL:
+            if (ToInt(value) != 0) {
+                PutKey(out, field->tag, WIRE_VARINT);
+                PutVarint(out, 1);
+            }
+            break;
+        case FIELD_STRING: {
+            QByteArray bytes = ToString(value).toUtf8();
+            if (!bytes.isEmpty()) {
+                PutBytes(out, field->tag, bytes);
+            }
+            break;
+        }
+        case FIELD_MESSAGE: {
+            const QJsonArray array = value.toArray();
+            for (const QJsonValue& item : array) {
+                QByteArray sub;
+                EncodeObject(item.toObject(), field->sub, sub);
+                PutBytes(out, field->tag, sub);
+            }
+            break;
+        }
+        }
+    }
+}
+
+class Reader {
+public:
+    Reader(const char* data, int len) :_ptr(data), _end(data + len) {}
+
+    bool Done() const {
+        return _ptr >= _end;
+    }
+
+    bool ReadVarint(quint64& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (_ptr >= _end) {
+                return false;
+            }
+            auto byte = static_cast<uchar>(*_ptr++);
+            value |= static_cast<quint64>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Skip(quint64 len) {
+        if (static_cast<quint64>(_end - _ptr) < len) {
+            return false;
+        }
+        _ptr += len;
+        return true;
+    }
+
+    const char* Pos() const {
+        return _ptr;
+    }
+
+private:
+    const char* _ptr;
+    const char* _end;
+};
+
+const ProtoField* FindField(const ProtoField* fields, int tag)
+{
+    for (const ProtoField* field = fields; field->tag != 0; ++field) {
+        if (field->tag == tag) {
+            return field;
+        }
+    }
+    return nullptr;
+}
+
+// 先按proto3默认值填充全部字段，处理函数依赖error等字段一定存在
+bool DecodeObject(const char* data, int len, const ProtoField* fields, QJsonObject& obj)
+{
+    for (const ProtoField* field = fields; field->tag != 0; ++field) {
+        switch (field->type) {
+        case FIELD_INT32: obj[field->name] = 0; break;
+        case FIELD_BOOL: obj[field->name] = false; break;
+        case FIELD_STRING: obj[field->name] = QString(); break;
+        case FIELD_MESSAGE: obj[field->name] = QJsonArray(); break;
+        }
+    }
+
+    Reader reader(data, len);
+    while (!reader.Done()) {
+        quint64 key = 0;
+        if (!reader.ReadVarint(key)) {
+            return false;
+        }
+        int tag = static_cast<int>(key >> 3);
+        int type = static_cast<int>(key & 0x7);
+        const ProtoField* field = FindField(fields, tag);
+
+        if (type == WIRE_VARINT) {
+            quint64 value = 0;
+            if (!reader.ReadVarint(value)) {
+                return false;
+            }
+            if (field && field->type == FIELD_INT32) {
+                obj[field->name] = static_cast<int>(static_cast<qint32>(value));
+            } else if (field && field->type == FIELD_BOOL) {
+                obj[field->name] = value != 0;
+            }
+            continue;
+        }
+
+        if (type == WIRE_LEN) {
+            quint64 size = 0;
+            if (!reader.ReadVarint(size)) {
+                return false;
+            }
+            const char* begin = reader.Pos();
+            if (!reader.Skip(size)) {
+                return false;
+            }
+            if (field && field->type == FIELD_STRING) {
+                obj[field->name] = QString::fromUtf8(begin, static_cast<int>(size));
+            } else if (field && field->type == FIELD_MESSAGE) {
+                QJsonObject sub;
+                if (!DecodeObject(begin, static_cast<int>(size), field->sub, sub)) {
+                    return false;
+                }
+                QJsonArray array = obj[field->name].toArray();
+                array.append(sub);
+                obj[field->name] = array;
+            }
+            continue;
+        }
+
+        //新版本增加的未知字段直接跳过
+        if (type == WIRE_FIXED64) {
+            if (!reader.Skip(8)) {
+                return false;
+            }
+        } else if (type == WIRE_FIXED32) {
+            if (!reader.Skip(4)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+bool ProtoCodec::JsonToProto(ReqId id, const QByteArray& json, QByteArray& out)
+{
+    const ProtoField* fields = FieldsOf(id);
+    if (fields == nullptr) {
+        return false;
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (!doc.isObject()) {
+        return false;
+    }
+    out.clear();
+    EncodeObject(doc.object(), fields, out);
+    return true;
+}
+
+bool ProtoCodec::ProtoToJson(ReqId id, const QByteArray& proto, QByteArray& out)
+{
+    const ProtoField* fields = FieldsOf(id);
+    if (fields == nullptr) {
+        return false;
+    }
+    QJsonObject obj;
+    if (!DecodeObject(proto.constData(), proto.size(), fields, obj)) {
+        return false;
+    }
+    out = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+    return true;
+}
@@ -0,0 +1,18 @@
+#ifndef PROTOCODEC_H
+#define PROTOCODEC_H
+#include <QByteArray>
+#include "global.h"
+
+// 客户端消息的protobuf编解码，字段定义与ChatServer/client.proto一致
+// 界面和TcpMgr的消息处理仍然使用json，收发时在TcpMgr中按消息id转换，
+// 不需要引入protobuf库
+class ProtoCodec
+{
+public:
+    // json消息体编码为protobuf，id没有对应的消息定义或json无效时返回false
+    static bool JsonToProto(ReqId id, const QByteArray& json, QByteArray& out);
+    // protobuf消息体解码为json，未出现的字段按proto3的默认值补齐
+    static bool ProtoToJson(ReqId id, const QByteArray& proto, QByteArray& out);
+};
+
+#endif // PROTOCODEC_H
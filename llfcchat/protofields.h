@@ -0,0 +1,209 @@
+#ifndef PROTOFIELDS_H
+#define PROTOFIELDS_H
+#include "reqid.h"
+
+// 客户端消息的protobuf字段表，ProtoCodec按表编解码
+// 不依赖Qt，ChatServer/ProtoCheck引用同一份表，与服务器Visit和client.proto逐个比对
+namespace {
+
+enum FieldType {
+    FIELD_INT32,
+    FIELD_BOOL,
+    FIELD_STRING,
+    FIELD_MESSAGE, // repeated的嵌套消息，json中对应数组
+};
+
+struct ProtoField {
+    int tag;
+    const char* name;
+    FieldType type;
+    const ProtoField* sub; // FIELD_MESSAGE的元素字段表
+};
+
+// 各字段表以tag为0的项结尾
+const ProtoField TEXT_CHAT_DATA[] = {
+    {1, "msgid", FIELD_STRING, nullptr},
+    {2, "content", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField APPLY_INFO[] = {
+    {1, "uid", FIELD_INT32, nullptr},
+    {2, "name", FIELD_STRING, nullptr},
+    {3, "nick", FIELD_STRING, nullptr},
+    {4, "icon", FIELD_STRING, nullptr},
+    {5, "sex", FIELD_INT32, nullptr},
+    {6, "desc", FIELD_STRING, nullptr},
+    {7, "status", FIELD_INT32, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField FRIEND_INFO[] = {
+    {1, "uid", FIELD_INT32, nullptr},
+    {2, "name", FIELD_STRING, nullptr},
+    {3, "nick", FIELD_STRING, nullptr},
+    {4, "icon", FIELD_STRING, nullptr},
+    {5, "sex", FIELD_INT32, nullptr},
+    {6, "desc", FIELD_STRING, nullptr},
+    {7, "back", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField CHAT_LOGIN_REQ[] = {
+    {1, "uid", FIELD_INT32, nullptr},
+    {2, "token", FIELD_STRING, nullptr},
+    {3, "ext_head", FIELD_BOOL, nullptr},
+    {4, "compress", FIELD_STRING, nullptr},
+    {5, "codec", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField CHAT_LOGIN_RSP[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "uid", FIELD_INT32, nullptr},
+    {3, "pwd", FIELD_STRING, nullptr},
+    {4, "name", FIELD_STRING, nullptr},
+    {5, "email", FIELD_STRING, nullptr},
+    {6, "nick", FIELD_STRING, nullptr},
+    {7, "desc", FIELD_STRING, nullptr},
+    {8, "sex", FIELD_INT32, nullptr},
+    {9, "icon", FIELD_STRING, nullptr},
+    {10, "apply_list", FIELD_MESSAGE, APPLY_INFO},
+    {11, "friend_list", FIELD_MESSAGE, FRIEND_INFO},
+    {12, "compress", FIELD_STRING, nullptr},
+    {13, "retry_after", FIELD_INT32, nullptr},
+    {14, "ext_head", FIELD_BOOL, nullptr},
+    {15, "codec", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField SEARCH_USER_REQ[] = {
+    {1, "uid", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField SEARCH_USER_RSP[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "uid", FIELD_INT32, nullptr},
+    {3, "pwd", FIELD_STRING, nullptr},
+    {4, "name", FIELD_STRING, nullptr},
+    {5, "email", FIELD_STRING, nullptr},
+    {6, "nick", FIELD_STRING, nullptr},
+    {7, "desc", FIELD_STRING, nullptr},
+    {8, "sex", FIELD_INT32, nullptr},
+    {9, "icon", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField ADD_FRIEND_REQ[] = {
+    {1, "uid", FIELD_INT32, nullptr},
+    {2, "applyname", FIELD_STRING, nullptr},
+    {3, "bakname", FIELD_STRING, nullptr},
+    {4, "touid", FIELD_INT32, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField ERROR_ONLY_RSP[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField NOTIFY_ADD_FRIEND[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "applyuid", FIELD_INT32, nullptr},
+    {3, "name", FIELD_STRING, nullptr},
+    {4, "desc", FIELD_STRING, nullptr},
+    {5, "icon", FIELD_STRING, nullptr},
+    {6, "sex", FIELD_INT32, nullptr},
+    {7, "nick", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField AUTH_FRIEND_REQ[] = {
+    {1, "fromuid", FIELD_INT32, nullptr},
+    {2, "touid", FIELD_INT32, nullptr},
+    {3, "back", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField AUTH_FRIEND_RSP[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "uid", FIELD_INT32, nullptr},
+    {3, "name", FIELD_STRING, nullptr},
+    {4, "nick", FIELD_STRING, nullptr},
+    {5, "icon", FIELD_STRING, nullptr},
+    {6, "sex", FIELD_INT32, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField NOTIFY_AUTH_FRIEND[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "fromuid", FIELD_INT32, nullptr},
+    {3, "touid", FIELD_INT32, nullptr},
+    {4, "name", FIELD_STRING, nullptr},
+    {5, "nick", FIELD_STRING, nullptr},
+    {6, "icon", FIELD_STRING, nullptr},
+    {7, "sex", FIELD_INT32, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField TEXT_CHAT_MSG_REQ[] = {
+    {1, "fromuid", FIELD_INT32, nullptr},
+    {2, "touid", FIELD_INT32, nullptr},
+    {3, "text_array", FIELD_MESSAGE, TEXT_CHAT_DATA},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField TEXT_CHAT_MSG_RSP[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "fromuid", FIELD_INT32, nullptr},
+    {3, "touid", FIELD_INT32, nullptr},
+    {4, "text_array", FIELD_MESSAGE, TEXT_CHAT_DATA},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField NOTIFY_OFFLINE[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "uid", FIELD_INT32, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField HEART_BEAT_REQ[] = {
+    {1, "fromuid", FIELD_INT32, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField NOTIFY_SYSTEM_MSG[] = {
+    {1, "error", FIELD_INT32, nullptr},
+    {2, "type", FIELD_INT32, nullptr},
+    {3, "content", FIELD_STRING, nullptr},
+    {0, nullptr, FIELD_INT32, nullptr},
+};
+
+const ProtoField* FieldsOf(ReqId id)
+{
+    switch (id) {
+    case ID_CHAT_LOGIN: return CHAT_LOGIN_REQ;
+    case ID_CHAT_LOGIN_RSP: return CHAT_LOGIN_RSP;
+    case ID_SEARCH_USER_REQ: return SEARCH_USER_REQ;
+    case ID_SEARCH_USER_RSP: return SEARCH_USER_RSP;
+    case ID_ADD_FRIEND_REQ: return ADD_FRIEND_REQ;
+    case ID_ADD_FRIEND_RSP: return ERROR_ONLY_RSP;
+    case ID_NOTIFY_ADD_FRIEND_REQ: return NOTIFY_ADD_FRIEND;
+    case ID_AUTH_FRIEND_REQ: return AUTH_FRIEND_REQ;
+    case ID_AUTH_FRIEND_RSP: return AUTH_FRIEND_RSP;
+    case ID_NOTIFY_AUTH_FRIEND_REQ: return NOTIFY_AUTH_FRIEND;
+    case ID_TEXT_CHAT_MSG_REQ: return TEXT_CHAT_MSG_REQ;
+    case ID_TEXT_CHAT_MSG_RSP: return TEXT_CHAT_MSG_RSP;
+    case ID_NOTIFY_TEXT_CHAT_MSG_REQ: return TEXT_CHAT_MSG_RSP;
+    case ID_NOTIFY_OFF_LINE_REQ: return NOTIFY_OFFLINE;
+    case ID_HEART_BEAT_REQ: return HEART_BEAT_REQ;
+    case ID_HEARTBEAT_RSP: return ERROR_ONLY_RSP;
+    case ID_NOTIFY_SYSTEM_MSG_REQ: return NOTIFY_SYSTEM_MSG;
+    default: return nullptr;
+    }
+}
+
+}
+
+#endif // PROTOFIELDS_H
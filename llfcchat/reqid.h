@@ -0,0 +1,35 @@
+#ifndef REQID_H
+#define REQID_H
+
+// 消息id单独放在不依赖Qt的头文件中，ChatServer/ProtoCheck可以直接引用客户端的字段表
+// ReqId 是业务操作的 “数字身份证”，用于区分请求 / 响应 / 通知类型、关联请求与处理逻辑、统一网络协议的标识解析，是客户端与服务器之间通信的 “业务指令码”。
+// _REQ：客户端 “发请求” 的标识 _RSP：服务器 “回响应” 的标识 _NOTIFY_：服务器 “推通知” 的标识
+enum ReqId{
+    ID_GET_VARIFY_CODE = 1001, //获取验证码
+    ID_REG_USER = 1002, //注册用户
+    ID_RESET_PWD = 1003, //重置密码
+    ID_LOGIN_USER = 1004, //用户登录
+    ID_CHAT_LOGIN = 1005, //登陆聊天服务器
+    ID_CHAT_LOGIN_RSP= 1006, //登陆聊天服务器回包
+    ID_SEARCH_USER_REQ = 1007, //用户搜索请求
+    ID_SEARCH_USER_RSP = 1008, //搜索用户回包
+    ID_ADD_FRIEND_REQ = 1009,  //添加好友申请
+    ID_ADD_FRIEND_RSP = 1010, //申请添加好友回复
+    ID_NOTIFY_ADD_FRIEND_REQ = 1011,  //通知用户添加好友申请
+    ID_AUTH_FRIEND_REQ = 1013,  //认证好友请求
+    ID_AUTH_FRIEND_RSP = 1014,  //认证好友回复
+    ID_NOTIFY_AUTH_FRIEND_REQ = 1015, //通知用户认证好友申请
+    ID_TEXT_CHAT_MSG_REQ  = 1017,  //文本聊天信息请求
+    ID_TEXT_CHAT_MSG_RSP  = 1018,  //文本聊天信息回复
+    ID_NOTIFY_TEXT_CHAT_MSG_REQ = 1019, //通知用户文本聊天信息
+    ID_NOTIFY_OFF_LINE_REQ = 1021, //通知用户下线
+    ID_HEART_BEAT_REQ = 1023,      //心跳请求
+    ID_HEARTBEAT_RSP = 1024,       //心跳回复
+    ID_NOTIFY_SYSTEM_MSG_REQ = 1025, //通知用户系统公告
+};
+
+//聊天服务器消息id的范围，和服务器ClientMsg.h中的MSG_ID_BEGIN/MSG_ID_END保持一致
+const int ID_CHAT_MSG_BEGIN = ID_CHAT_LOGIN;
+const int ID_CHAT_MSG_END = ID_NOTIFY_SYSTEM_MSG_REQ + 1;
+
+#endif // REQID_H
@@ -1,8 +1,11 @@
 #include "tcpmgr.h"
 #include <QAbstractSocket>
+#include <QtEndian>
 #include "usermgr.h"
+#include "protocodec.h"
 
-TcpMgr::TcpMgr():_host(""),_port(0),_b_recv_pending(false),_message_id(0),_message_len(0)
+TcpMgr::TcpMgr():_host(""),_port(0),_b_recv_pending(false),_message_id(0),_message_len(0),
+    _message_compressed(false),_message_proto(false),_b_compress(false),_b_ext_head(false),_b_proto(false)
 {
     QObject::connect(&_socket, &QTcpSocket::connected, [&]() {
         qDebug() << "Connected to server!";
@@ -15,22 +18,34 @@ TcpMgr::TcpMgr():_host(""),_port(0),_b_recv_pending(false),_message_id(0),_messa
         // 读取所有数据并追加到缓冲区
         _buffer.append(_socket.readAll());
 
-        QDataStream stream(&_buffer, QIODevice::ReadOnly);
-        stream.setVersion(QDataStream::Qt_5_0);
-
         forever {
             //先解析头部
             if(!_b_recv_pending){
                 // 检查缓冲区中的数据是否足够解析出一个消息头（消息ID + 消息长度）
-                if (_buffer.size() < static_cast<int>(sizeof(quint16) * 2)) {
+                if (_buffer.size() < HEAD_TOTAL_LEN) {
                     return; // 数据不够，等待更多数据
                 }
 
-                // 预读取消息ID和消息长度，但不从缓冲区中移除
-                stream >> _message_id >> _message_len;
+                // 预读取消息ID，最高位置位表示扩展头部，长度字段为4字节
+                auto head = reinterpret_cast<const uchar*>(_buffer.constData());
+                quint16 raw_id = qFromBigEndian<quint16>(head);
+                int head_len = HEAD_TOTAL_LEN;
+                if(raw_id & HEAD_EXT_FLAG){
+                    if (_buffer.size() < HEAD_EXT_TOTAL_LEN) {
+                        return;
+                    }
+                    _message_len = qFromBigEndian<quint32>(head + sizeof(quint16));
+                    head_len = HEAD_EXT_TOTAL_LEN;
+                }else{
+                    _message_len = qFromBigEndian<quint16>(head + sizeof(quint16));
+                }
+                _message_id = raw_id & ~(HEAD_EXT_FLAG | HEAD_COMPRESS_FLAG | HEAD_PROTO_FLAG);
+                //次高位置位表示消息体经过压缩，格式与qCompress一致
+                _message_compressed = (raw_id & HEAD_COMPRESS_FLAG) != 0;
+                _message_proto = (raw_id & HEAD_PROTO_FLAG) != 0;
 
-                //将buffer 中的前四个字节移除
-                _buffer = _buffer.mid(sizeof(quint16) * 2);
+                //将buffer 中的头部移除
+                _buffer = _buffer.mid(head_len);
 
                 // 输出读取的数据
                 qDebug() << "Message ID:" << _message_id << ", Length:" << _message_len;
@@ -38,7 +53,7 @@ TcpMgr::TcpMgr():_host(""),_port(0),_b_recv_pending(false),_message_id(0),_messa
             }
 
             //buffer剩余长读是否满足消息体长度，不满足则退出继续等待接受
-            if(_buffer.size() < _message_len){
+            if(static_cast<quint32>(_buffer.size()) < _message_len){
                 _b_recv_pending = true;
                 return;
             }
@@ -49,7 +64,23 @@ TcpMgr::TcpMgr():_host(""),_port(0),_b_recv_pending(false),_message_id(0),_messa
             qDebug() << "receive body msg is " << messageBody ;
 
             _buffer = _buffer.mid(_message_len);
-            handleMsg(ReqId(_message_id),_message_len, messageBody);
+            if(_message_compressed){
+                messageBody = qUncompress(messageBody);
+                if(messageBody.isEmpty()){
+                    qDebug() << "uncompress msg failed, Message ID:" << _message_id;
+                    continue;
+                }
+            }
+            //protobuf消息体转成json，处理函数不区分编码
+            if(_message_proto){
+                QByteArray jsonBody;
+                if(!ProtoCodec::ProtoToJson(ReqId(_message_id), messageBody, jsonBody)){
+                    qDebug() << "decode proto msg failed, Message ID:" << _message_id;
+                    continue;
+                }
+                messageBody = jsonBody;
+            }
+            handleMsg(ReqId(_message_id),messageBody.size(), messageBody);
         }
 
     });
@@ -83,7 +114,7 @@ TcpMgr::~TcpMgr(){
 void TcpMgr::initHandlers()
 {
     //auto self = shared_from_this();
-    _handlers.insert(ID_CHAT_LOGIN_RSP, [this](ReqId id, int len, QByteArray data){
+    registerHandler(ID_CHAT_LOGIN_RSP, [this](ReqId id, int len, QByteArray data){
         Q_UNUSED(len);
         qDebug()<< "handle id is "<< id ;
         // 将QByteArray转换为QJsonDocument
@@ -107,11 +138,19 @@ void TcpMgr::initHandlers()
 
         int err = jsonObj["error"].toInt();
         if(err != ErrorCodes::SUCCESS){
-            qDebug() << "Login Failed, err is " << err ;
+            //服务器过载时带有建议的重试间隔
+            qDebug() << "Login Failed, err is " << err << " retry after " << jsonObj["retry_after"].toInt();
             emit sig_login_failed(err);
             return;
         }
 
+        //服务器确认压缩后，之后发送的较大消息也压缩
+        _b_compress = jsonObj["compress"].toString() == "deflate";
+        //服务器确认扩展头部后，才发送超过MAX_LENGTH的消息
+        _b_ext_head = jsonObj["ext_head"].toBool();
+        //服务器确认protobuf后，之后的请求按protobuf发送，旧版本服务器不会确认
+        _b_proto = jsonObj["codec"].toString() == "proto";
+
         auto uid = jsonObj["uid"].toInt();
         auto name = jsonObj["name"].toString();
         auto nick = jsonObj["nick"].toString();
@@ -136,7 +175,7 @@ void TcpMgr::initHandlers()
     });
 
 
-    _handlers.insert(ID_SEARCH_USER_RSP, [this](ReqId id, int len, QByteArray data) {
+    registerHandler(ID_SEARCH_USER_RSP, [this](ReqId id, int len, QByteArray data) {
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -171,7 +210,7 @@ void TcpMgr::initHandlers()
         emit sig_user_search(search_info);
     });
 
-    _handlers.insert(ID_NOTIFY_ADD_FRIEND_REQ, [this](ReqId id, int len, QByteArray data) {
+    registerHandler(ID_NOTIFY_ADD_FRIEND_REQ, [this](ReqId id, int len, QByteArray data) {
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -214,7 +253,7 @@ void TcpMgr::initHandlers()
         emit sig_friend_apply(apply_info);
     });
 
-    _handlers.insert(ID_NOTIFY_AUTH_FRIEND_REQ, [this](ReqId id, int len, QByteArray data) {
+    registerHandler(ID_NOTIFY_AUTH_FRIEND_REQ, [this](ReqId id, int len, QByteArray data) {
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -251,7 +290,7 @@ void TcpMgr::initHandlers()
         emit sig_add_auth_friend(auth_info);
     });
 
-    _handlers.insert(ID_ADD_FRIEND_RSP, [this](ReqId id, int len, QByteArray data) {
+    registerHandler(ID_ADD_FRIEND_RSP, [this](ReqId id, int len, QByteArray data) {
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -281,7 +320,7 @@ void TcpMgr::initHandlers()
     });
 
 
-    _handlers.insert(ID_AUTH_FRIEND_RSP, [this](ReqId id, int len, QByteArray data) {
+    registerHandler(ID_AUTH_FRIEND_RSP, [this](ReqId id, int len, QByteArray data) {
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -319,7 +358,7 @@ void TcpMgr::initHandlers()
     });
 
 
-    _handlers.insert(ID_TEXT_CHAT_MSG_RSP, [this](ReqId id, int len, QByteArray data) {
+    registerHandler(ID_TEXT_CHAT_MSG_RSP, [this](ReqId id, int len, QByteArray data) {
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -349,7 +388,7 @@ void TcpMgr::initHandlers()
         //ui设置送达等标记 todo...
     });
 
-    _handlers.insert(ID_NOTIFY_TEXT_CHAT_MSG_REQ, [this](ReqId id, int len, QByteArray data) {
+    registerHandler(ID_NOTIFY_TEXT_CHAT_MSG_REQ, [this](ReqId id, int len, QByteArray data) {
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -381,7 +420,7 @@ void TcpMgr::initHandlers()
         emit sig_text_chat_msg(msg_ptr);
     });
 
-    _handlers.insert(ID_NOTIFY_OFF_LINE_REQ,[this](ReqId id, int len, QByteArray data){
+    registerHandler(ID_NOTIFY_OFF_LINE_REQ,[this](ReqId id, int len, QByteArray data){
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -415,7 +454,7 @@ void TcpMgr::initHandlers()
 
     });
 
-    _handlers.insert(ID_HEARTBEAT_RSP,[this](ReqId id, int len, QByteArray data){
+    registerHandler(ID_HEARTBEAT_RSP,[this](ReqId id, int len, QByteArray data){
         Q_UNUSED(len);
         qDebug() << "handle id is " << id << " data is " << data;
         // 将QByteArray转换为QJsonDocument
@@ -445,17 +484,53 @@ void TcpMgr::initHandlers()
 
     });
 
+    registerHandler(ID_NOTIFY_SYSTEM_MSG_REQ,[this](ReqId id, int len, QByteArray data){
+        Q_UNUSED(len);
+        qDebug() << "handle id is " << id << " data is " << data;
+        // 将QByteArray转换为QJsonDocument
+        QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
+
+        // 检查转换是否成功
+        if (jsonDoc.isNull()) {
+            qDebug() << "Failed to create QJsonDocument.";
+            return;
+        }
+
+        QJsonObject jsonObj = jsonDoc.object();
+
+        if (!jsonObj.contains("error")) {
+            int err = ErrorCodes::ERR_JSON;
+            qDebug() << "System Notice Failed, err is Json Parse Err" << err;
+            return;
+        }
+
+        int err = jsonObj["error"].toInt();
+        if (err != ErrorCodes::SUCCESS) {
+            qDebug() << "System Notice Failed, err is " << err;
+            return;
+        }
+
+        qDebug() << "Receive System Notice Success" ;
+        emit sig_system_notice(jsonObj["type"].toInt(), jsonObj["content"].toString());
+    });
+
+}
+
+void TcpMgr::registerHandler(ReqId id, MsgHandler handler)
+{
+    Q_ASSERT(id >= ID_CHAT_MSG_BEGIN && id < ID_CHAT_MSG_END);
+    _handlers[id - ID_CHAT_MSG_BEGIN] = std::move(handler);
 }
 
 void TcpMgr::handleMsg(ReqId id, int len, QByteArray data)
 {
-    auto find_iter =  _handlers.find(id);
-    if(find_iter == _handlers.end()){
+    //消息id是连续的，直接按id下标查表
+    if(id < ID_CHAT_MSG_BEGIN || id >= ID_CHAT_MSG_END || !_handlers[id - ID_CHAT_MSG_BEGIN]){
         qDebug()<< "not found id ["<< id << "] to handle";
         return ;
     }
 
-    find_iter.value()(id, len, data);
+    _handlers[id - ID_CHAT_MSG_BEGIN](id, len, data);
 }
 
 void TcpMgr::slot_tcp_connect(ServerInfo si)
@@ -465,6 +540,10 @@ void TcpMgr::slot_tcp_connect(ServerInfo si)
     qDebug() << "Connecting to server...";
     _host = si.Host;
     _port = static_cast<uint16_t>(si.Port.toUInt());
+    //压缩、扩展头部和编码需要在新连接的登录中重新协商，登录请求按json发送
+    _b_compress = false;
+    _b_ext_head = false;
+    _b_proto = false;
     _socket.connectToHost(si.Host, _port);
 }
 
@@ -472,9 +551,6 @@ void TcpMgr::slot_send_data(ReqId reqId, QByteArray dataBytes)
 {
     uint16_t id = reqId;
 
-    // 计算长度（使用网络字节序转换）
-    quint16 len = static_cast<quint16>(dataBytes.length());
-
     // 创建一个QByteArray用于存储要发送的所有数据
     QByteArray block;
     QDataStream out(&block, QIODevice::WriteOnly);
@@ -482,8 +558,37 @@ void TcpMgr::slot_send_data(ReqId reqId, QByteArray dataBytes)
     // 设置数据流使用网络字节序
     out.setByteOrder(QDataStream::BigEndian);
 
-    // 写入ID和长度
-    out << id << len;
+    //服务器在登录回包中确认protobuf后按client.proto编码
+    if(_b_proto){
+        QByteArray protoBytes;
+        if(ProtoCodec::JsonToProto(reqId, dataBytes, protoBytes)){
+            dataBytes = protoBytes;
+            id |= HEAD_PROTO_FLAG;
+        }
+    }
+
+    //协商了压缩时较大的消息压缩发送，压缩后没有变小的按原文发送
+    if(_b_compress && dataBytes.length() >= COMPRESS_MIN_BYTES){
+        QByteArray packed = qCompress(dataBytes);
+        if(packed.length() < dataBytes.length()){
+            dataBytes = packed;
+            id |= HEAD_COMPRESS_FLAG;
+        }
+    }
+
+    // 写入ID和长度，超过MAX_LENGTH的消息使用扩展头部，服务器没有确认时无法发送
+    if(dataBytes.length() > MAX_LENGTH){
+        if(!_b_ext_head){
+            qDebug() << "msg too long without ext head, Message ID:" << reqId << ", Length:" << dataBytes.length();
+            return;
+        }
+        quint16 ext_id = id | HEAD_EXT_FLAG;
+        quint32 len = static_cast<quint32>(dataBytes.length());
+        out << ext_id << len;
+    }else{
+        quint16 len = static_cast<quint16>(dataBytes.length());
+        out << id << len;
+    }
 
     // 添加字符串数据
     block.append(dataBytes);
@@ -4,6 +4,7 @@
 #include "singleton.h"
 #include "global.h"
 #include <functional>
+#include <array>
 #include <QObject>
 #include "userdata.h"
 #include <QJsonArray>
@@ -18,7 +19,9 @@ public:
 private:
     friend class Singleton<TcpMgr>;
     TcpMgr();
+    typedef std::function<void(ReqId id, int len, QByteArray data)> MsgHandler;
     void initHandlers();
+    void registerHandler(ReqId id, MsgHandler handler);
     // 根据消息 ID 分发到对应的处理器
     void handleMsg(ReqId id, int len, QByteArray data);
     QTcpSocket _socket;
@@ -27,8 +30,14 @@ private:
     QByteArray _buffer;
     bool _b_recv_pending; // 接收状态标记，标识是否有未处理的接收数据
     quint16 _message_id;
-    quint16 _message_len;
-    QMap<ReqId, std::function<void(ReqId id, int len, QByteArray data)>> _handlers;
+    quint32 _message_len;
+    bool _message_compressed; // 当前消息体是否经过压缩
+    bool _message_proto; // 当前消息体是否为protobuf编码
+    bool _b_compress; // 登录时是否协商了压缩
+    bool _b_ext_head; // 服务器是否在登录回包中确认了扩展头部
+    bool _b_proto; // 服务器是否在登录回包中确认了protobuf编码
+    // 聊天服务器的消息id连续分配，处理函数按 id - ID_CHAT_MSG_BEGIN 存放
+    std::array<MsgHandler, ID_CHAT_MSG_END - ID_CHAT_MSG_BEGIN> _handlers;
 public slots:
     void slot_tcp_connect(ServerInfo);
     void slot_send_data(ReqId reqId, QByteArray data);
@@ -44,6 +53,7 @@ signals:
     void sig_auth_rsp(std::shared_ptr<AuthRsp>);
     void sig_text_chat_msg(std::shared_ptr<TextChatMsg> msg);
     void sig_notify_offline();
+    void sig_system_notice(int type, QString content);
     void sig_connection_closed();
 };
 